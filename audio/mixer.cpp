@@ -144,6 +144,16 @@ public:
 	 */
 	SoundHandle getHandle() const { return _handle; }
 
+	/**
+	 * Fills in the channel's part of the mixer statistics.
+	 */
+	void getStatistics(MixerStatistics::ChannelStatistics &stats) const;
+
+	/**
+	 * Clears the channel's statistics counters.
+	 */
+	void resetStatistics();
+
 private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
@@ -165,6 +175,11 @@ private:
 	uint32 _pauseStartTime;
 	uint32 _pauseTime;
 
+	uint32 _statsMixCalls;
+	uint64 _statsFrames;
+	uint64 _statsDecodeMicros;
+	uint32 _statsMaxDecodeMicros;
+
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
 };
@@ -175,7 +190,7 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings(), _statsEnabled(false), _stats() {
 
 	assert(sampleRate > 0);
 
@@ -269,8 +284,16 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
+	const bool collectStats = _statsEnabled;
+	uint64 startMicros = 0, lockedMicros = 0;
+	if (collectStats)
+		startMicros = g_system->getMicros();
+
 	Common::StackLock lock(_mutex);
 
+	if (collectStats)
+		lockedMicros = g_system->getMicros();
+
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
@@ -297,9 +320,62 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 			}
 		}
 
+	if (collectStats)
+		recordCallback(startMicros, lockedMicros, g_system->getMicros(), len);
+
 	return res;
 }
 
+void MixerImpl::recordCallback(uint64 startMicros, uint64 lockedMicros, uint64 endMicros, uint len) {
+	const uint32 duration = (uint32)(endMicros - startMicros);
+	const uint32 lockWait = (uint32)(lockedMicros - startMicros);
+
+	_stats.callbacks++;
+	_stats.callbackMicros += duration;
+	_stats.maxCallbackMicros = MAX(_stats.maxCallbackMicros, duration);
+	_stats.lockWaitMicros += lockWait;
+	_stats.maxLockWaitMicros = MAX(_stats.maxLockWaitMicros, lockWait);
+
+	int bucket = 0;
+	uint32 limit = MixerStatistics::kHistogramFirstBucketMicros;
+	while (bucket < MixerStatistics::kHistogramBuckets - 1 && duration >= limit) {
+		bucket++;
+		limit *= 2;
+	}
+	_stats.callbackHistogram[bucket]++;
+
+	// len is in sample pairs here
+	if ((uint64)duration * _sampleRate > (uint64)len * 1000000)
+		_stats.underruns++;
+}
+
+void MixerImpl::setStatisticsEnabled(bool enabled) {
+	Common::StackLock lock(_mutex);
+	_statsEnabled = enabled;
+}
+
+void MixerImpl::getStatistics(MixerStatistics &stats) {
+	Common::StackLock lock(_mutex);
+
+	stats = _stats;
+	stats.outputRate = _sampleRate;
+	stats.numChannels = 0;
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i] && stats.numChannels < MixerStatistics::kMaxChannels)
+			_channels[i]->getStatistics(stats.channels[stats.numChannels++]);
+	}
+}
+
+void MixerImpl::resetStatistics() {
+	Common::StackLock lock(_mutex);
+
+	_stats = MixerStatistics();
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i])
+			_channels[i]->resetStatistics();
+	}
+}
+
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
@@ -504,6 +580,7 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
+      _statsMixCalls(0), _statsFrames(0), _statsDecodeMicros(0), _statsMaxDecodeMicros(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
@@ -618,11 +695,44 @@ int Channel::mix(int16 *data, uint len) {
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
 		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
+
+		if (_mixer->isStatisticsEnabled()) {
+			const uint64 start = g_system->getMicros();
+			res = _converter->flow(*_stream, data, len, _volL, _volR);
+			const uint32 duration = (uint32)(g_system->getMicros() - start);
+
+			_statsMixCalls++;
+			_statsFrames += res;
+			_statsDecodeMicros += duration;
+			_statsMaxDecodeMicros = MAX(_statsMaxDecodeMicros, duration);
+		} else {
+			res = _converter->flow(*_stream, data, len, _volL, _volR);
+		}
 		_samplesDecoded += res;
 	}
 
 	return res;
 }
 
+void Channel::getStatistics(MixerStatistics::ChannelStatistics &stats) const {
+	stats.handle = _handle;
+	stats.id = _id;
+	stats.type = _type;
+	stats.paused = isPaused();
+	stats.converter = _converter->getName();
+	stats.inputRate = _stream->getRate();
+	stats.stereo = _stream->isStereo();
+	stats.mixCalls = _statsMixCalls;
+	stats.frames = _statsFrames;
+	stats.decodeMicros = _statsDecodeMicros;
+	stats.maxDecodeMicros = _statsMaxDecodeMicros;
+}
+
+void Channel::resetStatistics() {
+	_statsMixCalls = 0;
+	_statsFrames = 0;
+	_statsDecodeMicros = 0;
+	_statsMaxDecodeMicros = 0;
+}
+
 } // End of namespace Audio
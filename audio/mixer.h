@@ -31,6 +31,7 @@ namespace Audio {
 class AudioStream;
 class Channel;
 class Timestamp;
+struct MixerStatistics;
 
 /**
  * A SoundHandle instances corresponds to a specific sound
@@ -277,6 +278,90 @@ public:
 	 * @return the output sample rate in Hz
 	 */
 	virtual uint getOutputRate() const = 0;
+
+	/**
+	 * Enable or disable collecting timing statistics while mixing. When
+	 * disabled, which is the default, the mixer callback only checks the
+	 * flag.
+	 *
+	 * @see getStatistics()
+	 */
+	virtual void setStatisticsEnabled(bool enabled) = 0;
+
+	/**
+	 * Query whether timing statistics are being collected.
+	 */
+	virtual bool isStatisticsEnabled() const = 0;
+
+	/**
+	 * Get the statistics collected since they were enabled or last reset,
+	 * along with the counters of the currently active channels.
+	 *
+	 * @param stats the structure to fill
+	 */
+	virtual void getStatistics(MixerStatistics &stats) = 0;
+
+	/**
+	 * Clear the collected statistics, including the channel counters.
+	 */
+	virtual void resetStatistics() = 0;
+};
+
+/**
+ * Timing data collected by the mixer.
+ *
+ * @see Mixer::setStatisticsEnabled()
+ */
+struct MixerStatistics {
+	enum {
+		kMaxChannels = 32,
+
+		/**
+		 * Callback durations are counted in buckets of doubling size:
+		 * below 64us, below 128us, ... below 16ms, and 16ms or more.
+		 */
+		kHistogramBuckets = 10,
+		kHistogramFirstBucketMicros = 64
+	};
+
+	struct ChannelStatistics {
+		SoundHandle handle;
+		int id;
+		Mixer::SoundType type;
+		bool paused;
+
+		/** Name of the rate converter, e.g. "copy" or "linear". */
+		const char *converter;
+		uint inputRate;
+		bool stereo;
+
+		uint32 mixCalls;
+		/** Sample pairs written to the output. */
+		uint64 frames;
+		/** Time spent decoding, converting and mixing. */
+		uint64 decodeMicros;
+		uint32 maxDecodeMicros;
+	};
+
+	uint outputRate;
+
+	uint32 callbacks;
+	uint64 callbackMicros;
+	uint32 maxCallbackMicros;
+	uint32 callbackHistogram[kHistogramBuckets];
+
+	/**
+	 * Callbacks which took longer than the buffer they filled lasts.
+	 * Each one is likely to be heard as a dropout.
+	 */
+	uint32 underruns;
+
+	/** Time the callback waited for the mixer mutex. */
+	uint64 lockWaitMicros;
+	uint32 maxLockWaitMicros;
+
+	uint numChannels;
+	ChannelStatistics channels[kMaxChannels];
 };
 
 
@@ -70,6 +70,12 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	bool _statsEnabled;
+	// Only the callback counters are kept here, the channels keep their own
+	MixerStatistics _stats;
+
+	void recordCallback(uint64 startMicros, uint64 lockedMicros, uint64 endMicros, uint len);
+
 
 public:
 
@@ -118,6 +124,11 @@ public:
 
 	virtual uint getOutputRate() const;
 
+	virtual void setStatisticsEnabled(bool enabled);
+	virtual bool isStatisticsEnabled() const { return _statsEnabled; }
+	virtual void getStatistics(MixerStatistics &stats);
+	virtual void resetStatistics();
+
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
@@ -32,6 +32,7 @@
 #include "audio/rate.h"
 #include "audio/mixer.h"
 #include "common/frac.h"
+#include "common/simd.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
@@ -57,6 +58,176 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * Scale 'frames' sample frames from 'in' by the channel volumes and add
+ * them to the stereo output buffer 'obuf', clamping to the sample range.
+ *
+ * This is the portable reference implementation, all vector versions
+ * below must produce exactly the same output.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixFramesC(const st_sample_t *in, st_sample_t *obuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; frames > 0; --frames) {
+		st_sample_t out0, out1;
+		out0 = *in++;
+		out1 = (stereo ? *in++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
+#if defined(SCUMMVM_SIMD) && !defined(OUTPUT_UNSIGNED_AUDIO)
+#define RATE_MIX_SIMD
+
+/**
+ * The vector kernels divide by kMaxMixerVolume with a shift, and multiply
+ * the samples with signed 16 bit volumes.
+ */
+enum {
+	MIX_VOLUME_SHIFT = 8,
+	MIX_MAX_SIMD_VOLUME = 0x7FFF
+};
+
+#ifdef SCUMMVM_SSE2
+
+/**
+ * Scale the eight samples (four frames, already ordered like the output
+ * buffer) in 's' by the per lane volumes in 'vol' and add them, saturated,
+ * to 'obuf'.
+ */
+static inline void mixVectorSSE2(st_sample_t *obuf, __m128i s, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(s, vol);
+	const __m128i hi = _mm_mulhi_epi16(s, vol);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+	// Divide by kMaxMixerVolume rounding towards zero, like the C division
+	const __m128i bias = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), MIX_VOLUME_SHIFT);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), MIX_VOLUME_SHIFT);
+
+	const __m128i o = _mm_loadu_si128((const __m128i *)obuf);
+	p0 = _mm_add_epi32(p0, _mm_srai_epi32(_mm_unpacklo_epi16(o, o), 16));
+	p1 = _mm_add_epi32(p1, _mm_srai_epi32(_mm_unpackhi_epi16(o, o), 16));
+	_mm_storeu_si128((__m128i *)obuf, _mm_packs_epi32(p0, p1));
+}
+
+/**
+ * Mix as many whole groups of four frames as possible.
+ *
+ * @return the number of frames mixed
+ */
+template<bool stereo, bool reverseStereo>
+static st_size_t mixFramesSIMD(const st_sample_t *in, st_sample_t *obuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	// Lane n of the volume vector applies to obuf[n]
+	const __m128i vol = reverseStereo ?
+	                    _mm_set_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r) :
+	                    _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+	const st_size_t count = frames & ~3;
+
+	for (st_size_t i = 0; i < count; i += 4) {
+		__m128i s;
+		if (stereo) {
+			s = _mm_loadu_si128((const __m128i *)in);
+			if (reverseStereo) {
+				s = _mm_shufflelo_epi16(s, _MM_SHUFFLE(2, 3, 0, 1));
+				s = _mm_shufflehi_epi16(s, _MM_SHUFFLE(2, 3, 0, 1));
+			}
+			in += 8;
+		} else {
+			s = _mm_loadl_epi64((const __m128i *)in);
+			s = _mm_unpacklo_epi16(s, s);
+			in += 4;
+		}
+		mixVectorSSE2(obuf, s, vol);
+		obuf += 8;
+	}
+
+	return count;
+}
+
+#elif defined(SCUMMVM_NEON)
+
+/**
+ * Scale the eight samples (four frames, already ordered like the output
+ * buffer) in 's' by the per lane volumes in 'vol' and add them, saturated,
+ * to 'obuf'.
+ */
+static inline void mixVectorNEON(st_sample_t *obuf, int16x8_t s, int16x8_t vol) {
+	int32x4_t p0 = vmull_s16(vget_low_s16(s), vget_low_s16(vol));
+	int32x4_t p1 = vmull_s16(vget_high_s16(s), vget_high_s16(vol));
+
+	// Divide by kMaxMixerVolume rounding towards zero, like the C division
+	const int32x4_t bias = vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1);
+	p0 = vshrq_n_s32(vaddq_s32(p0, vandq_s32(vshrq_n_s32(p0, 31), bias)), MIX_VOLUME_SHIFT);
+	p1 = vshrq_n_s32(vaddq_s32(p1, vandq_s32(vshrq_n_s32(p1, 31), bias)), MIX_VOLUME_SHIFT);
+
+	const int16x8_t o = vld1q_s16(obuf);
+	p0 = vaddw_s16(p0, vget_low_s16(o));
+	p1 = vaddw_s16(p1, vget_high_s16(o));
+	vst1q_s16(obuf, vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1)));
+}
+
+/**
+ * Mix as many whole groups of four frames as possible.
+ *
+ * @return the number of frames mixed
+ */
+template<bool stereo, bool reverseStereo>
+static st_size_t mixFramesSIMD(const st_sample_t *in, st_sample_t *obuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	// Lane n of the volume vector applies to obuf[n]
+	const int16 left = (int16)(reverseStereo ? vol_r : vol_l);
+	const int16 right = (int16)(reverseStereo ? vol_l : vol_r);
+	const int16 volLanes[8] = { left, right, left, right, left, right, left, right };
+	const int16x8_t vol = vld1q_s16(volLanes);
+	const st_size_t count = frames & ~3;
+
+	for (st_size_t i = 0; i < count; i += 4) {
+		int16x8_t s;
+		if (stereo) {
+			s = vld1q_s16(in);
+			if (reverseStereo)
+				s = vrev32q_s16(s);
+			in += 8;
+		} else {
+			const int16x4_t m = vld1_s16(in);
+			const int16x4x2_t z = vzip_s16(m, m);
+			s = vcombine_s16(z.val[0], z.val[1]);
+			in += 4;
+		}
+		mixVectorNEON(obuf, s, vol);
+		obuf += 8;
+	}
+
+	return count;
+}
+
+#endif
+#endif
+
+/**
+ * Scale and add 'frames' sample frames to the output buffer, using the
+ * vector kernels when available.
+ */
+template<bool stereo, bool reverseStereo>
+static inline void mixFrames(const st_sample_t *in, st_sample_t *obuf, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+#ifdef RATE_MIX_SIMD
+	if (Common::hasSIMD() && vol_l <= MIX_MAX_SIMD_VOLUME && vol_r <= MIX_MAX_SIMD_VOLUME) {
+		const st_size_t done = mixFramesSIMD<stereo, reverseStereo>(in, obuf, frames, vol_l, vol_r);
+		in += done * (stereo ? 2 : 1);
+		obuf += done * 2;
+		frames -= done;
+	}
+#endif
+	mixFramesC<stereo, reverseStereo>(in, obuf, frames, vol_l, vol_r);
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -70,6 +241,9 @@ protected:
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** resampled stereo frames waiting to be mixed into the output */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -83,6 +257,9 @@ public:
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
+	const char *getName() const {
+		return "simple";
+	}
 };
 
 
@@ -119,37 +296,51 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
+		// Resample into the intermediate output buffer, then mix it in
+		// one go
+		st_sample_t *outPtr = outBuf;
+		st_sample_t *outEnd = outBuf + MIN<st_size_t>(ARRAYSIZE(outBuf), oend - obuf);
+		bool eos = false;
+
+		while (outPtr < outEnd) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						eos = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (eos)
+				break;
 
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
+			st_sample_t out0, out1;
+			out0 = *inPtr++;
+			out1 = (stereo ? *inPtr++ : out0);
 
-		// Increment output position
-		opos += opos_inc;
+			// Increment output position
+			opos += opos_inc;
 
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			*outPtr++ = out0;
+			*outPtr++ = out1;
+		}
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		const st_size_t frames = (outPtr - outBuf) / 2;
+		mixFrames<true, reverseStereo>(outBuf, obuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
 
-		obuf += 2;
+		if (eos)
+			break;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -183,12 +374,18 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolated stereo frames waiting to be mixed into the output */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
+	const char *getName() const {
+		return "linear";
+	}
 };
 
 
@@ -228,47 +425,61 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+		// Interpolate into the intermediate output buffer, then mix it in
+		// one go
+		st_sample_t *outPtr = outBuf;
+		st_sample_t *outEnd = outBuf + MIN<st_size_t>(ARRAYSIZE(outBuf), oend - obuf);
+		bool eos = false;
+
+		while (outPtr < outEnd) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						eos = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			opos -= FRAC_ONE_LOW;
-		}
-
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			if (eos)
+				break;
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the output buffer.
+			while (opos < (frac_t)FRAC_ONE_LOW && outPtr < outEnd) {
+				// interpolate
+				st_sample_t out0, out1;
+				out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				out1 = (stereo ?
+							  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
+							  out0);
 
-			obuf += 2;
+				*outPtr++ = out0;
+				*outPtr++ = out1;
 
-			// Increment output position
-			opos += opos_inc;
+				// Increment output position
+				opos += opos_inc;
+			}
 		}
+
+		const st_size_t frames = (outPtr - outBuf) / 2;
+		mixFrames<true, reverseStereo>(outBuf, obuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
+
+		if (eos)
+			break;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -293,7 +504,6 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
 		st_sample_t *ostart = obuf;
@@ -315,26 +525,20 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
+		const st_size_t frames = len / (stereo ? 2 : 1);
+		mixFrames<stereo, reverseStereo>(_buffer, obuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
 		return (obuf - ostart) / 2;
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
+
+	virtual const char *getName() const {
+		return "copy";
+	}
 };
 
 
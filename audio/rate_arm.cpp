@@ -109,6 +109,9 @@ public:
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
+	const char *getName() const {
+		return "simple";
+	}
 };
 
 
@@ -283,6 +286,9 @@ public:
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
+	const char *getName() const {
+		return "linear";
+	}
 };
 
 
@@ -438,6 +444,10 @@ public:
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
+
+	virtual const char *getName() const {
+		return "copy";
+	}
 };
 
 
@@ -62,7 +62,8 @@ MODULE_OBJS += \
 	mixer/sdl/sdl-mixer.o \
 	mutex/sdl/sdl-mutex.o \
 	plugins/sdl/sdl-provider.o \
-	timer/sdl/sdl-timer.o
+	timer/sdl/sdl-timer.o \
+	workers/sdl/sdl-workers.o
 
 # SDL 2 removed audio CD support
 ifndef USE_SDL2
@@ -64,7 +64,8 @@ OSystem_SDL::OSystem_SDL()
 	_logger(0),
 	_mixerManager(0),
 	_eventSource(0),
-	_window(0) {
+	_window(0),
+	_workerManager(0) {
 
 }
 
@@ -102,6 +103,8 @@ OSystem_SDL::~OSystem_SDL() {
 #endif
 
 	_timerManager = 0;
+	delete _workerManager;
+	_workerManager = 0;
 	delete _mutexManager;
 	_mutexManager = 0;
 
@@ -141,6 +144,9 @@ void OSystem_SDL::init() {
 	if (_window == 0)
 		_window = new SdlWindow();
 
+	if (_workerManager == 0)
+		_workerManager = new SdlWorkerManager();
+
 #if defined(USE_TASKBAR)
 	if (_taskbarManager == 0)
 		_taskbarManager = new Common::TaskbarManager();
@@ -397,6 +403,16 @@ uint32 OSystem_SDL::getMillis(bool skipRecord) {
 	return millis;
 }
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+uint64 OSystem_SDL::getMicros() {
+	static const uint64 frequency = SDL_GetPerformanceFrequency();
+	const uint64 counter = SDL_GetPerformanceCounter();
+
+	// Split the conversion to avoid overflowing with high frequency counters
+	return (counter / frequency) * 1000000 + (counter % frequency) * 1000000 / frequency;
+}
+#endif
+
 void OSystem_SDL::delayMillis(uint msecs) {
 #ifdef ENABLE_EVENTRECORDER
 	if (!g_eventRec.processDelayMillis())
@@ -439,6 +455,21 @@ Common::TimerManager *OSystem_SDL::getTimerManager() {
 #endif
 }
 
+OSystem::WorkerJobRef OSystem_SDL::startWorkerJob(WorkerProc proc, void *param) {
+	assert(_workerManager);
+	return _workerManager->startJob(proc, param);
+}
+
+void OSystem_SDL::waitWorkerJob(WorkerJobRef job) {
+	assert(_workerManager);
+	_workerManager->waitJob(job);
+}
+
+uint OSystem_SDL::getWorkerCount() const {
+	assert(_workerManager);
+	return _workerManager->getWorkerCount();
+}
+
 // ResidualVM specific code
 bool OSystem_SDL::hasFeature(Feature f) {
 	if (f == kFeatureSideTextures)
@@ -30,6 +30,7 @@
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/log/log.h"
 #include "backends/platform/sdl/sdl-window.h"
+#include "backends/workers/sdl/sdl-workers.h"
 
 #include "common/array.h"
 
@@ -72,10 +73,16 @@ public:
 	virtual void setWindowCaption(const char *caption);
 	virtual void addSysArchivesToSearchSet(Common::SearchSet &s, int priority = 0);
 	virtual uint32 getMillis(bool skipRecord = false);
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	virtual uint64 getMicros();
+#endif
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &td) const;
 	virtual Audio::Mixer *getMixer();
 	virtual Common::TimerManager *getTimerManager();
+	virtual WorkerJobRef startWorkerJob(WorkerProc proc, void *param);
+	virtual void waitWorkerJob(WorkerJobRef job);
+	virtual uint getWorkerCount() const;
 
 	// ResidualVM specific code
 	virtual bool hasFeature(Feature f);
@@ -102,6 +109,11 @@ protected:
 	 */
 	SdlWindow *_window;
 
+	/**
+	 * The pool of threads running the worker jobs.
+	 */
+	SdlWorkerManager *_workerManager;
+
 	virtual Common::EventSource *getDefaultEventSource() { return _eventSource; }
 
 	/**
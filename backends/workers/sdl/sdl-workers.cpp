@@ -0,0 +1,184 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/workers/sdl/sdl-workers.h"
+#include "backends/platform/sdl/sdl-sys.h"
+
+#include "common/textconsole.h"
+#include "common/util.h"
+
+SdlWorkerManager::SdlWorkerManager() :
+	_threadCount(0),
+	_mutex(0),
+	_jobQueued(0),
+	_jobDone(0),
+	_queueHead(0),
+	_queueTail(0),
+	_quit(false) {
+
+	for (uint i = 0; i < kMaxWorkers; i++)
+		_threads[i] = 0;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	// Leave one core to the main thread
+	int cpuCount = SDL_GetCPUCount();
+	_workerCount = CLIP<int>(cpuCount - 1, 0, kMaxWorkers);
+#else
+	// SDL 1.2 cannot tell how many cores there are
+	_workerCount = 1;
+#endif
+}
+
+SdlWorkerManager::~SdlWorkerManager() {
+	if (_threadCount > 0) {
+		SDL_LockMutex(_mutex);
+		_quit = true;
+		SDL_CondBroadcast(_jobQueued);
+		SDL_UnlockMutex(_mutex);
+
+		for (uint i = 0; i < _threadCount; i++)
+			SDL_WaitThread(_threads[i], NULL);
+	}
+
+	if (_jobDone)
+		SDL_DestroyCond(_jobDone);
+	if (_jobQueued)
+		SDL_DestroyCond(_jobQueued);
+	if (_mutex)
+		SDL_DestroyMutex(_mutex);
+}
+
+bool SdlWorkerManager::startThreads() {
+	if (_threadCount > 0)
+		return true;
+
+	if (_workerCount == 0)
+		return false;
+
+	_mutex = SDL_CreateMutex();
+	_jobQueued = SDL_CreateCond();
+	_jobDone = SDL_CreateCond();
+
+	if (!_mutex || !_jobQueued || !_jobDone) {
+		warning("Could not create the worker thread synchronization objects");
+		_workerCount = 0;
+		return false;
+	}
+
+	for (uint i = 0; i < _workerCount; i++) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		_threads[i] = SDL_CreateThread(workerThreadEntry, "ResidualVM Worker", this);
+#else
+		_threads[i] = SDL_CreateThread(workerThreadEntry, this);
+#endif
+		if (!_threads[i])
+			break;
+
+		_threadCount++;
+	}
+
+	if (_threadCount == 0) {
+		warning("Could not create any worker thread");
+		_workerCount = 0;
+		return false;
+	}
+
+	_workerCount = _threadCount;
+	return true;
+}
+
+OSystem::WorkerJobRef SdlWorkerManager::startJob(OSystem::WorkerProc proc, void *param) {
+	if (!startThreads()) {
+		proc(param);
+		return 0;
+	}
+
+	Job *job = new Job;
+	job->proc = proc;
+	job->param = param;
+	job->done = false;
+	job->next = 0;
+
+	SDL_LockMutex(_mutex);
+	if (_queueTail)
+		_queueTail->next = job;
+	else
+		_queueHead = job;
+	_queueTail = job;
+	SDL_CondSignal(_jobQueued);
+	SDL_UnlockMutex(_mutex);
+
+	return (OSystem::WorkerJobRef)job;
+}
+
+void SdlWorkerManager::waitJob(OSystem::WorkerJobRef jobRef) {
+	Job *job = (Job *)jobRef;
+	if (!job)
+		return;
+
+	SDL_LockMutex(_mutex);
+	while (!job->done)
+		SDL_CondWait(_jobDone, _mutex);
+	SDL_UnlockMutex(_mutex);
+
+	delete job;
+}
+
+int SdlWorkerManager::workerThreadEntry(void *arg) {
+	SdlWorkerManager *manager = (SdlWorkerManager *)arg;
+	manager->workerThread();
+	return 0;
+}
+
+void SdlWorkerManager::workerThread() {
+	SDL_LockMutex(_mutex);
+
+	for (;;) {
+		while (!_queueHead && !_quit)
+			SDL_CondWait(_jobQueued, _mutex);
+
+		// Jobs still queued when quitting are run all the same, since
+		// somebody may be waiting for them
+		if (!_queueHead)
+			break;
+
+		Job *job = _queueHead;
+		_queueHead = job->next;
+		if (!_queueHead)
+			_queueTail = 0;
+
+		SDL_UnlockMutex(_mutex);
+		job->proc(job->param);
+		SDL_LockMutex(_mutex);
+
+		job->done = true;
+		SDL_CondBroadcast(_jobDone);
+	}
+
+	SDL_UnlockMutex(_mutex);
+}
+
+#endif
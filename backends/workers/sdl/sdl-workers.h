@@ -0,0 +1,78 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_WORKERS_SDL_H
+#define BACKENDS_WORKERS_SDL_H
+
+#include "common/system.h"
+
+struct SDL_mutex;
+struct SDL_cond;
+struct SDL_Thread;
+
+/**
+ * SDL worker manager
+ *
+ * Runs the jobs passed to OSystem::startWorkerJob() on a small pool of
+ * threads, which are started on demand and live until the manager is
+ * deleted. Jobs are picked up in the order they were started.
+ */
+class SdlWorkerManager {
+public:
+	SdlWorkerManager();
+	~SdlWorkerManager();
+
+	OSystem::WorkerJobRef startJob(OSystem::WorkerProc proc, void *param);
+	void waitJob(OSystem::WorkerJobRef job);
+	uint getWorkerCount() const { return _workerCount; }
+
+private:
+	static const uint kMaxWorkers = 4;
+
+	struct Job {
+		OSystem::WorkerProc proc;
+		void *param;
+		bool done;
+		Job *next;
+	};
+
+	static int workerThreadEntry(void *arg);
+	void workerThread();
+
+	/** Start the worker threads, if this has not happened yet. */
+	bool startThreads();
+
+	uint _workerCount;
+	uint _threadCount;
+
+	SDL_mutex *_mutex;
+	SDL_cond *_jobQueued;
+	SDL_cond *_jobDone;
+	SDL_Thread *_threads[kMaxWorkers];
+
+	Job *_queueHead;
+	Job *_queueTail;
+
+	bool _quit;
+};
+
+#endif
@@ -49,4 +49,16 @@ CosineTable::~CosineTable() {
 	delete[] _table;
 }
 
+// Indexed by bit precision, never freed, see getShared()
+static CosineTable *s_sharedTables[17];
+
+const CosineTable *CosineTable::getShared(int bitPrecision) {
+	assert((bitPrecision >= 4) && (bitPrecision <= 16));
+
+	if (!s_sharedTables[bitPrecision])
+		s_sharedTables[bitPrecision] = new CosineTable(bitPrecision);
+
+	return s_sharedTables[bitPrecision];
+}
+
 } // End of namespace Common
@@ -30,10 +30,11 @@
 
 namespace Common {
 
-DCT::DCT(int bits, TransformType trans) : _bits(bits), _cos(_bits + 2), _trans(trans), _rdft(0) {
+DCT::DCT(int bits, TransformType trans) : _bits(bits), _trans(trans), _cos(0), _rdft(0) {
 	int n = 1 << _bits;
 
-	_tCos = _cos.getTable();
+	_cos = CosineTable::getShared(_bits + 2);
+	_tCos = _cos->getTable();
 
 	_csc2 = new float[n / 2];
 
@@ -28,40 +28,99 @@
 
 #include "common/cosinetables.h"
 #include "common/fft.h"
+#include "common/simd.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
 namespace Common {
 
-FFT::FFT(int bits, int inverse) : _bits(bits), _inverse(inverse) {
-	assert((_bits >= 2) && (_bits <= 16));
+/**
+ * The tables of one transform size and direction, shared by all FFT
+ * instances using them.
+ */
+struct FFTPlan {
+	int bits;
+	int inverse;
 
-	int n = 1 << bits;
+	uint16 *revTab;
 
-	_tmpBuf = new Complex[n];
-	_expTab = new Complex[n / 2];
-	_revTab = new uint16[n];
+	/** Cosine tables of the passes, indexed by log2(pass size) - 4. */
+	const CosineTable *cosTables[13];
 
-	_splitRadix = 1;
+	/**
+	 * Twiddle factors of the passes laid out for the vector code, indexed
+	 * like cosTables. Every factor is stored twice so one vector load
+	 * covers two complex values.
+	 */
+	float *simdRe[13];
+	float *simdIm[13];
+};
 
+// Indexed by bits and direction. Like the shared cosine tables the plans
+// are kept until the process exits: WMA streams are deleted on the audio
+// thread, which must not free them under a decoder being created.
+static FFTPlan *s_fftPlans[17][2];
+
+const FFTPlan *FFT::getPlan(int bits, int inverse) {
+	FFTPlan *&plan = s_fftPlans[bits][inverse ? 1 : 0];
+	if (plan)
+		return plan;
+
+	plan = new FFTPlan();
+	plan->bits = bits;
+	plan->inverse = inverse;
+
+	const int n = 1 << bits;
+
+	plan->revTab = new uint16[n];
 	for (int i = 0; i < n; i++)
-		_revTab[-splitRadixPermutation(i, n, _inverse) & (n - 1)] = i;
+		plan->revTab[-splitRadixPermutation(i, n, inverse) & (n - 1)] = i;
 
-	for (int i = 0; i < ARRAYSIZE(_cosTables); i++) {
-		if (i+4 <= _bits)
-			_cosTables[i] = new Common::CosineTable(i+4);
-		else
-			_cosTables[i] = 0;
+	for (int i = 0; i < ARRAYSIZE(plan->cosTables); i++) {
+		plan->cosTables[i] = 0;
+		plan->simdRe[i] = plan->simdIm[i] = 0;
+
+		if (i + 4 > bits)
+			continue;
+
+		plan->cosTables[i] = CosineTable::getShared(i + 4);
+
+#ifdef SCUMMVM_SIMD
+		// Passes are used from 32 points on, see FFT::fft()
+		if (i + 4 < 5)
+			continue;
+
+		const float *cosTable = plan->cosTables[i]->getTable();
+		const int count = (1 << (i + 4)) / 4;
+
+		plan->simdRe[i] = new float[count * 2];
+		plan->simdIm[i] = new float[count * 2];
+		for (int k = 0; k < count; k++) {
+			// The first factor is exactly 1, like in TRANSFORM_ZERO
+			const float wre = k ? cosTable[k] : 1.0f;
+			const float wim = k ? cosTable[count - k] : 0.0f;
+
+			plan->simdRe[i][k * 2] = plan->simdRe[i][k * 2 + 1] = wre;
+			plan->simdIm[i][k * 2] = plan->simdIm[i][k * 2 + 1] = wim;
+		}
+#endif
 	}
+
+	return plan;
 }
 
-FFT::~FFT() {
-	for (int i = 0; i < ARRAYSIZE(_cosTables); i++) {
-		delete _cosTables[i];
-	}
+FFT::FFT(int bits, int inverse) : _bits(bits), _inverse(inverse) {
+	assert((_bits >= 2) && (_bits <= 16));
+
+	int n = 1 << bits;
+
+	_tmpBuf = new Complex[n];
 
-	delete[] _revTab;
-	delete[] _expTab;
+	_plan = getPlan(bits, inverse);
+	_revTab = _plan->revTab;
+}
+
+FFT::~FFT() {
 	delete[] _tmpBuf;
 }
 
@@ -178,6 +237,96 @@ PASS(pass)
 #define BUTTERFLIES BUTTERFLIES_BIG
 PASS(pass_big)
 
+/*
+ * Vector versions of pass(), transforming two complex values of each
+ * quarter at once. They do the same operations in the same order as
+ * TRANSFORM, so the results match the scalar code.
+ *
+ * z[0...8n-1], wre/wim: the duplicated twiddle factors from FFTPlan
+ */
+#if defined(SCUMMVM_SSE2)
+
+static void passSIMD(Complex *z, const float *wre, const float *wim, unsigned int n) {
+	float *z0 = (float *)z;
+	float *z1 = (float *)(z + 2 * n);
+	float *z2 = (float *)(z + 4 * n);
+	float *z3 = (float *)(z + 6 * n);
+
+	// Sign flips applied to the odd (re/im swapped) products
+	const __m128 signT = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+	const __m128 signU = _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f);
+
+	for (unsigned int k = 0; k < 4 * n; k += 4) {
+		const __m128 a0 = _mm_loadu_ps(z0 + k);
+		const __m128 a1 = _mm_loadu_ps(z1 + k);
+		const __m128 a2 = _mm_loadu_ps(z2 + k);
+		const __m128 a3 = _mm_loadu_ps(z3 + k);
+		const __m128 wr = _mm_loadu_ps(wre + k);
+		const __m128 wi = _mm_loadu_ps(wim + k);
+
+		const __m128 a2s = _mm_shuffle_ps(a2, a2, _MM_SHUFFLE(2, 3, 0, 1));
+		const __m128 a3s = _mm_shuffle_ps(a3, a3, _MM_SHUFFLE(2, 3, 0, 1));
+
+		// (t1, t2) and (t5, t6)
+		const __m128 t = _mm_add_ps(_mm_mul_ps(a2, wr), _mm_xor_ps(_mm_mul_ps(a2s, wi), signT));
+		const __m128 u = _mm_add_ps(_mm_mul_ps(a3, wr), _mm_xor_ps(_mm_mul_ps(a3s, wi), signU));
+
+		const __m128 sum = _mm_add_ps(u, t);
+		const __m128 diff = _mm_sub_ps(u, t);
+		// (t4, t3)
+		const __m128 rot = _mm_xor_ps(_mm_shuffle_ps(diff, diff, _MM_SHUFFLE(2, 3, 0, 1)), signU);
+
+		_mm_storeu_ps(z2 + k, _mm_sub_ps(a0, sum));
+		_mm_storeu_ps(z0 + k, _mm_add_ps(a0, sum));
+		_mm_storeu_ps(z3 + k, _mm_sub_ps(a1, rot));
+		_mm_storeu_ps(z1 + k, _mm_add_ps(a1, rot));
+	}
+}
+
+#elif defined(SCUMMVM_NEON)
+
+static inline float32x4_t flipSigns(float32x4_t v, uint32x4_t mask) {
+	return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v), mask));
+}
+
+static void passSIMD(Complex *z, const float *wre, const float *wim, unsigned int n) {
+	float *z0 = (float *)z;
+	float *z1 = (float *)(z + 2 * n);
+	float *z2 = (float *)(z + 4 * n);
+	float *z3 = (float *)(z + 6 * n);
+
+	// Sign flips applied to the odd (re/im swapped) products
+	static const uint32 signTLanes[4] = { 0, 0x80000000, 0, 0x80000000 };
+	static const uint32 signULanes[4] = { 0x80000000, 0, 0x80000000, 0 };
+	const uint32x4_t signT = vld1q_u32(signTLanes);
+	const uint32x4_t signU = vld1q_u32(signULanes);
+
+	for (unsigned int k = 0; k < 4 * n; k += 4) {
+		const float32x4_t a0 = vld1q_f32(z0 + k);
+		const float32x4_t a1 = vld1q_f32(z1 + k);
+		const float32x4_t a2 = vld1q_f32(z2 + k);
+		const float32x4_t a3 = vld1q_f32(z3 + k);
+		const float32x4_t wr = vld1q_f32(wre + k);
+		const float32x4_t wi = vld1q_f32(wim + k);
+
+		// (t1, t2) and (t5, t6)
+		const float32x4_t t = vaddq_f32(vmulq_f32(a2, wr), flipSigns(vmulq_f32(vrev64q_f32(a2), wi), signT));
+		const float32x4_t u = vaddq_f32(vmulq_f32(a3, wr), flipSigns(vmulq_f32(vrev64q_f32(a3), wi), signU));
+
+		const float32x4_t sum = vaddq_f32(u, t);
+		const float32x4_t diff = vsubq_f32(u, t);
+		// (t4, t3)
+		const float32x4_t rot = flipSigns(vrev64q_f32(diff), signU);
+
+		vst1q_f32(z2 + k, vsubq_f32(a0, sum));
+		vst1q_f32(z0 + k, vaddq_f32(a0, sum));
+		vst1q_f32(z3 + k, vsubq_f32(a1, rot));
+		vst1q_f32(z1 + k, vaddq_f32(a1, rot));
+	}
+}
+
+#endif
+
 void FFT::fft4(Complex *z) {
 	float t1, t2, t3, t4, t5, t6, t7, t8;
 
@@ -217,8 +366,8 @@ void FFT::fft16(Complex *z) {
 	fft4(z + 8);
 	fft4(z + 12);
 
-	assert(_cosTables[0]);
-	const float * const cosTable = _cosTables[0]->getTable();
+	assert(_plan->cosTables[0]);
+	const float * const cosTable = _plan->cosTables[0]->getTable();
 
 	TRANSFORM_ZERO(z[0], z[4], z[8], z[12]);
 	TRANSFORM(z[2], z[6], z[10], z[14], sqrthalf, sqrthalf);
@@ -241,11 +390,17 @@ void FFT::fft(int n, int logn, Complex *z) {
 		fft((n / 2), logn - 1, z);
 		fft((n / 4), logn - 2, z + (n / 4) * 2);
 		fft((n / 4), logn - 2, z + (n / 4) * 3);
-		assert(_cosTables[logn - 4]);
+		assert(_plan->cosTables[logn - 4]);
+#ifdef SCUMMVM_SIMD
+		if (hasSIMD()) {
+			passSIMD(z, _plan->simdRe[logn - 4], _plan->simdIm[logn - 4], (n / 4) / 2);
+			break;
+		}
+#endif
 		if (n > 1024)
-			pass_big(z, _cosTables[logn - 4]->getTable(), (n / 4) / 2);
+			pass_big(z, _plan->cosTables[logn - 4]->getTable(), (n / 4) / 2);
 		else
-			pass(z, _cosTables[logn - 4]->getTable(), (n / 4) / 2);
+			pass(z, _plan->cosTables[logn - 4]->getTable(), (n / 4) / 2);
 	}
 }
 
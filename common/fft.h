@@ -35,10 +35,15 @@
 namespace Common {
 
 class CosineTable;
+struct FFTPlan;
 
 /**
  * (Inverse) Fast Fourier Transform.
  *
+ * The permutation and twiddle tables are shared by all instances of the
+ * same size and direction. The butterfly passes use SSE2 or NEON when
+ * available, see common/simd.h.
+ *
  * Used in engines:
  *  - scumm
  */
@@ -63,16 +68,14 @@ private:
 	int _bits;
 	int _inverse;
 
-	uint16 *_revTab;
+	const FFTPlan *_plan;
+	const uint16 *_revTab;
 
-	Complex *_expTab;
 	Complex *_tmpBuf;
 
-	int _splitRadix;
-
 	static int splitRadixPermutation(int i, int n, int inverse);
 
-	CosineTable *_cosTables[13];
+	static const FFTPlan *getPlan(int bits, int inverse);
 
 	void fft4(Complex *z);
 	void fft8(Complex *z);
@@ -28,6 +28,7 @@ MODULE_OBJS := \
 	random.o \
 	rational.o \
 	rendermode.o \
+	simd.o \
 	sinewindows.o \
 	str.o \
 	stream.o \
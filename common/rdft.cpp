@@ -28,7 +28,7 @@
 
 namespace Common {
 
-RDFT::RDFT(int bits, TransformType trans) : _bits(bits), _sin(bits), _cos(bits), _fft(0) {
+RDFT::RDFT(int bits, TransformType trans) : _bits(bits), _sin(0), _cos(0), _fft(0) {
 	assert((_bits >= 4) && (_bits <= 16));
 
 	_inverse        = trans == IDFT_C2R || trans == DFT_C2R;
@@ -38,8 +38,11 @@ RDFT::RDFT(int bits, TransformType trans) : _bits(bits), _sin(bits), _cos(bits),
 
 	int n = 1 << bits;
 
-	_tSin = _sin.getTable() + (trans == DFT_R2C || trans == DFT_C2R) * (n >> 2);
-	_tCos = _cos.getTable();
+	_sin = SineTable::getShared(bits);
+	_cos = CosineTable::getShared(bits);
+
+	_tSin = _sin->getTable() + (trans == DFT_R2C || trans == DFT_C2R) * (n >> 2);
+	_tCos = _cos->getTable();
 }
 
 RDFT::~RDFT() {
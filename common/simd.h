@@ -0,0 +1,69 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_SIMD_H
+#define COMMON_SIMD_H
+
+#include "common/scummsys.h"
+
+/**
+ * @file
+ * Compile time detection of the vector instruction sets used by the
+ * optimized audio and video kernels.
+ *
+ * SCUMMVM_SSE2 is defined when SSE2 intrinsics may be used, SCUMMVM_NEON
+ * when ARM NEON intrinsics may be used. Code using them must always keep
+ * a portable C fallback, and should consult Common::hasSIMD() before
+ * taking the vector path so the fallback can be forced at runtime.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCUMMVM_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SCUMMVM_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(SCUMMVM_SSE2) || defined(SCUMMVM_NEON)
+#define SCUMMVM_SIMD
+#endif
+
+namespace Common {
+
+/**
+ * Check whether the vector code paths are compiled in and enabled.
+ */
+bool hasSIMD();
+
+/**
+ * Enable or disable the vector code paths. Disabling them makes every
+ * optimized kernel fall back to its portable C implementation, which is
+ * used to compare both paths in the unit tests and benchmarks.
+ *
+ * @return whether the vector code paths were enabled before the call
+ */
+bool setSIMDEnabled(bool enable);
+
+} // End of namespace Common
+
+#endif
@@ -49,4 +49,16 @@ SineTable::~SineTable() {
 	delete[] _table;
 }
 
+// Indexed by bit precision, never freed, see getShared()
+static SineTable *s_sharedTables[17];
+
+const SineTable *SineTable::getShared(int bitPrecision) {
+	assert((bitPrecision >= 4) && (bitPrecision <= 16));
+
+	if (!s_sharedTables[bitPrecision])
+		s_sharedTables[bitPrecision] = new SineTable(bitPrecision);
+
+	return s_sharedTables[bitPrecision];
+}
+
 } // End of namespace Common
@@ -45,12 +45,22 @@ public:
 	 * - Entries 2^bitPrecision/4 up to (excluding) 2^bitPrecision/2:
 	 *           sin(pi) till (excluding) sin(3/2*pi)
 	 */
-	const float *getTable() { return _table; }
+	const float *getTable() const { return _table; }
 
 	/**
 	 * Get pointer to table
 	 */
-	int getPrecision() { return _bitPrecision; }
+	int getPrecision() const { return _bitPrecision; }
+
+	/**
+	 * Get a sine table shared by all users of the same bit precision,
+	 * creating it if needed.
+	 *
+	 * The shared tables are kept until the process exits, so decoders
+	 * deleted on the audio thread have nothing to release. They are
+	 * meant to be requested on the thread which creates the decoders.
+	 */
+	static const SineTable *getShared(int bitPrecision);
 
 private:
 	float *_table;
@@ -130,6 +130,22 @@ void OSystem::fatalError() {
 	exit(1);
 }
 
+uint64 OSystem::getMicros() {
+	return (uint64)getMillis(true) * 1000;
+}
+
+OSystem::WorkerJobRef OSystem::startWorkerJob(WorkerProc proc, void *param) {
+	proc(param);
+	return 0;
+}
+
+void OSystem::waitWorkerJob(WorkerJobRef job) {
+}
+
+uint OSystem::getWorkerCount() const {
+	return 0;
+}
+
 FilesystemFactory *OSystem::getFilesystemFactory() {
 	assert(_fsFactory);
 	return _fsFactory;
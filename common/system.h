@@ -999,6 +999,14 @@ public:
 	*/
 	virtual uint32 getMillis(bool skipRecord = false) = 0;
 
+	/**
+	 * Get a timestamp in microseconds, for profiling. Unlike getMillis()
+	 * the value is never recorded by the event recorder, and it only makes
+	 * sense as a difference between two calls. The default implementation
+	 * has millisecond resolution.
+	 */
+	virtual uint64 getMicros();
+
 	/** Delay/sleep for the specified amount of milliseconds. */
 	virtual void delayMillis(uint msecs) = 0;
 
@@ -1118,6 +1126,54 @@ public:
 
 
 
+	/**
+	 * @name Worker jobs
+	 * There still is no general threading API (see above). Decoders may
+	 * however hand self-contained pieces of work to a backend-owned pool
+	 * of worker threads, and wait for them to finish later on.
+	 *
+	 * A job must only touch memory that nobody else uses until it has been
+	 * waited for, or that is guarded by a Common::Mutex. It must not call
+	 * into the backend (graphics, events, sound, file system) and must not
+	 * wait for other jobs. Reading from or writing to a stream opened
+	 * beforehand is fine as long as nothing else uses that stream meanwhile.
+	 *
+	 * Backends without worker threads can keep the default implementation,
+	 * which simply runs each job on the calling thread right away.
+	 */
+	//@{
+
+	typedef void (*WorkerProc)(void *param);
+	typedef struct OpaqueWorkerJob *WorkerJobRef;
+
+	/**
+	 * Start running a job on a worker thread.
+	 *
+	 * @param proc	the function to run.
+	 * @param param	the parameter passed to proc.
+	 * @return a reference to pass to waitWorkerJob(). This may be 0 if the
+	 *         job already finished before startWorkerJob() returned.
+	 */
+	virtual WorkerJobRef startWorkerJob(WorkerProc proc, void *param);
+
+	/**
+	 * Wait until a job has finished. Every job started with startWorkerJob()
+	 * has to be waited for exactly once.
+	 *
+	 * @param job	the job reference returned by startWorkerJob().
+	 */
+	virtual void waitWorkerJob(WorkerJobRef job);
+
+	/**
+	 * Return the number of jobs which may run in parallel to the calling
+	 * thread. 0 means that jobs are run on the calling thread.
+	 */
+	virtual uint getWorkerCount() const;
+
+	//@}
+
+
+
 	/** @name Sound */
 	//@{
 
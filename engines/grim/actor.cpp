@@ -600,6 +600,36 @@ void Actor::turnTo(const Math::Angle &pitchParam, const Math::Angle &yawParam, c
 		_turning = false;
 }
 
+class Actor::WalkQuery : public WalkGraph::PathQuery {
+public:
+	WalkQuery(const Actor *actor, Set *set, const Math::Vector3d &dest) :
+		_actor(actor), _set(set), _dest(dest) {}
+
+	bool isNodeEnabled(int node) override {
+		Sector *s = _set->getSectorBase(node);
+		return Set::isWalkableSector(s) && s->isVisible();
+	}
+
+	bool isGoal(int node) override {
+		return _set->getSectorBase(node)->isPointInSector(_dest);
+	}
+
+	Math::Vector3d getTarget(int node) override {
+		if (g_grim->getGameType() == GType_GRIM)
+			return _set->getSectorBase(node)->getClosestPoint(_dest);
+		return _dest;
+	}
+
+	Math::Vector3d adjustStep(const Math::Vector3d &from, const Math::Vector3d &to) override {
+		return _actor->handleCollisionTo(from, to);
+	}
+
+private:
+	const Actor *_actor;
+	Set *_set;
+	Math::Vector3d _dest;
+};
+
 void Actor::walkTo(const Math::Vector3d &p) {
 	if (p == _pos)
 		_walking = false;
@@ -609,144 +639,19 @@ void Actor::walkTo(const Math::Vector3d &p) {
 		_path.clear();
 
 		if (_followBoxes) {
-			bool pathFound = false;
-
 			Set *currSet = g_grim->getCurrSet();
 			currSet->findClosestSector(p, nullptr, &_destPos);
 
-			Common::List<PathNode *> openList;
-			Common::List<PathNode *> closedList;
-
-			PathNode *start = new PathNode;
-			start->parent = nullptr;
-			start->pos = _pos;
-			start->dist = 0.f;
-			start->cost = 0.f;
-			openList.push_back(start);
-			currSet->findClosestSector(_pos, &start->sect, nullptr);
-
-			Common::List<Sector *> sectors;
+			Sector *startSector;
+			currSet->findClosestSector(_pos, &startSector, nullptr);
+			int start = -1;
 			for (int i = 0; i < currSet->getSectorCount(); ++i) {
-				Sector *s = currSet->getSectorBase(i);
-				int type = s->getType();
-				if ((type == Sector::WalkType || type == Sector::HotType || type == Sector::FunnelType) && s->isVisible()) {
-					sectors.push_back(s);
-				}
+				if (currSet->getSectorBase(i) == startSector)
+					start = i;
 			}
 
-			do {
-				PathNode *node = nullptr;
-				float cost = -1.f;
-				for (Common::List<PathNode *>::iterator j = openList.begin(); j != openList.end(); ++j) {
-					PathNode *n = *j;
-					float c = n->dist + n->cost;
-					if (cost < 0.f || c < cost) {
-						cost = c;
-						node = n;
-					}
-				}
-				closedList.push_back(node);
-				openList.remove(node);
-				Sector *sector = node->sect;
-
-				if (sector && sector->isPointInSector(_destPos)) {
-					PathNode *n = closedList.back();
-					// Don't put the start position in the list, or else
-					// the first angle calculated in updateWalk() will be
-					// meaningless. The only node without parent is the start
-					// one.
-					while (n->parent) {
-						_path.push_back(n->pos);
-						n = n->parent;
-					}
-
-					pathFound = true;
-					break;
-				}
-
-				for (Common::List<Sector *>::iterator i = sectors.begin(); i != sectors.end(); ++i) {
-					Sector *s = *i;
-					bool inClosed = false;
-					for (Common::List<PathNode *>::iterator j = closedList.begin(); j != closedList.end(); ++j) {
-						if ((*j)->sect == s) {
-							inClosed = true;
-							break;
-						}
-					}
-					if (inClosed)
-						continue;
-
-					// Get "bridges" from the current sector to the other.
-					Common::List<Math::Line3d> bridges = sector->getBridgesTo(s);
-					if (bridges.empty())
-						continue; // The sectors are not adjacent.
-
-					Math::Vector3d closestPoint;
-					if (g_grim->getGameType() == GType_GRIM)
-						closestPoint = s->getClosestPoint(_destPos);
-					else
-						closestPoint = _destPos;
-					Math::Vector3d best;
-					float bestDist = 1e6f;
-					Math::Line3d l(node->pos, closestPoint);
-
-					// Pick a point on the boundary of the two sectors to walk towards.
-					while (!bridges.empty()) {
-						Math::Line3d bridge = bridges.back();
-						Math::Vector3d pos;
-						const bool useXZ = (g_grim->getGameType() == GType_MONKEY4);
-
-						// Prefer points on the straight line from this node towards
-						// the destination. Otherwise pick the middle point of a bridge
-						// that is closest to the destination.
-						if (!bridge.intersectLine2d(l, &pos, useXZ)) {
-							pos = bridge.middle();
-						} else {
-							best = pos;
-							break;
-						}
-						float dist = (pos - closestPoint).getMagnitude();
-						if (dist < bestDist) {
-							bestDist = dist;
-							best = pos;
-						}
-						bridges.pop_back();
-					}
-					best = handleCollisionTo(node->pos, best);
-
-					PathNode *n = nullptr;
-					for (Common::List<PathNode *>::iterator j = openList.begin(); j != openList.end(); ++j) {
-						if ((*j)->sect == s) {
-							n = *j;
-							break;
-						}
-					}
-					if (n) {
-						float newCost = node->cost + (best - node->pos).getMagnitude();
-						if (newCost < n->cost) {
-							n->cost = newCost;
-							n->parent = node;
-							n->pos = best;
-							n->dist = (n->pos - _destPos).getMagnitude();
-						}
-					} else {
-						n = new PathNode;
-						n->parent = node;
-						n->sect = s;
-						n->pos = best;
-						n->dist = (n->pos - _destPos).getMagnitude();
-						n->cost = node->cost + (n->pos - node->pos).getMagnitude();
-						openList.push_back(n);
-					}
-				}
-			} while (!openList.empty());
-
-			for (Common::List<PathNode *>::iterator j = closedList.begin(); j != closedList.end(); ++j) {
-				delete *j;
-			}
-			for (Common::List<PathNode *>::iterator j = openList.begin(); j != openList.end(); ++j) {
-				delete *j;
-			}
+			WalkQuery query(this, currSet, _destPos);
+			bool pathFound = currSet->getWalkGraph().findPath(start, _pos, _destPos, query, _path);
 
 			if (!pathFound) {
 				warning("Actor::walkTo(): No path found for %s", _name.c_str());
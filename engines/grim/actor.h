@@ -686,14 +686,8 @@ private:
 	// lookAt
 	Math::Vector3d _lookAtVector;
 
-	// struct used for path finding
-	struct PathNode {
-		Sector *sect;
-		PathNode *parent;
-		Math::Vector3d pos;
-		float dist;
-		float cost;
-	};
+	// Path finding through the walkable sectors of the current set
+	class WalkQuery;
 	Common::List<Math::Vector3d> _path;
 
 	CollisionMode _collisionMode;
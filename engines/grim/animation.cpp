@@ -34,10 +34,12 @@ Animation::Animation(const Common::String &keyframe, AnimManager *manager, int p
 		_manager(manager), _priority1(pr1), _priority2(pr2), _paused(true),
 		_active(false), _time(-1), _fade(1.f), _fadeMode(None) {
 	_keyframe = g_resourceloader->getKeyframe(keyframe);
+	_nodeCursors = new KeyframeCursor[_keyframe->getNumJoints()];
 }
 
 Animation::~Animation() {
 	deactivate();
+	delete[] _nodeCursors;
 }
 
 void Animation::activate() {
@@ -280,7 +282,7 @@ void AnimManager::animate(ModelNode *hier, int numNodes) {
 			if (layerWeight > 1.0f)
 				weight /= layerWeight;
 			weight *= remainingWeight;
-			j->_anim->_keyframe->animate(hier, i, time, weight, j->_tagged);
+			j->_anim->_keyframe->animate(hier, i, time, weight, j->_tagged, j->_anim->_nodeCursors);
 		}
 	}
 }
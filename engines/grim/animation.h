@@ -63,6 +63,7 @@ public:
 private:
 	AnimManager *_manager;
 	ObjectPtr<KeyframeAnim> _keyframe;
+	KeyframeCursor *_nodeCursors;
 	int _priority1;
 	int _priority2;
 	bool _paused;
@@ -20,12 +20,20 @@
  *
  */
 
+#include "common/algorithm.h"
 #include "common/config-manager.h"
+#include "common/file.h"
 #include "graphics/renderer.h"
 
 #include "engines/grim/debugger.h"
 #include "engines/grim/md5check.h"
 #include "engines/grim/grim.h"
+#include "engines/grim/parsecache.h"
+#include "engines/grim/resource.h"
+#include "engines/grim/lua/lgc.h"
+#include "engines/grim/lua/lprofile.h"
+#include "engines/grim/lua/lua.h"
+#include "engines/grim/set.h"
 
 namespace Grim {
 
@@ -38,6 +46,11 @@ Debugger::Debugger() :
 	registerCmd("set_renderer", WRAP_METHOD(Debugger, cmd_set_renderer));
 	registerCmd("save", WRAP_METHOD(Debugger, cmd_save));
 	registerCmd("load", WRAP_METHOD(Debugger, cmd_load));
+	registerCmd("resource_cache", WRAP_METHOD(Debugger, cmd_resourceCache));
+	registerCmd("sector_index", WRAP_METHOD(Debugger, cmd_sectorIndex));
+	registerCmd("parse_cache", WRAP_METHOD(Debugger, cmd_parseCache));
+	registerCmd("lua_gc", WRAP_METHOD(Debugger, cmd_luaGC));
+	registerCmd("lua_profile", WRAP_METHOD(Debugger, cmd_luaProfile));
 }
 
 Debugger::~Debugger() {
@@ -127,4 +140,183 @@ bool Debugger::cmd_load(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmd_resourceCache(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Usage: resource_cache [<budget in KB>]\n");
+		return true;
+	}
+
+	if (argc == 2)
+		g_resourceloader->setCacheBudget(atoi(argv[1]) * 1024);
+
+	ResourceLoader::CacheStats stats;
+	g_resourceloader->getCacheStats(stats);
+
+	const uint32 lookups = stats.hits + stats.misses;
+	debugPrintf("Files: %u, %u KB of %u KB", stats.entries, stats.residentSize / 1024, stats.budget / 1024);
+	if (stats.pinnedSize)
+		debugPrintf(" (%u KB evicted but in use)", stats.pinnedSize / 1024);
+	debugPrintf("\nHits: %u, misses: %u (%.1f%% hit rate), evictions: %u\n", stats.hits, stats.misses,
+	            lookups ? stats.hits * 100.0 / lookups : 0.0, stats.evictions);
+
+	return true;
+}
+
+bool Debugger::cmd_sectorIndex(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset") != 0 && strcmp(argv[1], "time") != 0)) {
+		debugPrintf("Usage: sector_index [reset|time]\n");
+		return true;
+	}
+
+	Set *set = g_grim->getCurrSet();
+	if (!set) {
+		debugPrintf("No set loaded\n");
+		return true;
+	}
+
+	SectorIndex &index = set->getSectorIndex();
+	if (argc == 2) {
+		// Timing costs two clock reads per query, so it is only done on request
+		if (strcmp(argv[1], "time") == 0)
+			index.setTiming(!index.isTiming());
+		index.resetStats();
+		return true;
+	}
+
+	debugPrintf("Sectors: %d, grid cells: %d, unbounded sectors: %d\n", index.getSectorCount(),
+	            index.getCellCount(), index.getUnboundedCount());
+
+	static const char *const names[] = { "point", "sort order", "closest" };
+	for (int i = 0; i < SectorIndex::kQueryTypeCount; i++) {
+		const SectorIndex::QueryStats &stats = index.getStats((SectorIndex::QueryType)i);
+		if (!stats.queries) {
+			debugPrintf("%s: no queries\n", names[i]);
+			continue;
+		}
+		if (index.isTiming())
+			debugPrintf("%s: %u queries, %.2f us and %.1f sectors tested on average\n", names[i], stats.queries,
+			            (double)stats.micros / stats.queries, (double)stats.sectorsTested / stats.queries);
+		else
+			debugPrintf("%s: %u queries, %.1f sectors tested on average\n", names[i], stats.queries,
+			            (double)stats.sectorsTested / stats.queries);
+	}
+
+	return true;
+}
+
+bool Debugger::cmd_parseCache(int argc, const char **argv) {
+	if (!g_parseCache) {
+		debugPrintf("The parse cache is disabled\n");
+		return true;
+	}
+
+	ParseCache::Stats stats;
+	g_parseCache->getStats(stats);
+
+	const uint32 lookups = stats.hits + stats.misses;
+	debugPrintf("Files: %u, %u KB\nHits: %u, misses: %u (%.1f%% hit rate)\n", stats.entries, stats.size / 1024,
+	            stats.hits, stats.misses, lookups ? stats.hits * 100.0 / lookups : 0.0);
+
+	return true;
+}
+
+bool Debugger::cmd_luaGC(int argc, const char **argv) {
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		luaC_resetstats();
+		debugPrintf("Lua garbage collector statistics reset\n");
+		return true;
+	} else if (argc == 2 && !strcmp(argv[1], "full")) {
+		debugPrintf("Full collection recovered %d blocks\n", lua_collectgarbage(0));
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Usage: %s [reset|full]\n", argv[0]);
+		return true;
+	}
+
+	const GCStats &stats = luaC_getstats();
+	const uint32 steps = MAX<uint32>(stats.steps, 1);
+	debugPrintf("%u cycles, %u steps, %u full collections\n", stats.cycles, stats.steps, stats.fullCollections);
+	debugPrintf("Step time: avg %u us, max %u us\n", (uint32)(stats.stepMicros / steps), stats.maxStepMicros);
+
+	debugPrintf("Step time histogram:\n");
+	uint32 limit = GCStats::kHistogramFirstBucketMicros;
+	for (int i = 0; i < GCStats::kHistogramBuckets; i++, limit *= 2) {
+		if (i < GCStats::kHistogramBuckets - 1)
+			debugPrintf("  < %5u us: %u\n", limit, stats.stepHistogram[i]);
+		else
+			debugPrintf(" >= %5u us: %u\n", limit / 2, stats.stepHistogram[i]);
+	}
+
+	return true;
+}
+
+static bool compareTasks(const ProfileTask &a, const ProfileTask &b) {
+	return a.micros > b.micros;
+}
+
+static bool compareFunctions(const ProfileFunction &a, const ProfileFunction &b) {
+	return a.exclusiveMicros > b.exclusiveMicros;
+}
+
+bool Debugger::cmd_luaProfile(int argc, const char **argv) {
+	if (argc == 2 && !strcmp(argv[1], "start")) {
+		luaP_start();
+		debugPrintf("Lua profiler started\n");
+		return true;
+	} else if (argc == 2 && !strcmp(argv[1], "stop")) {
+		luaP_stop();
+		debugPrintf("Lua profiler stopped\n");
+		return true;
+	} else if (argc == 2 && !strcmp(argv[1], "reset")) {
+		luaP_reset();
+		debugPrintf("Lua profile reset\n");
+		return true;
+	} else if (argc == 3 && !strcmp(argv[1], "dump")) {
+		// One line per call stack with its time in microseconds, the input
+		// of flamegraph.pl and most other flame graph tools
+		Common::DumpFile file;
+		if (!file.open(argv[2])) {
+			debugPrintf("Unable to open file '%s' for writing\n", argv[2]);
+			return true;
+		}
+		luaP_writefolded(&file);
+		debugPrintf("Wrote the call stacks to '%s'\n", argv[2]);
+		return true;
+	} else if (argc != 2 || strcmp(argv[1], "dump")) {
+		debugPrintf("Usage: %s start|stop|reset|dump [<file>]\n", argv[0]);
+		return true;
+	}
+
+	const uint32 frames = luaP_getframes();
+	debugPrintf("%u frames profiled%s\n", frames, luaP_enabled ? ", still running" : "");
+
+	Common::Array<ProfileTask> tasks;
+	luaP_gettasks(tasks);
+	Common::sort(tasks.begin(), tasks.end(), compareTasks);
+	debugPrintf("Tasks:\n    id frames  avg us  max us avg instr max instr name\n");
+	for (uint i = 0; i < tasks.size() && i < 20; i++) {
+		const ProfileTask &task = tasks[i];
+		debugPrintf("%6u %6u %7u %7u %9u %9u %s\n", task.id, task.frames, (uint32)(task.micros / task.frames),
+		            task.maxMicros, (uint32)(task.instructions / task.frames), task.maxInstructions, task.name.c_str());
+	}
+
+	Common::Array<ProfileFunction> functions;
+	luaP_getfunctions(functions);
+	Common::sort(functions.begin(), functions.end(), compareFunctions);
+	for (int builtins = 0; builtins < 2; builtins++) {
+		debugPrintf("%s:\n   calls  excl ms  incl ms name\n", builtins ? "Builtins" : "Functions");
+		uint shown = 0;
+		for (uint i = 0; i < functions.size() && shown < 20; i++) {
+			const ProfileFunction &function = functions[i];
+			if (function.builtin != (builtins != 0))
+				continue;
+			debugPrintf("%8u %8.1f %8.1f %s\n", function.calls, function.exclusiveMicros / 1000.0,
+			            function.inclusiveMicros / 1000.0, function.name.c_str());
+			shown++;
+		}
+	}
+
+	return true;
+}
+
 }
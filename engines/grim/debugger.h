@@ -40,6 +40,11 @@ public:
 	bool cmd_set_renderer(int argc, const char **argv);
 	bool cmd_save(int argc, const char **argv);
 	bool cmd_load(int argc, const char **argv);
+	bool cmd_resourceCache(int argc, const char **argv);
+	bool cmd_sectorIndex(int argc, const char **argv);
+	bool cmd_parseCache(int argc, const char **argv);
+	bool cmd_luaGC(int argc, const char **argv);
+	bool cmd_luaProfile(int argc, const char **argv);
 };
 
 }
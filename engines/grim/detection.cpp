@@ -653,14 +653,35 @@ SaveStateList GrimMetaEngine::listSaves(const char *target) const {
 		if (slotNum >= 0) {
 			SaveGame *savedState = SaveGame::openForLoading(*file);
 			if (savedState && savedState->isCompatible()) {
-				if (platform == Common::kPlatformPS2)
-					savedState->beginSection('PS2S');
-				else
-					savedState->beginSection('SUBS');
-				strSize = savedState->readLESint32();
-				savedState->read(str, strSize);
-				savedState->endSection();
-				saveList.push_back(SaveStateDescriptor(slotNum, str));
+				// Only the header of the newer saves has to be read, unless
+				// the scripts submitted no description when saving
+				Common::String description;
+				if (savedState->hasMetadata())
+					description = savedState->getDescription();
+
+				const uint32 tag = platform == Common::kPlatformPS2 ? 'PS2S' : 'SUBS';
+				if (description.empty() && savedState->hasSection(tag)) {
+					savedState->beginSection(tag);
+					strSize = CLIP<int32>(savedState->readLESint32(), 0, sizeof(str) - 1);
+					savedState->read(str, strSize);
+					str[strSize] = '\0';
+					savedState->endSection();
+					description = str;
+				} else if (savedState->isBroken()) {
+					warning("Skipping the broken savegame %s", file->c_str());
+					delete savedState;
+					continue;
+				}
+
+				SaveStateDescriptor desc(slotNum, description);
+				if (savedState->hasMetadata()) {
+					int year, month, day, hour, minute;
+					savedState->getSaveDate(year, month, day);
+					savedState->getSaveTime(hour, minute);
+					desc.setSaveDate(year, month, day);
+					desc.setSaveTime(hour, minute);
+				}
+				saveList.push_back(desc);
 			}
 			delete savedState;
 		}
@@ -27,31 +27,25 @@
 #include "math/mathfwd.h"
 #include "math/quat.h"
 #include "engines/grim/animation.h"
+#include "engines/grim/keyframecursor.h"
 #include "engines/grim/object.h"
 #include "engines/grim/emi/skeleton.h"
 
 namespace Grim {
 
-struct AnimRotation {
-	Math::Quaternion _quat;
-	float _time;
-};
-
-struct AnimTranslation {
-	Math::Vector3d _vec;
-	float _time;
-};
-
 struct Bone {
 	Common::String _boneName;
 	int _operation;
 	int _priority;
 	int _c;
 	int _count;
-	AnimRotation *_rotations;
-	AnimTranslation *_translations;
+	// The key times are kept apart from the values, the keys are searched
+	// by time every frame
+	float *_times;
+	Math::Quaternion *_rotations;
+	Math::Vector3d *_translations;
 	Joint *_target;
-	Bone() : _rotations(NULL), _translations(NULL), _boneName(""), _operation(0), _target(NULL) {}
+	Bone() : _times(NULL), _rotations(NULL), _translations(NULL), _boneName(""), _operation(0), _target(NULL) {}
 	~Bone();
 	void loadBinary(Common::SeekableReadStream *data);
 };
@@ -105,6 +99,7 @@ private:
 	Animation::FadeMode _fadeMode;
 	int _fadeLength;
 	int *_boneJoints;
+	KeyframeCursor *_boneCursors;
 };
 
 } // end of namespace Grim
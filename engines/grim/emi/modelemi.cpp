@@ -187,9 +187,28 @@ void EMIModel::loadMesh(Common::SeekableReadStream *data) {
 
 	_faces = new EMIMeshFace[_numFaces];
 
+	Common::Array<bool> isLit;
+	isLit.resize(_numVertices);
+	for (int i = 0; i < _numVertices; i++) {
+		isLit[i] = false;
+	}
 	for (uint32 j = 0; j < _numFaces; j++) {
 		_faces[j].setParent(this);
 		_faces[j].loadFace(data);
+		if (_faces[j]._flags & EMIMeshFace::kNoLighting) {
+			continue;
+		}
+		const int *indices = (const int *)_faces[j]._indexes;
+		for (uint32 k = 0; k < _faces[j]._faceLength * 3; k++) {
+			if (indices[k] >= 0 && indices[k] < _numVertices) {
+				isLit[indices[k]] = true;
+			}
+		}
+	}
+	for (int i = 0; i < _numVertices; i++) {
+		if (isLit[i]) {
+			_litVertices.push_back(i);
+		}
 	}
 
 	int hasBones = data->readUint32LE();
@@ -222,50 +241,42 @@ void EMIModel::setSkeleton(Skeleton *skel) {
 		return;
 	}
 	_skeleton = skel;
+	_skinnedGeneration = 0;
 	if (!skel || !_numBoneInfos) {
 		return;
 	}
-	delete[] _vertexBoneInfo; _vertexBoneInfo = nullptr;
-	_vertexBoneInfo = new int[_numBoneInfos];
-	for (int i = 0; i < _numBoneInfos; i++) {
-		_vertexBoneInfo[i] = _skeleton->findJointIndex(_boneNames[_boneInfos[i]._joint]);
-	}
-}
-
-void EMIModel::prepareForRender() {
-	if (!_skeleton || !_vertexBoneInfo)
-		return;
-
-	for (int i = 0; i < _numVertices; i++) {
-		_drawVertices[i].set(0.0f, 0.0f, 0.0f);
-		_drawNormals[i].set(0.0f, 0.0f, 0.0f);
-	}
-
+	_skinning.reset(_numVertices);
 	int boneVert = -1;
 	for (int i = 0; i < _numBoneInfos; i++) {
 		if (_boneInfos[i]._incFac == 1) {
 			boneVert++;
 		}
+		if (boneVert < 0 || boneVert >= _numVertices) {
+			continue;
+		}
+		int jointIndex = _skeleton->findJointIndex(_boneNames[_boneInfos[i]._joint]);
+		_skinning.addInfluence(boneVert, jointIndex, _boneInfos[i]._weight);
+	}
+	_jointMatrices.resize(_skinning.getJointCount());
+}
 
-		int jointIndex = _vertexBoneInfo[i];
-		const Math::Matrix4 &jointMatrix = _skeleton->_joints[jointIndex]._finalMatrix;
-		const Math::Matrix4 &bindPose = _skeleton->_joints[jointIndex]._absMatrix;
+void EMIModel::prepareForRender() {
+	if (!_skeleton || !_skinning.getVertexCount())
+		return;
 
-		Math::Vector3d vert = _vertices[boneVert];
-		bindPose.inverseTranslate(&vert);
-		bindPose.inverseRotate(&vert);
-		jointMatrix.transform(&vert, true);
-		_drawVertices[boneVert] += vert * _boneInfos[i]._weight;
+	// Nothing moved since the last time
+	if (_skinnedGeneration == _skeleton->_poseGeneration)
+		return;
+	_skinnedGeneration = _skeleton->_poseGeneration;
 
-		Math::Vector3d normal = _normals[boneVert];
-		bindPose.inverseRotate(&normal);
-		jointMatrix.transform(&normal, false);
-		_drawNormals[boneVert] += normal * _boneInfos[i]._weight;
+	// Each joint matrix takes a vertex from the bind pose straight to the
+	// current pose, so every influence only costs one blend
+	for (uint i = 0; i < _jointMatrices.size(); i++) {
+		const Joint &joint = _skeleton->_joints[i];
+		_jointMatrices[i].set(joint._finalMatrix * joint._invBindMatrix);
 	}
 
-	for (int i = 0; i < _numVertices; i++) {
-		_drawNormals[i].normalize();
-	}
+	_skinning.skin(_jointMatrices.begin(), _vertices, _normals, _drawVertices, _drawNormals);
 
 	g_driver->updateEMIModel(this);
 }
@@ -293,7 +304,7 @@ void EMIModel::draw() {
 		// If shaders are not available, we calculate lighting in software.
 		Actor::LightMode lightMode = actor->getLightMode();
 		if (lightMode != Actor::LightNone) {
-			if (lightMode != Actor::LightStatic)
+			if (lightMode != Actor::LightStatic && !isLightingCurrent(modelToWorld))
 				_lightingDirty = true;
 
 			if (_lightingDirty) {
@@ -323,89 +334,57 @@ void EMIModel::updateLighting(const Math::Matrix4 &modelToWorld) {
 	// FastDyn is requested. We assume that FastDyn mode was used only for the purpose of
 	// performance optimization, but NormDyn mode is visually superior in all cases.
 
-	Common::Array<Grim::Light *> activeLights;
 	bool hasAmbient = false;
 
 	Actor *actor = _costume->getOwner();
-
-	foreach(Light *l, g_grim->getCurrSet()->getLights(actor->isInOverworld())) {
-		if (l->_enabled) {
-			activeLights.push_back(l);
-			if (l->_type == Light::Ambient)
-				hasAmbient = true;
-		}
+	Set *set = g_grim->getCurrSet();
+
+	_vertexLighting.setVertices(modelToWorld, _drawVertices, _drawNormals, _litVertices.begin(), _litVertices.size());
+
+	foreach(Light *l, set->getLights(actor->isInOverworld())) {
+		if (!l->_enabled)
+			continue;
+		if (l->_type == Light::Ambient)
+			hasAmbient = true;
+
+		VertexLighting::LightSource light;
+		light._type = (VertexLighting::LightSource::Type)l->_type;
+		light._pos = l->_pos;
+		light._dir = l->_dir;
+		light._color[0] = l->_color.getRed() / 255.0f;
+		light._color[1] = l->_color.getGreen() / 255.0f;
+		light._color[2] = l->_color.getBlue() / 255.0f;
+		light._intensity = l->_intensity;
+		light._falloffNear = l->_falloffNear;
+		light._falloffFar = l->_falloffFar;
+		light._umbraAngle = l->_umbraangle;
+		light._penumbraAngle = l->_penumbraangle;
+		_vertexLighting.addLight(light);
 	}
 
-	for (int i = 0; i < _numVertices; i++) {
-		Math::Vector3d &result = _lighting[i];
-		result.set(0.0f, 0.0f, 0.0f);
-
-		Math::Vector3d normal = _drawNormals[i];
-		Math::Vector3d vertex = _drawVertices[i];
-		modelToWorld.transform(&vertex, true);
-		modelToWorld.transform(&normal, false);
-
-		for (uint j = 0; j < activeLights.size(); ++j) {
-			Light *l = activeLights[j];
-			float shade = l->_intensity;
-		
-			if (l->_type != Light::Ambient) {
-				// Direction of incident light
-				Math::Vector3d dir = l->_dir;
-
-				if (l->_type != Light::Direct) {
-					dir = l->_pos - vertex;
-					float distSq = dir.getSquareMagnitude();
-					if (distSq > l->_falloffFar * l->_falloffFar)
-						continue;
-
-					dir.normalize();
-
-					if (distSq > l->_falloffNear * l->_falloffNear) {
-						float dist = sqrt(distSq);
-						float attn = 1.0f - (dist - l->_falloffNear) / (l->_falloffFar - l->_falloffNear);
-						shade *= attn;
-					}
-				}
-
-				if (l->_type == Light::Spot) {
-					float cosAngle = l->_dir.dotProduct(dir);
-					if (cosAngle < 0.0f)
-						continue;
-
-					float angle = acos(cosAngle);
-					if (angle > l->_penumbraangle)
-						continue;
-
-					if (angle > l->_umbraangle)
-						shade *= 1.0f - (angle - l->_umbraangle) / (l->_penumbraangle - l->_umbraangle);
-				}
-
-				float dot = MAX(0.0f, normal.dotProduct(dir));
-				shade *= dot;
-			}
-
-			Math::Vector3d color;
-			color.x() = l->_color.getRed() / 255.0f;
-			color.y() = l->_color.getGreen() / 255.0f;
-			color.z() = l->_color.getBlue() / 255.0f;
+	if (!hasAmbient) {
+		// If the set does not specify an ambient light, a default ambient light is used
+		// instead. The effect of this is visible for example in the set gmi.
+		_vertexLighting.addAmbient(0.5f, 0.5f, 0.5f);
+	}
 
-			result += color * shade;
-		}
+	_vertexLighting.getResults(_lighting);
 
-		if (!hasAmbient) {
-			// If the set does not specify an ambient light, a default ambient light is used
-			// instead. The effect of this is visible for example in the set gmi.
-			result += Math::Vector3d(0.5f, 0.5f, 0.5f);
-		}
+	_litModelToWorld = modelToWorld;
+	_litSet = set;
+	_litLightsGeneration = set->getLightsGeneration();
+	_litInOverworld = actor->isInOverworld();
+	_litSkeleton = _skeleton;
+	_litPoseGeneration = _skinnedGeneration;
+}
 
-		float max = MAX(MAX(result.x(), result.y()), result.z());
-		if (max > 1.0f) {
-			result.x() = result.x() / max;
-			result.y() = result.y() / max;
-			result.z() = result.z() / max;
-		}
-	}
+bool EMIModel::isLightingCurrent(const Math::Matrix4 &modelToWorld) const {
+	const Actor *actor = _costume->getOwner();
+	const Set *set = g_grim->getCurrSet();
+	return _litSet == set && _litLightsGeneration == set->getLightsGeneration() &&
+	       _litInOverworld == actor->isInOverworld() && _litSkeleton == _skeleton &&
+	       _litPoseGeneration == _skinnedGeneration &&
+	       memcmp(_litModelToWorld.getData(), modelToWorld.getData(), 16 * sizeof(float)) == 0;
 }
 
 void EMIModel::getBoundingBox(int *x1, int *y1, int *x2, int *y2) const {
@@ -447,7 +426,7 @@ EMIModel::EMIModel(const Common::String &filename, Common::SeekableReadStream *d
 	_numBones = 0;
 	_boneInfos = nullptr;
 	_numBoneInfos = 0;
-	_vertexBoneInfo = nullptr;
+	_skinnedGeneration = 0;
 	_skeleton = nullptr;
 	_radius = 0;
 	_center = new Math::Vector3d();
@@ -458,6 +437,11 @@ EMIModel::EMIModel(const Common::String &filename, Common::SeekableReadStream *d
 	_boneNames = nullptr;
 	_lighting = nullptr;
 	_lightingDirty = true;
+	_litSet = nullptr;
+	_litLightsGeneration = 0;
+	_litInOverworld = false;
+	_litSkeleton = nullptr;
+	_litPoseGeneration = 0;
 	_texFlags = nullptr;
 
 	loadMesh(data);
@@ -475,7 +459,6 @@ EMIModel::~EMIModel() {
 	delete[] _texNames;
 	delete[] _mats;
 	delete[] _boneInfos;
-	delete[] _vertexBoneInfo;
 	delete[] _boneNames;
 	delete[] _lighting;
 	delete[] _texFlags;
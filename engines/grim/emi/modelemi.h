@@ -25,6 +25,8 @@
 
 #include "engines/grim/object.h"
 #include "engines/grim/actor.h"
+#include "engines/grim/emi/skinning.h"
+#include "engines/grim/emi/vertexlighting.h"
 #include "math/matrix4.h"
 #include "math/vector2d.h"
 #include "math/vector3d.h"
@@ -51,6 +53,7 @@ class EMIModel;
 struct BoneInfo;
 struct Bone;
 class Skeleton;
+class Set;
 
 class EMIMeshFace {
 public:
@@ -113,7 +116,10 @@ public:
 	int _numBoneInfos;
 	BoneInfo *_boneInfos;
 	Common::String *_boneNames;
-	int *_vertexBoneInfo;
+	Skinning _skinning;
+	Common::Array<Skinning::JointMatrix> _jointMatrices;
+	// The pose of the skeleton the draw vertices were last skinned to
+	uint32 _skinnedGeneration;
 
 	// Stuff we dont know how to use:
 	float _radius;
@@ -129,6 +135,16 @@ public:
 	void *_userData;
 	bool _lightingDirty;
 
+	// The vertices used by faces with lighting, and what they were lit with
+	Common::Array<int> _litVertices;
+	VertexLighting _vertexLighting;
+	Math::Matrix4 _litModelToWorld;
+	Set *_litSet;
+	uint32 _litLightsGeneration;
+	bool _litInOverworld;
+	Skeleton *_litSkeleton;
+	uint32 _litPoseGeneration;
+
 public:
 	EMIModel(const Common::String &filename, Common::SeekableReadStream *data, EMICostume *costume);
 	~EMIModel();
@@ -139,6 +155,7 @@ public:
 	void prepareTextures();
 	void draw();
 	void updateLighting(const Math::Matrix4 &modelToWorld);
+	bool isLightingCurrent(const Math::Matrix4 &modelToWorld) const;
 	void getBoundingBox(int *x1, int *y1, int *x2, int *y2) const;
 	Math::AABB calculateWorldBounds(const Math::Matrix4 &matrix) const;
 };
@@ -27,6 +27,7 @@
 #include "engines/grim/debug.h"
 #include "engines/grim/emi/animationemi.h"
 #include "engines/grim/emi/skeleton.h"
+#include "engines/grim/emi/skinning.h"
 
 namespace Grim {
 
@@ -34,7 +35,7 @@ namespace Grim {
 #define TRANSLATE_OP 3
 
 Skeleton::Skeleton(const Common::String &filename, Common::SeekableReadStream *data) :
-		_numJoints(0), _joints(nullptr), _animLayers(nullptr) {
+		_numJoints(0), _joints(nullptr), _poseGeneration(1), _animLayers(nullptr) {
 	loadSkeleton(data);
 }
 
@@ -82,6 +83,7 @@ void Skeleton::initBone(int index) {
 		// Might be the other way around.
 		_joints[index]._absMatrix =  _joints[index]._absMatrix * _joints[index]._relMatrix;
 	}
+	_joints[index]._invBindMatrix = Skinning::getInverseBindMatrix(_joints[index]._absMatrix);
 }
 
 void Skeleton::initBones() {
@@ -171,16 +173,25 @@ void Skeleton::removeAnimation(AnimationStateEmi *anim) {
 }
 
 void Skeleton::commitAnim() {
+	bool changed = false;
 	for (int m = 0; m < _numJoints; ++m) {
 		const Joint *parent = getParentJoint(&_joints[m]);
+		Math::Matrix4 finalMatrix;
 		if (parent) {
-			_joints[m]._finalMatrix = parent->_finalMatrix * _joints[m]._animMatrix;
+			finalMatrix = parent->_finalMatrix * _joints[m]._animMatrix;
 			_joints[m]._finalQuat = parent->_finalQuat * _joints[m]._animQuat;
 		} else {
-			_joints[m]._finalMatrix = _joints[m]._animMatrix;
+			finalMatrix = _joints[m]._animMatrix;
 			_joints[m]._finalQuat = _joints[m]._animQuat;
 		}
+		if (!changed && memcmp(finalMatrix.getData(), _joints[m]._finalMatrix.getData(), 16 * sizeof(float)) != 0)
+			changed = true;
+		_joints[m]._finalMatrix = finalMatrix;
 	}
+
+	// The meshes only need to be skinned again when the pose changed
+	if (changed)
+		++_poseGeneration;
 }
 
 int Skeleton::findJointIndex(const Common::String &name) const {
@@ -46,6 +46,7 @@ struct Joint {
 	Math::Quaternion _quat;
 	int _parentIndex;
 	Math::Matrix4 _absMatrix;
+	Math::Matrix4 _invBindMatrix;
 	Math::Matrix4 _relMatrix;
 	Math::Matrix4 _animMatrix;
 	Math::Quaternion _animQuat;
@@ -80,6 +81,9 @@ public:
 	typedef Common::HashMap<Common::String, int, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> JointMap;
 	JointMap _jointsMap;
 
+	// Bumped every time commitAnim() changes the final matrix of a joint
+	uint32 _poseGeneration;
+
 	Skeleton(const Common::String &filename, Common::SeekableReadStream *data);
 	~Skeleton();
 	void animate();
@@ -0,0 +1,196 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/simd.h"
+#include "common/textconsole.h"
+
+#include "engines/grim/emi/skinning.h"
+
+namespace Grim {
+
+void Skinning::JointMatrix::set(const Math::Matrix4 &m) {
+	for (int col = 0; col < 4; col++) {
+		for (int row = 0; row < 3; row++)
+			_columns[col][row] = m.getValue(row, col);
+		_columns[col][3] = 0.f;
+	}
+}
+
+Skinning::Skinning() : _lastVertex(-1), _jointCount(0) {
+}
+
+void Skinning::reset(int numVertices) {
+	_influenceCounts.clear();
+	_influenceCounts.resize(numVertices);
+	for (int i = 0; i < numVertices; i++)
+		_influenceCounts[i] = 0;
+	_joints.clear();
+	_weights.clear();
+	_lastVertex = -1;
+	_jointCount = 0;
+}
+
+void Skinning::addInfluence(int vertex, int joint, float weight) {
+	assert(vertex >= _lastVertex && vertex < getVertexCount());
+	if (joint < 0)
+		return;
+
+	_influenceCounts[vertex]++;
+	_joints.push_back(joint);
+	_weights.push_back(weight);
+	_lastVertex = vertex;
+	_jointCount = MAX(_jointCount, joint + 1);
+}
+
+Math::Matrix4 Skinning::getInverseBindMatrix(const Math::Matrix4 &bindPose) {
+	// The inverse of a rotation and a translation is the transposed rotation,
+	// after moving back by the translation
+	Math::Matrix4 inverse;
+	for (int row = 0; row < 3; row++) {
+		float translation = 0.f;
+		for (int col = 0; col < 3; col++) {
+			inverse.setValue(row, col, bindPose.getValue(col, row));
+			translation -= bindPose.getValue(col, row) * bindPose.getValue(col, 3);
+		}
+		inverse.setValue(row, 3, translation);
+	}
+	return inverse;
+}
+
+void Skinning::skin(const JointMatrix *joints, const Math::Vector3d *vertices, const Math::Vector3d *normals,
+                    Math::Vector3d *outVertices, Math::Vector3d *outNormals) const {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		skinSIMD(joints, vertices, normals, outVertices, outNormals);
+		return;
+	}
+#endif
+
+	skinScalar(joints, vertices, normals, outVertices, outNormals);
+}
+
+void Skinning::skinScalar(const JointMatrix *joints, const Math::Vector3d *vertices, const Math::Vector3d *normals,
+                          Math::Vector3d *outVertices, Math::Vector3d *outNormals) const {
+	const int numVertices = getVertexCount();
+	const int *joint = _joints.begin();
+	const float *weight = _weights.begin();
+
+	for (int i = 0; i < numVertices; i++) {
+		// Blend the matrices of the joints first, which is cheaper than
+		// transforming the vertex once per joint
+		float m[4][3] = { { 0.f } };
+		for (int count = _influenceCounts[i]; count > 0; count--, joint++, weight++) {
+			const JointMatrix &jm = joints[*joint];
+			for (int col = 0; col < 4; col++) {
+				m[col][0] += jm._columns[col][0] * *weight;
+				m[col][1] += jm._columns[col][1] * *weight;
+				m[col][2] += jm._columns[col][2] * *weight;
+			}
+		}
+
+		const Math::Vector3d &v = vertices[i];
+		outVertices[i].set(m[0][0] * v.x() + m[1][0] * v.y() + m[2][0] * v.z() + m[3][0],
+		                   m[0][1] * v.x() + m[1][1] * v.y() + m[2][1] * v.z() + m[3][1],
+		                   m[0][2] * v.x() + m[1][2] * v.y() + m[2][2] * v.z() + m[3][2]);
+
+		const Math::Vector3d &n = normals[i];
+		outNormals[i].set(m[0][0] * n.x() + m[1][0] * n.y() + m[2][0] * n.z(),
+		                  m[0][1] * n.x() + m[1][1] * n.y() + m[2][1] * n.z(),
+		                  m[0][2] * n.x() + m[1][2] * n.y() + m[2][2] * n.z());
+		outNormals[i].normalize();
+	}
+}
+
+#if defined(SCUMMVM_SSE2)
+
+void Skinning::skinSIMD(const JointMatrix *joints, const Math::Vector3d *vertices, const Math::Vector3d *normals,
+                        Math::Vector3d *outVertices, Math::Vector3d *outNormals) const {
+	const int numVertices = getVertexCount();
+	const int *joint = _joints.begin();
+	const float *weight = _weights.begin();
+	float result[4];
+
+	for (int i = 0; i < numVertices; i++) {
+		__m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps(), c2 = _mm_setzero_ps(), c3 = _mm_setzero_ps();
+		for (int count = _influenceCounts[i]; count > 0; count--, joint++, weight++) {
+			const JointMatrix &jm = joints[*joint];
+			const __m128 w = _mm_set1_ps(*weight);
+			c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(jm._columns[0]), w));
+			c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(jm._columns[1]), w));
+			c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(jm._columns[2]), w));
+			c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(jm._columns[3]), w));
+		}
+
+		const Math::Vector3d &v = vertices[i];
+		__m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(v.x())), _mm_mul_ps(c1, _mm_set1_ps(v.y())));
+		r = _mm_add_ps(r, _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(v.z())), c3));
+		_mm_storeu_ps(result, r);
+		outVertices[i].set(result[0], result[1], result[2]);
+
+		const Math::Vector3d &n = normals[i];
+		r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(n.x())), _mm_mul_ps(c1, _mm_set1_ps(n.y())));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(n.z())));
+		_mm_storeu_ps(result, r);
+		outNormals[i].set(result[0], result[1], result[2]);
+		outNormals[i].normalize();
+	}
+}
+
+#elif defined(SCUMMVM_NEON)
+
+void Skinning::skinSIMD(const JointMatrix *joints, const Math::Vector3d *vertices, const Math::Vector3d *normals,
+                        Math::Vector3d *outVertices, Math::Vector3d *outNormals) const {
+	const int numVertices = getVertexCount();
+	const int *joint = _joints.begin();
+	const float *weight = _weights.begin();
+	float result[4];
+
+	for (int i = 0; i < numVertices; i++) {
+		float32x4_t c0 = vdupq_n_f32(0.f), c1 = vdupq_n_f32(0.f), c2 = vdupq_n_f32(0.f), c3 = vdupq_n_f32(0.f);
+		for (int count = _influenceCounts[i]; count > 0; count--, joint++, weight++) {
+			const JointMatrix &jm = joints[*joint];
+			c0 = vmlaq_n_f32(c0, vld1q_f32(jm._columns[0]), *weight);
+			c1 = vmlaq_n_f32(c1, vld1q_f32(jm._columns[1]), *weight);
+			c2 = vmlaq_n_f32(c2, vld1q_f32(jm._columns[2]), *weight);
+			c3 = vmlaq_n_f32(c3, vld1q_f32(jm._columns[3]), *weight);
+		}
+
+		const Math::Vector3d &v = vertices[i];
+		float32x4_t r = vmlaq_n_f32(c3, c0, v.x());
+		r = vmlaq_n_f32(r, c1, v.y());
+		r = vmlaq_n_f32(r, c2, v.z());
+		vst1q_f32(result, r);
+		outVertices[i].set(result[0], result[1], result[2]);
+
+		const Math::Vector3d &n = normals[i];
+		r = vmulq_n_f32(c0, n.x());
+		r = vmlaq_n_f32(r, c1, n.y());
+		r = vmlaq_n_f32(r, c2, n.z());
+		vst1q_f32(result, r);
+		outNormals[i].set(result[0], result[1], result[2]);
+		outNormals[i].normalize();
+	}
+}
+
+#endif
+
+} // end of namespace Grim
@@ -0,0 +1,90 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRIM_SKINNING_H
+#define GRIM_SKINNING_H
+
+#include "common/array.h"
+
+#include "math/matrix4.h"
+#include "math/vector3d.h"
+
+namespace Grim {
+
+/**
+ * Linear blend skinning of the vertices and normals of a mesh.
+ *
+ * Each vertex is moved by the weighted sum of the matrices of the joints
+ * influencing it, and its normal by the rotation part of that sum. The
+ * joint matrices take a vertex from the bind pose to the current pose.
+ */
+class Skinning {
+public:
+	/** A joint matrix, stored by columns padded to four floats for vector code. */
+	struct JointMatrix {
+		float _columns[4][4];
+
+		void set(const Math::Matrix4 &m);
+	};
+
+	Skinning();
+
+	/** Remove all influences, and set the number of vertices. */
+	void reset(int numVertices);
+	/**
+	 * Add an influence of a joint on a vertex. Influences must be added in
+	 * order of the vertex. Vertices without influences end up at the origin.
+	 */
+	void addInfluence(int vertex, int joint, float weight);
+
+	int getVertexCount() const { return _influenceCounts.size(); }
+	int getInfluenceCount() const { return _joints.size(); }
+	/** The number of joint matrices skin() reads. */
+	int getJointCount() const { return _jointCount; }
+
+	void skin(const JointMatrix *joints, const Math::Vector3d *vertices, const Math::Vector3d *normals,
+	          Math::Vector3d *outVertices, Math::Vector3d *outNormals) const;
+
+	/**
+	 * Get the matrix taking a vertex in the bind pose of a joint back to
+	 * the space of the mesh. The bind pose must be a rotation and a
+	 * translation.
+	 */
+	static Math::Matrix4 getInverseBindMatrix(const Math::Matrix4 &bindPose);
+
+private:
+	void skinScalar(const JointMatrix *joints, const Math::Vector3d *vertices, const Math::Vector3d *normals,
+	                Math::Vector3d *outVertices, Math::Vector3d *outNormals) const;
+	void skinSIMD(const JointMatrix *joints, const Math::Vector3d *vertices, const Math::Vector3d *normals,
+	              Math::Vector3d *outVertices, Math::Vector3d *outNormals) const;
+
+	// The influences, in order of the vertex, and how many each vertex has
+	Common::Array<int> _influenceCounts;
+	Common::Array<int> _joints;
+	Common::Array<float> _weights;
+	int _lastVertex;
+	int _jointCount;
+};
+
+} // end of namespace Grim
+
+#endif
@@ -77,7 +77,8 @@ void AIFFTrack::setLooping(bool looping) {
 bool AIFFTrack::play() {
 	if (_stream) {
 		Audio::RewindableAudioStream *stream = dynamic_cast<Audio::RewindableAudioStream *>(_stream);
-		if (!_looping) {
+		// A prefetched stream already sits at its start.
+		if (!_looping && !isPrefetched()) {
 			stream->rewind();
 		}
 		return SoundTrack::play();
@@ -22,6 +22,7 @@
 
 #include "gui/error.h"
 
+#include "common/algorithm.h"
 #include "common/stream.h"
 #include "common/mutex.h"
 #include "common/timer.h"
@@ -197,6 +198,7 @@ EMISound::~EMISound() {
 	g_system->getTimerManager()->removeTimerProc(timerHandler);
 	freePlayingSounds();
 	freeLoadedSounds();
+	freePrewarmedMusic();
 	delete _musicTrack;
 	if (g_grim->getGamePlatform() != Common::kPlatformPS2) {
 		delete[] _musicTable;
@@ -226,6 +228,13 @@ void EMISound::freeLoadedSounds() {
 	_preloadedTrackMap.clear();
 }
 
+void EMISound::freePrewarmedMusic() {
+	for (TrackMap::iterator it = _prewarmedMusic.begin(); it != _prewarmedMusic.end(); ++it) {
+		delete it->_value;
+	}
+	_prewarmedMusic.clear();
+}
+
 bool EMISound::startVoice(const Common::String &soundName, int volume, int pan) {
 	return startSound(soundName, Audio::Mixer::kSpeechSoundType, volume, pan);
 }
@@ -538,14 +547,25 @@ void EMISound::setMusicState(int stateId) {
 		Debug::debug(Debug::Sound, "Attempted to play track #%d, not found in music table!", stateId);
 		return;
 	}
+	const int prevState = _curMusicState;
 	_curMusicState = stateId;
 
 	Audio::Timestamp *start = nullptr;
 	if (prevSync != 0 && sync != 0 && prevSync == sync)
 		start = &musicPos;
 
-	Debug::debug(Debug::Sound, "Loading music: %s", soundName.c_str());
-	SoundTrack *music = initTrack(soundName, Audio::Mixer::kMusicSoundType, start);
+	const uint32 switchStart = g_system->getMillis();
+
+	// Tracks continuing at the position of the previous one can't be opened
+	// in advance, as the position is only known now.
+	SoundTrack *music = nullptr;
+	if (!start)
+		music = takePrewarmedMusic(stateId, soundName);
+	const bool prewarmed = music != nullptr;
+	if (!music) {
+		Debug::debug(Debug::Sound, "Loading music: %s", soundName.c_str());
+		music = initTrack(soundName, Audio::Mixer::kMusicSoundType, start);
+	}
 	if (music) {
 		music->play();
 		music->setSync(sync);
@@ -555,6 +575,89 @@ void EMISound::setMusicState(int stateId) {
 		}
 		_musicTrack = music;
 	}
+
+	Debug::debug(Debug::Sound, "Switched to music state %d in %d ms (%s)", stateId,
+	             g_system->getMillis() - switchStart, prewarmed ? "prewarmed" : "opened on demand");
+
+	updatePrewarmCandidates(prevState);
+}
+
+SoundTrack *EMISound::takePrewarmedMusic(int stateId, const Common::String &soundName) {
+	TrackMap::iterator it = _prewarmedMusic.find(stateId);
+	if (it == _prewarmedMusic.end())
+		return nullptr;
+
+	SoundTrack *track = it->_value;
+	_prewarmedMusic.erase(it);
+	if (track && track->getSoundName() != soundName) {
+		delete track;
+		return nullptr;
+	}
+	return track;
+}
+
+/**
+ * Guess the music states which may be requested after the current one:
+ * the previous and the stacked states, which the scripts tend to return
+ * to, and the neighbouring table entries of the same area, which hold the
+ * variations of the current room's music. Music files are named after the
+ * area they belong to, e.g. 1100.scx to 1185.scx share one area.
+ */
+void EMISound::updatePrewarmCandidates(int prevState) {
+	_prewarmCandidates.clear();
+
+	Common::Array<int> states;
+	states.push_back(prevState);
+	for (uint i = 0; i < _stateStack.size(); ++i)
+		states.push_back(_stateStack[i]._state);
+
+	const Common::String &curFilename = _musicTable[_curMusicState]._filename;
+	for (int distance = 1; distance <= 2; ++distance) {
+		const int neighbours[] = { _curMusicState + distance, _curMusicState - distance };
+		for (int i = 0; i < ARRAYSIZE(neighbours); ++i) {
+			const int id = neighbours[i];
+			if (id <= 0 || id >= _numMusicStates)
+				continue;
+			if (strncmp(_musicTable[id]._filename.c_str(), curFilename.c_str(), 2) == 0)
+				states.push_back(id);
+		}
+	}
+
+	for (uint i = 0; i < states.size() && _prewarmCandidates.size() < kMaxPrewarmedMusic; ++i) {
+		const int id = states[i];
+		if (id <= 0 || id >= _numMusicStates || id == _curMusicState)
+			continue;
+		if (_musicTable[id]._id != id || _musicTable[id]._filename.empty())
+			continue;
+		if (Common::find(_prewarmCandidates.begin(), _prewarmCandidates.end(), id) != _prewarmCandidates.end())
+			continue;
+		_prewarmCandidates.push_back(id);
+	}
+
+	// Drop the tracks which are no longer expected
+	for (TrackMap::iterator it = _prewarmedMusic.begin(); it != _prewarmedMusic.end(); ++it) {
+		if (Common::find(_prewarmCandidates.begin(), _prewarmCandidates.end(), it->_key) == _prewarmCandidates.end()) {
+			delete it->_value;
+			_prewarmedMusic.erase(it);
+		}
+	}
+}
+
+void EMISound::prewarmMusic() {
+	// Only the game thread touches the prewarmed tracks, and they are not
+	// playing yet, so the files are opened without holding the mutex.
+	for (uint i = 0; i < _prewarmCandidates.size(); ++i) {
+		const int id = _prewarmCandidates[i];
+		if (_prewarmedMusic.contains(id))
+			continue;
+
+		SoundTrack *track = initTrack(_musicTable[id]._filename, Audio::Mixer::kMusicSoundType);
+		if (track)
+			track->prefetch(kPrewarmMsecs);
+		// Failed opens are remembered too, so they are not retried every frame
+		_prewarmedMusic[id] = track;
+		return;
+	}
 }
 
 uint32 EMISound::getMsPos(int stateId) {
@@ -707,6 +810,9 @@ void EMISound::selectMusicSet(int setId) {
 		error("EMISound::selectMusicSet - Unknown setId %d", setId);
 	}
 
+	// The prewarmed tracks were opened from the previous set
+	freePrewarmedMusic();
+
 	// Immediately switch all currently active music tracks to the new quality.
 	for (TrackList::iterator it = _playingTracks.begin(); it != _playingTracks.end(); ++it) {
 		SoundTrack *track = (*it);
@@ -877,6 +983,8 @@ void EMISound::restoreState(SaveGame *savedState) {
 	setMusicState(0);
 	freePlayingSounds();
 	freeLoadedSounds();
+	freePrewarmedMusic();
+	_prewarmCandidates.clear();
 	delete _musicTrack;
 	_musicTrack = nullptr;
 	// Actually load:
@@ -28,6 +28,7 @@
 #include "common/stack.h"
 #include "common/mutex.h"
 #include "common/hashmap.h"
+#include "common/array.h"
 #include "math/vector3d.h"
 
 namespace Grim {
@@ -94,6 +95,12 @@ public:
 
 	void updateSoundPositions();
 
+	/**
+	 * Open and prefetch one of the music tracks likely to be requested
+	 * next. Called once per frame from the main loop.
+	 */
+	void prewarmMusic();
+
 private:
 	struct StackEntry {
 		int _state;
@@ -113,6 +120,15 @@ private:
 	typedef Common::HashMap<int, SoundTrack *> TrackMap;
 	TrackMap _preloadedTrackMap;
 
+	enum {
+		kMaxPrewarmedMusic = 4,
+		kPrewarmMsecs = 300
+	};
+
+	// Music states which may come next, and the tracks already opened for them
+	Common::Array<int> _prewarmCandidates;
+	TrackMap _prewarmedMusic;
+
 	int _curMusicState;
 	int _numMusicStates;
 	int _callbackFps;
@@ -128,6 +144,9 @@ private:
 	void updateTrack(SoundTrack *track);
 	void freePlayingSounds();
 	void freeLoadedSounds();
+	void freePrewarmedMusic();
+	void updatePrewarmCandidates(int prevState);
+	SoundTrack *takePrewarmedMusic(int stateId, const Common::String &soundName);
 	SoundTrack *initTrack(const Common::String &soundName, Audio::Mixer::SoundType soundType, const Audio::Timestamp *start = nullptr) const;
 	SoundTrack *restartTrack(SoundTrack *track);
 	bool startSound(const Common::String &soundName, Audio::Mixer::SoundType soundType, int volume, int pan);
@@ -74,7 +74,8 @@ Audio::Timestamp SCXTrack::getPos() {
 bool SCXTrack::play() {
 	if (_stream) {
 		Audio::RewindableAudioStream *stream = dynamic_cast<Audio::RewindableAudioStream *>(_stream);
-		if (!_looping) {
+		// A prefetched stream already sits at its start.
+		if (!_looping && !isPrefetched()) {
 			stream->rewind();
 		}
 		return SoundTrack::play();
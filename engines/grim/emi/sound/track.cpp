@@ -33,6 +33,40 @@
 
 namespace Grim {
 
+/**
+ * Plays back samples decoded by SoundTrack::prefetch() before continuing
+ * with the stream they were read from.
+ */
+class PrefetchedAudioStream : public Audio::AudioStream {
+public:
+	PrefetchedAudioStream(int16 *buffer, int numSamples, Audio::AudioStream *parent, DisposeAfterUse::Flag disposeAfterUse)
+		: _buffer(buffer), _numSamples(numSamples), _pos(0), _parent(parent, disposeAfterUse) {}
+
+	~PrefetchedAudioStream() {
+		delete[] _buffer;
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		const int buffered = MIN(numSamples, _numSamples - _pos);
+		memcpy(buffer, _buffer + _pos, buffered * sizeof(int16));
+		_pos += buffered;
+		if (buffered == numSamples)
+			return buffered;
+		return buffered + _parent->readBuffer(buffer + buffered, numSamples - buffered);
+	}
+
+	bool isStereo() const override { return _parent->isStereo(); }
+	int getRate() const override { return _parent->getRate(); }
+	bool endOfData() const override { return _pos == _numSamples && _parent->endOfData(); }
+	bool endOfStream() const override { return _pos == _numSamples && _parent->endOfStream(); }
+
+private:
+	int16 *_buffer;
+	int _numSamples;
+	int _pos;
+	Common::DisposablePtr<Audio::AudioStream> _parent;
+};
+
 SoundTrack::SoundTrack() {
 	_stream = nullptr;
 	_handle = nullptr;
@@ -45,12 +79,15 @@ SoundTrack::SoundTrack() {
 	_fadeMode = FadeNone;
 	_fade = 1.0f;
 	_attenuation = 1.0f;
+	_prefetchBuffer = nullptr;
+	_prefetchSamples = 0;
 
 	// Initialize to a plain sound for now
 	_soundType = Audio::Mixer::kPlainSoundType;
 }
 
 SoundTrack::~SoundTrack() {
+	delete[] _prefetchBuffer;
 	if (_stream && (_disposeAfterPlaying == DisposeAfterUse::NO || !_handle))
 		delete _stream;
 }
@@ -119,6 +156,15 @@ bool SoundTrack::play() {
 			warning("sound: %s already playing, don't start again!", _soundName.c_str());
 			return true;
 		}
+		if (_prefetchBuffer) {
+			// The mixer owns the wrapper, which in turn disposes of the stream
+			// like the mixer would have.
+			Audio::AudioStream *stream = new PrefetchedAudioStream(_prefetchBuffer, _prefetchSamples, _stream, _disposeAfterPlaying);
+			_prefetchBuffer = nullptr;
+			_prefetchSamples = 0;
+			g_system->getMixer()->playStream(_soundType, _handle, stream, -1, (byte)getEffectiveVolume(), _balance, DisposeAfterUse::YES);
+			return true;
+		}
 		// If _disposeAfterPlaying is NO, the destructor will take care of the stream.
 		g_system->getMixer()->playStream(_soundType, _handle, _stream, -1, (byte)getEffectiveVolume(), _balance, _disposeAfterPlaying);
 		return true;
@@ -126,6 +172,26 @@ bool SoundTrack::play() {
 	return false;
 }
 
+bool SoundTrack::prefetch(uint32 msecs) {
+	if (!_stream || !_handle || _prefetchBuffer || isPlaying())
+		return false;
+
+	const int channels = _stream->isStereo() ? 2 : 1;
+	const int numSamples = (int)((uint64)msecs * _stream->getRate() / 1000) * channels;
+	if (numSamples <= 0)
+		return false;
+
+	_prefetchBuffer = new int16[numSamples];
+	_prefetchSamples = _stream->readBuffer(_prefetchBuffer, numSamples);
+	if (_prefetchSamples <= 0) {
+		delete[] _prefetchBuffer;
+		_prefetchBuffer = nullptr;
+		_prefetchSamples = 0;
+		return false;
+	}
+	return true;
+}
+
 void SoundTrack::pause() {
 	_paused = !_paused;
 	if (_stream) {
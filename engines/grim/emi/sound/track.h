@@ -65,6 +65,8 @@ protected:
 	int _balance;
 	int _volume;
 	int _sync;
+	int16 *_prefetchBuffer;
+	int _prefetchSamples;
 public:
 	SoundTrack();
 	virtual ~SoundTrack();
@@ -74,6 +76,15 @@ public:
 	virtual void pause();
 	virtual void stop();
 
+	/**
+	 * Decode the first msecs of the stream before play() is called, so
+	 * starting the track does not have to wait for the decoder. The
+	 * position reported by streams which track their own decoding position
+	 * runs ahead by the prefetched part until the mixer has consumed it.
+	 */
+	bool prefetch(uint32 msecs);
+	bool isPrefetched() const { return _prefetchSamples > 0; }
+
 	void fadeIn() { _fadeMode = FadeIn; }
 	void fadeOut() { _fadeMode = FadeOut; }
 	void setFadeMode(FadeMode fadeMode) { _fadeMode = fadeMode; }
@@ -0,0 +1,304 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/simd.h"
+#include "common/util.h"
+
+#include "engines/grim/emi/vertexlighting.h"
+
+#include <math.h>
+
+namespace Grim {
+
+// A spot light has no visible cone when both its angles are at least this,
+// as the angle to a lit vertex is at most a right angle
+static const float kRightAngle = (float)(M_PI / 2);
+
+VertexLighting::VertexLighting() : _count(0) {
+}
+
+void VertexLighting::setVertices(const Math::Matrix4 &modelToWorld, const Math::Vector3d *vertices,
+                                 const Math::Vector3d *normals, const int *indices, int count) {
+	const int padded = (count + 3) & ~3;
+	for (int s = 0; s < kNumStreams; s++) {
+		_streams[s].resize(padded);
+		for (int i = count; i < padded; i++)
+			_streams[s][i] = 0.f;
+	}
+	_indices.resize(count);
+	_count = count;
+
+	// The matrix is stored by rows
+	const float *m = modelToWorld.getData();
+	for (int i = 0; i < count; i++) {
+		const Math::Vector3d &vertex = vertices[indices[i]];
+		const Math::Vector3d &normal = normals[indices[i]];
+
+		_indices[i] = indices[i];
+		_streams[kPosX][i] = m[0] * vertex.x() + m[1] * vertex.y() + m[2] * vertex.z() + m[3];
+		_streams[kPosY][i] = m[4] * vertex.x() + m[5] * vertex.y() + m[6] * vertex.z() + m[7];
+		_streams[kPosZ][i] = m[8] * vertex.x() + m[9] * vertex.y() + m[10] * vertex.z() + m[11];
+		_streams[kNormalX][i] = m[0] * normal.x() + m[1] * normal.y() + m[2] * normal.z();
+		_streams[kNormalY][i] = m[4] * normal.x() + m[5] * normal.y() + m[6] * normal.z();
+		_streams[kNormalZ][i] = m[8] * normal.x() + m[9] * normal.y() + m[10] * normal.z();
+		_streams[kRed][i] = 0.f;
+		_streams[kGreen][i] = 0.f;
+		_streams[kBlue][i] = 0.f;
+	}
+}
+
+void VertexLighting::addLight(const LightSource &light) {
+	if (light._type == LightSource::kAmbient) {
+		addAmbient(light._color[0] * light._intensity, light._color[1] * light._intensity,
+		           light._color[2] * light._intensity);
+		return;
+	}
+
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		addLightSIMD(light);
+		return;
+	}
+#endif
+
+	addLightScalar(light);
+}
+
+void VertexLighting::addAmbient(float red, float green, float blue) {
+	for (int i = 0; i < _count; i++) {
+		_streams[kRed][i] += red;
+		_streams[kGreen][i] += green;
+		_streams[kBlue][i] += blue;
+	}
+}
+
+void VertexLighting::getResults(Math::Vector3d *results) const {
+	for (int i = 0; i < _count; i++) {
+		Math::Vector3d &result = results[_indices[i]];
+		result.set(_streams[kRed][i], _streams[kGreen][i], _streams[kBlue][i]);
+
+		float max = MAX(MAX(result.x(), result.y()), result.z());
+		if (max > 1.0f) {
+			result.x() = result.x() / max;
+			result.y() = result.y() / max;
+			result.z() = result.z() / max;
+		}
+	}
+}
+
+float VertexLighting::getConeShade(const LightSource &light, float cosAngle) {
+	float angle = acos(cosAngle);
+	if (angle > light._penumbraAngle)
+		return 0.0f;
+
+	if (angle > light._umbraAngle)
+		return 1.0f - (angle - light._umbraAngle) / (light._penumbraAngle - light._umbraAngle);
+	return 1.0f;
+}
+
+void VertexLighting::addLightScalar(const LightSource &light) {
+	for (int i = 0; i < _count; i++) {
+		const Math::Vector3d vertex(_streams[kPosX][i], _streams[kPosY][i], _streams[kPosZ][i]);
+		const Math::Vector3d normal(_streams[kNormalX][i], _streams[kNormalY][i], _streams[kNormalZ][i]);
+		float shade = light._intensity;
+
+		// Direction of incident light
+		Math::Vector3d dir = light._dir;
+
+		if (light._type != LightSource::kDirect) {
+			dir = light._pos - vertex;
+			float distSq = dir.getSquareMagnitude();
+			if (distSq > light._falloffFar * light._falloffFar)
+				continue;
+
+			dir.normalize();
+
+			if (distSq > light._falloffNear * light._falloffNear) {
+				float dist = sqrt(distSq);
+				float attn = 1.0f - (dist - light._falloffNear) / (light._falloffFar - light._falloffNear);
+				shade *= attn;
+			}
+		}
+
+		if (light._type == LightSource::kSpot) {
+			float cosAngle = light._dir.dotProduct(dir);
+			if (cosAngle < 0.0f)
+				continue;
+
+			shade *= getConeShade(light, cosAngle);
+		}
+
+		float dot = MAX(0.0f, normal.dotProduct(dir));
+		shade *= dot;
+
+		_streams[kRed][i] += light._color[0] * shade;
+		_streams[kGreen][i] += light._color[1] * shade;
+		_streams[kBlue][i] += light._color[2] * shade;
+	}
+}
+
+#if defined(SCUMMVM_SSE2)
+
+void VertexLighting::addLightSIMD(const LightSource &light) {
+	const bool isDirect = light._type == LightSource::kDirect;
+	const bool isSpot = light._type == LightSource::kSpot;
+	const bool hasCone = isSpot && (light._umbraAngle < kRightAngle || light._penumbraAngle < kRightAngle);
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 lightX = _mm_set1_ps(light._pos.x()), lightY = _mm_set1_ps(light._pos.y()), lightZ = _mm_set1_ps(light._pos.z());
+	const __m128 dirX = _mm_set1_ps(light._dir.x()), dirY = _mm_set1_ps(light._dir.y()), dirZ = _mm_set1_ps(light._dir.z());
+	const __m128 nearSq = _mm_set1_ps(light._falloffNear * light._falloffNear);
+	const __m128 farSq = _mm_set1_ps(light._falloffFar * light._falloffFar);
+	const __m128 falloffNear = _mm_set1_ps(light._falloffNear);
+	const __m128 falloffRange = _mm_set1_ps(light._falloffFar - light._falloffNear);
+	const __m128 intensity = _mm_set1_ps(light._intensity);
+	const __m128 red = _mm_set1_ps(light._color[0]), green = _mm_set1_ps(light._color[1]), blue = _mm_set1_ps(light._color[2]);
+
+	const int padded = _streams[kPosX].size();
+	for (int i = 0; i < padded; i += 4) {
+		__m128 shade = intensity;
+		__m128 lit = _mm_cmpeq_ps(zero, zero);
+		__m128 dx = dirX, dy = dirY, dz = dirZ;
+
+		if (!isDirect) {
+			dx = _mm_sub_ps(lightX, _mm_loadu_ps(&_streams[kPosX][i]));
+			dy = _mm_sub_ps(lightY, _mm_loadu_ps(&_streams[kPosY][i]));
+			dz = _mm_sub_ps(lightZ, _mm_loadu_ps(&_streams[kPosZ][i]));
+			const __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			// A vertex at the light has no direction to it, and gets no light
+			lit = _mm_and_ps(_mm_cmple_ps(distSq, farSq), _mm_cmpgt_ps(distSq, zero));
+
+			const __m128 dist = _mm_sqrt_ps(distSq);
+			dx = _mm_div_ps(dx, dist);
+			dy = _mm_div_ps(dy, dist);
+			dz = _mm_div_ps(dz, dist);
+
+			const __m128 attn = _mm_sub_ps(one, _mm_div_ps(_mm_sub_ps(dist, falloffNear), falloffRange));
+			const __m128 pastNear = _mm_cmpgt_ps(distSq, nearSq);
+			shade = _mm_mul_ps(shade, _mm_or_ps(_mm_and_ps(pastNear, attn), _mm_andnot_ps(pastNear, one)));
+		}
+
+		if (isSpot) {
+			const __m128 cosAngle = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dirX, dx), _mm_mul_ps(dirY, dy)), _mm_mul_ps(dirZ, dz));
+			lit = _mm_and_ps(lit, _mm_cmpge_ps(cosAngle, zero));
+			if (hasCone) {
+				// There is no vector arc cosine, the cone is rarely needed
+				float cosAngles[4], cone[4];
+				_mm_storeu_ps(cosAngles, cosAngle);
+				for (int j = 0; j < 4; j++)
+					cone[j] = cosAngles[j] >= 0.0f ? getConeShade(light, cosAngles[j]) : 0.0f;
+				shade = _mm_mul_ps(shade, _mm_loadu_ps(cone));
+			}
+		}
+
+		__m128 dot = _mm_mul_ps(_mm_loadu_ps(&_streams[kNormalX][i]), dx);
+		dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(&_streams[kNormalY][i]), dy));
+		dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(&_streams[kNormalZ][i]), dz));
+		shade = _mm_and_ps(lit, _mm_mul_ps(shade, _mm_max_ps(dot, zero)));
+
+		_mm_storeu_ps(&_streams[kRed][i], _mm_add_ps(_mm_loadu_ps(&_streams[kRed][i]), _mm_mul_ps(red, shade)));
+		_mm_storeu_ps(&_streams[kGreen][i], _mm_add_ps(_mm_loadu_ps(&_streams[kGreen][i]), _mm_mul_ps(green, shade)));
+		_mm_storeu_ps(&_streams[kBlue][i], _mm_add_ps(_mm_loadu_ps(&_streams[kBlue][i]), _mm_mul_ps(blue, shade)));
+	}
+}
+
+#elif defined(SCUMMVM_NEON)
+
+/** Divide with a refined reciprocal estimate, ARMv7 has no vector division. */
+static inline float32x4_t divideNEON(float32x4_t a, float32x4_t b) {
+	float32x4_t r = vrecpeq_f32(b);
+	r = vmulq_f32(r, vrecpsq_f32(b, r));
+	r = vmulq_f32(r, vrecpsq_f32(b, r));
+	return vmulq_f32(a, r);
+}
+
+void VertexLighting::addLightSIMD(const LightSource &light) {
+	const bool isDirect = light._type == LightSource::kDirect;
+	const bool isSpot = light._type == LightSource::kSpot;
+	const bool hasCone = isSpot && (light._umbraAngle < kRightAngle || light._penumbraAngle < kRightAngle);
+
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t lightX = vdupq_n_f32(light._pos.x()), lightY = vdupq_n_f32(light._pos.y()), lightZ = vdupq_n_f32(light._pos.z());
+	const float32x4_t dirX = vdupq_n_f32(light._dir.x()), dirY = vdupq_n_f32(light._dir.y()), dirZ = vdupq_n_f32(light._dir.z());
+	const float32x4_t nearSq = vdupq_n_f32(light._falloffNear * light._falloffNear);
+	const float32x4_t farSq = vdupq_n_f32(light._falloffFar * light._falloffFar);
+	const float32x4_t falloffNear = vdupq_n_f32(light._falloffNear);
+	const float32x4_t falloffRange = vdupq_n_f32(light._falloffFar - light._falloffNear);
+	const float32x4_t intensity = vdupq_n_f32(light._intensity);
+
+	const int padded = _streams[kPosX].size();
+	for (int i = 0; i < padded; i += 4) {
+		float32x4_t shade = intensity;
+		uint32x4_t lit = vdupq_n_u32(0xffffffff);
+		float32x4_t dx = dirX, dy = dirY, dz = dirZ;
+
+		if (!isDirect) {
+			dx = vsubq_f32(lightX, vld1q_f32(&_streams[kPosX][i]));
+			dy = vsubq_f32(lightY, vld1q_f32(&_streams[kPosY][i]));
+			dz = vsubq_f32(lightZ, vld1q_f32(&_streams[kPosZ][i]));
+			const float32x4_t distSq = vmlaq_f32(vmlaq_f32(vmulq_f32(dx, dx), dy, dy), dz, dz);
+			// A vertex at the light has no direction to it, and gets no light
+			lit = vandq_u32(vcleq_f32(distSq, farSq), vcgtq_f32(distSq, zero));
+
+			// The masked out lanes may hold infinities, they are dropped below
+			float32x4_t invDist = vrsqrteq_f32(distSq);
+			invDist = vmulq_f32(invDist, vrsqrtsq_f32(vmulq_f32(distSq, invDist), invDist));
+			invDist = vmulq_f32(invDist, vrsqrtsq_f32(vmulq_f32(distSq, invDist), invDist));
+			const float32x4_t dist = vmulq_f32(distSq, invDist);
+			dx = vmulq_f32(dx, invDist);
+			dy = vmulq_f32(dy, invDist);
+			dz = vmulq_f32(dz, invDist);
+
+			const float32x4_t attn = vsubq_f32(one, divideNEON(vsubq_f32(dist, falloffNear), falloffRange));
+			shade = vmulq_f32(shade, vbslq_f32(vcgtq_f32(distSq, nearSq), attn, one));
+		}
+
+		if (isSpot) {
+			const float32x4_t cosAngle = vmlaq_f32(vmlaq_f32(vmulq_f32(dirX, dx), dirY, dy), dirZ, dz);
+			lit = vandq_u32(lit, vcgeq_f32(cosAngle, zero));
+			if (hasCone) {
+				// There is no vector arc cosine, the cone is rarely needed
+				float cosAngles[4], cone[4];
+				vst1q_f32(cosAngles, cosAngle);
+				for (int j = 0; j < 4; j++)
+					cone[j] = cosAngles[j] >= 0.0f ? getConeShade(light, cosAngles[j]) : 0.0f;
+				shade = vmulq_f32(shade, vld1q_f32(cone));
+			}
+		}
+
+		float32x4_t dot = vmulq_f32(vld1q_f32(&_streams[kNormalX][i]), dx);
+		dot = vmlaq_f32(dot, vld1q_f32(&_streams[kNormalY][i]), dy);
+		dot = vmlaq_f32(dot, vld1q_f32(&_streams[kNormalZ][i]), dz);
+		shade = vmulq_f32(shade, vmaxq_f32(dot, zero));
+		shade = vreinterpretq_f32_u32(vandq_u32(lit, vreinterpretq_u32_f32(shade)));
+
+		vst1q_f32(&_streams[kRed][i], vmlaq_n_f32(vld1q_f32(&_streams[kRed][i]), shade, light._color[0]));
+		vst1q_f32(&_streams[kGreen][i], vmlaq_n_f32(vld1q_f32(&_streams[kGreen][i]), shade, light._color[1]));
+		vst1q_f32(&_streams[kBlue][i], vmlaq_n_f32(vld1q_f32(&_streams[kBlue][i]), shade, light._color[2]));
+	}
+}
+
+#endif
+
+} // end of namespace Grim
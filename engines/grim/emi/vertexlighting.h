@@ -0,0 +1,100 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRIM_VERTEXLIGHTING_H
+#define GRIM_VERTEXLIGHTING_H
+
+#include "common/array.h"
+
+#include "math/matrix4.h"
+#include "math/vector3d.h"
+
+namespace Grim {
+
+/**
+ * Software lighting of the vertices of a mesh, as in the NormDyn mode of EMI.
+ *
+ * The vertices are transformed to world space and stored as separate arrays
+ * of x, y and z coordinates, so the lights can be applied to four vertices
+ * at a time.
+ */
+class VertexLighting {
+public:
+	/** A light, with its type and values as in Grim::Light. */
+	struct LightSource {
+		enum Type {
+			kOmni = 1,
+			kSpot = 2,
+			kDirect = 3,
+			kAmbient = 4
+		};
+
+		Type _type;
+		Math::Vector3d _pos, _dir;
+		/** The color, scaled to 0 to 1. */
+		float _color[3];
+		float _intensity;
+		float _falloffNear, _falloffFar;
+		float _umbraAngle, _penumbraAngle;
+	};
+
+	VertexLighting();
+
+	/**
+	 * Transform the vertices and normals with the given indices to world space,
+	 * and clear their light.
+	 */
+	void setVertices(const Math::Matrix4 &modelToWorld, const Math::Vector3d *vertices,
+	                 const Math::Vector3d *normals, const int *indices, int count);
+	/** Add the light of a light source to all the vertices. */
+	void addLight(const LightSource &light);
+	/** Add a constant light to all the vertices. */
+	void addAmbient(float red, float green, float blue);
+	/**
+	 * Scale the light of every vertex down to a maximum of 1 and store it at
+	 * the index of the vertex in the results.
+	 */
+	void getResults(Math::Vector3d *results) const;
+
+	int getVertexCount() const { return _count; }
+
+private:
+	void addLightScalar(const LightSource &light);
+	void addLightSIMD(const LightSource &light);
+	static float getConeShade(const LightSource &light, float cosAngle);
+
+	// The coordinates in world space and the light of the vertices, each
+	// array padded to a multiple of four entries
+	enum {
+		kPosX, kPosY, kPosZ,
+		kNormalX, kNormalY, kNormalZ,
+		kRed, kGreen, kBlue,
+		kNumStreams
+	};
+	Common::Array<float> _streams[kNumStreams];
+	Common::Array<int> _indices;
+	int _count;
+};
+
+} // end of namespace Grim
+
+#endif
@@ -30,6 +30,7 @@
 #include "common/file.h"
 #include "common/foreach.h"
 #include "common/fs.h"
+#include "common/savefile.h"
 #include "common/config-manager.h"
 #include "common/translation.h"
 
@@ -60,6 +61,7 @@
 #include "engines/grim/movie/movie.h"
 #include "engines/grim/savegame.h"
 #include "engines/grim/registry.h"
+#include "engines/grim/parsecache.h"
 #include "engines/grim/resource.h"
 #include "engines/grim/localize.h"
 #include "engines/grim/gfx_base.h"
@@ -108,6 +110,8 @@ GrimEngine::GrimEngine(OSystem *syst, uint32 gameFlags, GrimGameType gameType, C
 	ConfMan.registerDefault("fullscreen", false);
 	ConfMan.registerDefault("show_fps", false);
 	ConfMan.registerDefault("use_arb_shaders", true);
+	ConfMan.registerDefault("resource_cache_size", 64); // In megabytes
+	ConfMan.registerDefault("parse_cache", true);
 
 	_showFps = ConfMan.getBool("show_fps");
 
@@ -142,6 +146,9 @@ GrimEngine::GrimEngine(OSystem *syst, uint32 gameFlags, GrimGameType gameType, C
 	ConfMan.setInt("engine_speed", 1000 / _speedLimitMs);
 	_listFilesIter = nullptr;
 	_savedState = nullptr;
+	_backgroundSave = nullptr;
+	_saveStartTime = 0;
+	_saveSnapshotTime = 0;
 	_fps[0] = 0;
 	_iris = new Iris();
 	_buildActiveActorsList = false;
@@ -185,6 +192,9 @@ GrimEngine::~GrimEngine() {
 	delete[] _controlsState;
 	delete[] _joyAxisPosition;
 
+	// Waits for it to be written
+	delete _backgroundSave;
+
 	clearPools();
 
 	delete LuaBase::instance();
@@ -205,6 +215,18 @@ GrimEngine::~GrimEngine() {
 	g_localizer = nullptr;
 	delete g_resourceloader;
 	g_resourceloader = nullptr;
+	if (g_parseCache) {
+		if (g_parseCache->isDirty()) {
+			Common::OutSaveFile *data = _saveFileMan->openForSaving(_targetName + ".pcache", false);
+			if (data) {
+				g_parseCache->save(data);
+				data->finalize();
+				delete data;
+			}
+		}
+		delete g_parseCache;
+		g_parseCache = nullptr;
+	}
 	delete g_driver;
 	g_driver = nullptr;
 	delete _iris;
@@ -327,6 +349,14 @@ Common::Error GrimEngine::run() {
 	}
 
 	g_resourceloader = new ResourceLoader();
+	if (ConfMan.getBool("parse_cache")) {
+		g_parseCache = new ParseCache();
+		Common::InSaveFile *data = _saveFileMan->openForLoading(_targetName + ".pcache");
+		if (data) {
+			g_parseCache->load(data);
+			delete data;
+		}
+	}
 	bool demo = getGameFlags() & ADGF_DEMO;
 	if (getGameType() == GType_GRIM)
 		g_movie = CreateSmushPlayer(demo);
@@ -773,6 +803,7 @@ void GrimEngine::mainLoop() {
 		if (_savegameSaveRequest) {
 			savegameSave();
 		}
+		updateBackgroundSave();
 
 		if (_changeHardwareState || _changeFullscreenState) {
 			_changeHardwareState = false;
@@ -1088,6 +1119,11 @@ void GrimEngine::storeSaveGameImage(SaveGame *state) {
 void GrimEngine::savegameSave() {
 	debug("GrimEngine::savegameSave() started.");
 	_savegameSaveRequest = false;
+	if (_backgroundSave) {
+		_backgroundSave->waitWritten();
+		updateBackgroundSave();
+	}
+	_saveStartTime = g_system->getMillis();
 	Common::String filename;
 	if (_savegameFileName.size() == 0) {
 		filename = "grim.sav";
@@ -1158,7 +1194,12 @@ void GrimEngine::savegameSave() {
 
 	lua_Save(_savedState);
 
-	delete _savedState;
+	// Compressing and writing the file takes a while with a large Lua state,
+	// so it happens on a worker thread while the game goes on
+	_saveSnapshotTime = g_system->getMillis() - _saveStartTime;
+	_savedState->writeInBackground(savegameWritten, this);
+	_backgroundSave = _savedState;
+	_savedState = nullptr;
 
 	if (g_imuse)
 		g_imuse->pause(false);
@@ -1169,6 +1210,24 @@ void GrimEngine::savegameSave() {
 	clearEventQueue();
 }
 
+void GrimEngine::updateBackgroundSave() {
+	if (_backgroundSave && _backgroundSave->pollWritten()) {
+		delete _backgroundSave;
+		_backgroundSave = nullptr;
+	}
+}
+
+void GrimEngine::savegameWritten(SaveGame *savedState, bool success, void *param) {
+	GrimEngine *engine = static_cast<GrimEngine *>(param);
+	if (!success) {
+		warning("GrimEngine::savegameWritten() Can't write file. (Disk full?)");
+		//TODO: Translate this!
+		GUI::displayErrorDialog("Error: the game could not be saved.");
+	}
+	Debug::debug(Debug::Engine, "Savegame written: the snapshot took %u ms, the whole save %u ms.",
+	             engine->_saveSnapshotTime, g_system->getMillis() - engine->_saveStartTime);
+}
+
 void GrimEngine::saveGRIM() {
 	_savedState->beginSection('GRIM');
 
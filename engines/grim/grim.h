@@ -207,6 +207,8 @@ protected:
 
 	void savegameSave();
 	void saveGRIM();
+	void updateBackgroundSave();
+	static void savegameWritten(SaveGame *savedState, bool success, void *param);
 
 	void savegameRestore();
 	void restoreGRIM();
@@ -217,6 +219,10 @@ protected:
 	bool _savegameSaveRequest;
 	Common::String _savegameFileName;
 	SaveGame *_savedState;
+	// The last savegame, until it has been written on a worker thread
+	SaveGame *_backgroundSave;
+	uint32 _saveStartTime;
+	uint32 _saveSnapshotTime;
 
 	Set *_currSet;
 	EngineMode _mode, _previousMode;
@@ -178,7 +178,7 @@ bool KeyframeAnim::isNodeAnimated(ModelNode *nodes, int num, float time, bool ta
 	}
 }
 
-void KeyframeAnim::animate(ModelNode *nodes, int num, float time, float fade, bool tagged) const {
+void KeyframeAnim::animate(ModelNode *nodes, int num, float time, float fade, bool tagged, KeyframeCursor *cursors) const {
 	// Without this sending the bread down the tube in "mo" often crashes,
 	// because it goes outside the bounds of the array of the nodes.
 	if (num >= _numJoints)
@@ -190,7 +190,7 @@ void KeyframeAnim::animate(ModelNode *nodes, int num, float time, float fade, bo
 		frame = _numFrames;
 
 	if (_nodes[num] && tagged == ((_type & nodes[num]._type) != 0)) {
-		_nodes[num]->animate(nodes[num], frame, fade, (_flags & 256) == 0);
+		_nodes[num]->animate(nodes[num], frame, fade, (_flags & 256) == 0, cursors[num]);
 	}
 }
 
@@ -211,7 +211,6 @@ int KeyframeAnim::getMarker(float startTime, float stopTime) const {
 }
 
 void KeyframeAnim::KeyframeEntry::loadBinary(const char *data) {
-	_frame = get_float(data);
 	_flags = READ_LE_UINT32(data + 4);
 	_pos = Math::Vector3d::getVector3d(data + 8);
 	_pitch = get_float(data + 20);
@@ -228,10 +227,12 @@ void KeyframeAnim::KeyframeNode::loadBinary(Common::SeekableReadStream *data, ch
 
 	_numEntries = data->readUint32LE();
 	data->seek(4, SEEK_CUR);
+	_frames = new float[_numEntries];
 	_entries = new KeyframeEntry[_numEntries];
 	char kfEntry[56];
 	for (int i = 0; i < _numEntries; i++) {
 		data->read(kfEntry, 56);
+		_frames[i] = get_float(kfEntry);
 		_entries[i].loadBinary(kfEntry);
 	}
 }
@@ -239,6 +240,7 @@ void KeyframeAnim::KeyframeNode::loadBinary(Common::SeekableReadStream *data, ch
 void KeyframeAnim::KeyframeNode::loadText(TextSplitter &ts) {
 	ts.scanString("mesh name %s", 1, _meshName);
 	ts.scanString("entries %d", 1, &_numEntries);
+	_frames = new float[_numEntries];
 	_entries = new KeyframeEntry[_numEntries];
 	for (int i = 0; i < _numEntries; i++) {
 		int which;
@@ -246,7 +248,7 @@ void KeyframeAnim::KeyframeNode::loadText(TextSplitter &ts) {
 		float frame, x, y, z, p, yaw, r, dx, dy, dz, dp, dyaw, dr;
 		ts.scanString(" %d: %f %x %f %f %f %f %f %f", 9, &which, &frame, &flags, &x, &y, &z, &p, &yaw, &r);
 		ts.scanString(" %f %f %f %f %f %f", 6, &dx, &dy, &dz, &dp, &dyaw, &dr);
-		_entries[which]._frame = frame;
+		_frames[which] = frame;
 		_entries[which]._flags = (int)flags;
 		_entries[which]._pos = Math::Vector3d(x, y, z);
 		_entries[which]._dpos = Math::Vector3d(dx, dy, dz);
@@ -260,25 +262,20 @@ void KeyframeAnim::KeyframeNode::loadText(TextSplitter &ts) {
 }
 
 KeyframeAnim::KeyframeNode::~KeyframeNode() {
+	delete[] _frames;
 	delete[] _entries;
 }
 
-void KeyframeAnim::KeyframeNode::animate(ModelNode &node, float frame, float fade, bool useDelta) const {
+void KeyframeAnim::KeyframeNode::animate(ModelNode &node, float frame, float fade, bool useDelta, KeyframeCursor &cursor) const {
 	if (_numEntries == 0)
 		return;
 
-	// Do a binary search for the nearest previous frame
-	// Loop invariant: entries_[low].frame_ <= frame < entries_[high].frame_
-	int low = 0, high = _numEntries;
-	while (high > low + 1) {
-		int mid = (low + high) / 2;
-		if (_entries[mid]._frame <= frame)
-			low = mid;
-		else
-			high = mid;
-	}
+	// Find the nearest previous frame, or the first one
+	int low = cursor.countKeysBefore(_frames, _numEntries, frame, true) - 1;
+	if (low < 0)
+		low = 0;
 
-	float dt = frame - _entries[low]._frame;
+	float dt = frame - _frames[low];
 	Math::Vector3d pos = _entries[low]._pos;
 	Math::Angle pitch = _entries[low]._pitch;
 	Math::Angle yaw = _entries[low]._yaw;
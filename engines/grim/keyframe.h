@@ -25,6 +25,7 @@
 
 #include "math/vector3d.h"
 
+#include "engines/grim/keyframecursor.h"
 #include "engines/grim/object.h"
 
 namespace Common {
@@ -44,10 +45,15 @@ public:
 	void loadBinary(Common::SeekableReadStream *data);
 	void loadText(TextSplitter &ts);
 	bool isNodeAnimated(ModelNode *nodes, int num, float time, bool tagged) const;
-	void animate(ModelNode *nodes, int num, float time, float fade, bool tagged) const;
+	/**
+	 * Animate a node. cursors has an entry for each joint, where sampling
+	 * the node resumes from.
+	 */
+	void animate(ModelNode *nodes, int num, float time, float fade, bool tagged, KeyframeCursor *cursors) const;
 	int getMarker(float startTime, float stopTime) const;
 
 	float getLength() const { return _numFrames / _fps; }
+	int getNumJoints() const { return _numJoints; }
 	const Common::String &getFilename() const { return _fname; }
 
 private:
@@ -73,7 +79,6 @@ private:
 	struct KeyframeEntry {
 		void loadBinary(const char *data);
 
-		float _frame;
 		int _flags;
 		Math::Vector3d _pos, _dpos;
 		Math::Angle _pitch, _yaw, _roll, _dpitch, _dyaw, _droll;
@@ -84,10 +89,13 @@ private:
 		void loadText(TextSplitter &ts);
 		~KeyframeNode();
 
-		void animate(ModelNode &node, float frame, float fade, bool useDelta) const;
+		void animate(ModelNode &node, float frame, float fade, bool useDelta, KeyframeCursor &cursor) const;
 
 		char _meshName[32];
 		int _numEntries;
+		// The frame of each entry, apart from the entries as it is
+		// searched every time the node is animated
+		float *_frames;
 		KeyframeEntry *_entries;
 	};
 
@@ -0,0 +1,90 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRIM_KEYFRAMECURSOR_H
+#define GRIM_KEYFRAMECURSOR_H
+
+#include "common/util.h"
+
+namespace Grim {
+
+/**
+ * Remembers where a track of keyframes was last sampled. While an animation
+ * plays, time moves forward by less than a key per frame, so only the keys
+ * following the last position are looked at. Seeks, loops and long jumps
+ * fall back to a binary search.
+ *
+ * The key times must be sorted and stored on their own, without the values.
+ */
+class KeyframeCursor {
+public:
+	KeyframeCursor() : _keys(0) {}
+
+	/**
+	 * Return the number of keys before the time t. If inclusive is true,
+	 * the keys at t count as before it.
+	 */
+	int countKeysBefore(const float *times, int count, float t, bool inclusive) {
+		int low = 0, high = count;
+		int keys = MIN(_keys, count);
+
+		if (keys == 0 || isBefore(times[keys - 1], t, inclusive)) {
+			// The usual case, look at a few keys following the last position
+			const int last = MIN(keys + kMaxSteps, count);
+			while (keys < last && isBefore(times[keys], t, inclusive))
+				keys++;
+			if (keys < last || keys == count) {
+				_keys = keys;
+				return keys;
+			}
+			low = keys;
+		} else {
+			high = keys - 1;
+		}
+
+		// Loop invariant: the answer is in [low, high]
+		while (low < high) {
+			const int mid = (low + high) / 2;
+			if (isBefore(times[mid], t, inclusive))
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		_keys = low;
+		return low;
+	}
+
+	void reset() { _keys = 0; }
+
+private:
+	static const int kMaxSteps = 4;
+
+	static bool isBefore(float time, float t, bool inclusive) {
+		return inclusive ? time <= t : time < t;
+	}
+
+	int _keys;
+};
+
+} // end of namespace Grim
+
+#endif
@@ -261,11 +261,15 @@ void LuaBase::boot() {
 }
 
 void LuaBase::update(int frameTime, int movieTime) {
+	// Start a collection every ten seconds at least, and advance the one in
+	// progress by a bounded step every frame instead of stopping for all of it
 	_frameTimeCollection += frameTime;
+	bool startCollection = false;
 	if (_frameTimeCollection > 10000) {
 		_frameTimeCollection = 0;
-		lua_collectgarbage(0);
+		startCollection = true;
 	}
+	lua_stepgarbage(startCollection);
 
 	lua_beginblock();
 	setFrameTime(frameTime);
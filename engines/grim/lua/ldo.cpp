@@ -20,6 +20,7 @@
 #include "engines/grim/lua/lobject.h"
 #include "engines/grim/lua/lopcodes.h"
 #include "engines/grim/lua/lparser.h"
+#include "engines/grim/lua/lprofile.h"
 #include "engines/grim/lua/lstate.h"
 #include "engines/grim/lua/ltask.h"
 #include "engines/grim/lua/ltm.h"
@@ -142,7 +143,11 @@ static StkId callC(lua_CFunction f, StkId base) {
 		(*lua_callhook)(Ref(r), "(C)", -1);
 	}
 	lua_state->state_counter2++;
+	if (luaP_enabled)
+		luaP_enterbuiltin(f);
 	(*f)();  // do the actual call
+	if (luaP_enabled)
+		luaP_leavebuiltin();
 	lua_state->state_counter2--;
 //	if (lua_callhook)  // func may have changed lua_callhook
 //		(*lua_callhook)(LUA_NOOBJECT, "(return)", 0);
@@ -358,6 +363,7 @@ int32 luaD_protectedrun(int32 nResults) {
 	lua_state->errorJmp = &myErrorJmp;
 	lua_state->state_counter1++;
 	lua_Task *tmpTask = lua_state->task;
+	int32 profileDepth = luaP_depth();
 	if (setjmp(myErrorJmp) == 0) {
 		do_callinc(nResults);
 		status = 0;
@@ -369,6 +375,8 @@ int32 luaD_protectedrun(int32 nResults) {
 			lua_state->task = lua_state->task->next;
 			luaM_free(t);
 		}
+		if (luaP_enabled)
+			luaP_unwind(profileDepth);
 		status = 1;
 	}
 	lua_state->state_counter1--;
@@ -407,18 +415,17 @@ static int32 protectedparser(ZIO *z, int32 bin) {
 static int32 do_main(ZIO *z, int32 bin) {
 	int32 status;
 	do {
-		int32 old_blocks = (luaC_checkGC(), nblocks);
+		// The threshold is not raised for the blocks of the new chunk. The
+		// collector steps set it again, and each step only does a bounded
+		// amount of work, however big the chunk is.
+		luaC_checkGC();
 		status = protectedparser(z, bin);
 		if (status == 1)
 			return 1;  // error
 		else if (status == 2)
 			return 0;  // 'natural' end
-		else {
-			int32 newelems2 = 2 * (nblocks - old_blocks);
-			GCthreshold += newelems2;
+		else
 			status = luaD_protectedrun(MULT_RET);
-			GCthreshold -= newelems2;
-		}
 	} while (bin && status == 0);
 	return status;
 }
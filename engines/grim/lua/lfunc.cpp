@@ -7,7 +7,9 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_longjmp
 
 #include "engines/grim/lua/lfunc.h"
+#include "engines/grim/lua/lgc.h"
 #include "engines/grim/lua/lmem.h"
+#include "engines/grim/lua/lprofile.h"
 #include "engines/grim/lua/lstate.h"
 
 namespace Grim {
@@ -20,6 +22,7 @@ namespace Grim {
 Closure *luaF_newclosure(int32 nelems) {
 	Closure *c = (Closure *)luaM_malloc(sizeof(Closure) + nelems * sizeof(TObject));
 	luaO_insertlist(&rootcl, (GCnode *)c);
+	luaC_newobject((GCnode *)c, LUA_T_CLOSURE);
 	nblocks += gcsizeclosure(c);
 	c->nelems = nelems;
 	return c;
@@ -33,15 +36,19 @@ TProtoFunc *luaF_newproto() {
 	f->consts = nullptr;
 	f->nconsts = 0;
 	f->locvars = nullptr;
+	f->slotHints = nullptr;
 	luaO_insertlist(&rootproto, (GCnode *)f);
+	luaC_newobject((GCnode *)f, LUA_T_PROTO);
 	nblocks += gcsizeproto(f);
 	return f;
 }
 
 static void freefunc(TProtoFunc *f) {
+	luaP_freefunction(f);
 	luaM_free(f->code);
 	luaM_free(f->locvars);
 	luaM_free(f->consts);
+	luaM_free(f->slotHints);
 	luaM_free(f);
 }
 
@@ -6,6 +6,9 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_setjmp
 #define FORBIDDEN_SYMBOL_EXCEPTION_longjmp
 
+#include "common/system.h"
+#include "common/util.h"
+
 #include "engines/grim/lua/ldo.h"
 #include "engines/grim/lua/lfunc.h"
 #include "engines/grim/lua/lgc.h"
@@ -19,6 +22,42 @@
 
 namespace Grim {
 
+/*
+** The collector is incremental: it marks and sweeps in bounded steps, and
+** the program runs between them. Objects reached are gray until the
+** objects they refer to are marked, and black after that. Two barriers
+** keep a black object from referring to a white one while marking: a
+** table written to turns gray again, and a global variable being set marks
+** its new value. Stacks, locked references and tag methods are not
+** watched, they are marked again in the step which ends the marking.
+*/
+
+#define GC_STEPSIZE	100  // blocks allocated between two steps
+#define GC_STEPWORK	4000  // objects, slots and nodes visited in a step
+
+enum GCPhase {
+	GCpause,
+	GCpropagate,
+	GCsweepstrings,
+	GCsweeptables,
+	GCsweepprotos,
+	GCsweepclosures
+};
+
+struct GrayList {
+	TObject *objects;
+	int32 size;
+	int32 top;
+};
+
+static GCPhase gcPhase = GCpause;
+static GrayList gray = { nullptr, 0, 0 };
+static GrayList grayAgain = { nullptr, 0, 0 };  // written to after being marked
+static TaggedString *globalCursor = nullptr;  // next global variable to mark
+static int32 sweepString = 0;  // next string table to sweep
+static GCnode *sweepNode = nullptr;  // last node kept in the list being swept
+static GCStats gcStats;
+
 static int32 markobject (TObject *o);
 
 /*
@@ -129,127 +168,321 @@ void luaC_strcallIM(TaggedString *l) {
 	}
 }
 
-static GCnode *listcollect(GCnode *l) {
-	GCnode *frees = nullptr;
-	while (l) {
-		GCnode *next = l->next;
-		l->marked = 0;
-		while (next && !next->marked) {
-			l->next = next->next;
-			next->next = frees;
-			frees = next;
-			next = l->next;
-		}
-		l = next;
-	}
-	return frees;
+static void pushgray(GrayList *list, TObject *o) {
+	if (list->top == list->size)
+		list->size = luaM_growvector(&list->objects, list->size, TObject, memEM, MAX_INT);
+	list->objects[list->top++] = *o;
 }
 
 static void strmark(TaggedString *s) {
 	if (!s->head.marked)
-		s->head.marked = 1;
-}
-
-static void protomark(TProtoFunc *f) {
-	if (!f->head.marked) {
-		LocVar *v = f->locvars;
-		int32 i;
-		f->head.marked = 1;
-		if (f->fileName)
-			strmark(f->fileName);
-		for (i = 0; i < f->nconsts; i++)
-			markobject(&f->consts[i]);
-		if (v) {
-			for (; v->line != -1; v++) {
-				if (v->varname)
-					strmark(v->varname);
-			}
+		s->head.marked = GC_BLACK;
+}
+
+static int32 protomark(TProtoFunc *f) {
+	LocVar *v = f->locvars;
+	int32 i;
+	f->head.marked = GC_BLACK;
+	if (f->fileName)
+		strmark(f->fileName);
+	for (i = 0; i < f->nconsts; i++)
+		markobject(&f->consts[i]);
+	if (v) {
+		for (; v->line != -1; v++, i++) {
+			if (v->varname)
+				strmark(v->varname);
 		}
 	}
+	return 1 + i;
 }
 
-static void closuremark(Closure *f) {
-	if (!f->head.marked) {
-		int32 i;
-		f->head.marked = 1;
-		for (i = f->nelems; i >= 0; i--)
-			markobject(&f->consts[i]);
-	}
+static int32 closuremark(Closure *f) {
+	int32 i;
+	f->head.marked = GC_BLACK;
+	for (i = f->nelems; i >= 0; i--)
+		markobject(&f->consts[i]);
+	return 2 + f->nelems;
 }
 
-static void hashmark(Hash *h) {
-	if (!h->head.marked) {
-		int32 i;
-		h->head.marked = 1;
-		for (i = 0; i < nhash(h); i++) {
-			Node *n = node(h, i);
-			if (ttype(ref(n)) != LUA_T_NIL) {
-				markobject(&n->ref);
-				markobject(&n->val);
-			}
+static int32 hashmark(Hash *h) {
+	int32 i;
+	h->head.marked = GC_BLACK;
+	for (i = 0; i < nhash(h); i++) {
+		Node *n = node(h, i);
+		if (ttype(ref(n)) != LUA_T_NIL) {
+			markobject(&n->ref);
+			markobject(&n->val);
 		}
 	}
+	return 1 + nhash(h);
 }
 
-static void globalmark() {
-	TaggedString *g;
-	for (g = (TaggedString *)rootglobal.next; g; g = (TaggedString *)g->head.next){
-		if (g->globalval.ttype != LUA_T_NIL) {
-			markobject(&g->globalval);
-			strmark(g);  // cannot collect non nil global variables
-		}
+static void globalmark(TaggedString *g) {
+	if (g->globalval.ttype != LUA_T_NIL) {
+		markobject(&g->globalval);
+		strmark(g);  // cannot collect non nil global variables
 	}
 }
 
 static int32 markobject(TObject *o) {
+	GCnode *node;
 	switch (ttype(o)) {
 	case LUA_T_STRING:
 		strmark(tsvalue(o));
-		break;
+		return 0;
 	case LUA_T_ARRAY:
-		hashmark(avalue(o));
+		node = (GCnode *)avalue(o);
 		break;
 	case LUA_T_CLOSURE:
 	case LUA_T_CLMARK:
-		closuremark(o->value.cl);
+		node = (GCnode *)o->value.cl;
 		break;
 	case LUA_T_PROTO:
 	case LUA_T_PMARK:
-		protomark(o->value.tf);
+		node = (GCnode *)o->value.tf;
 		break;
 	default:
-		break;  // numbers, cprotos, etc
+		return 0;  // numbers, cprotos, etc
+	}
+	if (node->marked == GC_WHITE) {
+		node->marked = GC_GRAY;
+		pushgray(&gray, o);
 	}
 	return 0;
 }
 
-static void markall() {
+// Marks the objects a gray object refers to, returns the work done
+static int32 blacken(TObject *o) {
+	switch (ttype(o)) {
+	case LUA_T_ARRAY:
+		return hashmark(avalue(o));
+	case LUA_T_CLOSURE:
+	case LUA_T_CLMARK:
+		return closuremark(o->value.cl);
+	default:
+		return protomark(o->value.tf);
+	}
+}
+
+static void markroots() {
 	luaD_travstack(markobject); // mark stack objects
-	globalmark();  // mark global variable values and names
 	travlock(); // mark locked objects
 	luaT_travtagmethods(markobject);  // mark fallbacks
 }
 
-int32 lua_collectgarbage(int32 limit) {
-	int32 recovered = nblocks;  // to subtract nblocks after gc
-	Hash *freetable;
-	TaggedString *freestr;
-	TProtoFunc *freefunc;
-	Closure *freeclos;
-	markall();
+void luaC_newobject(GCnode *o, lua_Type type) {
+	GCPhase sweepPhase;
+	GCnode *root;
+	switch (type) {
+	case LUA_T_ARRAY:
+		sweepPhase = GCsweeptables;
+		root = &roottable;
+		break;
+	case LUA_T_PROTO:
+		sweepPhase = GCsweepprotos;
+		root = &rootproto;
+		break;
+	default:
+		sweepPhase = GCsweepclosures;
+		root = &rootcl;
+		break;
+	}
+
+	if (gcPhase == GCpropagate) {
+		// It is filled after being created, mark it once it is complete
+		TObject t;
+		ttype(&t) = type;
+		t.value.a = (Hash *)o;
+		o->marked = GC_GRAY;
+		pushgray(&gray, &t);
+	} else if (gcPhase != GCpause && (gcPhase < sweepPhase || (gcPhase == sweepPhase && sweepNode == root))) {
+		// Its list has yet to be swept, which would free it if it were white
+		o->marked = GC_BLACK;
+	} else {
+		o->marked = GC_WHITE;
+	}
+}
+
+void luaC_newstring(TaggedString *ts) {
+	// A string which is white and still to be swept may be found again
+	// by a lookup after it was not reached, and must not be freed then
+	if (ts->head.marked == GC_WHITE && (gcPhase == GCpropagate || gcPhase == GCsweepstrings))
+		ts->head.marked = GC_BLACK;
+}
+
+void luaC_barrierback(Hash *t) {
+	// Only black tables not yet swept are marked for the current cycle
+	if (gcPhase == GCpropagate) {
+		TObject o;
+		ttype(&o) = LUA_T_ARRAY;
+		avalue(&o) = t;
+		t->head.marked = GC_GRAY;
+		pushgray(&grayAgain, &o);
+	}
+}
+
+void luaC_globalbarrier(TaggedString *ts) {
+	if (gcPhase == GCpropagate)
+		globalmark(ts);
+}
+
+static void startcycle() {
+	gcPhase = GCpropagate;
+	globalCursor = (TaggedString *)rootglobal.next;
+	markroots();
+	gcStats.cycles++;
+}
+
+// Finishes the marking, with the program stopped
+static int32 atomic() {
+	int32 work = 0;
+	markroots();
+	for (; globalCursor; globalCursor = (TaggedString *)globalCursor->head.next)
+		globalmark(globalCursor);
+	while (gray.top > 0 || grayAgain.top > 0) {
+		if (gray.top > 0)
+			work += blacken(&gray.objects[--gray.top]);
+		else
+			work += blacken(&grayAgain.objects[--grayAgain.top]);
+	}
 	invalidaterefs();
-	freestr = luaS_collector();
-	freetable = (Hash *)listcollect(&roottable);
-	freefunc = (TProtoFunc *)listcollect(&rootproto);
-	freeclos = (Closure *)listcollect(&rootcl);
-	GCthreshold *= 4;  // to avoid GC during GC
-	luaC_hashcallIM(freetable);  // GC tag methods for tables
-	luaC_strcallIM(freestr);  // GC tag methods for userdata
+	luaS_collectglobals();
+	gcPhase = GCsweepstrings;
+	sweepString = 0;
+	return work;
+}
+
+// Sweeps the nodes after sweepNode until the work runs out, returns
+// whether the end of the list was reached
+static bool sweeplist(GCnode **frees, int32 *work) {
+	GCnode *l = sweepNode;
+	while (*work > 0) {
+		GCnode *next = l->next;
+		if (!next)
+			return true;
+		(*work)--;
+		if (next->marked == GC_WHITE) {
+			l->next = next->next;
+			next->next = *frees;
+			*frees = next;
+		} else {
+			next->marked = GC_WHITE;
+			l = next;
+		}
+	}
+	sweepNode = l;
+	return false;
+}
+
+static void endcycle() {
+	gcPhase = GCpause;
 	luaD_gcIM(&luaO_nilobject);  // GC tag method for nil (signal end of GC)
-	luaH_free(freetable);
-	luaS_free(freestr);
-	luaF_freeproto(freefunc);
-	luaF_freeclosure(freeclos);
+}
+
+// Advances the collection until the work runs out or the cycle ends.
+// The gc tag methods run Lua code, the threshold keeps it from
+// stepping in here again.
+static void collect(int32 work) {
+	while (work > 0 && gcPhase != GCpause) {
+		switch (gcPhase) {
+		case GCpropagate:
+			if (gray.top > 0)
+				work -= blacken(&gray.objects[--gray.top]);
+			else if (globalCursor) {
+				globalmark(globalCursor);
+				globalCursor = (TaggedString *)globalCursor->head.next;
+				work--;
+			} else
+				work -= atomic();
+			break;
+		case GCsweepstrings:
+			{
+				// Whole string tables are swept, as they may be rehashed
+				// between two steps
+				work -= 1 + string_root[sweepString].size;
+				TaggedString *freestr = luaS_collector(sweepString);
+				if (++sweepString == NUM_HASHS) {
+					gcPhase = GCsweeptables;
+					sweepNode = &roottable;
+				}
+				GCthreshold = MAX_INT;
+				luaC_strcallIM(freestr);  // GC tag methods for userdata
+				luaS_free(freestr);
+			}
+			break;
+		case GCsweeptables:
+			{
+				GCnode *freetable = nullptr;
+				if (sweeplist(&freetable, &work)) {
+					gcPhase = GCsweepprotos;
+					sweepNode = &rootproto;
+				}
+				GCthreshold = MAX_INT;
+				luaC_hashcallIM((Hash *)freetable);  // GC tag methods for tables
+				luaH_free((Hash *)freetable);
+			}
+			break;
+		case GCsweepprotos:
+			{
+				GCnode *freefunc = nullptr;
+				if (sweeplist(&freefunc, &work)) {
+					gcPhase = GCsweepclosures;
+					sweepNode = &rootcl;
+				}
+				luaF_freeproto((TProtoFunc *)freefunc);
+			}
+			break;
+		case GCsweepclosures:
+			{
+				GCnode *freeclos = nullptr;
+				if (sweeplist(&freeclos, &work))
+					endcycle();
+				luaF_freeclosure((Closure *)freeclos);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+static void recordstep(uint64 startMicros) {
+	const uint32 duration = (uint32)(g_system->getMicros() - startMicros);
+	gcStats.steps++;
+	gcStats.stepMicros += duration;
+	gcStats.maxStepMicros = MAX(gcStats.maxStepMicros, duration);
+
+	int bucket = 0;
+	uint32 limit = GCStats::kHistogramFirstBucketMicros;
+	while (bucket < GCStats::kHistogramBuckets - 1 && duration >= limit) {
+		bucket++;
+		limit *= 2;
+	}
+	gcStats.stepHistogram[bucket]++;
+}
+
+int32 lua_stepgarbage(int32 start) {
+	if (gcPhase == GCpause) {
+		if (!start)
+			return 0;
+		startcycle();
+	}
+	uint64 startMicros = g_system->getMicros();
+	collect(GC_STEPWORK);
+	recordstep(startMicros);
+	GCthreshold = (gcPhase == GCpause) ? 2 * nblocks : nblocks + GC_STEPSIZE;
+	return gcPhase != GCpause;
+}
+
+int32 lua_collectgarbage(int32 limit) {
+	int32 recovered = nblocks;  // to subtract nblocks after gc
+	uint64 startMicros = g_system->getMicros();
+	// A cycle in progress has to end before everything can be marked again
+	collect(MAX_INT);
+	startcycle();
+	collect(MAX_INT);
+	recordstep(startMicros);
+	gcStats.fullCollections++;
 	recovered = recovered - nblocks;
 	GCthreshold = (limit == 0) ? 2 * nblocks : nblocks + limit;
 	return recovered;
@@ -257,7 +490,25 @@ int32 lua_collectgarbage(int32 limit) {
 
 void luaC_checkGC() {
 	if (nblocks >= GCthreshold)
-		lua_collectgarbage(0);
+		lua_stepgarbage(1);
+}
+
+void luaC_init() {
+	gcPhase = GCpause;
+	luaM_free(gray.objects);
+	luaM_free(grayAgain.objects);
+	gray.objects = grayAgain.objects = nullptr;
+	gray.size = gray.top = grayAgain.size = grayAgain.top = 0;
+	globalCursor = nullptr;
+	sweepNode = nullptr;
+}
+
+const GCStats &luaC_getstats() {
+	return gcStats;
+}
+
+void luaC_resetstats() {
+	memset(&gcStats, 0, sizeof(gcStats));
 }
 
 } // end of namespace Grim
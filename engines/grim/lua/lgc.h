@@ -11,11 +11,52 @@
 
 namespace Grim {
 
+/*
+** Colors of the collectable objects, kept in GCnode::marked.
+** Strings are never gray, fixed strings and reserved words are marked
+** with 2 or more and never collected.
+*/
+#define GC_WHITE	0  // not reached in the current cycle
+#define GC_BLACK	1  // reached, and the objects it refers to as well
+#define GC_GRAY		3  // reached, the objects it refers to still to be marked
+
+/*
+** Timing of the collection steps, see the lua_gc debugger command.
+*/
+struct GCStats {
+	enum {
+		/**
+		 * Step durations are counted in buckets of doubling size:
+		 * below 64us, below 128us, ... below 16ms, and 16ms or more.
+		 */
+		kHistogramBuckets = 10,
+		kHistogramFirstBucketMicros = 64
+	};
+
+	uint32 cycles;
+	uint32 steps;
+	// Full collections are counted as steps as well
+	uint32 fullCollections;
+	uint64 stepMicros;
+	uint32 maxStepMicros;
+	uint32 stepHistogram[kHistogramBuckets];
+};
+
+void luaC_init();
 void luaC_checkGC();
 TObject* luaC_getref(int32 r);
 int32 luaC_ref(TObject *o, int32 lock);
 void luaC_hashcallIM(Hash *l);
 void luaC_strcallIM(TaggedString *l);
+void luaC_newobject(GCnode *o, lua_Type type);
+void luaC_newstring(TaggedString *ts);
+void luaC_barrierback(Hash *t);
+void luaC_globalbarrier(TaggedString *ts);
+const GCStats &luaC_getstats();
+void luaC_resetstats();
+
+// A black table which is written to turns gray again
+#define luaC_tablebarrier(t)	{ if ((t)->head.marked == GC_BLACK) luaC_barrierback(t); }
 
 } // end of namespace Grim
 
@@ -98,6 +98,7 @@ typedef struct TProtoFunc {
 	int32 lineDefined;
 	TaggedString  *fileName;
 	struct LocVar *locvars;  // ends with line = -1
+	int32 *slotHints;  // table slots of the fields named by consts, see lvm.cpp
 } TProtoFunc;
 
 typedef struct LocVar {
@@ -0,0 +1,406 @@
+/*
+** Profiler of the scripts
+** See Copyright Notice in lua.h
+*/
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_setjmp
+#define FORBIDDEN_SYMBOL_EXCEPTION_longjmp
+
+#include "common/hashmap.h"
+#include "common/stream.h"
+#include "common/system.h"
+
+#include "engines/grim/lua/lobject.h"
+#include "engines/grim/lua/lprofile.h"
+#include "engines/grim/lua/lstate.h"
+#include "engines/grim/lua/ltable.h"
+#include "engines/grim/lua/ltask.h"
+
+namespace Grim {
+
+/*
+** The interpreter tells the profiler when a Lua function or a C builtin is
+** called and when it returns, and runtasks tells it when it resumes and
+** suspends a task. Every call is a node of a call tree, below the node of
+** its caller, and the time between two of these events is added to the node
+** on top of the call stack of the running task. A task keeps its stack while
+** it waits for the next frame. The inclusive times, and the stacks in the
+** folded format read by the flame graph tools, are computed from the tree
+** when they are asked for.
+**
+** Functions are told apart by their TProtoFunc or C function. They are named
+** after the global variables, or the fields of the tables in global
+** variables, holding them, or else after where they are defined.
+*/
+
+struct ProfileFrame {
+	lua_Task *task;  // the task running a Lua function
+	int32 node;
+	bool builtin;
+};
+
+struct ProfileFrames {
+	Common::Array<ProfileFrame> frames;
+};
+
+struct ProfileNode {
+	int32 function;
+	int32 parent;  // -1 for the functions called from outside of Lua
+	uint64 micros;
+	Common::Array<int32> children;
+};
+
+struct AddressHash {
+	uint operator()(size_t address) const {
+		return (uint)(address ^ (address >> 16));
+	}
+};
+
+typedef Common::HashMap<size_t, int32, AddressHash> FunctionMap;
+typedef Common::HashMap<uint32, int32> TaskMap;
+
+struct Profile {
+	Common::Array<ProfileFunction> functions;
+	Common::Array<bool> named;  // whether the functions were found in a global variable
+	FunctionMap functionIndex;
+	Common::Array<ProfileNode> nodes;
+	Common::Array<int32> roots;
+	Common::Array<ProfileTask> tasks;
+	Common::Array<int32> taskFunctions;
+	TaskMap taskIndex;  // from LState::id to tasks
+	ProfileFrames *running;  // the call stack of the running task
+	uint64 lastMicros;
+	uint64 stateMicros;
+	uint32 stateInstructions;
+	uint32 frames;
+
+	Profile() : running(nullptr), lastMicros(0), stateMicros(0), stateInstructions(0), frames(0) {}
+};
+
+bool luaP_enabled = false;
+uint32 luaP_instructions = 0;
+
+static Profile *profile = nullptr;
+
+static void charge() {
+	const uint64 now = g_system->getMicros();
+	if (profile->running && !profile->running->frames.empty()) {
+		ProfileNode &node = profile->nodes[profile->running->frames.back().node];
+		node.micros += now - profile->lastMicros;
+		profile->functions[node.function].exclusiveMicros += now - profile->lastMicros;
+	}
+	profile->lastMicros = now;
+}
+
+static ProfileFrames *getframes(LState *state) {
+	if (!state->profileFrames)
+		state->profileFrames = new ProfileFrames();
+	return state->profileFrames;
+}
+
+static void clearframes() {
+	for (LState *state = lua_rootState; state; state = state->next)
+		luaP_freestate(state);
+}
+
+static int32 newfunction(size_t key, const Common::String &name, bool builtin) {
+	ProfileFunction function;
+	function.name = name;
+	function.builtin = builtin;
+	function.calls = 0;
+	function.exclusiveMicros = 0;
+	function.inclusiveMicros = 0;
+	profile->functions.push_back(function);
+	profile->named.push_back(false);
+	profile->functionIndex[key] = profile->functions.size() - 1;
+	return profile->functions.size() - 1;
+}
+
+static int32 luafunction(TProtoFunc *tf) {
+	FunctionMap::const_iterator i = profile->functionIndex.find((size_t)tf);
+	if (i != profile->functionIndex.end())
+		return i->_value;
+	return newfunction((size_t)tf, Common::String::format("%s:%d", tf->fileName->str, tf->lineDefined), false);
+}
+
+static int32 builtinfunction(lua_CFunction f) {
+	FunctionMap::const_iterator i = profile->functionIndex.find((size_t)f);
+	if (i != profile->functionIndex.end())
+		return i->_value;
+	return newfunction((size_t)f, Common::String::format("(C function %u)", profile->functions.size()), true);
+}
+
+// The function of a value, or -1 if it is not a function
+static int32 getfunction(TObject *o) {
+	if (ttype(o) == LUA_T_CLOSURE)
+		o = &clvalue(o)->consts[0];
+	if (ttype(o) == LUA_T_PROTO)
+		return luafunction(tfvalue(o));
+	if (ttype(o) == LUA_T_CPROTO)
+		return builtinfunction(fvalue(o));
+	return -1;
+}
+
+static int32 getnode(int32 parent, int32 function) {
+	Common::Array<int32> &siblings = parent < 0 ? profile->roots : profile->nodes[parent].children;
+	for (uint i = 0; i < siblings.size(); i++) {
+		if (profile->nodes[siblings[i]].function == function)
+			return siblings[i];
+	}
+
+	ProfileNode node;
+	node.function = function;
+	node.parent = parent;
+	node.micros = 0;
+	siblings.push_back(profile->nodes.size());
+	profile->nodes.push_back(node);
+	return profile->nodes.size() - 1;
+}
+
+static void push(ProfileFrames *frames, lua_Task *task, int32 function, bool builtin) {
+	ProfileFrame frame;
+	frame.task = task;
+	frame.node = getnode(frames->frames.empty() ? -1 : frames->frames.back().node, function);
+	frame.builtin = builtin;
+	frames->frames.push_back(frame);
+}
+
+void luaP_start() {
+	if (!profile)
+		profile = new Profile();
+	// The stacks were not kept up to date while stopped
+	clearframes();
+	profile->running = nullptr;
+	profile->lastMicros = g_system->getMicros();
+	luaP_enabled = true;
+}
+
+void luaP_stop() {
+	if (!luaP_enabled)
+		return;
+	charge();
+	clearframes();
+	luaP_enabled = false;
+}
+
+void luaP_reset() {
+	clearframes();
+	delete profile;
+	profile = new Profile();
+	profile->lastMicros = g_system->getMicros();
+}
+
+void luaP_newframe() {
+	profile->frames++;
+}
+
+void luaP_beginstate(LState *state) {
+	charge();
+	ProfileFrames *frames = getframes(state);
+	profile->running = frames;
+	// A task which was waiting when the profiler started has none of its
+	// calls on the stack, count its time in its function
+	if (frames->frames.empty() && state->task) {
+		int32 function = getfunction(&state->taskFunc);
+		if (function >= 0)
+			push(frames, nullptr, function, false);
+	}
+	profile->stateMicros = profile->lastMicros;
+	profile->stateInstructions = luaP_instructions;
+}
+
+void luaP_endstate(LState *state) {
+	charge();
+	profile->running = nullptr;
+
+	int32 index;
+	TaskMap::const_iterator i = profile->taskIndex.find(state->id);
+	if (i != profile->taskIndex.end()) {
+		index = i->_value;
+	} else {
+		ProfileTask task;
+		task.id = state->id;
+		task.frames = 0;
+		task.micros = 0;
+		task.maxMicros = 0;
+		task.instructions = 0;
+		task.maxInstructions = 0;
+		profile->tasks.push_back(task);
+		profile->taskFunctions.push_back(getfunction(&state->taskFunc));
+		index = profile->tasks.size() - 1;
+		profile->taskIndex[state->id] = index;
+	}
+
+	ProfileTask &task = profile->tasks[index];
+	const uint32 micros = (uint32)(profile->lastMicros - profile->stateMicros);
+	const uint32 instructions = luaP_instructions - profile->stateInstructions;
+	task.frames++;
+	task.micros += micros;
+	task.maxMicros = MAX(task.maxMicros, micros);
+	task.instructions += instructions;
+	task.maxInstructions = MAX(task.maxInstructions, instructions);
+}
+
+void luaP_enterlua(lua_Task *task) {
+	charge();
+	const int32 function = luafunction(task->tf);
+	profile->running = getframes(lua_state);
+	push(profile->running, task, function, false);
+	profile->functions[function].calls++;
+}
+
+void luaP_leavelua(lua_Task *task) {
+	charge();
+	ProfileFrames *frames = getframes(lua_state);
+	profile->running = frames;
+	// The calls above it on the stack were left by an error
+	for (int32 i = frames->frames.size() - 1; i >= 0; i--) {
+		if (frames->frames[i].task == task && !frames->frames[i].builtin) {
+			frames->frames.resize(i);
+			break;
+		}
+	}
+}
+
+void luaP_enterbuiltin(lua_CFunction f) {
+	charge();
+	const int32 function = builtinfunction(f);
+	profile->running = getframes(lua_state);
+	push(profile->running, nullptr, function, true);
+	profile->functions[function].calls++;
+}
+
+void luaP_leavebuiltin() {
+	charge();
+	ProfileFrames *frames = getframes(lua_state);
+	profile->running = frames;
+	if (!frames->frames.empty() && frames->frames.back().builtin)
+		frames->frames.pop_back();
+}
+
+int32 luaP_depth() {
+	return (lua_state && lua_state->profileFrames) ? lua_state->profileFrames->frames.size() : 0;
+}
+
+void luaP_unwind(int32 depth) {
+	charge();
+	ProfileFrames *frames = getframes(lua_state);
+	if ((int32)frames->frames.size() > depth)
+		frames->frames.resize(depth);
+}
+
+void luaP_freestate(LState *state) {
+	if (profile && profile->running == state->profileFrames)
+		profile->running = nullptr;
+	delete state->profileFrames;
+	state->profileFrames = nullptr;
+}
+
+void luaP_freefunction(TProtoFunc *f) {
+	// The address may be reused by another function
+	if (profile)
+		profile->functionIndex.erase((size_t)f);
+}
+
+static void namefunction(TObject *o, const char *table, const char *field) {
+	if (ttype(o) == LUA_T_CLOSURE)
+		o = &clvalue(o)->consts[0];
+	size_t key;
+	if (ttype(o) == LUA_T_PROTO)
+		key = (size_t)tfvalue(o);
+	else if (ttype(o) == LUA_T_CPROTO)
+		key = (size_t)fvalue(o);
+	else
+		return;
+
+	FunctionMap::const_iterator i = profile->functionIndex.find(key);
+	if (i == profile->functionIndex.end() || profile->named[i->_value])
+		return;
+	profile->functions[i->_value].name = table ? Common::String::format("%s.%s", table, field) : field;
+	profile->named[i->_value] = true;
+}
+
+static void namefunctions() {
+	if (!lua_rootState)
+		return;
+
+	TaggedString *g;
+	for (g = (TaggedString *)rootglobal.next; g; g = (TaggedString *)g->head.next)
+		namefunction(&g->globalval, nullptr, g->str);
+	// Then the methods, in the tables of the global variables
+	for (g = (TaggedString *)rootglobal.next; g; g = (TaggedString *)g->head.next) {
+		if (ttype(&g->globalval) != LUA_T_ARRAY)
+			continue;
+		Hash *t = avalue(&g->globalval);
+		for (int32 i = 0; i < nhash(t); i++) {
+			Node *n = node(t, i);
+			if (ttype(ref(n)) == LUA_T_STRING)
+				namefunction(val(n), g->str, tsvalue(ref(n))->str);
+		}
+	}
+}
+
+uint32 luaP_getframes() {
+	return profile ? profile->frames : 0;
+}
+
+void luaP_getfunctions(Common::Array<ProfileFunction> &functions) {
+	functions.clear();
+	if (!profile)
+		return;
+	namefunctions();
+
+	// Callees always come after their callers in the tree
+	Common::Array<uint64> totals;
+	totals.resize(profile->nodes.size());
+	for (int32 i = profile->nodes.size() - 1; i >= 0; i--) {
+		totals[i] += profile->nodes[i].micros;
+		if (profile->nodes[i].parent >= 0)
+			totals[profile->nodes[i].parent] += totals[i];
+	}
+
+	for (uint i = 0; i < profile->functions.size(); i++)
+		profile->functions[i].inclusiveMicros = 0;
+	for (uint i = 0; i < profile->nodes.size(); i++) {
+		const int32 function = profile->nodes[i].function;
+		int32 p = profile->nodes[i].parent;
+		while (p >= 0 && profile->nodes[p].function != function)
+			p = profile->nodes[p].parent;
+		// Recursive calls are already counted in the outermost one
+		if (p < 0)
+			profile->functions[function].inclusiveMicros += totals[i];
+	}
+
+	functions = profile->functions;
+}
+
+void luaP_gettasks(Common::Array<ProfileTask> &tasks) {
+	tasks.clear();
+	if (!profile)
+		return;
+	namefunctions();
+
+	tasks = profile->tasks;
+	for (uint i = 0; i < tasks.size(); i++) {
+		const int32 function = profile->taskFunctions[i];
+		tasks[i].name = function >= 0 ? profile->functions[function].name : "(unknown)";
+	}
+}
+
+void luaP_writefolded(Common::WriteStream *stream) {
+	if (!profile)
+		return;
+	namefunctions();
+
+	for (uint i = 0; i < profile->nodes.size(); i++) {
+		if (!profile->nodes[i].micros)
+			continue;
+		Common::String line = profile->functions[profile->nodes[i].function].name;
+		for (int32 p = profile->nodes[i].parent; p >= 0; p = profile->nodes[p].parent)
+			line = profile->functions[profile->nodes[p].function].name + ";" + line;
+		line += Common::String::format(" %u\n", (uint32)profile->nodes[i].micros);
+		stream->writeString(line);
+	}
+}
+
+} // end of namespace Grim
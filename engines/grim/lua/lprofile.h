@@ -0,0 +1,77 @@
+/*
+** Profiler of the scripts
+** See Copyright Notice in lua.h
+*/
+
+#ifndef GRIM_LPROFILE_H
+#define GRIM_LPROFILE_H
+
+#include "common/array.h"
+#include "common/str.h"
+
+#include "engines/grim/lua/lua.h"
+
+namespace Common {
+class WriteStream;
+}
+
+namespace Grim {
+
+struct lua_Task;
+struct LState;
+struct TProtoFunc;
+
+/*
+** Time spent in a Lua function or a C builtin while the profiler ran.
+** The inclusive time counts the functions it called as well, once for
+** recursive calls.
+*/
+struct ProfileFunction {
+	Common::String name;
+	bool builtin;
+	uint32 calls;
+	uint64 exclusiveMicros;
+	uint64 inclusiveMicros;
+};
+
+/*
+** Time and instructions of a task, over the frames in which it ran.
+*/
+struct ProfileTask {
+	Common::String name;
+	uint32 id;
+	uint32 frames;
+	uint64 micros;
+	uint32 maxMicros;
+	uint64 instructions;
+	uint32 maxInstructions;
+};
+
+extern bool luaP_enabled;
+// Instructions executed by luaV_execute, counted when it returns
+extern uint32 luaP_instructions;
+
+void luaP_start();
+void luaP_stop();
+void luaP_reset();
+
+void luaP_newframe();
+void luaP_beginstate(LState *state);
+void luaP_endstate(LState *state);
+void luaP_enterlua(lua_Task *task);
+void luaP_leavelua(lua_Task *task);
+void luaP_enterbuiltin(lua_CFunction f);
+void luaP_leavebuiltin();
+int32 luaP_depth();
+void luaP_unwind(int32 depth);
+void luaP_freestate(LState *state);
+void luaP_freefunction(TProtoFunc *f);
+
+uint32 luaP_getframes();
+void luaP_getfunctions(Common::Array<ProfileFunction> &functions);
+void luaP_gettasks(Common::Array<ProfileTask> &tasks);
+void luaP_writefolded(Common::WriteStream *stream);
+
+} // end of namespace Grim
+
+#endif
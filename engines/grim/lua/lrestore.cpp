@@ -330,6 +330,7 @@ void lua_Restore(SaveGame *savedState) {
 		arraysObj->idObj.low = savedState->readLESint32();
 		arraysObj->idObj.hi = savedState->readLESint32();
 		tempProtoFunc = luaM_new(TProtoFunc);
+		tempProtoFunc->slotHints = nullptr;
 		luaO_insertlist(oldProto, (GCnode *)tempProtoFunc);
 		oldProto = (GCnode *)tempProtoFunc;
 		PointerId ptr;
@@ -24,6 +24,7 @@
 #include "engines/grim/lua/lgc.h"
 #include "engines/grim/lua/llex.h"
 #include "engines/grim/lua/lmem.h"
+#include "engines/grim/lua/lprofile.h"
 #include "engines/grim/lua/lstate.h"
 #include "engines/grim/lua/lstring.h"
 #include "engines/grim/lua/ltable.h"
@@ -91,6 +92,7 @@ void lua_stateinit(LState *state) {
 	state->some_task = nullptr;
 	state->taskFunc.ttype = LUA_T_NIL;
 	state->sleepFor = 0;
+	state->profileFrames = nullptr;
 
 	state->stack.stack = luaM_newvector(STACK_UNIT, TObject);
 	state->stack.top = state->stack.stack;
@@ -114,6 +116,7 @@ void lua_statedeinit(LState *state) {
 		}
 	}
 
+	luaP_freestate(state);
 	free(state->stack.stack);
 }
 
@@ -132,6 +135,7 @@ void lua_resetglobals() {
 	refSize = 0;
 	GCthreshold = GARBAGE_BLOCK;
 	nblocks = 0;
+	luaC_init();
 
 	luaD_init();
 	luaS_init();
@@ -211,6 +215,7 @@ void lua_open() {
 }
 
 void lua_close() {
+	luaC_init();  // drop a collection in progress
 	TaggedString *alludata = luaS_collectudata();
 	GCthreshold = MAX_INT;  // to avoid GC during GC
 	luaC_hashcallIM((Hash *)roottable.next);  // GC t.methods for tables
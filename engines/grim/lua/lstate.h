@@ -106,6 +106,7 @@ struct LState {
 	struct C_Lua_Stack Cblocks[MAX_C_BLOCKS];
 	int numCblocks; // number of nested Cblocks
 	int sleepFor;
+	struct ProfileFrames *profileFrames;  // calls seen by the profiler, see lprofile.cpp
 };
 
 extern LState *lua_state, *lua_rootState;
@@ -13,7 +13,8 @@ namespace Grim {
 
 void luaS_init();
 TaggedString *luaS_createudata(void *udata, int32 tag);
-TaggedString *luaS_collector();
+TaggedString *luaS_collector(int32 table);
+void luaS_collectglobals();
 void luaS_free (TaggedString *l);
 TaggedString *luaS_new(const char *str);
 TaggedString *luaS_newfixedstring (const char *str);
@@ -10,6 +10,7 @@
 #include "engines/grim/lua/lauxlib.h"
 #include "engines/grim/lua/lmem.h"
 #include "engines/grim/lua/ldo.h"
+#include "engines/grim/lua/lprofile.h"
 #include "engines/grim/lua/lvm.h"
 #include "engines/grim/grim.h"
 
@@ -323,6 +324,9 @@ void lua_runtasks() {
 		return;
 	}
 
+	if (luaP_enabled)
+		luaP_newframe();
+
 	// Mark all the states to be updated
 	LState *state = lua_state->next;
 	do {
@@ -346,6 +350,8 @@ void runtasks(LState *const rootState) {
 		if (!lua_state->all_paused && !lua_state->updated && !lua_state->paused) {
 			jmp_buf	errorJmp;
 			lua_state->errorJmp = &errorJmp;
+			if (luaP_enabled)
+				luaP_beginstate(lua_state);
 			if (setjmp(errorJmp)) {
 				lua_Task *t, *m;
 				for (t = lua_state->task; t != nullptr;) {
@@ -365,6 +371,8 @@ void runtasks(LState *const rootState) {
 					stillRunning = luaD_call(base + 1, 255);
 				}
 			}
+			if (luaP_enabled)
+				luaP_endstate(lua_state);
 			nextState = lua_state->next;
 			// The state returned. Delete it
 			if (!stillRunning) {
@@ -12,6 +12,7 @@
 #include "engines/grim/lua/lgc.h"
 #include "engines/grim/lua/lmem.h"
 #include "engines/grim/lua/lopcodes.h"
+#include "engines/grim/lua/lprofile.h"
 #include "engines/grim/lua/lstate.h"
 #include "engines/grim/lua/lstring.h"
 #include "engines/grim/lua/ltable.h"
@@ -28,6 +29,29 @@ namespace Grim {
 
 #define	EXTRA_STACK	5
 
+/*
+** With GCC and Clang every instruction jumps straight to the code of the
+** next one through a table of label addresses, rather than back to a single
+** switch, which gives the branch predictor one jump per opcode to learn.
+** Other compilers, and debug builds, use the switch.
+*/
+#if defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__)) && !defined(LUA_DEBUG)
+#define LUA_THREADED_DISPATCH
+#endif
+
+// Fetches the next opcode, counting the instructions for the profiler
+#define vmfetch()		(executed++, task->aux = *task->pc++)
+
+#ifdef LUA_THREADED_DISPATCH
+#define vmdispatch(o)	goto *dispatchTable[o];
+#define vmcase(op)		L_##op:
+#define vmbreak			goto *dispatchTable[vmfetch()]
+#else
+#define vmdispatch(o)	switch (o)
+#define vmcase(op)		case op:
+#define vmbreak			break
+#endif
+
 static TaggedString *strconc(char *l, char *r) {
 	size_t nl = strlen(l);
 	char *buffer = luaL_openspace(nl + strlen(r) + 1);
@@ -241,8 +265,83 @@ static void adjust_varargs(StkId first_extra_arg) {
 	*lua_state->stack.top++ = arg;
 }
 
+/*
+** Inline caches for the fields named by string constants, read by GETDOTTED
+** and PUSHSELF. Each function keeps the table slot where the field named by
+** each of its constants was found last. Tables with the same fields set in
+** the same order have them in the same slots, so the lookup usually skips
+** hashing and probing. The key in the slot is checked before using it, so
+** the slots are never invalidated: a table which was rehashed, or freed and
+** replaced by another one, just misses once.
+*/
+static TObject *getfield(TProtoFunc *tf, int32 constant, Hash *t) {
+	TObject *key = &tf->consts[constant];
+	if (!tf->slotHints) {
+		tf->slotHints = luaM_newvector(tf->nconsts, int32);
+		memset(tf->slotHints, 0, tf->nconsts * sizeof(int32));
+	}
+	int32 *hint = &tf->slotHints[constant];
+	Node *n;
+	if (*hint < nhash(t)) {
+		n = node(t, *hint);
+		if (ttype(ref(n)) == LUA_T_STRING && tsvalue(ref(n)) == tsvalue(key))
+			return val(n);
+	}
+	*hint = present(t, key);
+	n = node(t, *hint);
+	return (ttype(ref(n)) == LUA_T_NIL) ? nullptr : val(n);
+}
+
+// Returns the field of a table without "gettable" method, or nullptr when
+// the field is nil or the tag methods have to be called
+static TObject *getcachedfield(lua_Task *task, TObject *t) {
+	if (ttype(t) != LUA_T_ARRAY || ttype(luaT_getim(avalue(t)->htag, IM_GETTABLE)) != LUA_T_NIL)
+		return nullptr;
+	TObject *h = getfield(task->tf, task->aux, avalue(t));
+	return (h && ttype(h) != LUA_T_NIL) ? h : nullptr;
+}
+
+#ifdef LUA_THREADED_DISPATCH
+// Computed gotos are a GCC extension
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
 StkId luaV_execute(lua_Task *task) {
+#ifdef LUA_THREADED_DISPATCH
+	// In the order of OpCode
+	static const void *const dispatchTable[] = {
+		&&L_ENDCODE, &&L_PUSHNIL, &&L_PUSHNIL0, &&L_PUSHNUMBER, &&L_PUSHNUMBER0, &&L_PUSHNUMBER1,
+		&&L_PUSHNUMBER2, &&L_PUSHNUMBERW, &&L_PUSHCONSTANT, &&L_PUSHCONSTANT0, &&L_PUSHCONSTANT1,
+		&&L_PUSHCONSTANT2, &&L_PUSHCONSTANT3, &&L_PUSHCONSTANT4, &&L_PUSHCONSTANT5,
+		&&L_PUSHCONSTANT6, &&L_PUSHCONSTANT7, &&L_PUSHCONSTANTW, &&L_PUSHUPVALUE, &&L_PUSHUPVALUE0,
+		&&L_PUSHUPVALUE1, &&L_PUSHLOCAL, &&L_PUSHLOCAL0, &&L_PUSHLOCAL1, &&L_PUSHLOCAL2,
+		&&L_PUSHLOCAL3, &&L_PUSHLOCAL4, &&L_PUSHLOCAL5, &&L_PUSHLOCAL6, &&L_PUSHLOCAL7,
+		&&L_GETGLOBAL, &&L_GETGLOBAL0, &&L_GETGLOBAL1, &&L_GETGLOBAL2, &&L_GETGLOBAL3,
+		&&L_GETGLOBAL4, &&L_GETGLOBAL5, &&L_GETGLOBAL6, &&L_GETGLOBAL7, &&L_GETGLOBALW,
+		&&L_GETTABLE, &&L_GETDOTTED, &&L_GETDOTTED0, &&L_GETDOTTED1, &&L_GETDOTTED2,
+		&&L_GETDOTTED3, &&L_GETDOTTED4, &&L_GETDOTTED5, &&L_GETDOTTED6, &&L_GETDOTTED7,
+		&&L_GETDOTTEDW, &&L_PUSHSELF, &&L_PUSHSELF0, &&L_PUSHSELF1, &&L_PUSHSELF2, &&L_PUSHSELF3,
+		&&L_PUSHSELF4, &&L_PUSHSELF5, &&L_PUSHSELF6, &&L_PUSHSELF7, &&L_PUSHSELFW, &&L_CREATEARRAY,
+		&&L_CREATEARRAY0, &&L_CREATEARRAY1, &&L_CREATEARRAYW, &&L_SETLOCAL, &&L_SETLOCAL0,
+		&&L_SETLOCAL1, &&L_SETLOCAL2, &&L_SETLOCAL3, &&L_SETLOCAL4, &&L_SETLOCAL5, &&L_SETLOCAL6,
+		&&L_SETLOCAL7, &&L_SETGLOBAL, &&L_SETGLOBAL0, &&L_SETGLOBAL1, &&L_SETGLOBAL2,
+		&&L_SETGLOBAL3, &&L_SETGLOBAL4, &&L_SETGLOBAL5, &&L_SETGLOBAL6, &&L_SETGLOBAL7,
+		&&L_SETGLOBALW, &&L_SETTABLE0, &&L_SETTABLE, &&L_SETLIST, &&L_SETLIST0, &&L_SETLISTW,
+		&&L_SETMAP, &&L_SETMAP0, &&L_EQOP, &&L_NEQOP, &&L_LTOP, &&L_LEOP, &&L_GTOP, &&L_GEOP,
+		&&L_ADDOP, &&L_SUBOP, &&L_MULTOP, &&L_DIVOP, &&L_POWOP, &&L_CONCOP, &&L_MINUSOP, &&L_NOTOP,
+		&&L_ONTJMP, &&L_ONTJMPW, &&L_ONFJMP, &&L_ONFJMPW, &&L_JMP, &&L_JMPW, &&L_IFFJMP,
+		&&L_IFFJMPW, &&L_IFTUPJMP, &&L_IFTUPJMPW, &&L_IFFUPJMP, &&L_IFFUPJMPW, &&L_CLOSURE,
+		&&L_CLOSURE0, &&L_CLOSURE1, &&L_CALLFUNC, &&L_CALLFUNC0, &&L_CALLFUNC1, &&L_RETCODE,
+		&&L_SETLINE, &&L_SETLINEW, &&L_POP, &&L_POP0, &&L_POP1,
+	};
+#endif
+
+	uint32 executed = 0;
+
 	if (!task->some_flag) {
+		if (luaP_enabled)
+			luaP_enterlua(task);
 		luaD_checkstack((*task->pc++) + EXTRA_STACK);
 		if (*task->pc < ZEROVARARG) {
 			luaD_adjusttop(task->base + *(task->pc++));
@@ -255,181 +354,194 @@ StkId luaV_execute(lua_Task *task) {
 	lua_state->state_counter2++;
 
 	while (1) {
-		switch ((OpCode)(task->aux = *task->pc++)) {
-		case PUSHNIL0:
+		vmdispatch((OpCode)vmfetch()) {
+		vmcase(PUSHNIL0)
 			ttype(task->S->top++) = LUA_T_NIL;
-			break;
-		case PUSHNIL:
+			vmbreak;
+		vmcase(PUSHNIL)
 			task->aux = *task->pc++;
 			do {
 				ttype(task->S->top++) = LUA_T_NIL;
 			} while (task->aux--);
-			break;
-		case PUSHNUMBER:
+			vmbreak;
+		vmcase(PUSHNUMBER)
 			task->aux = *task->pc++;
 			goto pushnumber;
-		case PUSHNUMBERW:
+		vmcase(PUSHNUMBERW)
 			task->aux = next_word(task->pc);
 			goto pushnumber;
-		case PUSHNUMBER0:
-		case PUSHNUMBER1:
-		case PUSHNUMBER2:
+		vmcase(PUSHNUMBER0)
+		vmcase(PUSHNUMBER1)
+		vmcase(PUSHNUMBER2)
 			task->aux -= PUSHNUMBER0;
 pushnumber:
 			ttype(task->S->top) = LUA_T_NUMBER;
 			nvalue(task->S->top) = (float)task->aux;
 			task->S->top++;
-			break;
-		case PUSHLOCAL:
+			vmbreak;
+		vmcase(PUSHLOCAL)
 			task->aux = *task->pc++;
 			goto pushlocal;
-		case PUSHLOCAL0:
-		case PUSHLOCAL1:
-		case PUSHLOCAL2:
-		case PUSHLOCAL3:
-		case PUSHLOCAL4:
-		case PUSHLOCAL5:
-		case PUSHLOCAL6:
-		case PUSHLOCAL7:
+		vmcase(PUSHLOCAL0)
+		vmcase(PUSHLOCAL1)
+		vmcase(PUSHLOCAL2)
+		vmcase(PUSHLOCAL3)
+		vmcase(PUSHLOCAL4)
+		vmcase(PUSHLOCAL5)
+		vmcase(PUSHLOCAL6)
+		vmcase(PUSHLOCAL7)
 			task->aux -= PUSHLOCAL0;
 pushlocal:
 			*task->S->top++ = *((task->S->stack + task->base) + task->aux);
-			break;
-		case GETGLOBALW:
+			vmbreak;
+		vmcase(GETGLOBALW)
 			task->aux = next_word(task->pc);
 			goto getglobal;
-		case GETGLOBAL:
+		vmcase(GETGLOBAL)
 			task->aux = *task->pc++;
 			goto getglobal;
-		case GETGLOBAL0:
-		case GETGLOBAL1:
-		case GETGLOBAL2:
-		case GETGLOBAL3:
-		case GETGLOBAL4:
-		case GETGLOBAL5:
-		case GETGLOBAL6:
-		case GETGLOBAL7:
+		vmcase(GETGLOBAL0)
+		vmcase(GETGLOBAL1)
+		vmcase(GETGLOBAL2)
+		vmcase(GETGLOBAL3)
+		vmcase(GETGLOBAL4)
+		vmcase(GETGLOBAL5)
+		vmcase(GETGLOBAL6)
+		vmcase(GETGLOBAL7)
 			task->aux -= GETGLOBAL0;
 getglobal:
 			luaV_getglobal(tsvalue(&task->consts[task->aux]));
-			break;
-		case GETTABLE:
+			vmbreak;
+		vmcase(GETTABLE)
 			luaV_gettable();
-			break;
-		case GETDOTTEDW:
+			vmbreak;
+		vmcase(GETDOTTEDW)
 			task->aux = next_word(task->pc); goto getdotted;
-		case GETDOTTED:
+		vmcase(GETDOTTED)
 			task->aux = *task->pc++;
 			goto getdotted;
-		case GETDOTTED0:
-		case GETDOTTED1:
-		case GETDOTTED2:
-		case GETDOTTED3:
-		case GETDOTTED4:
-		case GETDOTTED5:
-		case GETDOTTED6:
-		case GETDOTTED7:
+		vmcase(GETDOTTED0)
+		vmcase(GETDOTTED1)
+		vmcase(GETDOTTED2)
+		vmcase(GETDOTTED3)
+		vmcase(GETDOTTED4)
+		vmcase(GETDOTTED5)
+		vmcase(GETDOTTED6)
+		vmcase(GETDOTTED7)
 			task->aux -= GETDOTTED0;
 getdotted:
-			*task->S->top++ = task->consts[task->aux];
-			luaV_gettable();
-			break;
-		case PUSHSELFW:
+			{
+				TObject *h = getcachedfield(task, task->S->top - 1);
+				if (h) {
+					*(task->S->top - 1) = *h;
+					vmbreak;
+				}
+				*task->S->top++ = task->consts[task->aux];
+				luaV_gettable();
+				vmbreak;
+			}
+		vmcase(PUSHSELFW)
 			task->aux = next_word(task->pc);
 			goto pushself;
-		case PUSHSELF:
+		vmcase(PUSHSELF)
 			task->aux = *task->pc++;
 			goto pushself;
-		case PUSHSELF0:
-		case PUSHSELF1:
-		case PUSHSELF2:
-		case PUSHSELF3:
-		case PUSHSELF4:
-		case PUSHSELF5:
-		case PUSHSELF6:
-		case PUSHSELF7:
+		vmcase(PUSHSELF0)
+		vmcase(PUSHSELF1)
+		vmcase(PUSHSELF2)
+		vmcase(PUSHSELF3)
+		vmcase(PUSHSELF4)
+		vmcase(PUSHSELF5)
+		vmcase(PUSHSELF6)
+		vmcase(PUSHSELF7)
 			task->aux -= PUSHSELF0;
 pushself:
 			{
 				TObject receiver = *(task->S->top - 1);
+				TObject *h = getcachedfield(task, task->S->top - 1);
+				if (h) {
+					*(task->S->top - 1) = *h;
+					*task->S->top++ = receiver;
+					vmbreak;
+				}
 				*task->S->top++ = task->consts[task->aux];
 				luaV_gettable();
 				*task->S->top++ = receiver;
-				break;
+				vmbreak;
 			}
-		case PUSHCONSTANTW:
+		vmcase(PUSHCONSTANTW)
 			task->aux = next_word(task->pc);
 			goto pushconstant;
-		case PUSHCONSTANT:
+		vmcase(PUSHCONSTANT)
 			task->aux = *task->pc++; goto pushconstant;
-		case PUSHCONSTANT0:
-		case PUSHCONSTANT1:
-		case PUSHCONSTANT2:
-		case PUSHCONSTANT3:
-		case PUSHCONSTANT4:
-		case PUSHCONSTANT5:
-		case PUSHCONSTANT6:
-		case PUSHCONSTANT7:
+		vmcase(PUSHCONSTANT0)
+		vmcase(PUSHCONSTANT1)
+		vmcase(PUSHCONSTANT2)
+		vmcase(PUSHCONSTANT3)
+		vmcase(PUSHCONSTANT4)
+		vmcase(PUSHCONSTANT5)
+		vmcase(PUSHCONSTANT6)
+		vmcase(PUSHCONSTANT7)
 			task->aux -= PUSHCONSTANT0;
 pushconstant:
 			*task->S->top++ = task->consts[task->aux];
-			break;
-		case PUSHUPVALUE:
+			vmbreak;
+		vmcase(PUSHUPVALUE)
 			task->aux = *task->pc++;
 			goto pushupvalue;
-		case PUSHUPVALUE0:
-		case PUSHUPVALUE1:
+		vmcase(PUSHUPVALUE0)
+		vmcase(PUSHUPVALUE1)
 			task->aux -= PUSHUPVALUE0;
 pushupvalue:
 			*task->S->top++ = task->cl->consts[task->aux + 1];
-			break;
-		case SETLOCAL:
+			vmbreak;
+		vmcase(SETLOCAL)
 			task->aux = *task->pc++;
 			goto setlocal;
-		case SETLOCAL0:
-		case SETLOCAL1:
-		case SETLOCAL2:
-		case SETLOCAL3:
-		case SETLOCAL4:
-		case SETLOCAL5:
-		case SETLOCAL6:
-		case SETLOCAL7:
+		vmcase(SETLOCAL0)
+		vmcase(SETLOCAL1)
+		vmcase(SETLOCAL2)
+		vmcase(SETLOCAL3)
+		vmcase(SETLOCAL4)
+		vmcase(SETLOCAL5)
+		vmcase(SETLOCAL6)
+		vmcase(SETLOCAL7)
 			task->aux -= SETLOCAL0;
 setlocal:
 			*((task->S->stack + task->base) + task->aux) = *(--task->S->top);
-			break;
-		case SETGLOBALW:
+			vmbreak;
+		vmcase(SETGLOBALW)
 			task->aux = next_word(task->pc);
 			goto setglobal;
-		case SETGLOBAL:
+		vmcase(SETGLOBAL)
 			task->aux = *task->pc++;
 			goto setglobal;
-		case SETGLOBAL0:
-		case SETGLOBAL1:
-		case SETGLOBAL2:
-		case SETGLOBAL3:
-		case SETGLOBAL4:
-		case SETGLOBAL5:
-		case SETGLOBAL6:
-		case SETGLOBAL7:
+		vmcase(SETGLOBAL0)
+		vmcase(SETGLOBAL1)
+		vmcase(SETGLOBAL2)
+		vmcase(SETGLOBAL3)
+		vmcase(SETGLOBAL4)
+		vmcase(SETGLOBAL5)
+		vmcase(SETGLOBAL6)
+		vmcase(SETGLOBAL7)
 			task->aux -= SETGLOBAL0;
 setglobal:
 			luaV_setglobal(tsvalue(&task->consts[task->aux]));
-			break;
-		case SETTABLE0:
+			vmbreak;
+		vmcase(SETTABLE0)
 			luaV_settable(task->S->top - 3, 1);
-			break;
-		case SETTABLE:
+			vmbreak;
+		vmcase(SETTABLE)
 			luaV_settable(task->S->top - 3 - (*task->pc++), 2);
-			break;
-		case SETLISTW:
+			vmbreak;
+		vmcase(SETLISTW)
 			task->aux = next_word(task->pc);
 			task->aux *= LFIELDS_PER_FLUSH;
 			goto setlist;
-		case SETLIST:
+		vmcase(SETLIST)
 			task->aux = *(task->pc++) * LFIELDS_PER_FLUSH;
 			goto setlist;
-		case SETLIST0:
+		vmcase(SETLIST0)
 			task->aux = 0;
 setlist:
 			{
@@ -441,12 +553,12 @@ setlist:
 					*(luaH_set(avalue(arr), task->S->top)) = *(task->S->top - 1);
 					task->S->top--;
 			}
-			break;
+			vmbreak;
 		}
-		case SETMAP0:
+		vmcase(SETMAP0)
 			task->aux = 0;
 			goto setmap;
-		case SETMAP:
+		vmcase(SETMAP)
 			task->aux = *task->pc++;
 setmap:
 			{
@@ -455,34 +567,34 @@ setmap:
 					*(luaH_set(avalue(arr), task->S->top - 2)) = *(task->S->top - 1);
 					task->S->top -= 2;
 				} while (task->aux--);
-				break;
+				vmbreak;
 			}
-		case POP:
+		vmcase(POP)
 			task->aux = *task->pc++;
 			goto pop;
-		case POP0:
-		case POP1:
+		vmcase(POP0)
+		vmcase(POP1)
 			task->aux -= POP0;
 pop:
 			task->S->top -= (task->aux + 1);
-			break;
-		case CREATEARRAYW:
+			vmbreak;
+		vmcase(CREATEARRAYW)
 			task->aux = next_word(task->pc);
 			goto createarray;
-		case CREATEARRAY0:
-		case CREATEARRAY1:
+		vmcase(CREATEARRAY0)
+		vmcase(CREATEARRAY1)
 			task->aux -= CREATEARRAY0;
 			goto createarray;
-		case CREATEARRAY:
+		vmcase(CREATEARRAY)
 			task->aux = *task->pc++;
 createarray:
 			luaC_checkGC();
 			avalue(task->S->top) = luaH_new(task->aux);
 			ttype(task->S->top) = LUA_T_ARRAY;
 			task->S->top++;
-			break;
-		case EQOP:
-		case NEQOP:
+			vmbreak;
+		vmcase(EQOP)
+		vmcase(NEQOP)
 			{
 				int32 res = luaO_equalObj(task->S->top - 2, task->S->top - 1);
 				task->S->top--;
@@ -490,21 +602,21 @@ createarray:
 					res = !res;
 				ttype(task->S->top - 1) = res ? LUA_T_NUMBER : LUA_T_NIL;
 				nvalue(task->S->top - 1) = 1;
-				break;
+				vmbreak;
 			}
-		case LTOP:
+		vmcase(LTOP)
 			comparison(LUA_T_NUMBER, LUA_T_NIL, LUA_T_NIL, IM_LT);
-			break;
-		case LEOP:
+			vmbreak;
+		vmcase(LEOP)
 			comparison(LUA_T_NUMBER, LUA_T_NUMBER, LUA_T_NIL, IM_LE);
-			break;
-		case GTOP:
+			vmbreak;
+		vmcase(GTOP)
 			comparison(LUA_T_NIL, LUA_T_NIL, LUA_T_NUMBER, IM_GT);
-			break;
-		case GEOP:
+			vmbreak;
+		vmcase(GEOP)
 			comparison(LUA_T_NIL, LUA_T_NUMBER, LUA_T_NUMBER, IM_GE);
-			break;
-		case ADDOP:
+			vmbreak;
+		vmcase(ADDOP)
 			{
 				TObject *l = task->S->top - 2;
 				TObject *r = task->S->top - 1;
@@ -514,9 +626,9 @@ createarray:
 					nvalue(l) += nvalue(r);
 					--task->S->top;
 				}
-			break;
+			vmbreak;
 			}
-		case SUBOP:
+		vmcase(SUBOP)
 			{
 				TObject *l = task->S->top - 2;
 				TObject *r = task->S->top - 1;
@@ -526,9 +638,9 @@ createarray:
 					nvalue(l) -= nvalue(r);
 					--task->S->top;
 				}
-				break;
+				vmbreak;
 			}
-		case MULTOP:
+		vmcase(MULTOP)
 			{
 				TObject *l = task->S->top - 2;
 				TObject *r = task->S->top - 1;
@@ -538,9 +650,9 @@ createarray:
 					nvalue(l) *= nvalue(r);
 					--task->S->top;
 				}
-				break;
+				vmbreak;
 			}
-		case DIVOP:
+		vmcase(DIVOP)
 			{
 				TObject *l = task->S->top - 2;
 				TObject *r = task->S->top - 1;
@@ -550,12 +662,12 @@ createarray:
 					nvalue(l) /= nvalue(r);
 					--task->S->top;
 				}
-				break;
+				vmbreak;
 			}
-		case POWOP:
+		vmcase(POWOP)
 			call_arith(IM_POW);
-			break;
-		case CONCOP:
+			vmbreak;
+		vmcase(CONCOP)
 			{
 				TObject *l = task->S->top - 2;
 				TObject *r = task->S->top - 1;
@@ -566,106 +678,110 @@ createarray:
 					--task->S->top;
 				}
 				luaC_checkGC();
-				break;
+				vmbreak;
 			}
-		case MINUSOP:
+		vmcase(MINUSOP)
 			if (tonumber(task->S->top - 1)) {
 				ttype(task->S->top) = LUA_T_NIL;
 				task->S->top++;
 				call_arith(IM_UNM);
 			} else
 				nvalue(task->S->top - 1) = -nvalue(task->S->top - 1);
-			break;
-		case NOTOP:
+			vmbreak;
+		vmcase(NOTOP)
 			ttype(task->S->top - 1) = (ttype(task->S->top - 1) == LUA_T_NIL) ? LUA_T_NUMBER : LUA_T_NIL;
 			nvalue(task->S->top - 1) = 1;
-			break;
-		case ONTJMPW:
+			vmbreak;
+		vmcase(ONTJMPW)
 			task->aux = next_word(task->pc);
 			goto ontjmp;
-		case ONTJMP:
+		vmcase(ONTJMP)
 			task->aux = *task->pc++;
 ontjmp:
 			if (ttype(task->S->top - 1) != LUA_T_NIL)
 				task->pc += task->aux;
 			else
 				task->S->top--;
-			break;
-		case ONFJMPW:
+			vmbreak;
+		vmcase(ONFJMPW)
 			task->aux = next_word(task->pc);
 			goto onfjmp;
-		case ONFJMP:
+		vmcase(ONFJMP)
 			task->aux = *task->pc++;
 onfjmp:
 			if (ttype(task->S->top - 1) == LUA_T_NIL)
 				task->pc += task->aux;
 			else
 				task->S->top--;
-			break;
-		case JMPW:
+			vmbreak;
+		vmcase(JMPW)
 			task->aux = next_word(task->pc);
 			goto jmp;
-		case JMP:
+		vmcase(JMP)
 			task->aux = *task->pc++;
 jmp:
 			task->pc += task->aux;
-			break;
-		case IFFJMPW:
+			vmbreak;
+		vmcase(IFFJMPW)
 			task->aux = next_word(task->pc);
 			goto iffjmp;
-		case IFFJMP:
+		vmcase(IFFJMP)
 			task->aux = *task->pc++;
 iffjmp:
 			if (ttype(--task->S->top) == LUA_T_NIL)
 				task->pc += task->aux;
-			break;
-		case IFTUPJMPW:
+			vmbreak;
+		vmcase(IFTUPJMPW)
 			task->aux = next_word(task->pc);
 			goto iftupjmp;
-		case IFTUPJMP:
+		vmcase(IFTUPJMP)
 			task->aux = *task->pc++;
 iftupjmp:
 			if (ttype(--task->S->top) != LUA_T_NIL)
 				task->pc -= task->aux;
-			break;
-		case IFFUPJMPW:
+			vmbreak;
+		vmcase(IFFUPJMPW)
 			task->aux = next_word(task->pc);
 			goto iffupjmp;
-		case IFFUPJMP:
+		vmcase(IFFUPJMP)
 			task->aux = *task->pc++;
 iffupjmp:
 			if (ttype(--task->S->top) == LUA_T_NIL)
 				task->pc -= task->aux;
-			break;
-		case CLOSURE:
+			vmbreak;
+		vmcase(CLOSURE)
 			task->aux = *task->pc++;
 			goto closure;
-		case CLOSURE0:
-		case CLOSURE1:
+		vmcase(CLOSURE0)
+		vmcase(CLOSURE1)
 			task->aux -= CLOSURE0;
 closure:
 			luaV_closure(task->aux);
 			luaC_checkGC();
-			break;
-	  case CALLFUNC:
+			vmbreak;
+	  vmcase(CALLFUNC)
 			task->aux = *task->pc++;
 			goto callfunc;
-	  case CALLFUNC0:
-	  case CALLFUNC1:
+	  vmcase(CALLFUNC0)
+	  vmcase(CALLFUNC1)
 			task->aux -= CALLFUNC0;
 callfunc:
 			lua_state->state_counter2--;
+			luaP_instructions += executed;
 			return -((task->S->top - task->S->stack) - (*task->pc++));
-		case ENDCODE:
+		vmcase(ENDCODE)
 			task->S->top = task->S->stack + task->base;
 			// goes through
-		case RETCODE:
+		vmcase(RETCODE)
 			lua_state->state_counter2--;
+			luaP_instructions += executed;
+			if (luaP_enabled)
+				luaP_leavelua(task);
 			return (task->base + ((task->aux == 123) ? *task->pc : 0));
-		case SETLINEW:
+		vmcase(SETLINEW)
 			task->aux = next_word(task->pc);
 			goto setline;
-		case SETLINE:
+		vmcase(SETLINE)
 			task->aux = *task->pc++;
 setline:
 			if ((task->S->stack + task->base - 1)->ttype != LUA_T_LINE) {
@@ -677,8 +793,8 @@ setline:
 			(task->S->stack + task->base - 1)->value.i = task->aux;
 			if (lua_linehook)
 				luaD_lineHook(task->aux);
-			break;
-#ifdef LUA_DEBUG
+			vmbreak;
+#ifndef LUA_THREADED_DISPATCH
 		default:
 			LUA_INTERNALERROR("internal error - opcode doesn't match");
 #endif
@@ -686,4 +802,8 @@ setline:
 	}
 }
 
+#ifdef LUA_THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
 } // end of namespace Grim
@@ -573,7 +573,11 @@ void Lua_V1::SubmitSaveGameData() {
 			g_grim->getGamePlatform() == Common::kPlatformPS2) {
 			if (count == 1) {
 				localized = g_localizer->localize(str);
+				savedState->setDescription(localized);
 			}
+		} else if (count == 1) {
+			// The description lets the saves be listed without reading this section
+			savedState->setDescription(str);
 		}
 		int32 len = strlen(str) + 1;
 		savedState->writeLESint32(len);
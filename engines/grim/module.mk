@@ -36,6 +36,8 @@ MODULE_OBJS := \
 	emi/emi.o \
 	emi/modelemi.o \
 	emi/skeleton.o \
+	emi/skinning.o \
+	emi/vertexlighting.o \
 	emi/poolsound.o \
 	emi/layer.o \
 	emi/lua_v2.o \
@@ -61,6 +63,7 @@ MODULE_OBJS := \
 	lua/lmathlib.o \
 	lua/lmem.o \
 	lua/lobject.o \
+	lua/lprofile.o \
 	lua/lrestore.o \
 	lua/lsave.o \
 	lua/lstate.o \
@@ -118,6 +121,7 @@ MODULE_OBJS := \
 	material.o \
 	model.o \
 	objectstate.o \
+	parsecache.o \
 	primitives.o \
 	patchr.o \
 	registry.o \
@@ -125,11 +129,13 @@ MODULE_OBJS := \
 	savegame.o \
 	set.o \
 	sector.o \
+	sectorindex.o \
 	sound.o \
 	sprite.o \
 	stuffit.o \
 	textobject.o \
 	textsplit.o \
+	walkgraph.o \
 	object.o \
 	debugger.o \
 	md5check.o \
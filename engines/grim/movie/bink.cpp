@@ -43,6 +43,7 @@ MoviePlayer *CreateBinkPlayer(bool demo) {
 
 BinkPlayer::BinkPlayer(bool demo) : MoviePlayer(), _demo(demo) {
 	_videoDecoder = new Video::BinkDecoder();
+	_videoDecoder->setDecodeAhead(3);
 	_subtitleIndex = _subtitles.begin();
 }
 
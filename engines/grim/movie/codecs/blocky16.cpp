@@ -21,6 +21,7 @@
  */
 
 #include "common/endian.h"
+#include "common/simd.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -160,43 +161,21 @@ void Blocky16::makeTablesInterpolation(int param) {
 	int32 variable1, variable2;
 	int32 b1, b2;
 	int32 value_table47_1_2, value_table47_1_1, value_table47_2_2, value_table47_2_1;
-	int32 tableSmallBig[64], tmp, s;
+	int32 tableSmallBig[64], tmp;
 	int8 *table47_1 = nullptr, *table47_2 = nullptr;
 	int32 *ptr_small_big;
-	byte *ptr;
 	int i, x, y;
 
 	if (param == 8) {
 		table47_1 = blocky16_table_big1;
 		table47_2 = blocky16_table_big2;
-		ptr = _tableBig + 384;
-		for (i = 0; i < 256; i++) {
-			*ptr = 0;
-			ptr += 388;
-		}
-		ptr = _tableBig + 385;
-		for (i = 0; i < 256; i++) {
-			*ptr = 0;
-			ptr += 388;
-		}
 	} else if (param == 4) {
 		table47_1 = blocky16_table_small1;
 		table47_2 = blocky16_table_small2;
-		ptr = _tableSmall + 96;
-		for (i = 0; i < 256; i++) {
-			*ptr = 0;
-			ptr += 128;
-		}
-		ptr = _tableSmall + 97;
-		for (i = 0; i < 256; i++) {
-			*ptr = 0;
-			ptr += 128;
-		}
 	} else {
 		error("Blocky16::makeTablesInterpolation: unknown param %d", param);
 	}
 
-	s = 0;
 	for (x = 0; x < 16; x++) {
 		value_table47_1_1 = table47_1[x];
 		value_table47_2_1 = table47_2[x];
@@ -286,30 +265,18 @@ void Blocky16::makeTablesInterpolation(int param) {
 				}
 			}
 
-			if (param == 8) {
-				for (i = 64 - 1; i >= 0; i--) {
-					if (tableSmallBig[i] != 0) {
-						_tableBig[256 + s + _tableBig[384 + s]] = (byte)i;
-						_tableBig[384 + s]++;
-					} else {
-						_tableBig[320 + s + _tableBig[385 + s]] = (byte)i;
-						_tableBig[385 + s]++;
-					}
-				}
-				s += 388;
-			}
-			if (param == 4) {
-				for (i = 16 - 1; i >= 0; i--) {
-					if (tableSmallBig[i] != 0) {
-						_tableSmall[64 + s + _tableSmall[96 + s]] = (byte)i;
-						_tableSmall[96 + s]++;
-					} else {
-						_tableSmall[80 + s + _tableSmall[97 + s]] = (byte)i;
-						_tableSmall[97 + s]++;
-					}
-				}
-				s += 128;
+			// The marked side of the line gets the first color of the pattern,
+			// the rest the second one
+			uint64 mask = 0;
+			for (i = 0; i < param * param; i++) {
+				if (tableSmallBig[i] != 0)
+					mask |= (uint64)1 << i;
 			}
+
+			if (param == 8)
+				_patternBig[x * 16 + y] = mask;
+			else
+				_patternSmall[x * 16 + y] = (uint16)mask;
 		}
 	}
 }
@@ -320,44 +287,210 @@ void Blocky16::makeTables47(int width) {
 
 	_lastTableWidth = width;
 
-	int32 a, c, d;
-	int16 tmp;
-
 	for (int l = 0; l < 512; l += 2) {
 		_table[l / 2] = (int16)(blocky16_table[l + 1] * width + blocky16_table[l]);
 	}
+}
 
-	a = 0;
-	c = 0;
-	do {
-		for (d = 0; d < _tableSmall[96 + c]; d++) {
-			tmp = _tableSmall[64 + c + d];
-			tmp = (int16)((byte)(tmp >> 2) * width + (tmp & 3));
-			_tableSmall[c + d * 2] = (byte)tmp;
-			_tableSmall[c + d * 2 + 1] = tmp >> 8;
-		}
-		for (d = 0; d < _tableSmall[97 + c]; d++) {
-			tmp = _tableSmall[80 + c + d];
-			tmp = (int16)((byte)(tmp >> 2) * width + (tmp & 3));
-			_tableSmall[32 + c + d * 2] = (byte)tmp;
-			_tableSmall[32 + c + d * 2 + 1] = tmp >> 8;
+/*
+ * Block kernels
+ *
+ * Pixels are 16-bit, so the rows of the 8x8 pixel blocks are 16 bytes and
+ * those of the 4x4 pixel blocks 8 bytes wide.
+ */
+
+static void copyBlock8x8C(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 8; i++, dst += pitch, src += pitch) {
+		COPY_4X1_LINE(dst +  0, src +  0);
+		COPY_4X1_LINE(dst +  4, src +  4);
+		COPY_4X1_LINE(dst +  8, src +  8);
+		COPY_4X1_LINE(dst + 12, src + 12);
+	}
+}
+
+static void fillBlock8x8C(byte *dst, uint32 t, int pitch) {
+	for (int i = 0; i < 8; i++, dst += pitch) {
+		WRITE_4X1_LINE(dst +  0, t);
+		WRITE_4X1_LINE(dst +  4, t);
+		WRITE_4X1_LINE(dst +  8, t);
+		WRITE_4X1_LINE(dst + 12, t);
+	}
+}
+
+static void copyBlock4x4C(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 4; i++, dst += pitch, src += pitch) {
+		COPY_4X1_LINE(dst + 0, src + 0);
+		COPY_4X1_LINE(dst + 4, src + 4);
+	}
+}
+
+static void fillBlock4x4C(byte *dst, uint32 t, int pitch) {
+	for (int i = 0; i < 4; i++, dst += pitch) {
+		WRITE_4X1_LINE(dst + 0, t);
+		WRITE_4X1_LINE(dst + 4, t);
+	}
+}
+
+static void fillPatternC(byte *dst, int pitch, int size, uint64 mask, uint16 color1, uint16 color2) {
+	for (int i = 0; i < size; i++, dst += pitch) {
+		for (int j = 0; j < size; j++, mask >>= 1) {
+			uint16 c = (mask & 1) ? color1 : color2;
+			WRITE_2X1_LINE(dst + j * 2, c);
 		}
-		for (d = 0; d < _tableBig[384 + a]; d++) {
-			tmp = _tableBig[256 + a + d];
-			tmp = (int16)((byte)(tmp >> 3) * width + (tmp & 7));
-			_tableBig[a + d * 2] = (byte)tmp;
-			_tableBig[a + d * 2 + 1] = tmp >> 8;
+	}
+}
+
+#if defined(SCUMMVM_SSE2)
+
+static void copyBlock8x8SIMD(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 8; i++, dst += pitch, src += pitch)
+		_mm_storeu_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+}
+
+static void fillBlock8x8SIMD(byte *dst, uint32 t, int pitch) {
+	const __m128i v = _mm_set1_epi32(t);
+	for (int i = 0; i < 8; i++, dst += pitch)
+		_mm_storeu_si128((__m128i *)dst, v);
+}
+
+static void copyBlock4x4SIMD(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 4; i++, dst += pitch, src += pitch)
+		_mm_storel_epi64((__m128i *)dst, _mm_loadl_epi64((const __m128i *)src));
+}
+
+static void fillBlock4x4SIMD(byte *dst, uint32 t, int pitch) {
+	const __m128i v = _mm_set1_epi32(t);
+	for (int i = 0; i < 4; i++, dst += pitch)
+		_mm_storel_epi64((__m128i *)dst, v);
+}
+
+/** Choose between the colors for 8 pixels, with the low 8 bits of the mask. */
+static inline __m128i selectPixelsSSE2(uint32 mask, __m128i color1, __m128i color2) {
+	const __m128i bits = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+	const __m128i m = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(mask & 0xff), bits), bits);
+	return _mm_or_si128(_mm_and_si128(m, color1), _mm_andnot_si128(m, color2));
+}
+
+static void fillPatternSIMD(byte *dst, int pitch, int size, uint64 mask, uint16 color1, uint16 color2) {
+	const __m128i c1 = _mm_set1_epi16(color1);
+	const __m128i c2 = _mm_set1_epi16(color2);
+
+	if (size == 8) {
+		for (int i = 0; i < 8; i++, dst += pitch, mask >>= 8)
+			_mm_storeu_si128((__m128i *)dst, selectPixelsSSE2((uint32)mask, c1, c2));
+	} else {
+		// Two rows of 4 pixels at a time
+		for (int i = 0; i < 4; i += 2, dst += pitch * 2, mask >>= 8) {
+			const __m128i rows = selectPixelsSSE2((uint32)mask, c1, c2);
+			_mm_storel_epi64((__m128i *)dst, rows);
+			_mm_storel_epi64((__m128i *)(dst + pitch), _mm_srli_si128(rows, 8));
 		}
-		for (d = 0; d < _tableBig[385 + a]; d++) {
-			tmp = _tableBig[320 + a + d];
-			tmp = (int16)((byte)(tmp >> 3) * width + (tmp & 7));
-			_tableBig[128 + a + d * 2] = (byte)tmp;
-			_tableBig[128 + a + d * 2 + 1] = tmp >> 8;
+	}
+}
+
+#elif defined(SCUMMVM_NEON)
+
+static void copyBlock8x8SIMD(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 8; i++, dst += pitch, src += pitch)
+		vst1q_u8(dst, vld1q_u8(src));
+}
+
+static void fillBlock8x8SIMD(byte *dst, uint32 t, int pitch) {
+	const uint8x16_t v = vreinterpretq_u8_u32(vdupq_n_u32(t));
+	for (int i = 0; i < 8; i++, dst += pitch)
+		vst1q_u8(dst, v);
+}
+
+static void copyBlock4x4SIMD(byte *dst, const byte *src, int pitch) {
+	for (int i = 0; i < 4; i++, dst += pitch, src += pitch)
+		vst1_u8(dst, vld1_u8(src));
+}
+
+static void fillBlock4x4SIMD(byte *dst, uint32 t, int pitch) {
+	const uint8x8_t v = vreinterpret_u8_u32(vdup_n_u32(t));
+	for (int i = 0; i < 4; i++, dst += pitch)
+		vst1_u8(dst, v);
+}
+
+/** Choose between the colors for 8 pixels, with the low 8 bits of the mask. */
+static inline uint8x16_t selectPixelsNEON(uint32 mask, uint16x8_t color1, uint16x8_t color2) {
+	static const uint16 bitValues[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+	const uint16x8_t m = vtstq_u16(vdupq_n_u16(mask & 0xff), vld1q_u16(bitValues));
+	return vreinterpretq_u8_u16(vbslq_u16(m, color1, color2));
+}
+
+static void fillPatternSIMD(byte *dst, int pitch, int size, uint64 mask, uint16 color1, uint16 color2) {
+	const uint16x8_t c1 = vdupq_n_u16(color1);
+	const uint16x8_t c2 = vdupq_n_u16(color2);
+
+	if (size == 8) {
+		for (int i = 0; i < 8; i++, dst += pitch, mask >>= 8)
+			vst1q_u8(dst, selectPixelsNEON((uint32)mask, c1, c2));
+	} else {
+		// Two rows of 4 pixels at a time
+		for (int i = 0; i < 4; i += 2, dst += pitch * 2, mask >>= 8) {
+			const uint8x16_t rows = selectPixelsNEON((uint32)mask, c1, c2);
+			vst1_u8(dst, vget_low_u8(rows));
+			vst1_u8(dst + pitch, vget_high_u8(rows));
 		}
+	}
+}
+
+#endif
+
+static inline void copyBlock8x8(byte *dst, const byte *src, int pitch) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		copyBlock8x8SIMD(dst, src, pitch);
+		return;
+	}
+#endif
+
+	copyBlock8x8C(dst, src, pitch);
+}
+
+static inline void fillBlock8x8(byte *dst, uint32 t, int pitch) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		fillBlock8x8SIMD(dst, t, pitch);
+		return;
+	}
+#endif
+
+	fillBlock8x8C(dst, t, pitch);
+}
+
+static inline void copyBlock4x4(byte *dst, const byte *src, int pitch) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		copyBlock4x4SIMD(dst, src, pitch);
+		return;
+	}
+#endif
+
+	copyBlock4x4C(dst, src, pitch);
+}
+
+static inline void fillBlock4x4(byte *dst, uint32 t, int pitch) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		fillBlock4x4SIMD(dst, t, pitch);
+		return;
+	}
+#endif
+
+	fillBlock4x4C(dst, t, pitch);
+}
+
+static inline void fillPattern(byte *dst, int pitch, int size, uint64 mask, uint32 colors) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		fillPatternSIMD(dst, pitch, size, mask, colors & 0xffff, colors >> 16);
+		return;
+	}
+#endif
 
-		a += 388;
-		c += 128;
-	} while (c < 32768);
+	fillPatternC(dst, pitch, size, mask, colors & 0xffff, colors >> 16);
 }
 
 void Blocky16::level3(byte *d_dst) {
@@ -431,7 +564,6 @@ void Blocky16::level2(byte *d_dst) {
 	int32 tmp2;
 	uint32 t = 0, val;
 	byte code = *_d_src++;
-	int i;
 
 	if (code <= 0xF5) {
 		if (code == 0xF5) {
@@ -442,11 +574,7 @@ void Blocky16::level2(byte *d_dst) {
 			tmp2 = _table[code] * 2;
 		}
 		tmp2 += _offset1;
-		for (i = 0; i < 4; i++) {
-			COPY_4X1_LINE(d_dst +  0, d_dst + tmp2 +  0);
-			COPY_4X1_LINE(d_dst +  4, d_dst + tmp2 +  4);
-			d_dst += _d_pitch;
-		}
+		copyBlock4x4(d_dst, d_dst + tmp2, _d_pitch);
 	} else if (code == 0xFF) {
 		level3(d_dst);
 		d_dst += 4;
@@ -457,11 +585,7 @@ void Blocky16::level2(byte *d_dst) {
 		level3(d_dst);
 	} else if (code == 0xF6) {
 		tmp2 = _offset2;
-		for (i = 0; i < 4; i++) {
-			COPY_4X1_LINE(d_dst +  0, d_dst + tmp2 +  0);
-			COPY_4X1_LINE(d_dst +  4, d_dst + tmp2 +  4);
-			d_dst += _d_pitch;
-		}
+		copyBlock4x4(d_dst, d_dst + tmp2, _d_pitch);
 	} else if ((code == 0xF7) || (code == 0xF8)) {
 		byte tmp = *_d_src++;
 		if (code == 0xF8) {
@@ -473,20 +597,7 @@ void Blocky16::level2(byte *d_dst) {
 			val |= READ_LE_UINT16(_param6_7Ptr + (byte)tmp2 * 2);
 			_d_src += 2;
 		}
-		byte *tmp_ptr = _tableSmall + (tmp * 128);
-		byte l = tmp_ptr[96];
-		int16 *tmp_ptr2 = (int16 *)tmp_ptr;
-		while (l--) {
-			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
-			tmp_ptr2++;
-		}
-		l = tmp_ptr[97];
-		val >>= 16;
-		tmp_ptr2 = (int16 *)(tmp_ptr + 32);
-		while (l--) {
-			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
-			tmp_ptr2++;
-		}
+		fillPattern(d_dst, _d_pitch, 4, _patternSmall[tmp], val);
 	} else if (code >= 0xF9) {
 		if (code == 0xFD) {
 			t = *_d_src++;
@@ -500,11 +611,7 @@ void Blocky16::level2(byte *d_dst) {
 			t = READ_LE_UINT16(_paramPtr + code * 2);
 			t = (t << 16) | t;
 		}
-		for (i = 0; i < 4; i++) {
-			WRITE_4X1_LINE(d_dst + 0, t);
-			WRITE_4X1_LINE(d_dst + 4, t);
-			d_dst += _d_pitch;
-		}
+		fillBlock4x4(d_dst, t, _d_pitch);
 	}
 }
 
@@ -512,7 +619,6 @@ void Blocky16::level1(byte *d_dst) {
 	int32 tmp2;
 	uint32 t = 0, val;
 	byte code = *_d_src++;
-	int i;
 
 	if (code <= 0xF5) {
 		if (code == 0xF5) {
@@ -523,13 +629,7 @@ void Blocky16::level1(byte *d_dst) {
 			tmp2 = _table[code] * 2;
 		}
 		tmp2 += _offset1;
-		for (i = 0; i < 8; i++) {
-			COPY_4X1_LINE(d_dst +  0, d_dst + tmp2 +  0);
-			COPY_4X1_LINE(d_dst +  4, d_dst + tmp2 +  4);
-			COPY_4X1_LINE(d_dst +  8, d_dst + tmp2 +  8);
-			COPY_4X1_LINE(d_dst + 12, d_dst + tmp2 + 12);
-			d_dst += _d_pitch;
-		}
+		copyBlock8x8(d_dst, d_dst + tmp2, _d_pitch);
 	} else if (code == 0xFF) {
 		level2(d_dst);
 		d_dst += 8;
@@ -540,13 +640,7 @@ void Blocky16::level1(byte *d_dst) {
 		level2(d_dst);
 	} else if (code == 0xF6) {
 		tmp2 = _offset2;
-		for (i = 0; i < 8; i++) {
-			COPY_4X1_LINE(d_dst +  0, d_dst + tmp2 +  0);
-			COPY_4X1_LINE(d_dst +  4, d_dst + tmp2 +  4);
-			COPY_4X1_LINE(d_dst +  8, d_dst + tmp2 +  8);
-			COPY_4X1_LINE(d_dst + 12, d_dst + tmp2 + 12);
-			d_dst += _d_pitch;
-		}
+		copyBlock8x8(d_dst, d_dst + tmp2, _d_pitch);
 	} else if ((code == 0xF7) || (code == 0xF8)) {
 		byte tmp = *_d_src++;
 		if (code == 0xF8) {
@@ -558,20 +652,7 @@ void Blocky16::level1(byte *d_dst) {
 			val |= READ_LE_UINT16(_param6_7Ptr + (byte)tmp2 * 2);
 			_d_src += 2;
 		}
-		byte *tmp_ptr = _tableBig + (tmp * 388);
-		byte l = tmp_ptr[384];
-		int16 *tmp_ptr2 = (int16 *)tmp_ptr;
-		while (l--) {
-			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
-			tmp_ptr2++;
-		}
-		l = tmp_ptr[385];
-		val >>= 16;
-		tmp_ptr2 = (int16 *)(tmp_ptr + 128);
-		while (l--) {
-			WRITE_2X1_LINE(d_dst + READ_LE_UINT16(tmp_ptr2) * 2, val);
-			tmp_ptr2++;
-		}
+		fillPattern(d_dst, _d_pitch, 8, _patternBig[tmp], val);
 	} else if (code >= 0xF9) {
 		if (code == 0xFD) {
 			t = *_d_src++;
@@ -585,13 +666,7 @@ void Blocky16::level1(byte *d_dst) {
 			t = READ_LE_UINT16(_paramPtr + code * 2);
 			t = (t << 16) | t;
 		}
-		for (i = 0; i < 8; i++) {
-			WRITE_4X1_LINE(d_dst +  0, t);
-			WRITE_4X1_LINE(d_dst +  4, t);
-			WRITE_4X1_LINE(d_dst +  8, t);
-			WRITE_4X1_LINE(d_dst + 12, t);
-			d_dst += _d_pitch;
-		}
+		fillBlock8x8(d_dst, t, _d_pitch);
 	}
 }
 
@@ -642,10 +717,8 @@ void Blocky16::init(int width, int height) {
 }
 
 Blocky16::Blocky16() {
-	_tableBig = new byte[99328];
-	_tableSmall = new byte[32768];
-	memset(_tableBig, 0, 99328);
-	memset(_tableSmall, 0, 32768);
+	memset(_patternBig, 0, sizeof(_patternBig));
+	memset(_patternSmall, 0, sizeof(_patternSmall));
 	_deltaBuf = nullptr;
 	_deltaBufs[0] = nullptr;
 	_deltaBufs[1] = nullptr;
@@ -674,74 +747,72 @@ void Blocky16::deinit() {
 
 Blocky16::~Blocky16() {
 	deinit();
-	if (_tableBig) {
-		delete[] _tableBig;
-		_tableBig = nullptr;
-	}
-	if (_tableSmall) {
-		delete[] _tableSmall;
-		_tableSmall = nullptr;
-	}
 }
 
-static int bomp_left;
-static int bomp_num;
-static int bomp_color;
-static const byte *bomp_src;
+// The state is kept per call, so that several movies can be decoded at once
+struct BompState {
+	int left;
+	int num;
+	int color;
+	const byte *src;
+};
 
-static byte bompDecode() {
+static byte bompDecode(BompState &bomp) {
 	byte code, result;
 	const byte *src;
 
-	if (bomp_left == 2) {
-		src = bomp_src;
-		bomp_num = (*src >> 1) + 1;
+	if (bomp.left == 2) {
+		src = bomp.src;
+		bomp.num = (*src >> 1) + 1;
 		code = *(src++) & 1;
-		bomp_src = src;
+		bomp.src = src;
 		if (code != 0) {
-			bomp_left = 1;
-			bomp_color = *src++;
-			bomp_src = src;
+			bomp.left = 1;
+			bomp.color = *src++;
+			bomp.src = src;
 		} else {
-			bomp_left = 0;
+			bomp.left = 0;
 		}
 	} else {
-		src = bomp_src;
+		src = bomp.src;
 	}
-	if (bomp_left != 0) {
-		if (bomp_left - 1 == 0) {
-			result = bomp_color;
+	if (bomp.left != 0) {
+		if (bomp.left - 1 == 0) {
+			result = bomp.color;
 		} else {
 			result = 255;
 		}
 	} else {
 		result = *(src++);
-		bomp_src = src;
+		bomp.src = src;
 	}
 
-	bomp_num--;
-	if (bomp_num == 0) {
-		bomp_left = 2;
+	bomp.num--;
+	if (bomp.num == 0) {
+		bomp.left = 2;
 	}
 
 	return result;
 }
 
-static void bompInit(const byte *src) {
-	bomp_left = 2;
-	bomp_src = src;
+static void bompInit(BompState &bomp, const byte *src) {
+	bomp.left = 2;
+	bomp.num = 0;
+	bomp.color = 0;
+	bomp.src = src;
 }
 
 static void bompDecodeMain(byte *dst, const byte *src, int size) {
+	BompState bomp;
 	size /= 2;
-	bompInit(src);
+	bompInit(bomp, src);
 	while (size--) {
 #ifdef SCUMM_BIG_ENDIAN
-		*(dst + 1) = bompDecode();
-		*(dst + 0) = bompDecode();
+		*(dst + 1) = bompDecode(bomp);
+		*(dst + 0) = bompDecode(bomp);
 #else
-		*(dst + 0) = bompDecode();
-		*(dst + 1) = bompDecode();
+		*(dst + 0) = bompDecode(bomp);
+		*(dst + 1) = bompDecode(bomp);
 #endif
 		dst += 2;
 	}
@@ -817,18 +888,22 @@ void Blocky16::decode(byte *dst, const byte *src) {
 		break;
 	case 8:
 		{
-			bompInit(gfx_data);
+			BompState bomp;
+			bompInit(bomp, gfx_data);
 			int count = _frameSize / 2;
 			uint16 *ptr = (uint16 *)_curBuf;
 			while (count--) {
-				int offset = bompDecode() * 2;
+				int offset = bompDecode(bomp) * 2;
 				*(uint16 *)ptr++ = READ_LE_UINT16(src + 40 + offset);
 			};
 			break;
 		}
 	}
 
-	memcpy(dst, _curBuf, _frameSize);
+	// Without a destination the frame only updates the reference buffers, for seeking
+	if (dst) {
+		memcpy(dst, _curBuf, _frameSize);
+	}
 
 	if (seq_nb == _prevSeqNb + 1) {
 		byte *tmp_ptr = nullptr;
@@ -38,8 +38,10 @@ private:
 	const byte *_d_src, *_paramPtr, *_param6_7Ptr;
 	int _d_pitch;
 	int32 _offset1, _offset2;
-	byte *_tableBig;
-	byte *_tableSmall;
+	// Which pixels of an 8x8 respectively 4x4 block a two color pattern
+	// fills with its first color, one bit per pixel in row order
+	uint64 _patternBig[256];
+	uint16 _patternSmall[256];
 	int16 _table[256];
 	int32 _frameSize;
 	int _offset;
@@ -55,7 +55,6 @@ SmushDecoder::SmushDecoder() {
 
 	_videoLooping = false;
 	_startPos = 0;
-	_frames = nullptr;
 
 	_videoTrack = nullptr;
 	_audioTrack = nullptr;
@@ -65,7 +64,6 @@ SmushDecoder::SmushDecoder() {
 SmushDecoder::~SmushDecoder() {
 	delete _videoTrack;
 	delete _audioTrack;
-	delete[] _frames;
 }
 
 void SmushDecoder::init() {
@@ -73,48 +71,61 @@ void SmushDecoder::init() {
 	_audioTrack->init();
 }
 
-void SmushDecoder::initFrames() {
-	delete[] _frames;
-	_frames = new Frame[_videoTrack->getFrameCount()];
+void SmushDecoder::indexFrames(int lastFrame) {
+	lastFrame = MIN(lastFrame, _videoTrack->getFrameCount() - 1);
 
+	int curFrame = _keyframeIndex.getFrameCount();
+	if (curFrame > lastFrame) {
+		return;
+	}
+
+	// Go on after the frames which were already played or indexed
 	int seekPos = _file->pos();
-	int curFrame = -1;
-	_file->seek(_startPos, SEEK_SET);
-	while (curFrame < _videoTrack->getFrameCount() - 1) {
-		Frame &frame = _frames[++curFrame];
-		frame.frame = curFrame;
-		frame.pos = _file->pos();
-		frame.keyframe = false;
-
-		uint32 tag = _file->readUint32BE();
-		uint32 size;
-		if (tag == MKTAG('A', 'N', 'N', 'O')) {
-			size = _file->readUint32BE();
-			_file->seek(size, SEEK_CUR);
-			tag = _file->readUint32BE();
-		}
-		assert(tag == MKTAG('F', 'R', 'M', 'E'));
-		size = _file->readUint32BE();
+	if (curFrame == 0) {
+		_file->seek(_startPos, SEEK_SET);
+	} else {
+		_file->seek(_keyframeIndex.getPosition(curFrame - 1), SEEK_SET);
+		scanFrame();
+	}
 
-		while (size > 0) {
-			uint32 subType = _file->readUint32BE();
-			uint32 subSize = _file->readUint32BE();
+	for (; curFrame <= lastFrame; curFrame++) {
+		uint32 pos = _file->pos();
+		_keyframeIndex.addFrame(curFrame, pos, scanFrame());
+	}
 
-			if (subType == MKTAG('B', 'l', '1', '6')) {
-				_file->seek(18, SEEK_CUR);
-				if (_file->readByte() == 0) {
-					frame.keyframe = true;
-				}
-				_file->seek(subSize - 19, SEEK_CUR);
-			} else
-				_file->seek(subSize, SEEK_CUR);
-			size -= subSize + 8 + (subSize & 1);
-		}
+	_file->seek(seekPos, SEEK_SET);
+}
 
+bool SmushDecoder::scanFrame() {
+	bool keyframe = false;
+
+	uint32 tag = _file->readUint32BE();
+	uint32 size;
+	if (tag == MKTAG('A', 'N', 'N', 'O')) {
+		size = _file->readUint32BE();
 		_file->seek(size, SEEK_CUR);
+		tag = _file->readUint32BE();
 	}
+	assert(tag == MKTAG('F', 'R', 'M', 'E'));
+	size = _file->readUint32BE();
 
-	_file->seek(seekPos, SEEK_SET);
+	while (size > 0) {
+		uint32 subType = _file->readUint32BE();
+		uint32 subSize = _file->readUint32BE();
+
+		if (subType == MKTAG('B', 'l', '1', '6')) {
+			_file->seek(18, SEEK_CUR);
+			if (_file->readByte() == 0) {
+				keyframe = true;
+			}
+			_file->seek(subSize - 19, SEEK_CUR);
+		} else
+			_file->seek(subSize, SEEK_CUR);
+		size -= subSize + 8 + (subSize & 1);
+	}
+
+	_file->seek(size, SEEK_CUR);
+	return keyframe;
 }
 
 void SmushDecoder::close() {
@@ -123,8 +134,6 @@ void SmushDecoder::close() {
 	_videoTrack = nullptr;
 	_videoLooping = false;
 	_startPos = 0;
-	delete[] _frames;
-	_frames = nullptr;
 	if (_file) {
 		delete _file;
 		_file = nullptr;
@@ -267,15 +276,23 @@ bool SmushDecoder::loadStream(Common::SeekableReadStream *stream) {
 }
 
 const Graphics::Surface *SmushDecoder::decodeNextFrame() {
-	handleFrame();
-
 	// We might be interested in getting the last frame even after the video ends:
-	if (endOfVideo()) {
+	if (endOfVideoTracks()) {
+		_audioTrack->stop(); // HACK: Avoids the movie playing past the last frame
 		return _videoTrack->decodeNextFrame();
 	}
 	return VideoDecoder::decodeNextFrame();
 }
 
+void SmushDecoder::readNextPacket() {
+	// Frames decoded ahead of time are simply shown later, when resumed
+	if (isPaused() && !isDecodingAhead() && !isSkippingFrames()) {
+		return;
+	}
+
+	handleFrame();
+}
+
 void SmushDecoder::setLooping(bool l) {
 	_videoLooping = l;
 
@@ -288,16 +305,13 @@ void SmushDecoder::handleFrame() {
 	uint32 tag;
 	int32 size;
 
-	if (isPaused()) {
-		return;
-	}
-
 	if (_videoTrack->endOfTrack()) { // Looping is handled outside, by rewinding the video.
-		_audioTrack->stop(); // HACK: Avoids the movie playing past the last frame
-		//  pauseVideo(true);
 		return;
 	}
 
+	int frame = _videoTrack->getCurFrame() + 1;
+	uint32 framePos = _file->pos();
+
 	tag = _file->readUint32BE();
 	size = _file->readUint32BE();
 	if (tag == MKTAG('A', 'N', 'N', 'O')) {
@@ -331,13 +345,17 @@ void SmushDecoder::handleFrame() {
 	}
 
 	assert(tag == MKTAG('F', 'R', 'M', 'E'));
-	handleFRME(_file, size);
+	bool keyframe = handleFRME(_file, size);
+
+	// Seeking can start from the frames played so far without looking for them
+	_keyframeIndex.addFrame(frame, framePos, keyframe);
 
 	_videoTrack->finishFrame();
 }
 
-void SmushDecoder::handleFRME(Common::SeekableReadStream *stream, uint32 size) {
+bool SmushDecoder::handleFRME(Common::SeekableReadStream *stream, uint32 size) {
 	int blockSize = size;
+	bool keyframe = false;
 
 	byte *block = new byte[size];
 	stream->read(block, size);
@@ -351,6 +369,10 @@ void SmushDecoder::handleFRME(Common::SeekableReadStream *stream, uint32 size) {
 		switch (subType) {
 			// Retail only:
 		case MKTAG('B', 'l', '1', '6'):
+			// Uncompressed frames don't depend on the previous ones
+			if (subSize > 18 && block[subPos + 18] == 0) {
+				keyframe = true;
+			}
 			_videoTrack->handleBlocky16(memStream, subSize);
 			break;
 		case MKTAG('W', 'a', 'v', 'e'):
@@ -374,6 +396,7 @@ void SmushDecoder::handleFRME(Common::SeekableReadStream *stream, uint32 size) {
 	}
 	delete memStream;
 	delete[] block;
+	return keyframe;
 }
 
 bool SmushDecoder::rewind() {
@@ -391,18 +414,11 @@ bool SmushDecoder::seekIntern(const Audio::Timestamp &time) {
 		return false;
 	}
 
-	if (!_frames) {
-		initFrames();
-	}
+	// Only the frames which were not played yet need to be looked at
+	indexFrames(wantedFrame);
 
 	// Track down the keyframe
-	int keyframe = 0;
-	for (int i = wantedFrame; i >= 0; --i) {
-		if (_frames[i].keyframe) {
-			keyframe = i;
-			break;
-		}
-	}
+	int keyframe = _keyframeIndex.findKeyframe(wantedFrame);
 	_videoTrack->setFrameStart(keyframe);
 
 	// VIMA frames are 50 frames ahead of time, so we have to make sure we have 50 frames
@@ -414,12 +430,11 @@ bool SmushDecoder::seekIntern(const Audio::Timestamp &time) {
 		keyframe = 0;
 	}
 
-	_file->seek(_frames[keyframe].pos, SEEK_SET);
+	_file->seek(_keyframeIndex.getPosition(keyframe), SEEK_SET);
 	_videoTrack->setCurFrame(keyframe - 1);
 
-	while (_videoTrack->getCurFrame() < wantedFrame - 1) {
-		decodeNextFrame();
-	}
+	// The audio is needed, but the frames don't have to be shown
+	skipFrames(_videoTrack, wantedFrame);
 
 	// As said, VIMA is 50 frames ahead of time. Every frame it pushes 1470 samples, and 50 * 1470 = 73500.
 	// The first frame, instead of 1470, it pushes 73500 samples to have this 50-frames-time.
@@ -473,6 +488,7 @@ SmushDecoder::SmushVideoTrack::SmushVideoTrack(int width, int height, int fps, i
 		_deltaPal[i] = 0;
 	}
 	_frameStart = 0;
+	_skipOutput = false;
 }
 
 SmushDecoder::SmushVideoTrack::~SmushVideoTrack() {
@@ -523,7 +539,7 @@ void SmushDecoder::SmushVideoTrack::handleBlocky16(Common::SeekableReadStream *s
 	byte *ptr = new byte[size];
 	stream->read(ptr, size);
 
-	_blocky16->decode((byte *)_surface.getPixels(), ptr);
+	_blocky16->decode(_skipOutput ? nullptr : (byte *)_surface.getPixels(), ptr);
 	delete[] ptr;
 }
 
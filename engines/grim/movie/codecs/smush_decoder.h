@@ -58,10 +58,11 @@ protected:
 	void handleFrameDemo();
 	void handleFrame();
 	bool handleFramesHeader();
-	void handleFRME(Common::SeekableReadStream *stream, uint32 size);
+	bool handleFRME(Common::SeekableReadStream *stream, uint32 size);
 	void init();
 	void close() override;
 	const Graphics::Surface *decodeNextFrame() override;
+	void readNextPacket() override;
 	class SmushVideoTrack : public FixedRateVideoTrack {
 	public:
 		SmushVideoTrack(int width, int height, int fps, int numFrames, bool is16Bit);
@@ -79,6 +80,7 @@ protected:
 		void finishFrame();
 		bool isSeekable() const override { return true; }
 		bool seek(const Audio::Timestamp &time) override { return true; }
+		bool setSkipOutput(bool skip) override { _skipOutput = skip; return true; }
 		void setFrameStart(int frame);
 
 		void handleBlocky16(Common::SeekableReadStream *stream, uint32 size);
@@ -104,6 +106,7 @@ protected:
 		Codec48Decoder *_codec48;
 		int32 _nbframes;
 		int _frameStart;
+		bool _skipOutput;
 	};
 
 	class SmushAudioTrack : public AudioTrack {
@@ -129,7 +132,8 @@ protected:
 		Audio::QueuingAudioStream *_queueStream;
 	};
 private:
-	void initFrames();
+	void indexFrames(int lastFrame);
+	bool scanFrame();
 
 	SmushAudioTrack *_audioTrack;
 	SmushVideoTrack *_videoTrack;
@@ -140,12 +144,6 @@ private:
 
 	bool _videoPause;
 	bool _videoLooping;
-	struct Frame {
-		int frame;
-		int pos;
-		bool keyframe;
-	};
-	Frame *_frames;
 	static bool _demo;
 };
 
@@ -102,6 +102,11 @@ bool MoviePlayer::prepareFrame() {
 	if (_videoDecoder->getTimeToNextFrame() > 0)
 		return false;
 
+	// Don't wait for a frame the worker thread is still decoding while
+	// holding the frame mutex, pick it up on the next tick instead.
+	if (!_videoDecoder->isNextFrameReady())
+		return false;
+
 	handleFrame();
 	_internalSurface = _videoDecoder->decodeNextFrame();
 	if (_frame != _videoDecoder->getCurFrame()) {
@@ -36,6 +36,11 @@ SmushPlayer::SmushPlayer(bool demo) : MoviePlayer(), _demo(demo) {
 	_smushDecoder = new SmushDecoder();
 	_videoDecoder = _smushDecoder;
 	//_smushDecoder->setDemo(_demo);
+
+	// Decode the frames and the VIMA audio on a worker thread. Demo frames
+	// move the movie on screen as they are decoded, so they stay in step.
+	if (!_demo)
+		_smushDecoder->setDecodeAhead(3);
 }
 
 bool SmushPlayer::loadFile(const Common::String &filename) {
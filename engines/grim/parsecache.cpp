@@ -0,0 +1,225 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/endian.h"
+#include "common/stream.h"
+#include "common/textconsole.h"
+
+#include "engines/grim/parsecache.h"
+
+namespace Grim {
+
+ParseCache *g_parseCache = nullptr;
+
+// Bump the version when the format of the blobs recorded by TextSplitter
+// changes, older cache files are then ignored.
+static const uint32 kCacheTag = MKTAG('G', 'P', 'C', 'H');
+static const uint32 kCacheVersion = 1;
+
+// Recorded blobs are preceded by their reference count, one for the entry
+// and one for each splitter replaying them
+static const uint32 kBlobHeader = 8;
+
+ParseCache::ParseCache() : _fileData(nullptr), _fileSize(0), _dirty(false), _hits(0), _misses(0) {
+}
+
+ParseCache::~ParseCache() {
+	clear();
+}
+
+void ParseCache::clear() {
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i)
+		unrefBlob(i->_value.data);
+	_entries.clear();
+	free(_fileData);
+	_fileData = nullptr;
+	_fileSize = 0;
+}
+
+void ParseCache::unrefBlob(const byte *data) {
+	if (isInFile(data))
+		return;
+
+	uint32 *refCount = (uint32 *)(const_cast<byte *>(data) - kBlobHeader);
+	if (--*refCount == 0)
+		free(refCount);
+}
+
+bool ParseCache::load(Common::SeekableReadStream *data) {
+	Common::StackLock lock(_mutex);
+
+	clear();
+	_dirty = false;
+
+	uint32 size = data->size();
+	if (size < 12)
+		return false;
+
+	_fileData = (byte *)malloc(size);
+	_fileSize = size;
+	if (data->read(_fileData, size) != size || READ_BE_UINT32(_fileData) != kCacheTag ||
+	    READ_LE_UINT32(_fileData + 4) != kCacheVersion) {
+		clear();
+		return false;
+	}
+
+	const uint32 count = READ_LE_UINT32(_fileData + 8);
+	const byte *pos = _fileData + 12;
+	const byte *end = _fileData + size;
+	uint32 i = 0;
+	for (; i < count; i++) {
+		if (end - pos < 2)
+			break;
+		const uint32 nameLength = READ_LE_UINT16(pos);
+		pos += 2;
+		if ((uint32)(end - pos) < nameLength + 12)
+			break;
+		Common::String fname((const char *)pos, nameLength);
+		pos += nameLength;
+
+		Entry entry;
+		entry.contentHash = READ_LE_UINT32(pos);
+		entry.contentSize = READ_LE_UINT32(pos + 4);
+		entry.length = READ_LE_UINT32(pos + 8);
+		pos += 12;
+		if ((uint32)(end - pos) < entry.length)
+			break;
+		entry.data = pos;
+		pos += entry.length;
+
+		_entries[fname] = entry;
+	}
+
+	// A file cut between two entries still has to have all of them
+	if (i != count || pos != end) {
+		warning("ParseCache::load(): The parse cache is truncated, ignoring it");
+		clear();
+		return false;
+	}
+
+	return true;
+}
+
+void ParseCache::save(Common::WriteStream *data) {
+	Common::StackLock lock(_mutex);
+
+	data->writeUint32BE(kCacheTag);
+	data->writeUint32LE(kCacheVersion);
+	data->writeUint32LE(_entries.size());
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		const Entry &entry = i->_value;
+		data->writeUint16LE(i->_key.size());
+		data->write(i->_key.c_str(), i->_key.size());
+		data->writeUint32LE(entry.contentHash);
+		data->writeUint32LE(entry.contentSize);
+		data->writeUint32LE(entry.length);
+		data->write(entry.data, entry.length);
+	}
+
+	_dirty = false;
+}
+
+const byte *ParseCache::find(const Common::String &fname, uint32 contentHash, uint32 contentSize, uint32 &length) {
+	Common::StackLock lock(_mutex);
+
+	EntryMap::const_iterator i = _entries.find(fname);
+	if (i == _entries.end() || i->_value.contentHash != contentHash || i->_value.contentSize != contentSize) {
+		_misses++;
+		return nullptr;
+	}
+
+	_hits++;
+	length = i->_value.length;
+	if (!isInFile(i->_value.data))
+		(*(uint32 *)(const_cast<byte *>(i->_value.data) - kBlobHeader))++;
+	return i->_value.data;
+}
+
+void ParseCache::release(const byte *data) {
+	Common::StackLock lock(_mutex);
+
+	unrefBlob(data);
+}
+
+void ParseCache::store(const Common::String &fname, uint32 contentHash, uint32 contentSize, const byte *data, uint32 length) {
+	if (fname.size() > 0xffff)
+		return;
+
+	Common::StackLock lock(_mutex);
+
+	byte *blob = (byte *)malloc(kBlobHeader + length);
+	*(uint32 *)blob = 1;
+	blob += kBlobHeader;
+	memcpy(blob, data, length);
+
+	EntryMap::iterator i = _entries.find(fname);
+	if (i != _entries.end())
+		unrefBlob(i->_value.data);
+
+	Entry &entry = _entries[fname];
+	entry.contentHash = contentHash;
+	entry.contentSize = contentSize;
+	entry.data = blob;
+	entry.length = length;
+	_dirty = true;
+}
+
+void ParseCache::remove(const Common::String &fname) {
+	Common::StackLock lock(_mutex);
+
+	EntryMap::iterator i = _entries.find(fname);
+	if (i != _entries.end()) {
+		unrefBlob(i->_value.data);
+		_entries.erase(i);
+		_dirty = true;
+	}
+}
+
+void ParseCache::getStats(Stats &stats) {
+	Common::StackLock lock(_mutex);
+
+	stats.entries = _entries.size();
+	stats.size = 0;
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i)
+		stats.size += i->_value.length;
+	stats.hits = _hits;
+	stats.misses = _misses;
+}
+
+uint32 ParseCache::hashContent(const char *data, uint32 length) {
+	// 64 bit FNV-1a, on words rather than bytes. The high bits are folded
+	// back in every step, the multiplication only carries bits upwards.
+	uint64 hash = 14695981039346656037ULL;
+	uint32 i = 0;
+	for (; i + 8 <= length; i += 8) {
+		hash ^= READ_LE_UINT64(data + i);
+		hash *= 1099511628211ULL;
+		hash ^= hash >> 32;
+	}
+	for (; i < length; i++) {
+		hash ^= (byte)data[i];
+		hash *= 1099511628211ULL;
+	}
+	return (uint32)(hash ^ (hash >> 32));
+}
+
+} // end of namespace Grim
@@ -0,0 +1,105 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRIM_PARSECACHE_H
+#define GRIM_PARSECACHE_H
+
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/mutex.h"
+
+namespace Common {
+class SeekableReadStream;
+class WriteStream;
+}
+
+namespace Grim {
+
+/**
+ * The values parsed out of text-format resources, so they don't need to be
+ * parsed again the next time the same file is loaded.
+ *
+ * Entries are opaque blobs recorded by TextSplitter, keyed by file name and
+ * checked against the size and hash of the file content. The cache can be
+ * saved and loaded again, loaded entries point into the loaded data.
+ */
+class ParseCache {
+public:
+	struct Stats {
+		uint32 entries;
+		uint32 size;
+		uint32 hits;
+		uint32 misses;
+	};
+
+	ParseCache();
+	~ParseCache();
+
+	/** Replace the entries with the ones written by save(). */
+	bool load(Common::SeekableReadStream *data);
+	void save(Common::WriteStream *data);
+	bool isDirty() const { return _dirty; }
+
+	/**
+	 * Find the blob recorded for a file with the given content. The blob
+	 * stays valid until it is given back with release(), even if the entry
+	 * gets replaced or removed meanwhile.
+	 */
+	const byte *find(const Common::String &fname, uint32 contentHash, uint32 contentSize, uint32 &length);
+	void release(const byte *data);
+	void store(const Common::String &fname, uint32 contentHash, uint32 contentSize, const byte *data, uint32 length);
+	void remove(const Common::String &fname);
+
+	void getStats(Stats &stats);
+
+	static uint32 hashContent(const char *data, uint32 length);
+
+private:
+	struct Entry {
+		uint32 contentHash;
+		uint32 contentSize;
+		const byte *data;
+		uint32 length;
+	};
+
+	typedef Common::HashMap<Common::String, Entry, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> EntryMap;
+
+	void clear();
+	bool isInFile(const byte *data) const { return data >= _fileData && data < _fileData + _fileSize; }
+	void unrefBlob(const byte *data);
+
+	EntryMap _entries;
+	// The loaded cache file, which the loaded entries point into. Blobs
+	// recorded since are counted, and freed once neither an entry nor a
+	// splitter refers to them anymore.
+	byte *_fileData;
+	uint32 _fileSize;
+	bool _dirty;
+	uint32 _hits, _misses;
+	Common::Mutex _mutex;
+};
+
+extern ParseCache *g_parseCache;
+
+} // end of namespace Grim
+
+#endif
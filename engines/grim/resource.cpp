@@ -71,9 +71,27 @@ public:
 	}
 };
 
+/**
+ * A stream on a cached file, which keeps the data alive until it is deleted.
+ */
+class CachedResourceStream : public Common::MemoryReadStream {
+public:
+	CachedResourceStream(ResourceLoader::CacheEntry *entry) :
+		Common::MemoryReadStream(entry->data, entry->len), _entry(entry) {}
+	~CachedResourceStream() { ResourceLoader::releaseCacheEntry(_entry); }
+
+private:
+	ResourceLoader::CacheEntry *_entry;
+};
+
 ResourceLoader::ResourceLoader() {
-	_cacheDirty = false;
 	_cacheMemorySize = 0;
+	_cachePinnedSize = 0;
+	_cacheHits = 0;
+	_cacheMisses = 0;
+	_cacheEvictions = 0;
+	// In megabytes, kept well inside what the byte counts can hold
+	_cacheBudget = CLIP(ConfMan.getInt("resource_cache_size"), 0, 2048) * 1024 * 1024;
 
 	Lab *l;
 	Common::ArchiveMemberList files, updFiles;
@@ -221,10 +239,19 @@ void clearList(Common::List<T> &list) {
 }
 
 ResourceLoader::~ResourceLoader() {
-	for (Common::Array<ResourceCache>::iterator i = _cache.begin(); i != _cache.end(); ++i) {
-		ResourceCache &r = *i;
-		delete[] r.fname;
-		delete[] r.resPtr;
+	// The streams still reading from the cache are left with their files,
+	// which they free when they are deleted. By now, the sound code which
+	// releases them on the mixer thread is gone too.
+	Common::StackLock lock(_cacheMutex);
+	_cachePinned.insert(_cachePinned.end(), _cacheLRU.begin(), _cacheLRU.end());
+	for (Common::List<CacheEntry *>::iterator i = _cachePinned.begin(); i != _cachePinned.end(); ++i) {
+		CacheEntry *entry = *i;
+		if (entry->refCount > 0) {
+			entry->loader = nullptr;
+		} else {
+			free(entry->data);
+			delete entry;
+		}
 	}
 	clearList(_models);
 	clearList(_colormaps);
@@ -233,32 +260,23 @@ ResourceLoader::~ResourceLoader() {
 	MD5Check::clear();
 }
 
-static int sortCallback(const void *entry1, const void *entry2) {
-	return scumm_stricmp(((const ResourceLoader::ResourceCache *)entry1)->fname, ((const ResourceLoader::ResourceCache *)entry2)->fname);
-}
-
 Common::SeekableReadStream *ResourceLoader::getFileFromCache(const Common::String &filename) const {
-	ResourceLoader::ResourceCache *entry = getEntryFromCache(filename);
-	if (!entry)
-		return nullptr;
-
-	return new Common::MemoryReadStream(entry->resPtr, entry->len);
+	Common::StackLock lock(_cacheMutex);
 
-}
-
-ResourceLoader::ResourceCache *ResourceLoader::getEntryFromCache(const Common::String &filename) const {
-	if (_cache.empty())
+	CacheMap::iterator i = _cache.find(filename);
+	if (i == _cache.end()) {
+		_cacheMisses++;
 		return nullptr;
-
-	if (_cacheDirty) {
-		qsort(_cache.begin(), _cache.size(), sizeof(ResourceCache), sortCallback);
-		_cacheDirty = false;
 	}
 
-	ResourceCache key;
-	key.fname = const_cast<char *>(filename.c_str());
+	CacheEntry *entry = i->_value;
+	_cacheLRU.erase(entry->lruPos);
+	_cacheLRU.push_front(entry);
+	entry->lruPos = _cacheLRU.begin();
+	entry->refCount++;
+	_cacheHits++;
 
-	return (ResourceLoader::ResourceCache *)bsearch(&key, _cache.begin(), _cache.size(), sizeof(ResourceCache), sortCallback);
+	return new CachedResourceStream(entry);
 }
 
 Common::SeekableReadStream *ResourceLoader::loadFile(const Common::String &filename) const {
@@ -284,11 +302,10 @@ Common::SeekableReadStream *ResourceLoader::openNewStreamFile(Common::String fna
 				return nullptr;
 
 			uint32 size = s->size();
-			byte *buf = new byte[size];
+			byte *buf = (byte *)malloc(size);
 			s->read(buf, size);
-			putIntoCache(fname, buf, size);
 			delete s;
-			s = new Common::MemoryReadStream(buf, size);
+			s = putIntoCache(fname, buf, size);
 		}
 	} else {
 		s = loadFile(fname);
@@ -297,15 +314,102 @@ Common::SeekableReadStream *ResourceLoader::openNewStreamFile(Common::String fna
 	return Common::wrapCompressedReadStream(s);
 }
 
-void ResourceLoader::putIntoCache(const Common::String &fname, byte *res, uint32 len) const {
-	ResourceCache entry;
-	entry.resPtr = res;
-	entry.len = len;
-	entry.fname = new char[fname.size() + 1];
-	strcpy(entry.fname, fname.c_str());
+Common::SeekableReadStream *ResourceLoader::putIntoCache(const Common::String &fname, byte *res, uint32 len) const {
+	// Files which would not fit are read without caching
+	if (len > _cacheBudget)
+		return new Common::MemoryReadStream(res, len, DisposeAfterUse::YES);
+
+	Common::StackLock lock(_cacheMutex);
+
+	// Another stream may still be reading an older copy, it keeps its own
+	CacheMap::iterator i = _cache.find(fname);
+	if (i != _cache.end())
+		evictCacheEntry(i->_value);
+
+	CacheEntry *entry = new CacheEntry();
+	entry->loader = this;
+	entry->fname = fname;
+	entry->data = res;
+	entry->len = len;
+	entry->refCount = 1;
+	entry->evicted = false;
+	_cacheLRU.push_front(entry);
+	entry->lruPos = _cacheLRU.begin();
+	_cache[fname] = entry;
 	_cacheMemorySize += len;
-	_cache.push_back(entry);
-	_cacheDirty = true;
+
+	trimCache();
+
+	return new CachedResourceStream(entry);
+}
+
+void ResourceLoader::releaseCacheEntry(CacheEntry *entry) {
+	const ResourceLoader *loader = entry->loader;
+	if (!loader) {
+		if (--entry->refCount == 0) {
+			free(entry->data);
+			delete entry;
+		}
+		return;
+	}
+
+	Common::StackLock lock(loader->_cacheMutex);
+
+	if (--entry->refCount == 0 && entry->evicted) {
+		loader->_cachePinned.erase(entry->lruPos);
+		loader->_cachePinnedSize -= entry->len;
+		free(entry->data);
+		delete entry;
+	}
+}
+
+void ResourceLoader::evictCacheEntry(CacheEntry *entry) const {
+	_cache.erase(entry->fname);
+	_cacheLRU.erase(entry->lruPos);
+	_cacheMemorySize -= entry->len;
+
+	if (entry->refCount > 0) {
+		entry->evicted = true;
+		_cachePinned.push_front(entry);
+		entry->lruPos = _cachePinned.begin();
+		_cachePinnedSize += entry->len;
+	} else {
+		free(entry->data);
+		delete entry;
+	}
+}
+
+void ResourceLoader::trimCache() const {
+	// Files still being read would not free anything, so they are kept
+	Common::List<CacheEntry *>::iterator i = _cacheLRU.reverse_begin();
+	while (_cacheMemorySize > _cacheBudget && i != _cacheLRU.end()) {
+		CacheEntry *entry = *i;
+		--i;
+
+		if (entry->refCount == 0) {
+			evictCacheEntry(entry);
+			_cacheEvictions++;
+		}
+	}
+}
+
+void ResourceLoader::setCacheBudget(uint32 bytes) {
+	Common::StackLock lock(_cacheMutex);
+
+	_cacheBudget = bytes;
+	trimCache();
+}
+
+void ResourceLoader::getCacheStats(CacheStats &stats) const {
+	Common::StackLock lock(_cacheMutex);
+
+	stats.hits = _cacheHits;
+	stats.misses = _cacheMisses;
+	stats.evictions = _cacheEvictions;
+	stats.entries = _cache.size();
+	stats.residentSize = _cacheMemorySize;
+	stats.pinnedSize = _cachePinnedSize;
+	stats.budget = _cacheBudget;
 }
 
 CMap *ResourceLoader::loadColormap(const Common::String &filename) {
@@ -516,23 +620,11 @@ AnimationEmi *ResourceLoader::loadAnimationEmi(const Common::String &filename) {
 }
 
 void ResourceLoader::uncache(const char *filename) const {
-	Common::String fname = filename;
-	fname.toLowercase();
-
-	if (_cacheDirty) {
-		qsort(_cache.begin(), _cache.size(), sizeof(ResourceCache), sortCallback);
-		_cacheDirty = false;
-	}
+	Common::StackLock lock(_cacheMutex);
 
-	for (unsigned int i = 0; i < _cache.size(); i++) {
-		if (fname.compareTo(_cache[i].fname) == 0) {
-			delete[] _cache[i].fname;
-			_cacheMemorySize -= _cache[i].len;
-			delete[] _cache[i].resPtr;
-			_cache.remove_at(i);
-			_cacheDirty = true;
-		}
-	}
+	CacheMap::iterator i = _cache.find(filename);
+	if (i != _cache.end())
+		evictCacheEntry(i->_value);
 }
 
 void ResourceLoader::uncacheModel(Model *m) {
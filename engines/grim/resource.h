@@ -25,6 +25,10 @@
 
 #include "common/archive.h"
 #include "common/array.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/mutex.h"
 
 #include "engines/grim/object.h"
 
@@ -84,24 +88,64 @@ public:
 	void uncacheLipSync(LipSync *l);
 	void uncacheAnimationEmi(AnimationEmi *a);
 
-	struct ResourceCache {
-		char *fname;
-		byte *resPtr;
-		uint32 len;
+	struct CacheStats {
+		uint32 hits;
+		uint32 misses;
+		uint32 evictions;
+		uint32 entries;
+		uint32 residentSize;   // Bytes kept in the cache
+		uint32 pinnedSize;     // Bytes evicted but still read by streams
+		uint32 budget;
 	};
 
+	/**
+	 * Set how many bytes of raw files the cache may keep. Least recently
+	 * used files are evicted when it is exceeded.
+	 */
+	void setCacheBudget(uint32 bytes);
+	void getCacheStats(CacheStats &stats) const;
+
 	static Common::String fixFilename(const Common::String &filename, bool append = true);
 
 private:
+	friend class CachedResourceStream;
+
+	/**
+	 * A cached raw file. Streams on it hold a reference, so that evicting
+	 * the file leaves the data to be freed by the last one of them. The
+	 * same goes for the streams which outlive the loader.
+	 */
+	struct CacheEntry {
+		const ResourceLoader *loader;   // nullptr once the loader is deleted
+		Common::String fname;
+		byte *data;
+		uint32 len;
+		int refCount;
+		bool evicted;
+		// In the LRU list, or in the pinned one once evicted
+		Common::List<CacheEntry *>::iterator lruPos;
+	};
+
+	typedef Common::HashMap<Common::String, CacheEntry *, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> CacheMap;
+
 	Common::SeekableReadStream *loadFile(const Common::String &filename) const;
 	Common::SeekableReadStream *getFileFromCache(const Common::String &filename) const;
-	ResourceLoader::ResourceCache *getEntryFromCache(const Common::String &filename) const;
-	void putIntoCache(const Common::String &fname, byte *res, uint32 len) const;
+	Common::SeekableReadStream *putIntoCache(const Common::String &fname, byte *res, uint32 len) const;
+	static void releaseCacheEntry(CacheEntry *entry);
+	void evictCacheEntry(CacheEntry *entry) const;
+	void trimCache() const;
 	void uncache(const char *fname) const;
 
-	mutable Common::Array<ResourceCache> _cache;
-	mutable bool _cacheDirty;
-	mutable int32 _cacheMemorySize;
+	mutable CacheMap _cache;
+	mutable Common::List<CacheEntry *> _cacheLRU;   // Most recently used first
+	mutable Common::List<CacheEntry *> _cachePinned; // Evicted, still read by streams
+	mutable Common::Mutex _cacheMutex;              // Streams are released from the mixer thread too
+	mutable uint32 _cacheMemorySize;
+	mutable uint32 _cachePinnedSize;
+	uint32 _cacheBudget;
+	mutable uint32 _cacheHits;
+	mutable uint32 _cacheMisses;
+	mutable uint32 _cacheEvictions;
 
 	Common::List<EMIModel *> _emiModels;
 	Common::List<Model *> _models;
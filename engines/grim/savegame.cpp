@@ -22,7 +22,9 @@
 
 #include "common/endian.h"
 #include "common/savefile.h"
+#include "common/substream.h"
 #include "common/system.h"
+#include "common/zlib.h"
 
 #include "math/vector3d.h"
 
@@ -33,11 +35,51 @@ namespace Grim {
 
 #define SAVEGAME_HEADERTAG  'RSAV'
 #define SAVEGAME_FOOTERTAG  'ESAV'
+#define SAVEGAME_THUMBNAILTAG 'SIMG'
 
 uint SaveGame::SAVEGAME_MAJOR_VERSION = 22;
-uint SaveGame::SAVEGAME_MINOR_VERSION = 26;
+uint SaveGame::SAVEGAME_MINOR_VERSION = 27;
+uint SaveGame::SAVEGAME_INDEXED_VERSION = 27;
+
+SaveGame *SaveGame::_backgroundWrite = nullptr;
+
+/**
+ * Collects the compressed data of a section in a buffer which grows
+ * geometrically. The buffer belongs to the caller, since the compressing
+ * stream deletes this one when it is done.
+ */
+class SectionWriteStream : public Common::WriteStream {
+public:
+	SectionWriteStream(byte *&data, uint32 &size) : _data(data), _size(size), _alloc(0) {
+		_data = nullptr;
+		_size = 0;
+	}
+
+	uint32 write(const void *dataPtr, uint32 dataSize) override {
+		if (_size + dataSize > _alloc) {
+			uint32 alloc = MAX<uint32>(_alloc, 4096);
+			while (_size + dataSize > alloc)
+				alloc *= 2;
+			byte *data = (byte *)realloc(_data, alloc);
+			if (!data)
+				return 0;
+			_data = data;
+			_alloc = alloc;
+		}
+		memcpy(_data + _size, dataPtr, dataSize);
+		_size += dataSize;
+		return dataSize;
+	}
+
+private:
+	byte *&_data;
+	uint32 &_size;
+	uint32 _alloc;
+};
 
 SaveGame *SaveGame::openForLoading(const Common::String &filename) {
+	waitBackgroundWrite();
+
 	Common::InSaveFile *inSaveFile = g_system->getSavefileManager()->openForLoading(filename);
 	if (!inSaveFile) {
 		warning("SaveGame::openForLoading() Error opening savegame file %s", filename.c_str());
@@ -57,11 +99,20 @@ SaveGame *SaveGame::openForLoading(const Common::String &filename) {
 	save->_majorVersion = inSaveFile->readUint32BE();
 	save->_minorVersion = inSaveFile->readUint32BE();
 
+	if (save->isCompatible() && save->hasMetadata() && !save->readMetadata()) {
+		warning("SaveGame::openForLoading() Savegame file %s is corrupted", filename.c_str());
+		delete save;
+		return nullptr;
+	}
+
 	return save;
 }
 
 SaveGame *SaveGame::openForSaving(const Common::String &filename) {
-	Common::OutSaveFile *outSaveFile =  g_system->getSavefileManager()->openForSaving(filename);
+	// The sections are compressed one by one, so that loading doesn't have to
+	// decompress the file up to the one it needs
+	waitBackgroundWrite();
+	Common::OutSaveFile *outSaveFile =  g_system->getSavefileManager()->openForSaving(filename, false);
 	if (!outSaveFile) {
 		warning("SaveGame::openForSaving() Error creating savegame file %s", filename.c_str());
 		return nullptr;
@@ -72,33 +123,51 @@ SaveGame *SaveGame::openForSaving(const Common::String &filename) {
 	save->_saving = true;
 	save->_outSaveFile = outSaveFile;
 
-	outSaveFile->writeUint32BE(SAVEGAME_HEADERTAG);
-	outSaveFile->writeUint32BE(SAVEGAME_MAJOR_VERSION);
-	outSaveFile->writeUint32BE(SAVEGAME_MINOR_VERSION);
-
 	save->_majorVersion = SAVEGAME_MAJOR_VERSION;
 	save->_minorVersion = SAVEGAME_MINOR_VERSION;
 
+	TimeDate t;
+	g_system->getTimeAndDate(t);
+	save->_saveYear = t.tm_year + 1900;
+	save->_saveMonth = t.tm_mon + 1;
+	save->_saveDay = t.tm_mday;
+	save->_saveHour = t.tm_hour;
+	save->_saveMinute = t.tm_min;
+
 	return save;
 }
 
 SaveGame::SaveGame() :
 		_currentSection(0), _sectionBuffer(nullptr), _majorVersion(0),
 		_minorVersion(0), _saving(false), _inSaveFile(nullptr), _outSaveFile(nullptr),
-		_sectionSize(0), _sectionAlloc(0), _sectionPtr(0) {
-
+		_sectionSize(0), _sectionAlloc(0), _sectionPtr(0), _saveYear(0), _saveMonth(0),
+		_saveDay(0), _saveHour(0), _saveMinute(0), _directoryRead(false),
+		_directoryBroken(false), _directoryOffset(0), _nextSection(0), _writeState(kWriteNone), _writeJob(0),
+		_writtenCallback(nullptr), _writtenParam(nullptr), _written(false), _writeFailed(false) {
+	_thumbnail.tag = SAVEGAME_THUMBNAILTAG;
+	_thumbnail.offset = 0;
+	_thumbnail.size = 0;
+	_thumbnail.storedSize = 0;
 }
 
 SaveGame::~SaveGame() {
 	if (_saving) {
-		_outSaveFile->writeUint32BE(SAVEGAME_FOOTERTAG);
-		_outSaveFile->finalize();
-		if (_outSaveFile->err())
+		if (_writeState == kWriteNone) {
+			writeFile();
+			_outSaveFile->finalize();
+		}
+		waitWritten();
+		// Unless the callback of the background write got them
+		if (_writeState != kWriteReported && _outSaveFile->err())
 			warning("SaveGame::~SaveGame() Can't write file. (Disk full?)");
 		delete _outSaveFile;
 	} else {
 		delete _inSaveFile;
 	}
+	for (uint i = 0; i < _sections.size(); ++i) {
+		free(_sections[i].data);
+		free(_sections[i].storedData);
+	}
 	free(_sectionBuffer);
 }
 
@@ -114,6 +183,282 @@ uint SaveGame::saveMinorVersion() const {
 	return _minorVersion;
 }
 
+bool SaveGame::hasMetadata() const {
+	return _majorVersion == SAVEGAME_MAJOR_VERSION && _minorVersion >= SAVEGAME_INDEXED_VERSION;
+}
+
+const Common::String &SaveGame::getDescription() const {
+	return _description;
+}
+
+void SaveGame::setDescription(const Common::String &description) {
+	_description = description;
+}
+
+void SaveGame::getSaveDate(int &year, int &month, int &day) const {
+	year = _saveYear;
+	month = _saveMonth;
+	day = _saveDay;
+}
+
+void SaveGame::getSaveTime(int &hour, int &minute) const {
+	hour = _saveHour;
+	minute = _saveMinute;
+}
+
+/*
+ * Savegames since SAVEGAME_INDEXED_VERSION are laid out as follows, the
+ * numbers being big endian:
+ *
+ *   'RSAV', major version, minor version
+ *   metadata size, then the metadata:
+ *     year (16 bits), month, day, hour and minute (8 bits each)
+ *     offset and size of the thumbnail, 0 if there is none
+ *     length of the description, then the description
+ *   number of sections, then for each of them:
+ *     tag, offset in the file, size, stored size
+ *   the data of the sections
+ *   'ESAV'
+ *
+ * A section is compressed unless its stored size is equal to its size.
+ * The thumbnail comes first and is stored as is.
+ */
+bool SaveGame::readMetadata() {
+	uint32 size = _inSaveFile->readUint32BE();
+	_directoryOffset = _inSaveFile->pos() + size;
+
+	_saveYear = _inSaveFile->readUint16BE();
+	_saveMonth = _inSaveFile->readByte();
+	_saveDay = _inSaveFile->readByte();
+	_saveHour = _inSaveFile->readByte();
+	_saveMinute = _inSaveFile->readByte();
+	_thumbnail.offset = _inSaveFile->readUint32BE();
+	_thumbnail.size = _inSaveFile->readUint32BE();
+	_thumbnail.storedSize = _thumbnail.size;
+
+	uint32 length = _inSaveFile->readUint32BE();
+	if (_inSaveFile->err() || _inSaveFile->eos() || length > size)
+		return false;
+	char *description = new char[length];
+	_inSaveFile->read(description, length);
+	_description = Common::String(description, length);
+	delete[] description;
+
+	return !_inSaveFile->err() && !_inSaveFile->eos();
+}
+
+const SaveGame::SectionEntry *SaveGame::findSection(uint32 sectionTag) {
+	if (!_directoryRead) {
+		if (sectionTag == SAVEGAME_THUMBNAILTAG && _thumbnail.offset != 0)
+			return &_thumbnail;
+
+		_directoryRead = true;
+		_inSaveFile->seek(_directoryOffset);
+		const uint32 fileSize = _inSaveFile->size();
+		uint32 count = _inSaveFile->readUint32BE();
+		if (_inSaveFile->err() || _inSaveFile->eos() || count > fileSize / 16) {
+			_directoryBroken = true;
+			return nullptr;
+		}
+		_directory.resize(count);
+		for (uint32 i = 0; i < count; ++i) {
+			SectionEntry &entry = _directory[i];
+			entry.tag = _inSaveFile->readUint32BE();
+			entry.offset = _inSaveFile->readUint32BE();
+			entry.size = _inSaveFile->readUint32BE();
+			entry.storedSize = _inSaveFile->readUint32BE();
+			if (entry.offset > fileSize || entry.storedSize > fileSize - entry.offset)
+				_directoryBroken = true;
+		}
+		if (_inSaveFile->err() || _inSaveFile->eos())
+			_directoryBroken = true;
+
+		// The callers decide whether a broken savegame is an error
+		if (_directoryBroken) {
+			_directory.clear();
+			return nullptr;
+		}
+	}
+
+	// Like in the older savegames, a section is looked for after the one
+	// read last, but the directory can be searched from the start too
+	for (uint i = 0; i < _directory.size(); ++i) {
+		uint index = (_nextSection + i) % _directory.size();
+		if (_directory[index].tag == sectionTag) {
+			_nextSection = index + 1;
+			return &_directory[index];
+		}
+	}
+	return nullptr;
+}
+
+void SaveGame::readSection(const SectionEntry &entry) {
+	reserveSection(entry.size);
+	_sectionSize = entry.size;
+
+	if (entry.storedSize == entry.size) {
+		_inSaveFile->seek(entry.offset);
+		if (_inSaveFile->read(_sectionBuffer, _sectionSize) != _sectionSize)
+			error("Unable to read section of savegame");
+		return;
+	}
+
+	Common::SeekableReadStream *stream = Common::wrapCompressedReadStream(
+		new Common::SeekableSubReadStream(_inSaveFile, entry.offset, entry.offset + entry.storedSize), entry.size);
+	if (!stream)
+		error("Savegame section is compressed, but zlib isn't available");
+	uint32 read = stream->read(_sectionBuffer, _sectionSize);
+	delete stream;
+	if (read != _sectionSize)
+		error("Unable to decompress section of savegame");
+}
+
+void SaveGame::reserveSection(uint32 size) {
+	if (!_sectionBuffer || _sectionAlloc < size) {
+		_sectionAlloc = size;
+		byte *buff = (byte *)realloc(_sectionBuffer, _sectionAlloc);
+		if (buff == nullptr) {
+			free(_sectionBuffer);
+			error("Could not allocate memory for save game");
+		}
+		_sectionBuffer = buff;
+	}
+}
+
+void SaveGame::compressSection(SectionData &section) {
+	byte *data;
+	uint32 size;
+	Common::WriteStream *stream = Common::wrapCompressedWriteStream(new SectionWriteStream(data, size));
+	stream->write(section.data, section.size);
+	stream->finalize();
+	bool failed = stream->err();
+	delete stream;
+
+	// Sections which don't get smaller are stored as is, which is also what
+	// tells them apart when loading. Without zlib, none of them does.
+	if (!failed && size < section.size) {
+		free(section.data);
+		section.data = nullptr;
+		section.storedData = data;
+		section.storedSize = size;
+	} else {
+		free(data);
+	}
+}
+
+void SaveGame::writeFile() {
+	// The thumbnail goes first, so that reading it seeks as little as possible
+	for (uint i = 1; i < _sections.size(); ++i) {
+		if (_sections[i].tag == SAVEGAME_THUMBNAILTAG) {
+			SectionData thumbnail = _sections[i];
+			_sections.remove_at(i);
+			_sections.insert_at(0, thumbnail);
+			break;
+		}
+	}
+	for (uint i = 0; i < _sections.size(); ++i) {
+		if (_sections[i].tag != SAVEGAME_THUMBNAILTAG)
+			compressSection(_sections[i]);
+	}
+
+	const uint32 metadataSize = 2 + 4 + 8 + 4 + _description.size();
+	uint32 offset = 12 + 4 + metadataSize + 4 + 16 * _sections.size();
+	const bool hasThumbnail = !_sections.empty() && _sections[0].tag == SAVEGAME_THUMBNAILTAG;
+
+	_outSaveFile->writeUint32BE(SAVEGAME_HEADERTAG);
+	_outSaveFile->writeUint32BE(_majorVersion);
+	_outSaveFile->writeUint32BE(_minorVersion);
+
+	_outSaveFile->writeUint32BE(metadataSize);
+	_outSaveFile->writeUint16BE(_saveYear);
+	_outSaveFile->writeByte(_saveMonth);
+	_outSaveFile->writeByte(_saveDay);
+	_outSaveFile->writeByte(_saveHour);
+	_outSaveFile->writeByte(_saveMinute);
+	_outSaveFile->writeUint32BE(hasThumbnail ? offset : 0);
+	_outSaveFile->writeUint32BE(hasThumbnail ? _sections[0].size : 0);
+	_outSaveFile->writeUint32BE(_description.size());
+	_outSaveFile->write(_description.c_str(), _description.size());
+
+	_outSaveFile->writeUint32BE(_sections.size());
+	for (uint i = 0; i < _sections.size(); ++i) {
+		const SectionData &section = _sections[i];
+		_outSaveFile->writeUint32BE(section.tag);
+		_outSaveFile->writeUint32BE(offset);
+		_outSaveFile->writeUint32BE(section.size);
+		_outSaveFile->writeUint32BE(section.storedSize);
+		offset += section.storedSize;
+	}
+
+	for (uint i = 0; i < _sections.size(); ++i) {
+		const SectionData &section = _sections[i];
+		_outSaveFile->write(section.storedData ? section.storedData : section.data, section.storedSize);
+	}
+
+	_outSaveFile->writeUint32BE(SAVEGAME_FOOTERTAG);
+}
+
+void SaveGame::writeInBackground(WrittenCallback callback, void *param) {
+	assert(_saving && _currentSection == 0 && _writeState == kWriteNone);
+
+	// Only one savegame is written at a time
+	waitBackgroundWrite();
+
+	_writtenCallback = callback;
+	_writtenParam = param;
+	_writeState = kWriteRunning;
+	_backgroundWrite = this;
+	_writeJob = g_system->startWorkerJob(writeJob, this);
+}
+
+void SaveGame::writeJob(void *param) {
+	SaveGame *save = (SaveGame *)param;
+	save->writeFile();
+	save->_outSaveFile->finalize();
+
+	Common::StackLock lock(save->_writeMutex);
+	save->_writeFailed = save->_outSaveFile->err();
+	save->_written = true;
+}
+
+bool SaveGame::pollWritten() {
+	if (_writeState == kWriteRunning) {
+		_writeMutex.lock();
+		bool written = _written;
+		_writeMutex.unlock();
+		if (!written)
+			return false;
+		waitWritten();
+	}
+	if (_writeState == kWriteDone) {
+		_writeState = kWriteReported;
+		if (_writtenCallback)
+			_writtenCallback(this, !_writeFailed, _writtenParam);
+	}
+	return _writeState == kWriteReported;
+}
+
+void SaveGame::waitWritten() {
+	if (_writeState != kWriteRunning)
+		return;
+	g_system->waitWorkerJob(_writeJob);
+	_writeState = kWriteDone;
+	if (_backgroundWrite == this)
+		_backgroundWrite = nullptr;
+}
+
+void SaveGame::waitBackgroundWrite() {
+	if (_backgroundWrite)
+		_backgroundWrite->waitWritten();
+}
+
+bool SaveGame::hasSection(uint32 sectionTag) {
+	if (_saving || !hasMetadata())
+		return true;
+
+	return findSection(sectionTag) != nullptr;
+}
+
 uint32 SaveGame::beginSection(uint32 sectionTag) {
 	assert(_majorVersion == SAVEGAME_MAJOR_VERSION);
 
@@ -121,7 +466,14 @@ uint32 SaveGame::beginSection(uint32 sectionTag) {
 		error("Tried to begin a new save game section with ending old section");
 	_currentSection = sectionTag;
 	_sectionSize = 0;
-	if (!_saving) {
+	if (!_saving && hasMetadata()) {
+		const SectionEntry *entry = findSection(sectionTag);
+		if (_directoryBroken)
+			error("Unable to read the sections of savegame");
+		if (!entry)
+			error("Unable to find requested section of savegame");
+		readSection(*entry);
+	} else if (!_saving) {
 		uint32 tag = 0;
 
 		while (tag != sectionTag) {
@@ -131,22 +483,14 @@ uint32 SaveGame::beginSection(uint32 sectionTag) {
 			_sectionSize = _inSaveFile->readUint32BE();
 			_inSaveFile->seek(_sectionSize, SEEK_CUR);
 		}
-		if (!_sectionBuffer || _sectionAlloc < _sectionSize) {
-			_sectionAlloc = _sectionSize;
-			byte *buff = (byte *)realloc(_sectionBuffer, _sectionAlloc);
-			if (buff == nullptr) {
-				free(_sectionBuffer);
-				error("Could not allocate memory for save game");
-			}
-			_sectionBuffer = buff;
-		}
+		reserveSection(_sectionSize);
 
 		_inSaveFile->seek(-(int32)_sectionSize, SEEK_CUR);
 		_inSaveFile->read(_sectionBuffer, _sectionSize);
 
 	} else {
 		if (!_sectionBuffer) {
-			_sectionAlloc = _allocAmmount;
+			_sectionAlloc = _initialAlloc;
 			_sectionBuffer = (byte *)malloc(_sectionAlloc);
 		}
 	}
@@ -158,9 +502,17 @@ void SaveGame::endSection() {
 	if (_currentSection == 0)
 		error("Tried to end a save game section without starting a section");
 	if (_saving) {
-		_outSaveFile->writeUint32BE(_currentSection);
-		_outSaveFile->writeUint32BE(_sectionSize);
-		_outSaveFile->write(_sectionBuffer, _sectionSize);
+		// The sections are kept until the savegame is complete, since the
+		// directory at the start of the file needs their stored size
+		SectionData section;
+		section.tag = _currentSection;
+		section.size = _sectionSize;
+		section.data = _sectionBuffer;
+		section.storedSize = _sectionSize;
+		section.storedData = nullptr;
+		_sections.push_back(section);
+		_sectionBuffer = nullptr;
+		_sectionAlloc = 0;
 	}
 	_currentSection = 0;
 }
@@ -220,8 +572,10 @@ bool SaveGame::readBool() {
 
 void SaveGame::checkAlloc(int size) {
 	if (_sectionSize + size > _sectionAlloc) {
+		// Growing geometrically keeps the copies linear in the size of the
+		// section, which is several megabytes for the Lua state
 		while (_sectionSize + size > _sectionAlloc)
-			_sectionAlloc += _allocAmmount;
+			_sectionAlloc *= 2;
 		_sectionBuffer = (byte *)realloc(_sectionBuffer, _sectionAlloc);
 		if (!_sectionBuffer)
 			error("Failed to allocate space for buffer");
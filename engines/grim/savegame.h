@@ -23,6 +23,11 @@
 #ifndef GRIM_SAVEGAME_H
 #define GRIM_SAVEGAME_H
 
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/str.h"
+#include "common/system.h"
+
 #include "math/mathfwd.h"
 
 namespace Common {
@@ -30,7 +35,6 @@ class SeekableReadStream;
 typedef SeekableReadStream InSaveFile;
 class WriteStream;
 typedef WriteStream OutSaveFile;
-class String;
 }
 
 namespace Grim {
@@ -56,11 +60,63 @@ public:
 	 * the current loading code.
 	 */
 	static uint SAVEGAME_MINOR_VERSION;
+	/**
+	 * First minor version with the metadata in the header and the compressed
+	 * sections listed in a directory. Older savegames store the sections one
+	 * after the other, uncompressed, and the whole file is compressed.
+	 */
+	static uint SAVEGAME_INDEXED_VERSION;
 
 	bool isCompatible() const;
 
 	uint saveMajorVersion() const;
 	uint saveMinorVersion() const;
+
+	/**
+	 * Whether the savegame has the metadata below, which are read when opening
+	 * it without reading any section.
+	 */
+	bool hasMetadata() const;
+	const Common::String &getDescription() const;
+	void setDescription(const Common::String &description);
+	void getSaveDate(int &year, int &month, int &day) const;
+	void getSaveTime(int &hour, int &minute) const;
+
+	typedef void (*WrittenCallback)(SaveGame *savedState, bool success, void *param);
+
+	/**
+	 * Compress the sections and write the file on a worker thread, instead of
+	 * when the savegame is deleted. No section may be written afterwards.
+	 * The callback is called by pollWritten(), on the thread calling it.
+	 */
+	void writeInBackground(WrittenCallback callback, void *param);
+	/**
+	 * Check whether the background write is over, and call the callback if
+	 * it is. The savegame can be deleted once this returns true.
+	 */
+	bool pollWritten();
+	/**
+	 * Wait until the background write is over. The callback is still left
+	 * to pollWritten().
+	 */
+	void waitWritten();
+	/**
+	 * Wait for the savegame being written in the background, if any. Opening
+	 * a savegame does it first, so that it never sees a partial file.
+	 */
+	static void waitBackgroundWrite();
+
+	/**
+	 * Whether the savegame has a section. Only savegames with metadata list
+	 * their sections, the older ones are assumed to have all of them.
+	 * Returns false when the list can't be read, see isBroken().
+	 */
+	bool hasSection(uint32 sectionTag);
+	/**
+	 * Whether the list of sections was found broken, which beginSection()
+	 * reports as an error.
+	 */
+	bool isBroken() const { return _directoryBroken; }
 	uint32 beginSection(uint32 sectionTag);
 	void endSection();
 	void read(void *data, int size);
@@ -88,8 +144,32 @@ public:
 	void checkAlloc(int size);
 
 protected:
+	struct SectionEntry {
+		uint32 tag;
+		uint32 offset;
+		uint32 size;
+		// Equal to the size for the sections stored as is
+		uint32 storedSize;
+	};
+
+	struct SectionData {
+		uint32 tag;
+		uint32 size;
+		byte *data;
+		uint32 storedSize;
+		byte *storedData;
+	};
+
 	SaveGame();
 
+	bool readMetadata();
+	const SectionEntry *findSection(uint32 sectionTag);
+	void readSection(const SectionEntry &entry);
+	void reserveSection(uint32 size);
+	void compressSection(SectionData &section);
+	void writeFile();
+	static void writeJob(void *param);
+
 	uint _majorVersion;
 	uint _minorVersion;
 	bool _saving;
@@ -101,7 +181,41 @@ protected:
 	uint32 _sectionPtr;
 	byte *_sectionBuffer;
 
-	static const int _allocAmmount = 1048576;
+	Common::String _description;
+	uint16 _saveYear;
+	byte _saveMonth, _saveDay, _saveHour, _saveMinute;
+
+	// The sections of a loaded savegame, read when the first one is needed.
+	// The thumbnail is in the metadata too, so that it can be shown without
+	// reading the directory.
+	Common::Array<SectionEntry> _directory;
+	bool _directoryRead;
+	bool _directoryBroken;
+	uint32 _directoryOffset;
+	uint _nextSection;
+	SectionEntry _thumbnail;
+	// The sections of a savegame being saved, written when it is deleted
+	Common::Array<SectionData> _sections;
+
+	enum WriteState {
+		kWriteNone,
+		kWriteRunning,
+		kWriteDone,
+		kWriteReported
+	};
+
+	WriteState _writeState;
+	OSystem::WorkerJobRef _writeJob;
+	WrittenCallback _writtenCallback;
+	void *_writtenParam;
+	// Set by the worker thread
+	Common::Mutex _writeMutex;
+	bool _written;
+	bool _writeFailed;
+
+	static SaveGame *_backgroundWrite;
+
+	static const int _initialAlloc = 65536;
 };
 
 } // end of namespace Grim
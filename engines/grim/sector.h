@@ -65,6 +65,7 @@ public:
 	Common::String getName() const { return _name; }
 	int getSectorId() const { return _id; }
 	SectorType getType() const { return _type; } // FIXME: Implement type de-masking
+	float getHeight() const { return _height; }
 	bool isVisible() const { return _visible && !_invalid; }
 	bool isPointInSector(const Math::Vector3d &point) const;
 	float distanceToPoint(const Math::Vector3d &point) const;
@@ -0,0 +1,350 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/system.h"
+
+#include "engines/grim/sectorindex.h"
+#include "engines/grim/sector.h"
+
+namespace Grim {
+
+// Points slightly outside of a sector still count as in it, and
+// findSectorSortOrder() accepts sectors up to 0.01 away.
+static const float kMargin = 0.02f;
+static const int kMaxCells = 64;
+
+namespace {
+
+class QueryTimer {
+public:
+	QueryTimer(SectorIndex::QueryStats &stats, bool timing) : _stats(stats), _timing(timing), _start(0) {
+		_stats.queries++;
+		if (_timing)
+			_start = g_system->getMicros();
+	}
+
+	~QueryTimer() {
+		if (_timing)
+			_stats.micros += g_system->getMicros() - _start;
+	}
+
+private:
+	SectorIndex::QueryStats &_stats;
+	bool _timing;
+	uint64 _start;
+};
+
+} // End of anonymous namespace
+
+SectorIndex::SectorIndex() :
+		_useXZ(false), _cellsX(0), _cellsY(0), _cellWidth(1.f), _cellHeight(1.f), _query(0), _timing(false) {
+	resetStats();
+}
+
+void SectorIndex::resetStats() {
+	for (int i = 0; i < kQueryTypeCount; i++) {
+		_stats[i].queries = 0;
+		_stats[i].sectorsTested = 0;
+		_stats[i].micros = 0;
+	}
+}
+
+void SectorIndex::build(Sector **sectors, int count, bool useXZ) {
+	_useXZ = useXZ;
+	_sectors.resize(count);
+	_bounds.resize(count);
+	_unbounded.clear();
+	_visited.resize(count);
+	_query = 0;
+
+	int boundedCount = 0;
+	for (int i = 0; i < count; i++) {
+		Sector *sector = sectors[i];
+		Bounds &bounds = _bounds[i];
+		_sectors[i] = sector;
+		_visited[i] = 0;
+
+		if (!sector || sector->getNumVertices() == 0) {
+			// Never matches anything
+			bounds.minA = bounds.minB = 1.f;
+			bounds.maxA = bounds.maxB = 0.f;
+			continue;
+		}
+
+		// Points count as in a sector as long as they are close enough
+		// to its plane, so tilted sectors reach further on the ground.
+		Math::Vector3d normal = sector->getNormal();
+		normal.normalize();
+		const float up = fabs(_useXZ ? normal.y() : normal.z());
+		const float tilt = sqrt(MAX(0.f, 1.f - up * up));
+		float margin = kMargin;
+		if (sector->getHeight() < 9000.f) {
+			margin += (sector->getHeight() + 0.01f) * tilt;
+		} else if (tilt * 10000.f > kMargin) {
+			bounds.minA = bounds.minB = -1e30f;
+			bounds.maxA = bounds.maxB = 1e30f;
+			_unbounded.push_back(i);
+			continue;
+		}
+
+		const Math::Vector3d *vertices = sector->getVertices();
+		bounds.minA = bounds.maxA = getA(vertices[0]);
+		bounds.minB = bounds.maxB = getB(vertices[0]);
+		for (int j = 1; j < sector->getNumVertices(); j++) {
+			bounds.minA = MIN(bounds.minA, getA(vertices[j]));
+			bounds.maxA = MAX(bounds.maxA, getA(vertices[j]));
+			bounds.minB = MIN(bounds.minB, getB(vertices[j]));
+			bounds.maxB = MAX(bounds.maxB, getB(vertices[j]));
+		}
+		bounds.minA -= margin;
+		bounds.minB -= margin;
+		bounds.maxA += margin;
+		bounds.maxB += margin;
+
+		if (boundedCount++ == 0) {
+			_gridBounds = bounds;
+		} else {
+			_gridBounds.minA = MIN(_gridBounds.minA, bounds.minA);
+			_gridBounds.maxA = MAX(_gridBounds.maxA, bounds.maxA);
+			_gridBounds.minB = MIN(_gridBounds.minB, bounds.minB);
+			_gridBounds.maxB = MAX(_gridBounds.maxB, bounds.maxB);
+		}
+	}
+
+	_cellStart.clear();
+	_cellSectors.clear();
+	if (boundedCount == 0) {
+		_cellsX = _cellsY = 0;
+		return;
+	}
+
+	// About two cells per sector, roughly square
+	const float width = _gridBounds.maxA - _gridBounds.minA;
+	const float height = _gridBounds.maxB - _gridBounds.minB;
+	const float cellSize = sqrt(width * height / (boundedCount * 2));
+	_cellsX = CLIP<int>((int)ceil(width / cellSize), 1, kMaxCells);
+	_cellsY = CLIP<int>((int)ceil(height / cellSize), 1, kMaxCells);
+	_cellWidth = width / _cellsX;
+	_cellHeight = height / _cellsY;
+
+	// Count the sectors of each cell, then fill them in
+	_cellStart.resize(_cellsX * _cellsY + 1);
+	for (uint i = 0; i < _cellStart.size(); i++)
+		_cellStart[i] = 0;
+
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < count; i++) {
+			const Bounds &bounds = _bounds[i];
+			if (bounds.minA > bounds.maxA || bounds.maxA >= 1e30f)
+				continue;
+
+			const int x0 = getCellX(bounds.minA), x1 = getCellX(bounds.maxA);
+			const int y0 = getCellY(bounds.minB), y1 = getCellY(bounds.maxB);
+			for (int y = y0; y <= y1; y++) {
+				for (int x = x0; x <= x1; x++) {
+					if (pass == 0)
+						_cellStart[y * _cellsX + x + 1]++;
+					else
+						_cellSectors[_cellStart[y * _cellsX + x]++] = i;
+				}
+			}
+		}
+
+		if (pass == 0) {
+			for (uint i = 1; i < _cellStart.size(); i++)
+				_cellStart[i] += _cellStart[i - 1];
+			_cellSectors.resize(_cellStart.back());
+		} else {
+			// Filling moved each start to the next cell's one
+			for (int i = _cellStart.size() - 1; i > 0; i--)
+				_cellStart[i] = _cellStart[i - 1];
+			_cellStart[0] = 0;
+		}
+	}
+}
+
+int SectorIndex::getCellX(float a) const {
+	return CLIP<int>((int)floor((a - _gridBounds.minA) / _cellWidth), 0, _cellsX - 1);
+}
+
+int SectorIndex::getCellY(float b) const {
+	return CLIP<int>((int)floor((b - _gridBounds.minB) / _cellHeight), 0, _cellsY - 1);
+}
+
+bool SectorIndex::isInBounds(int sector, const Math::Vector3d &p) const {
+	const Bounds &bounds = _bounds[sector];
+	const float a = getA(p), b = getB(p);
+	return a >= bounds.minA && a <= bounds.maxA && b >= bounds.minB && b <= bounds.maxB;
+}
+
+void SectorIndex::gatherCandidates(const Math::Vector3d &p) {
+	_candidates.clear();
+
+	const int *cell = nullptr, *cellEnd = nullptr;
+	const float a = getA(p), b = getB(p);
+	if (_cellsX > 0 && a >= _gridBounds.minA && a <= _gridBounds.maxA && b >= _gridBounds.minB && b <= _gridBounds.maxB) {
+		const int i = getCellY(b) * _cellsX + getCellX(a);
+		cell = _cellSectors.begin() + _cellStart[i];
+		cellEnd = _cellSectors.begin() + _cellStart[i + 1];
+	}
+
+	// Merge with the unbounded sectors, keeping the order of the set
+	uint unbounded = 0;
+	while (cell != cellEnd || unbounded < _unbounded.size()) {
+		if (cell != cellEnd && (unbounded == _unbounded.size() || *cell < _unbounded[unbounded]))
+			_candidates.push_back(*cell++);
+		else
+			_candidates.push_back(_unbounded[unbounded++]);
+	}
+}
+
+Sector *SectorIndex::findPointSector(const Math::Vector3d &p, int type) {
+	QueryTimer timer(_stats[kPointQuery], _timing);
+
+	gatherCandidates(p);
+	for (uint i = 0; i < _candidates.size(); i++) {
+		Sector *sector = _sectors[_candidates[i]];
+		if (!isInBounds(_candidates[i], p) || (sector->getType() & type) == 0 || !sector->isVisible())
+			continue;
+
+		_stats[kPointQuery].sectorsTested++;
+		if (sector->isPointInSector(p))
+			return sector;
+	}
+
+	return nullptr;
+}
+
+int SectorIndex::findSectorSortOrder(const Math::Vector3d &p, int type, int setup) {
+	QueryTimer timer(_stats[kSortOrderQuery], _timing);
+
+	int sortOrder = 0;
+	float minDist = 0.01f;
+
+	gatherCandidates(p);
+	for (uint i = 0; i < _candidates.size(); i++) {
+		Sector *sector = _sectors[_candidates[i]];
+		if (!isInBounds(_candidates[i], p) || (sector->getType() & type) == 0 || !sector->isVisible() || setup >= sector->getNumSortplanes())
+			continue;
+
+		_stats[kSortOrderQuery].sectorsTested++;
+		Math::Vector3d closestPt = sector->getClosestPoint(p);
+		float thisDist = (closestPt - p).getMagnitude();
+		if (thisDist < minDist) {
+			minDist = thisDist;
+			sortOrder = sector->getSortplane(setup);
+		}
+	}
+
+	return sortOrder;
+}
+
+void SectorIndex::testClosest(int i, const Math::Vector3d &p, int &best, float &bestDist, Math::Vector3d &bestPoint) {
+	Sector *sector = _sectors[i];
+	if (!sector || (sector->getType() & Sector::WalkType) == 0 || !sector->isVisible())
+		return;
+
+	// The closest point is within the bounds, skip sectors which can't be closer
+	if (best >= 0) {
+		const Bounds &bounds = _bounds[i];
+		const float a = getA(p), b = getB(p);
+		const float da = MAX(0.f, MAX(bounds.minA - a, a - bounds.maxA));
+		const float db = MAX(0.f, MAX(bounds.minB - b, b - bounds.maxB));
+		if (da * da + db * db > bestDist * bestDist)
+			return;
+	}
+
+	_stats[kClosestQuery].sectorsTested++;
+	Math::Vector3d closestPt = sector->getClosestPoint(p);
+	float thisDist = (closestPt - p).getMagnitude();
+	if (best < 0 || thisDist < bestDist || (thisDist == bestDist && i < best)) {
+		best = i;
+		bestDist = thisDist;
+		bestPoint = closestPt;
+	}
+}
+
+void SectorIndex::findClosestSector(const Math::Vector3d &p, Sector **sect, Math::Vector3d *closestPoint) {
+	QueryTimer timer(_stats[kClosestQuery], _timing);
+
+	int best = -1;
+	float bestDist = 0.f;
+	Math::Vector3d bestPoint = p;
+
+	for (uint i = 0; i < _unbounded.size(); i++)
+		testClosest(_unbounded[i], p, best, bestDist, bestPoint);
+
+	if (_cellsX > 0) {
+		if (++_query == 0) {
+			for (uint i = 0; i < _visited.size(); i++)
+				_visited[i] = 0;
+			_query = 1;
+		}
+
+		// Look at rings of cells further and further away
+		const float a = getA(p), b = getB(p);
+		const int cx = getCellX(a), cy = getCellY(b);
+		for (int r = 0;; r++) {
+			const int x0 = cx - r, x1 = cx + r, y0 = cy - r, y1 = cy + r;
+			for (int y = MAX(y0, 0); y <= MIN(y1, _cellsY - 1); y++) {
+				const bool fullRow = (y == y0 || y == y1);
+				for (int x = MAX(x0, 0); x <= MIN(x1, _cellsX - 1); x++) {
+					if (!fullRow && x != x0 && x != x1)
+						continue;
+
+					const int cell = y * _cellsX + x;
+					for (int i = _cellStart[cell]; i < _cellStart[cell + 1]; i++) {
+						const int sector = _cellSectors[i];
+						if (_visited[sector] == _query)
+							continue;
+
+						_visited[sector] = _query;
+						testClosest(sector, p, best, bestDist, bestPoint);
+					}
+				}
+			}
+
+			// Sectors not seen yet are entirely beyond one of the sides
+			// of the cells seen so far
+			float bound = 1e30f;
+			if (x0 > 0)
+				bound = MIN(bound, MAX(0.f, a - (_gridBounds.minA + x0 * _cellWidth)));
+			if (x1 < _cellsX - 1)
+				bound = MIN(bound, MAX(0.f, _gridBounds.minA + (x1 + 1) * _cellWidth - a));
+			if (y0 > 0)
+				bound = MIN(bound, MAX(0.f, b - (_gridBounds.minB + y0 * _cellHeight)));
+			if (y1 < _cellsY - 1)
+				bound = MIN(bound, MAX(0.f, _gridBounds.minB + (y1 + 1) * _cellHeight - b));
+
+			if (bound >= 1e30f || (best >= 0 && bestDist < bound))
+				break;
+		}
+	}
+
+	if (sect)
+		*sect = best >= 0 ? _sectors[best] : nullptr;
+
+	if (closestPoint)
+		*closestPoint = bestPoint;
+}
+
+} // end of namespace Grim
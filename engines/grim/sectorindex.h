@@ -0,0 +1,113 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRIM_SECTORINDEX_H
+#define GRIM_SECTORINDEX_H
+
+#include "common/array.h"
+
+#include "math/vector3d.h"
+
+namespace Grim {
+
+class Sector;
+
+/**
+ * A uniform grid over the bounds of the sectors of a set, on the plane
+ * actors walk on, so point queries only look at the sectors nearby.
+ *
+ * The queries give the same results as testing every sector in order.
+ * Types and visibility are checked while querying, so the grid only needs
+ * to be built again when the shape of the sectors changes.
+ */
+class SectorIndex {
+public:
+	enum QueryType {
+		kPointQuery,
+		kSortOrderQuery,
+		kClosestQuery,
+		kQueryTypeCount
+	};
+
+	struct QueryStats {
+		uint32 queries;
+		uint32 sectorsTested;
+		uint64 micros;         // Only counted while timing is enabled
+	};
+
+	SectorIndex();
+
+	void build(Sector **sectors, int count, bool useXZ);
+
+	Sector *findPointSector(const Math::Vector3d &p, int type);
+	int findSectorSortOrder(const Math::Vector3d &p, int type, int setup);
+	void findClosestSector(const Math::Vector3d &p, Sector **sect, Math::Vector3d *closestPoint);
+
+	int getSectorCount() const { return _sectors.size(); }
+	int getCellCount() const { return _cellsX * _cellsY; }
+	int getUnboundedCount() const { return _unbounded.size(); }
+	const QueryStats &getStats(QueryType type) const { return _stats[type]; }
+	void resetStats();
+	/** Whether to measure the time spent in queries, off by default. */
+	void setTiming(bool timing) { _timing = timing; }
+	bool isTiming() const { return _timing; }
+
+private:
+	struct Bounds {
+		float minA, minB, maxA, maxB;
+	};
+
+	float getA(const Math::Vector3d &p) const { return p.x(); }
+	float getB(const Math::Vector3d &p) const { return _useXZ ? p.z() : p.y(); }
+	int getCellX(float a) const;
+	int getCellY(float b) const;
+	bool isInBounds(int sector, const Math::Vector3d &p) const;
+	void gatherCandidates(const Math::Vector3d &p);
+	void testClosest(int sector, const Math::Vector3d &p, int &best, float &bestDist, Math::Vector3d &bestPoint);
+
+	Common::Array<Sector *> _sectors;
+	Common::Array<Bounds> _bounds;
+	bool _useXZ;
+
+	// Sectors which could be anywhere on the plane, e.g. tilted with no height limit
+	Common::Array<int> _unbounded;
+
+	// The sectors overlapping cell i are _cellSectors[_cellStart[i]] to
+	// _cellSectors[_cellStart[i + 1] - 1], in increasing order
+	Bounds _gridBounds;
+	int _cellsX, _cellsY;
+	float _cellWidth, _cellHeight;
+	Common::Array<int> _cellStart;
+	Common::Array<int> _cellSectors;
+
+	// Query state, kept to avoid allocations
+	Common::Array<int> _candidates;
+	Common::Array<uint32> _visited;
+	uint32 _query;
+
+	QueryStats _stats[kQueryTypeCount];
+	bool _timing;
+};
+
+} // end of namespace Grim
+
+#endif
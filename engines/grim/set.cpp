@@ -36,11 +36,14 @@
 #include "engines/grim/emi/sound/emisound.h"
 
 #include "math/frustum.h"
+#include "math/vector2d.h"
 
 namespace Grim {
 
 Set::Set(const Common::String &sceneName, Common::SeekableReadStream *data) :
-		_locked(false), _name(sceneName), _enableLights(false) {
+		_locked(false), _name(sceneName), _enableLights(false), _walkGraphDirty(true),
+		_sectorIndexDirty(true) {
+	lightsChanged();
 
 	char header[7];
 	data->read(header, 7);
@@ -58,7 +61,9 @@ Set::Set() :
 		_cmaps(nullptr), _locked(false), _enableLights(false), _numSetups(0),
 		_numLights(0), _numSectors(0), _numObjectStates(0), _minVolume(0),
 		_maxVolume(0), _numCmaps(0), _numShadows(0), _currSetup(nullptr),
-		_setups(nullptr), _lights(nullptr), _sectors(nullptr), _shadows(nullptr) {
+		_setups(nullptr), _lights(nullptr), _sectors(nullptr), _shadows(nullptr),
+		_walkGraphDirty(true), _sectorIndexDirty(true) {
+	lightsChanged();
 
 	setupOverworldLights();
 }
@@ -333,6 +338,8 @@ bool Set::restoreState(SaveGame *savedState) {
 	} else {
 		_sectors = nullptr;
 	}
+	_walkGraphDirty = true;
+	_sectorIndexDirty = true;
 
 	_numLights = savedState->readLESint32();
 	_lights = new Light[_numLights];
@@ -341,6 +348,7 @@ bool Set::restoreState(SaveGame *savedState) {
 		_lights[i]._id = i;
 		_lightsList.push_back(&_lights[i]);
 	}
+	lightsChanged();
 
 	if (savedState->saveMinorVersion() >= 19) {
 		_numShadows = savedState->readLESint32();
@@ -852,6 +860,12 @@ void Set::turnOffLights() {
 	}
 }
 
+void Set::lightsChanged() {
+	// Shared by all the sets, so a set never reuses the generation of another
+	static uint32 lastGeneration = 0;
+	_lightsGeneration = ++lastGeneration;
+}
+
 void Set::setSetup(int num) {
 	// Looks like num is zero-based so >= should work to find values
 	// that are out of the range of valid setups
@@ -918,57 +932,24 @@ void Set::setupCamera() {
 }
 
 Sector *Set::findPointSector(const Math::Vector3d &p, Sector::SectorType type) {
-	for (int i = 0; i < _numSectors; i++) {
-		Sector *sector = _sectors[i];
-		if (sector && (sector->getType() & type) && sector->isVisible() && sector->isPointInSector(p))
-			return sector;
-	}
-	return nullptr;
+	return getSectorIndex().findPointSector(p, type);
 }
 
 int Set::findSectorSortOrder(const Math::Vector3d &p, Sector::SectorType type) {
-	int setup = getSetup();
-	int sortOrder = 0;
-	float minDist = 0.01f;
-
-	for (int i = 0; i < _numSectors; i++) {
-		Sector *sector = _sectors[i];
-		if (!sector || (sector->getType() & type) == 0 || !sector->isVisible() || setup >= sector->getNumSortplanes())
-			continue;
-
-		Math::Vector3d closestPt = sector->getClosestPoint(p);
-		float thisDist = (closestPt - p).getMagnitude();
-		if (thisDist < minDist) {
-			minDist = thisDist;
-			sortOrder = sector->getSortplane(setup);
-		}
-	}
-	return sortOrder;
+	return getSectorIndex().findSectorSortOrder(p, type, getSetup());
 }
 
 void Set::findClosestSector(const Math::Vector3d &p, Sector **sect, Math::Vector3d *closestPoint) {
-	Sector *resultSect = nullptr;
-	Math::Vector3d resultPt = p;
-	float minDist = 0.0;
+	getSectorIndex().findClosestSector(p, sect, closestPoint);
+}
 
-	for (int i = 0; i < _numSectors; i++) {
-		Sector *sector = _sectors[i];
-		if ((sector->getType() & Sector::WalkType) == 0 || !sector->isVisible())
-			continue;
-		Math::Vector3d closestPt = sector->getClosestPoint(p);
-		float thisDist = (closestPt - p).getMagnitude();
-		if (!resultSect || thisDist < minDist) {
-			resultSect = sector;
-			resultPt = closestPt;
-			minDist = thisDist;
-		}
+SectorIndex &Set::getSectorIndex() {
+	if (_sectorIndexDirty) {
+		_sectorIndex.build(_sectors, _numSectors, g_grim->getGameType() == GType_MONKEY4);
+		_sectorIndexDirty = false;
 	}
 
-	if (sect)
-		*sect = resultSect;
-
-	if (closestPoint)
-		*closestPoint = resultPt;
+	return _sectorIndex;
 }
 
 void Set::shrinkBoxes(float radius) {
@@ -976,6 +957,8 @@ void Set::shrinkBoxes(float radius) {
 		Sector *sector = _sectors[i];
 		sector->shrink(radius);
 	}
+	_walkGraphDirty = true;
+	_sectorIndexDirty = true;
 }
 
 void Set::unshrinkBoxes() {
@@ -983,6 +966,69 @@ void Set::unshrinkBoxes() {
 		Sector *sector = _sectors[i];
 		sector->unshrink();
 	}
+	_walkGraphDirty = true;
+	_sectorIndexDirty = true;
+}
+
+bool Set::isWalkableSector(const Sector *sector) {
+	int type = sector->getType();
+	return type == Sector::WalkType || type == Sector::HotType || type == Sector::FunnelType;
+}
+
+WalkGraph &Set::getWalkGraph() {
+	if (_walkGraphDirty) {
+		buildWalkGraph();
+		_walkGraphDirty = false;
+	}
+
+	return _walkGraph;
+}
+
+void Set::buildWalkGraph() {
+	// EMI walks on the XZ plane, Grim on the XY one
+	const bool useXZ = (g_grim->getGameType() == GType_MONKEY4);
+	_walkGraph.reset(_numSectors, useXZ);
+
+	// Bridges lie on the edges of both sectors, so only sectors with
+	// overlapping bounds on the walking plane need to be checked.
+	const float margin = 0.01f;
+	Common::Array<Math::Vector2d> minBounds, maxBounds;
+	minBounds.resize(_numSectors);
+	maxBounds.resize(_numSectors);
+	for (int i = 0; i < _numSectors; i++) {
+		const Math::Vector3d *vertices = _sectors[i]->getVertices();
+		for (int j = 0; j < _sectors[i]->getNumVertices(); j++) {
+			Math::Vector2d v(vertices[j].x(), useXZ ? vertices[j].z() : vertices[j].y());
+			if (j == 0 || v.getX() < minBounds[i].getX())
+				minBounds[i].setX(v.getX());
+			if (j == 0 || v.getY() < minBounds[i].getY())
+				minBounds[i].setY(v.getY());
+			if (j == 0 || v.getX() > maxBounds[i].getX())
+				maxBounds[i].setX(v.getX());
+			if (j == 0 || v.getY() > maxBounds[i].getY())
+				maxBounds[i].setY(v.getY());
+		}
+	}
+
+	for (int i = 0; i < _numSectors; i++) {
+		Sector *sector = _sectors[i];
+		if (!isWalkableSector(sector))
+			continue;
+
+		for (int j = 0; j < _numSectors; j++) {
+			Sector *other = _sectors[j];
+			if (j == i || !isWalkableSector(other))
+				continue;
+
+			if (minBounds[i].getX() > maxBounds[j].getX() + margin || minBounds[j].getX() > maxBounds[i].getX() + margin ||
+			    minBounds[i].getY() > maxBounds[j].getY() + margin || minBounds[j].getY() > maxBounds[i].getY() + margin)
+				continue;
+
+			Common::List<Math::Line3d> bridges = sector->getBridgesTo(other);
+			if (!bridges.empty())
+				_walkGraph.addEdge(i, j, bridges);
+		}
+	}
 }
 
 void Set::setLightIntensity(const char *light, float intensity) {
@@ -990,6 +1036,7 @@ void Set::setLightIntensity(const char *light, float intensity) {
 		Light &l = _lights[i];
 		if (l._name == light) {
 			l.setIntensity(intensity);
+			lightsChanged();
 			return;
 		}
 	}
@@ -998,6 +1045,7 @@ void Set::setLightIntensity(const char *light, float intensity) {
 void Set::setLightIntensity(int light, float intensity) {
 	Light &l = _lights[light];
 	l.setIntensity(intensity);
+	lightsChanged();
 }
 
 void Set::setLightEnabled(const char *light, bool enabled) {
@@ -1005,6 +1053,7 @@ void Set::setLightEnabled(const char *light, bool enabled) {
 		Light &l = _lights[i];
 		if (l._name == light) {
 			l._enabled = enabled;
+			lightsChanged();
 			return;
 		}
 	}
@@ -1013,6 +1062,7 @@ void Set::setLightEnabled(const char *light, bool enabled) {
 void Set::setLightEnabled(int light, bool enabled) {
 	Light &l = _lights[light];
 	l._enabled = enabled;
+	lightsChanged();
 }
 
 void Set::setLightPosition(const char *light, const Math::Vector3d &pos) {
@@ -1020,6 +1070,7 @@ void Set::setLightPosition(const char *light, const Math::Vector3d &pos) {
 		Light &l = _lights[i];
 		if (l._name == light) {
 			l._pos = pos;
+			lightsChanged();
 			return;
 		}
 	}
@@ -1028,6 +1079,7 @@ void Set::setLightPosition(const char *light, const Math::Vector3d &pos) {
 void Set::setLightPosition(int light, const Math::Vector3d &pos) {
 	Light &l = _lights[light];
 	l._pos = pos;
+	lightsChanged();
 }
 
 void Set::setSoundPosition(const char *soundName, const Math::Vector3d &pos) {
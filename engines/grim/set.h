@@ -28,6 +28,8 @@
 #include "engines/grim/color.h"
 #include "engines/grim/sector.h"
 #include "engines/grim/objectstate.h"
+#include "engines/grim/sectorindex.h"
+#include "engines/grim/walkgraph.h"
 #include "math/quat.h"
 #include "math/frustum.h"
 
@@ -84,6 +86,11 @@ public:
 	void setLightEnabled(const char *light, bool enabled);
 	void setLightEnabled(int light, bool enabled);
 	void turnOffLights();
+	/**
+	 * Get a number which changes every time a light of the set is changed,
+	 * and differs between sets.
+	 */
+	uint32 getLightsGeneration() const { return _lightsGeneration; }
 
 	void setSetup(int num);
 	int getSetup() const { return _currSetup - _setups; }
@@ -103,6 +110,16 @@ public:
 	void shrinkBoxes(float radius);
 	void unshrinkBoxes();
 
+	/**
+	 * Get the adjacency of the walkable sectors, built again when
+	 * their shape has changed.
+	 */
+	WalkGraph &getWalkGraph();
+	static bool isWalkableSector(const Sector *sector);
+
+	/** Get the spatial index of the sectors, built again when their shape has changed. */
+	SectorIndex &getSectorIndex();
+
 	void addObjectState(const ObjectState::Ptr &s);
 	void deleteObjectState(const ObjectState::Ptr &s) {
 		_states.remove(s);
@@ -171,6 +188,16 @@ private:
 
 	Math::Frustum _frustum;
 
+	void buildWalkGraph();
+	WalkGraph _walkGraph;
+	bool _walkGraphDirty;
+
+	SectorIndex _sectorIndex;
+	bool _sectorIndexDirty;
+
+	void lightsChanged();
+	uint32 _lightsGeneration;
+
 	friend class GrimEngine;
 };
 
@@ -88,6 +88,7 @@ void SoundPlayer::flushTracks() {
 		g_imuse->flushTracks();
 	} else {
 		g_emiSound->flushTracks();
+		g_emiSound->prewarmMusic();
 	}
 }
 
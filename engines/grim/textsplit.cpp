@@ -20,14 +20,141 @@
  *
  */
 
+#include "common/endian.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 #include "common/stream.h"
 
 #include "engines/grim/textsplit.h"
+#include "engines/grim/parsecache.h"
 
 namespace Grim {
 
+// The parse cache stores, for each scanned line, the position of the line
+// in the file, a hash of the format, the number of fields and then the
+// fields. Strings are stored with the field width they were scanned with.
+enum {
+	kFieldInt,
+	kFieldFloat,
+	kFieldChar,
+	kFieldString,
+	kFieldCharClass
+};
+
+static void recordUint16(Common::Array<byte> *record, uint16 value) {
+	record->push_back(value & 0xff);
+	record->push_back(value >> 8);
+}
+
+static void recordUint32(Common::Array<byte> *record, uint32 value) {
+	for (int i = 0; i < 4; i++)
+		record->push_back((value >> (i * 8)) & 0xff);
+}
+
+static void storeInt(void *var, int value, Common::Array<byte> *record) {
+	*(int*)var = value;
+	if (record) {
+		record->push_back(kFieldInt);
+		recordUint32(record, value);
+	}
+}
+
+static void storeFloat(void *var, float value, Common::Array<byte> *record) {
+	*(float*)var = value;
+	if (record) {
+		uint32 bits;
+		memcpy(&bits, &value, 4);
+		record->push_back(kFieldFloat);
+		recordUint32(record, bits);
+	}
+}
+
+static void storeChar(void *var, char value, Common::Array<byte> *record) {
+	*(char*)var = value;
+	if (record) {
+		record->push_back(kFieldChar);
+		record->push_back(value);
+	}
+}
+
+static void storeString(void *var, byte type, const char *s, unsigned int fieldWidth, Common::Array<byte> *record) {
+	char *string = (char*)var;
+	strncpy(string, s, fieldWidth);
+	if (type == kFieldString) {
+		if (fieldWidth <= strlen(s)) {
+			// add terminating \0
+			string[fieldWidth] = '\0';
+		}
+	} else {
+		string[fieldWidth - 1] = '\0';
+	}
+
+	if (record) {
+		const uint16 length = strlen(s);
+		record->push_back(type);
+		recordUint16(record, fieldWidth);
+		recordUint16(record, length);
+		for (uint16 i = 0; i < length; i++)
+			record->push_back(s[i]);
+	}
+}
+
+// Read a field stored by one of the functions above, and store it into var.
+// When var is null the field is only checked.
+static bool replayField(const byte *&pos, const byte *end, void *var) {
+	if (pos == end)
+		return false;
+
+	const byte type = *pos++;
+	switch (type) {
+	case kFieldInt:
+	case kFieldFloat:
+		if (end - pos < 4)
+			return false;
+		if (var) {
+			uint32 bits = READ_LE_UINT32(pos);
+			memcpy(var, &bits, 4);
+		}
+		pos += 4;
+		return true;
+	case kFieldChar:
+		if (end - pos < 1)
+			return false;
+		if (var)
+			*(char*)var = *pos;
+		pos++;
+		return true;
+	case kFieldString:
+	case kFieldCharClass: {
+		if (end - pos < 4)
+			return false;
+		const uint16 fieldWidth = READ_LE_UINT16(pos);
+		const uint16 length = READ_LE_UINT16(pos + 2);
+		if (length >= 2000 || end - pos - 4 < length)
+			return false;
+		if (var) {
+			char s[2000];
+			memcpy(s, pos + 4, length);
+			s[length] = '\0';
+			storeString(var, type, s, fieldWidth, nullptr);
+		}
+		pos += 4 + length;
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+static uint32 hashFormat(const char *fmt) {
+	uint32 hash = 2166136261u;
+	for (; *fmt; fmt++) {
+		hash ^= (byte)*fmt;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
 static bool isCodeSeparator(char c) {
 	return (c == ' ' || c == ',' || c == '.' || c == '%' || c == '\'' || c == ':');
 }
@@ -97,8 +224,8 @@ static char *parseCharacterClass(const char *code, bool *isNegated) {
 }
 
 // This function is modelled after sscanf, and supports a subset of its features. See sscanf documentation
-// for information about the syntax it accepts.
-static void parse(const char *line, const char *fmt, int field_count, va_list va) {
+// for information about the syntax it accepts. Returns the number of variables stored, including %n ones.
+static int parse(const char *line, const char *fmt, int field_count, va_list va, Common::Array<byte> *record) {
 	char *str = strdup(line);
 	const int len = strlen(str);
 	for (int i = 0; i < len; ++i) {
@@ -114,6 +241,7 @@ static void parse(const char *line, const char *fmt, int field_count, va_list va
 	}
 
 	int count = 0;
+	int stored = 0;
 	const char *src = str;
 	const char *end = str + len;
 	for (int i = 0; i < formatlen; ++i) {
@@ -140,8 +268,9 @@ static void parse(const char *line, const char *fmt, int field_count, va_list va
 			width[jw] = '\0';
 
 			void *var = va_arg(va, void *);
+			++stored;
 			if (strcmp(code, "n") == 0) {
-				*(int*)var = src - str;
+				storeInt(var, src - str, record);
 				continue;
 			}
 
@@ -191,24 +320,17 @@ static void parse(const char *line, const char *fmt, int field_count, va_list va
 			}
 
 			if (strcmp(code, "d") == 0) {
-				*(int*)var = atoi(s);
+				storeInt(var, atoi(s), record);
 			} else if (strcmp(code, "x") == 0) {
-				*(int*)var = strtol(s, (char **) nullptr, 16);
+				storeInt(var, strtol(s, (char **) nullptr, 16), record);
 			} else if (strcmp(code, "f") == 0) {
-				*(float*)var = str2float(s);
+				storeFloat(var, str2float(s), record);
 			} else if (strcmp(code, "c") == 0) {
-				*(char*)var = s[0];
+				storeChar(var, s[0], record);
 			} else if (strcmp(code, "s") == 0) {
-				char *string = (char*)var;
-				strncpy(string, s, fieldWidth);
-				if (fieldWidth <= strlen(s)) {
-					// add terminating \0
-					string[fieldWidth] = '\0';
-				}
+				storeString(var, kFieldString, s, fieldWidth, record);
 			} else if (code[0] == '[') {
-				char *string = (char*)var;
-				strncpy(string, s, fieldWidth);
-				string[fieldWidth - 1] = '\0';
+				storeString(var, kFieldCharClass, s, fieldWidth, record);
 			} else {
 				error("Code not handled: \"%s\" \"%s\"\n\"%s\" \"%s\"", code, s, line, fmt);
 			}
@@ -241,6 +363,8 @@ static void parse(const char *line, const char *fmt, int field_count, va_list va
 	if (count < field_count) {
 		error("Expected line of format '%s', got '%s'", fmt, line);
 	}
+
+	return stored;
 }
 
 
@@ -273,10 +397,31 @@ TextSplitter::TextSplitter(const Common::String &fname, Common::SeekableReadStre
 		line++;
 	}
 	_currLine = nullptr;
+
+	// Files without a name can't be told apart in the parse cache
+	_contentSize = len;
+	_contentHash = 0;
+	_replayBlob = _replayPos = _replayEnd = nullptr;
+	_recording = false;
+	if (g_parseCache && !_fname.empty()) {
+		_contentHash = ParseCache::hashContent(_stringData, len);
+		uint32 length;
+		_replayBlob = _replayPos = g_parseCache->find(_fname, _contentHash, _contentSize, length);
+		if (_replayPos)
+			_replayEnd = _replayPos + length;
+		else
+			_recording = true;
+	}
+
 	processLine();
 }
 
 TextSplitter::~TextSplitter() {
+	if (_recording && !_record.empty())
+		g_parseCache->store(_fname, _contentHash, _contentSize, _record.begin(), _record.size());
+	if (_replayBlob)
+		g_parseCache->release(_replayBlob);
+
 	delete[] _stringData;
 	delete[] _lines;
 }
@@ -310,7 +455,7 @@ void TextSplitter::scanString(const char *fmt, int field_count, ...) {
 	va_list va;
 	va_start(va, field_count);
 
-	parse(getCurrentLine(), fmt, field_count, va);
+	scanLine(getCurrentLine(), fmt, field_count, va);
 
 	va_end(va);
 
@@ -324,7 +469,7 @@ void TextSplitter::scanStringAtOffset(int offset, const char *fmt, int field_cou
 	va_list va;
 	va_start(va, field_count);
 
-	parse(getCurrentLine() + offset, fmt, field_count, va);
+	scanLine(getCurrentLine() + offset, fmt, field_count, va);
 
 	va_end(va);
 
@@ -338,7 +483,7 @@ void TextSplitter::scanStringNoNewLine(const char *fmt, int field_count, ...) {
 	va_list va;
 	va_start(va, field_count);
 
-	parse(getCurrentLine(), fmt, field_count, va);
+	scanLine(getCurrentLine(), fmt, field_count, va);
 
 	va_end(va);
 }
@@ -350,36 +495,86 @@ void TextSplitter::scanStringAtOffsetNoNewLine(int offset, const char *fmt, int
 	va_list va;
 	va_start(va, field_count);
 
-	parse(getCurrentLine() + offset, fmt, field_count, va);
+	scanLine(getCurrentLine() + offset, fmt, field_count, va);
 
 	va_end(va);
 }
 
+void TextSplitter::scanLine(const char *line, const char *fmt, int field_count, va_list va) {
+	const uint32 offset = line - _stringData;
+	const uint32 formatHash = hashFormat(fmt);
+
+	if (_replayPos) {
+		// Check the whole record before storing anything, so the line can
+		// still be parsed if it doesn't match
+		const byte *pos = _replayPos;
+		bool valid = _replayEnd - pos >= 9 && READ_LE_UINT32(pos) == offset &&
+		             READ_LE_UINT32(pos + 4) == formatHash && pos[8] >= field_count;
+		if (valid) {
+			const int count = pos[8];
+			pos += 9;
+			for (int i = 0; i < count && valid; i++)
+				valid = replayField(pos, _replayEnd, nullptr);
+		}
+
+		if (valid) {
+			const int count = _replayPos[8];
+			_replayPos += 9;
+			for (int i = 0; i < count; i++)
+				replayField(_replayPos, _replayEnd, va_arg(va, void *));
+			return;
+		}
+
+		// The file was not parsed the same way as when the values were
+		// recorded. Forget them, they will be recorded again next time.
+		warning("TextSplitter: Outdated parse cache entry for %s", _fname.c_str());
+		g_parseCache->remove(_fname);
+		g_parseCache->release(_replayBlob);
+		_replayBlob = _replayPos = _replayEnd = nullptr;
+	}
+
+	if (!_recording) {
+		parse(line, fmt, field_count, va, nullptr);
+		return;
+	}
+
+	recordUint32(&_record, offset);
+	recordUint32(&_record, formatHash);
+	const uint countPos = _record.size();
+	_record.push_back(0);
+	const int stored = parse(line, fmt, field_count, va, &_record);
+	if (stored > 255) {
+		// Too many fields to record, don't cache the file at all
+		_recording = false;
+		_record.clear();
+		return;
+	}
+	_record[countPos] = stored;
+}
+
 void TextSplitter::processLine() {
 	if (isEof())
 		return;
 
 	_currLine = _lines[_lineIndex++];
 
-	// Cut off comments
-	char *comment_start = strchr(_currLine, '#');
-	if (comment_start)
-		*comment_start = '\0';
-
-	// Cut off trailing whitespace (including '\r')
-	char *strend = strchr(_currLine, '\0');
-	while (strend > _currLine && Common::isSpace(strend[-1]))
-		strend--;
+	// Cut off comments and trailing whitespace (including '\r'), and
+	// convert to lower case. The last line is left as it is.
+	const bool lowercase = !isEof();
+	char *strend = _currLine;
+	for (char *s = _currLine; *s != '\0' && *s != '#'; s++) {
+		const char c = *s;
+		if (c != ' ' && (c < '\t' || c > '\r')) {
+			strend = s + 1;
+			if (lowercase && c >= 'A' && c <= 'Z')
+				*s = c - 'A' + 'a';
+		}
+	}
 	*strend = '\0';
 
 	// Skip blank lines
 	if (*_currLine == '\0')
 		nextLine();
-
-	// Convert to lower case
-	if (!isEof())
-		for (char *s = _currLine; *s != '\0'; s++)
-			*s = tolower(*s);
 }
 
 } // end of namespace Grim
@@ -23,6 +23,9 @@
 #ifndef GRIM_TEXTSPLIT_HH
 #define GRIM_TEXTSPLIT_HH
 
+#include "common/array.h"
+#include "common/str.h"
+
 namespace Common {
 class SeekableReadStream;
 }
@@ -79,6 +82,13 @@ private:
 	int _numLines, _lineIndex;
 	char **_lines;
 
+	// Values recorded for the parse cache, or replayed from it
+	uint32 _contentHash, _contentSize;
+	const byte *_replayBlob, *_replayPos, *_replayEnd;
+	bool _recording;
+	Common::Array<byte> _record;
+
+	void scanLine(const char *line, const char *fmt, int field_count, va_list va);
 	void processLine();
 };
 
@@ -0,0 +1,215 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/grim/walkgraph.h"
+
+namespace Grim {
+
+WalkGraph::WalkGraph() : _useXZ(false), _search(0) {
+}
+
+void WalkGraph::reset(int nodeCount, bool useXZ) {
+	_useXZ = useXZ;
+
+	_adjacency.resize(nodeCount + 1);
+	for (int i = 0; i <= nodeCount; i++)
+		_adjacency[i] = 0;
+
+	_edges.clear();
+	_bridges.clear();
+
+	_nodes.resize(nodeCount);
+	for (int i = 0; i < nodeCount; i++) {
+		_nodes[i].openSearch = 0;
+		_nodes[i].closedSearch = 0;
+		_nodes[i].pushes = 0;
+	}
+	_search = 0;
+}
+
+void WalkGraph::addEdge(int from, int to, const Common::List<Math::Line3d> &bridges) {
+	assert(from >= 0 && from < getNodeCount() && to >= 0 && to < getNodeCount());
+	assert(_edges.empty() || from >= _edges.back().from);
+
+	Edge edge;
+	edge.from = from;
+	edge.to = to;
+	edge.firstBridge = _bridges.size();
+	edge.bridgeCount = bridges.size();
+	_edges.push_back(edge);
+
+	for (Common::List<Math::Line3d>::const_iterator i = bridges.begin(); i != bridges.end(); ++i)
+		_bridges.push_back(*i);
+
+	// The following nodes have no edges yet
+	for (int i = from + 1; i <= getNodeCount(); i++)
+		_adjacency[i] = _edges.size();
+}
+
+Math::Vector3d WalkGraph::pickBridgePoint(const Edge &edge, const Math::Vector3d &from, const Math::Vector3d &target) {
+	Math::Vector3d best;
+	float bestDist = 1e6f;
+	Math::Line3d l(from, target);
+
+	// Prefer points on the straight line from this node towards the
+	// destination. Otherwise pick the middle point of a bridge that is
+	// closest to the destination.
+	for (int i = edge.firstBridge + edge.bridgeCount - 1; i >= edge.firstBridge; i--) {
+		Math::Line3d bridge = _bridges[i];
+		Math::Vector3d pos;
+
+		if (bridge.intersectLine2d(l, &pos, _useXZ))
+			return pos;
+
+		pos = bridge.middle();
+		float dist = (pos - target).getMagnitude();
+		if (dist < bestDist) {
+			bestDist = dist;
+			best = pos;
+		}
+	}
+
+	return best;
+}
+
+void WalkGraph::pushOpen(int node) {
+	HeapEntry entry;
+	entry.estimate = _nodes[node].cost + _nodes[node].dist;
+	entry.order = _nodes[node].order;
+	entry.node = node;
+	entry.push = ++_nodes[node].pushes;
+
+	int i = _open.size();
+	_open.push_back(entry);
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		if (!(entry < _open[parent]))
+			break;
+
+		_open[i] = _open[parent];
+		i = parent;
+	}
+	_open[i] = entry;
+}
+
+int WalkGraph::popOpen() {
+	while (!_open.empty()) {
+		HeapEntry top = _open[0];
+		HeapEntry last = _open.back();
+		_open.pop_back();
+
+		int count = _open.size();
+		if (count > 0) {
+			int i = 0;
+			for (;;) {
+				int child = i * 2 + 1;
+				if (child >= count)
+					break;
+				if (child + 1 < count && _open[child + 1] < _open[child])
+					child++;
+				if (!(_open[child] < last))
+					break;
+
+				_open[i] = _open[child];
+				i = child;
+			}
+			_open[i] = last;
+		}
+
+		// A node gets pushed again when a cheaper way to it is found,
+		// only the entry made by the latest push is live.
+		const Node &node = _nodes[top.node];
+		if (node.closedSearch != _search && top.push == node.pushes)
+			return top.node;
+	}
+
+	return -1;
+}
+
+bool WalkGraph::findPath(int start, const Math::Vector3d &startPos, const Math::Vector3d &dest, PathQuery &query, Common::List<Math::Vector3d> &path) {
+	if (start < 0 || start >= getNodeCount())
+		return false;
+
+	if (++_search == 0) {
+		for (uint i = 0; i < _nodes.size(); i++) {
+			_nodes[i].openSearch = 0;
+			_nodes[i].closedSearch = 0;
+		}
+		_search = 1;
+	}
+	_open.clear();
+	int reached = 0;
+
+	Node &first = _nodes[start];
+	first.parent = -1;
+	first.order = reached++;
+	first.pos = startPos;
+	first.dist = 0.f;
+	first.cost = 0.f;
+	first.openSearch = _search;
+	first.pushes = 0;
+	pushOpen(start);
+
+	int current;
+	while ((current = popOpen()) >= 0) {
+		Node &node = _nodes[current];
+		node.closedSearch = _search;
+
+		if (query.isGoal(current)) {
+			// Don't put the start position in the path, the only node
+			// without parent is the start one.
+			for (int i = current; _nodes[i].parent >= 0; i = _nodes[i].parent)
+				path.push_back(_nodes[i].pos);
+
+			return true;
+		}
+
+		for (int e = _adjacency[current]; e < _adjacency[current + 1]; e++) {
+			const Edge &edge = _edges[e];
+			Node &n = _nodes[edge.to];
+			if (n.closedSearch == _search || !query.isNodeEnabled(edge.to))
+				continue;
+
+			Math::Vector3d best = pickBridgePoint(edge, node.pos, query.getTarget(edge.to));
+			best = query.adjustStep(node.pos, best);
+
+			float newCost = node.cost + (best - node.pos).getMagnitude();
+			if (n.openSearch == _search && newCost >= n.cost)
+				continue;
+
+			if (n.openSearch != _search) {
+				n.openSearch = _search;
+				n.order = reached++;
+				n.pushes = 0;
+			}
+			n.parent = current;
+			n.pos = best;
+			n.dist = (best - dest).getMagnitude();
+			n.cost = newCost;
+			pushOpen(edge.to);
+		}
+	}
+
+	return false;
+}
+
+} // end of namespace Grim
@@ -0,0 +1,127 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRIM_WALKGRAPH_H
+#define GRIM_WALKGRAPH_H
+
+#include "common/array.h"
+#include "common/list.h"
+
+#include "math/line3d.h"
+#include "math/vector3d.h"
+
+namespace Grim {
+
+/**
+ * The adjacency of the sectors of a set, with the bridges between them,
+ * used to find paths for walking actors.
+ *
+ * Nodes are sector indices. Which sectors can be walked through and where
+ * the path goes is decided by a PathQuery, so the graph stays valid while
+ * sectors are shown and hidden or actors move around.
+ */
+class WalkGraph {
+public:
+	class PathQuery {
+	public:
+		virtual ~PathQuery() {}
+
+		/** Whether the path can go through a node at all. */
+		virtual bool isNodeEnabled(int node) = 0;
+		/** Whether reaching a node ends the path. */
+		virtual bool isGoal(int node) = 0;
+		/** The point to head for once in a node. */
+		virtual Math::Vector3d getTarget(int node) = 0;
+		/** Correct a step of the path, e.g. to go around other actors. */
+		virtual Math::Vector3d adjustStep(const Math::Vector3d &from, const Math::Vector3d &to) = 0;
+	};
+
+	WalkGraph();
+
+	/** Remove all edges, and set the number of nodes. */
+	void reset(int nodeCount, bool useXZ);
+	/**
+	 * Add an edge from a node to another, through the bridges between them.
+	 * Edges must be added in order of the node they start from.
+	 */
+	void addEdge(int from, int to, const Common::List<Math::Line3d> &bridges);
+
+	int getNodeCount() const { return _nodes.size(); }
+	int getEdgeCount() const { return _edges.size(); }
+
+	/**
+	 * Find a path from a point in the start node to the destination.
+	 * On success, the points to walk through are put in path, from the
+	 * last one to the first one, without the start point.
+	 */
+	bool findPath(int start, const Math::Vector3d &startPos, const Math::Vector3d &dest, PathQuery &query, Common::List<Math::Vector3d> &path);
+
+private:
+	struct Edge {
+		int from;
+		int to;
+		int firstBridge;
+		int bridgeCount;
+	};
+
+	struct Node {
+		int parent;
+		Math::Vector3d pos;
+		float dist;
+		float cost;
+		int order;             // Nodes are reached in this order, for ties
+		uint32 openSearch;     // Search the node was last reached in
+		uint32 closedSearch;   // Search the node was last expanded in
+		uint32 pushes;         // Times the node was put in the open heap in this search
+	};
+
+	struct HeapEntry {
+		float estimate;
+		int order;
+		int node;
+		uint32 push;           // Value of the node's push count when this entry was made
+
+		bool operator<(const HeapEntry &other) const {
+			return estimate < other.estimate || (estimate == other.estimate && order < other.order);
+		}
+	};
+
+	Math::Vector3d pickBridgePoint(const Edge &edge, const Math::Vector3d &from, const Math::Vector3d &target);
+	void pushOpen(int node);
+	int popOpen();
+
+	bool _useXZ;
+
+	// The edges of node i are _edges[_adjacency[i]] to _edges[_adjacency[i + 1] - 1]
+	Common::Array<int> _adjacency;
+	Common::Array<Edge> _edges;
+	Common::Array<Math::Line3d> _bridges;
+
+	// Search state, kept between searches to avoid allocations
+	Common::Array<Node> _nodes;
+	Common::Array<HeapEntry> _open;
+	uint32 _search;
+};
+
+} // end of namespace Grim
+
+#endif
@@ -24,6 +24,7 @@
 #include "engines/myst3/database.h"
 #include "engines/myst3/effects.h"
 #include "engines/myst3/inventory.h"
+#include "engines/myst3/moviecache.h"
 #include "engines/myst3/script.h"
 #include "engines/myst3/state.h"
 
@@ -42,6 +43,7 @@ Console::Console(Myst3Engine *vm) : GUI::Debugger(), _vm(vm) {
 	registerCmd("fillInventory",			WRAP_METHOD(Console, Cmd_FillInventory));
 	registerCmd("dumpArchive",			WRAP_METHOD(Console, Cmd_DumpArchive));
 	registerCmd("dumpMasks",			WRAP_METHOD(Console, Cmd_DumpMasks));
+	registerCmd("movieCache",			WRAP_METHOD(Console, Cmd_MovieCache));
 }
 
 Console::~Console() {
@@ -379,6 +381,25 @@ bool Console::Cmd_DumpMasks(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::Cmd_MovieCache(int argc, const char **argv) {
+	const MovieCache *cache = _vm->_movieCache;
+	const MovieCache::ClipList &clips = cache->getClips();
+
+	debugPrintf("Movie frame cache: %d KB used of %d KB\n", cache->getUsedSize() / 1024, cache->getMaxSize() / 1024);
+
+	for (uint i = 0; i < clips.size(); i++) {
+		const MovieCache::Clip *clip = clips[i];
+
+		debugPrintf("%s %d: %d/%d frames (%s), %d KB, %d hits, %d misses%s\n",
+				_vm->_db->getRoomName(clip->room).c_str(), clip->id,
+				clip->cachedFrames, clip->frames.size(), clip->complete ? "complete" : "window",
+				clip->cachedFrames * clip->frameSize / 1024, clip->hits, clip->misses,
+				clip->users ? ", playing" : "");
+	}
+
+	return true;
+}
+
 bool Console::dumpFaceMask(uint16 index, int face, DirectorySubEntry::ResourceType type) {
 	const DirectorySubEntry *maskDesc = _vm->getFileDescription("", index, face, type);
 
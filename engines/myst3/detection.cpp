@@ -226,6 +226,10 @@ public:
 		Common::Platform platform = Common::parsePlatform(ConfMan.get("platform", target));
 		Common::String searchPattern = buildSaveName("*", platform);
 
+		// The game may still be writing one while its menu lists them. The
+		// other savegame functions start by listing them, too.
+		GameState::waitBackgroundSave();
+
 		SaveStateList saveList;
 		Common::StringArray filenames = g_system->getSavefileManager()->listSavefiles(searchPattern);
 
@@ -603,8 +603,7 @@ void PagingMenu::saveMenuSave() {
 	// Save the state and the thumbnail
 	Common::OutSaveFile *save = _vm->getSaveFileManager()->openForSaving(fileName);
 	_vm->_state->setSaveDescription(_saveName);
-	_vm->_state->save(save);
-	delete save;
+	_vm->_state->saveInBackground(save);
 
 	// Do next action
 	_vm->_state->setMenuNextAction(_vm->_state->getMenuSaveAction());
@@ -623,7 +622,8 @@ void PagingMenu::saveLoadErase() {
 	if (_vm->openDialog(dialogIdFromType(kConfirmEraseSavedGame)) != 1)
 		return;
 
-	// Delete the file
+	// Delete the file, once it is completely written
+	_vm->_state->updateBackgroundSave(true);
 	if (!_vm->getSaveFileManager()->removeSavefile(_saveLoadFiles[index]))
 		_vm->openDialog(dialogIdFromType(kErrorEraseSavedGame)); // Error dialog
 
@@ -826,6 +826,8 @@ Common::HashMap<int, Common::String> AlbumMenu::listSaveFiles() {
 }
 
 void AlbumMenu::loadSaves() {
+	_vm->_state->updateBackgroundSave(true);
+
 	Common::HashMap<int, Common::String> saveFiles = listSaveFiles();
 	for (uint i = 0; i < 10; i++) {
 		// Skip empty slots
@@ -933,8 +935,7 @@ void AlbumMenu::saveMenuSave() {
 	// Save the state and the thumbnail
 	Common::OutSaveFile *save = _vm->getSaveFileManager()->openForSaving(fileName);
 	_vm->_state->setSaveDescription(saveName);
-	_vm->_state->save(save);
-	delete save;
+	_vm->_state->saveInBackground(save);
 
 	// Do next action
 	_vm->_state->setMenuNextAction(_vm->_state->getMenuSaveAction());
@@ -20,6 +20,7 @@ MODULE_OBJS := \
 	inventory.o \
 	menu.o \
 	movie.o \
+	moviecache.o \
 	myst3.o \
 	node.o \
 	nodecube.o \
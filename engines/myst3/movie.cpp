@@ -45,7 +45,13 @@ Movie::Movie(Myst3Engine *vm, uint16 id) :
 		_subtitles(0),
 		_volume(0),
 		_additiveBlending(false),
-		_transparency(100) {
+		_transparency(100),
+		_cacheClip(0),
+		_playingFromCache(false),
+		_cacheNeedsUpdate(false),
+		_cachedFrame(-1),
+		_cacheStartTime(0),
+		_cachePauseTime(0) {
 
 	const DirectorySubEntry *binkDesc = _vm->getFileDescription("", id, 0, DirectorySubEntry::kMultitrackMovie);
 
@@ -163,22 +169,117 @@ void Movie::drawOverlay() {
 		draw2d();
 
 	if (_subtitles) {
-		_subtitles->setFrame(adjustFrameForRate(_bink.getCurFrame(), false));
+		_subtitles->setFrame(adjustFrameForRate(getCurFrame(), false));
 		_subtitles->drawOverlay();
 	}
 }
 
 void Movie::drawNextFrameToTexture() {
+	if (_playingFromCache) {
+		const Graphics::Surface *frame = _vm->_movieCache->getFrame(_cacheClip, _cachedFrame + 1);
+
+		if (frame) {
+			_cachedFrame++;
+			_cacheNeedsUpdate = false;
+			updateTexture(frame);
+			return;
+		}
+
+		// Past the cached frames, the decoder has to catch up.
+		// Seeking also resets its clock, which kept running meanwhile.
+		_playingFromCache = false;
+		_bink.seekToFrame(_cachedFrame + 1);
+	}
+
 	const Graphics::Surface *frame = _bink.decodeNextFrame();
 
 	if (frame) {
-		if (_texture)
-			_texture->update(frame);
-		else
-			_texture = _vm->_gfx->createTexture(frame);
+		if (_cacheClip)
+			_vm->_movieCache->addFrame(_cacheClip, _bink.getCurFrame(), *frame);
+
+		updateTexture(frame);
 	}
 }
 
+void Movie::updateTexture(const Graphics::Surface *frame) {
+	if (_texture)
+		_texture->update(frame);
+	else
+		_texture = _vm->_gfx->createTexture(frame);
+}
+
+void Movie::enableFrameCache() {
+	// The audio cannot follow the cached frames
+	if (!_bink.isVideoLoaded() || _bink.getAudioTrackCount() > 0)
+		return;
+
+	_cacheClip = _vm->_movieCache->acquire(_vm->_state->getLocationRoom(), _id, _bink.getFrameCount(),
+			_bink.getWidth(), _bink.getHeight(), _bink.getPixelFormat());
+}
+
+int32 Movie::getCurFrame() {
+	if (_playingFromCache)
+		return _cachedFrame;
+
+	return _bink.getCurFrame();
+}
+
+void Movie::seekToFrame(int32 frame) {
+	if (_cacheClip && _vm->_movieCache->getFrame(_cacheClip, frame)) {
+		// Play from memory until reaching a frame that is not cached
+		_playingFromCache = true;
+		_cacheNeedsUpdate = true;
+		_cachedFrame = frame - 1;
+		_cacheStartTime = g_system->getMillis() - getFrameTime(frame);
+		_cachePauseTime = g_system->getMillis();
+		return;
+	}
+
+	_playingFromCache = false;
+	_bink.seekToFrame(frame);
+}
+
+bool Movie::needsUpdate() {
+	if (!_playingFromCache)
+		return _bink.needsUpdate();
+
+	if (endOfVideo())
+		return false;
+
+	return _cacheNeedsUpdate || getCacheTime() >= getFrameTime(_cachedFrame + 1);
+}
+
+bool Movie::endOfVideo() {
+	if (!_playingFromCache)
+		return _bink.endOfVideo();
+
+	return _cachedFrame >= (int32)_bink.getFrameCount() - 1;
+}
+
+void Movie::pauseVideo(bool pause) {
+	bool wasPaused = _bink.isPaused();
+	_bink.pauseVideo(pause);
+
+	if (wasPaused == _bink.isPaused())
+		return;
+
+	if (pause)
+		_cachePauseTime = g_system->getMillis();
+	else
+		_cacheStartTime += g_system->getMillis() - _cachePauseTime;
+}
+
+uint32 Movie::getFrameTime(int32 frame) {
+	return (Common::Rational(frame * 1000) / _bink.getFrameRate()).toInt();
+}
+
+uint32 Movie::getCacheTime() {
+	if (_bink.isPaused())
+		return _cachePauseTime - _cacheStartTime;
+
+	return g_system->getMillis() - _cacheStartTime;
+}
+
 int32 Movie::adjustFrameForRate(int32 frame, bool dataToBink) {
 	// The scripts give frame numbers for a framerate of 15 im/s
 	// adjust the frame number according to the actual framerate
@@ -203,6 +304,9 @@ void Movie::setEndFrame(int32 v) {
 }
 
 Movie::~Movie() {
+	if (_cacheClip)
+		_vm->_movieCache->release(_cacheClip);
+
 	if (_texture)
 		_vm->_gfx->freeTexture(_texture);
 
@@ -229,6 +333,7 @@ ScriptedMovie::ScriptedMovie(Myst3Engine *vm, uint16 id) :
 		_volumeVar(0),
 		_loop(false),
 		_transparencyVar(0) {
+	enableFrameCache();
 }
 
 void ScriptedMovie::draw() {
@@ -282,20 +387,20 @@ void ScriptedMovie::update() {
 
 		if (newEnabled) {
 			if (_disableWhenComplete
-					|| _bink.getCurFrame() < _startFrame
-					|| _bink.getCurFrame() >= _endFrame
-					|| _bink.endOfVideo()) {
-				_bink.seekToFrame(_startFrame);
+					|| getCurFrame() < _startFrame
+					|| getCurFrame() >= _endFrame
+					|| endOfVideo()) {
+				seekToFrame(_startFrame);
 				_isLastFrame = false;
 			}
 
 			if (!_scriptDriven)
-				_bink.pauseVideo(false);
+				pauseVideo(false);
 
 			drawNextFrameToTexture();
 
 		} else {
-			_bink.pauseVideo(true);
+			pauseVideo(true);
 		}
 	}
 
@@ -306,10 +411,10 @@ void ScriptedMovie::update() {
 			int32 nextFrame = _vm->_state->getVar(_nextFrameReadVar);
 			if (nextFrame > 0 && nextFrame <= (int32)_bink.getFrameCount()) {
 				// Are we changing frame?
-				if (_bink.getCurFrame() != nextFrame - 1) {
+				if (getCurFrame() != nextFrame - 1) {
 					// Don't seek if we just want to display the next frame
-					if (_bink.getCurFrame() + 1 != nextFrame - 1) {
-						_bink.seekToFrame(nextFrame - 1);
+					if (getCurFrame() + 1 != nextFrame - 1) {
+						seekToFrame(nextFrame - 1);
 					}
 					drawNextFrameToTexture();
 				}
@@ -319,29 +424,29 @@ void ScriptedMovie::update() {
 			}
 		}
 
-		if (!_scriptDriven && (_bink.needsUpdate() || _isLastFrame)) {
+		if (!_scriptDriven && (needsUpdate() || _isLastFrame)) {
 			bool complete = false;
 
 			if (_isLastFrame) {
 				_isLastFrame = false;
 
 				if (_loop) {
-					_bink.seekToFrame(_startFrame);
+					seekToFrame(_startFrame);
 					drawNextFrameToTexture();
 				} else {
 					complete = true;
 				}
 			} else {
 				drawNextFrameToTexture();
-				_isLastFrame = _bink.getCurFrame() == (_endFrame - 1);
+				_isLastFrame = getCurFrame() == (_endFrame - 1);
 			}
 
 			if (_nextFrameWriteVar) {
-				_vm->_state->setVar(_nextFrameWriteVar, _bink.getCurFrame() + 1);
+				_vm->_state->setVar(_nextFrameWriteVar, getCurFrame() + 1);
 			}
 
 			if (_disableWhenComplete && complete) {
-				_bink.pauseVideo(true);
+				pauseVideo(true);
 
 				if (_playingVar) {
 					_vm->_state->setVar(_playingVar, 0);
@@ -381,14 +486,14 @@ SimpleMovie::SimpleMovie(Myst3Engine *vm, uint16 id) :
 }
 
 bool SimpleMovie::update() {
-	if (_bink.getCurFrame() < (_startFrame - 1)) {
-		_bink.seekToFrame(_startFrame - 1);
+	if (getCurFrame() < (_startFrame - 1)) {
+		seekToFrame(_startFrame - 1);
 	}
 
 	_bink.setVolume(_volume * Audio::Mixer::kMaxChannelVolume / 100);
 
 	uint16 scriptStartFrame = _vm->_state->getMovieScriptStartFrame();
-	if (scriptStartFrame && _bink.getCurFrame() > scriptStartFrame) {
+	if (scriptStartFrame && getCurFrame() > scriptStartFrame) {
 		uint16 script = _vm->_state->getMovieScript();
 
 		// The control variables are reset before running the script because
@@ -400,7 +505,7 @@ bool SimpleMovie::update() {
 	}
 
 	uint16 ambiantStartFrame = _vm->_state->getMovieAmbiantScriptStartFrame();
-	if (ambiantStartFrame && _bink.getCurFrame() > ambiantStartFrame) {
+	if (ambiantStartFrame && getCurFrame() > ambiantStartFrame) {
 		_vm->runAmbientScripts(_vm->_state->getMovieAmbiantScript());
 		_vm->_state->setMovieAmbiantScriptStartFrame(0);
 		_vm->_state->setMovieAmbiantScript(0);
@@ -408,18 +513,18 @@ bool SimpleMovie::update() {
 
 	if (!_synchronized) {
 		// Play the movie according to the bink file framerate
-		if (_bink.needsUpdate()) {
+		if (needsUpdate()) {
 			drawNextFrameToTexture();
 		}
 	} else {
 		// Draw a movie frame each two engine frames
 		int targetFrame = (_vm->_state->getFrameCount() - _startEngineFrame) >> 2;
-		if (_bink.getCurFrame() < targetFrame) {
+		if (getCurFrame() < targetFrame) {
 			drawNextFrameToTexture();
 		}
 	}
 
-	return !_bink.endOfVideo() && _bink.getCurFrame() < _endFrame;
+	return !endOfVideo() && getCurFrame() < _endFrame;
 }
 
 void SimpleMovie::playStartupSound() {
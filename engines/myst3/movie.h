@@ -24,6 +24,7 @@
 #define MOVIE_H_
 
 #include "engines/myst3/gfx.h"
+#include "engines/myst3/moviecache.h"
 #include "engines/myst3/node.h"
 
 #include "math/vector3d.h"
@@ -81,9 +82,28 @@ protected:
 	bool _additiveBlending;
 	int32 _transparency;
 
+	// When playing from the cache, the decoder is left behind and
+	// the timing is done here
+	MovieCache::Clip *_cacheClip;
+	bool _playingFromCache;
+	bool _cacheNeedsUpdate;
+	int32 _cachedFrame;
+	uint32 _cacheStartTime;
+	uint32 _cachePauseTime;
+
 	int32 adjustFrameForRate(int32 frame, bool dataToBink);
 	void loadPosition(const VideoData &videoData);
 	void drawNextFrameToTexture();
+	void updateTexture(const Graphics::Surface *frame);
+
+	void enableFrameCache();
+	int32 getCurFrame();
+	void seekToFrame(int32 frame);
+	bool needsUpdate();
+	bool endOfVideo();
+	void pauseVideo(bool pause);
+	uint32 getFrameTime(int32 frame);
+	uint32 getCacheTime();
 
 	void draw2d();
 	void draw3d();
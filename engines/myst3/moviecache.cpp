@@ -0,0 +1,173 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/myst3/moviecache.h"
+
+namespace Myst3 {
+
+MovieCache::MovieCache(uint32 maxSize) :
+		_usedSize(0),
+		_maxSize(maxSize),
+		_useCounter(0) {
+}
+
+MovieCache::~MovieCache() {
+	for (uint i = 0; i < _clips.size(); i++)
+		freeClip(_clips[i]);
+}
+
+MovieCache::Clip *MovieCache::acquire(uint32 room, uint16 id, uint32 frameCount, uint16 width, uint16 height, const Graphics::PixelFormat &format) {
+	uint32 frameSize = width * height * format.bytesPerPixel;
+
+	for (uint i = 0; i < _clips.size(); i++) {
+		Clip *clip = _clips[i];
+		if (clip->room == room && clip->id == id) {
+			if (clip->frames.size() == frameCount && clip->frameSize == frameSize) {
+				clip->users++;
+				clip->lastUse = ++_useCounter;
+				return clip;
+			}
+
+			// Not the same movie anymore
+			if (clip->users == 0) {
+				freeClip(clip);
+				_clips.remove_at(i);
+			}
+
+			break;
+		}
+	}
+
+	Clip *clip = new Clip();
+	clip->room = room;
+	clip->id = id;
+	clip->frames.resize(frameCount);
+	clip->frameSize = frameSize;
+	clip->cachedFrames = 0;
+	clip->complete = frameCount * frameSize <= kCompleteClipMaxSize;
+	clip->users = 1;
+	clip->lastUse = ++_useCounter;
+	clip->hits = 0;
+	clip->misses = 0;
+
+	for (uint i = 0; i < frameCount; i++)
+		clip->frames[i] = 0;
+
+	_clips.push_back(clip);
+	return clip;
+}
+
+void MovieCache::release(Clip *clip) {
+	assert(clip->users > 0);
+	clip->users--;
+	clip->lastUse = ++_useCounter;
+}
+
+const Graphics::Surface *MovieCache::getFrame(Clip *clip, int32 frame) {
+	if (frame < 0 || frame >= (int32)clip->frames.size() || !clip->frames[frame]) {
+		clip->misses++;
+		return 0;
+	}
+
+	clip->hits++;
+	return clip->frames[frame];
+}
+
+void MovieCache::addFrame(Clip *clip, int32 frame, const Graphics::Surface &surface) {
+	if (frame < 0 || frame >= (int32)clip->frames.size() || clip->frames[frame])
+		return;
+
+	if ((uint32)(surface.w * surface.h * surface.format.bytesPerPixel) != clip->frameSize)
+		return;
+
+	// Longer clips only keep the frames around the playhead
+	if (!clip->complete) {
+		for (uint32 i = 0; i < clip->frames.size(); i++)
+			if (clip->frames[i] && ABS<int32>((int32)i - frame) > kWindowFrames)
+				freeFrame(clip, i);
+	}
+
+	while (_usedSize + clip->frameSize > _maxSize) {
+		if (!evictUnusedClip() && !evictFurthestFrame(clip, frame))
+			return;
+	}
+
+	Graphics::Surface *copy = new Graphics::Surface();
+	copy->copyFrom(surface);
+
+	clip->frames[frame] = copy;
+	clip->cachedFrames++;
+	_usedSize += clip->frameSize;
+}
+
+void MovieCache::freeFrame(Clip *clip, uint32 frame) {
+	Graphics::Surface *surface = clip->frames[frame];
+	if (!surface)
+		return;
+
+	surface->free();
+	delete surface;
+
+	clip->frames[frame] = 0;
+	clip->cachedFrames--;
+	_usedSize -= clip->frameSize;
+}
+
+void MovieCache::freeClip(Clip *clip) {
+	for (uint32 i = 0; i < clip->frames.size(); i++)
+		freeFrame(clip, i);
+
+	delete clip;
+}
+
+bool MovieCache::evictUnusedClip() {
+	int oldest = -1;
+
+	for (uint i = 0; i < _clips.size(); i++) {
+		Clip *clip = _clips[i];
+		if (clip->users == 0 && (oldest < 0 || clip->lastUse < _clips[oldest]->lastUse))
+			oldest = i;
+	}
+
+	if (oldest < 0)
+		return false;
+
+	freeClip(_clips[oldest]);
+	_clips.remove_at(oldest);
+	return true;
+}
+
+bool MovieCache::evictFurthestFrame(Clip *clip, int32 frame) {
+	int32 furthest = -1;
+
+	for (uint32 i = 0; i < clip->frames.size(); i++)
+		if (clip->frames[i] && (furthest < 0 || ABS<int32>((int32)i - frame) > ABS<int32>(furthest - frame)))
+			furthest = i;
+
+	if (furthest < 0)
+		return false;
+
+	freeFrame(clip, furthest);
+	return true;
+}
+
+} // End of namespace Myst3
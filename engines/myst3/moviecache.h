@@ -0,0 +1,102 @@
+/* ResidualVM - A 3D game interpreter
+ *
+ * ResidualVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the AUTHORS
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef MOVIECACHE_H_
+#define MOVIECACHE_H_
+
+#include "common/array.h"
+
+#include "graphics/surface.h"
+
+namespace Myst3 {
+
+/**
+ * Decoded movie frames kept in memory
+ *
+ * Scripted movies loop and get scrubbed back and forth by the puzzles.
+ * Seeking back in a Bink file means decoding again from the previous
+ * keyframe, so the frames are kept around instead. Short clips are kept
+ * entirely, longer ones only around the current frame. The memory used
+ * by all the clips is bounded.
+ */
+class MovieCache {
+public:
+	/** The frames of one movie */
+	struct Clip {
+		uint32 room;
+		uint16 id;
+		Common::Array<Graphics::Surface *> frames;
+		uint32 frameSize;
+		uint32 cachedFrames;
+		bool complete;
+
+		uint32 users;
+		uint32 lastUse;
+		uint32 hits;
+		uint32 misses;
+	};
+
+	typedef Common::Array<Clip *> ClipList;
+
+	explicit MovieCache(uint32 maxSize = kDefaultMaxSize);
+	~MovieCache();
+
+	/**
+	 * Get the clip for a movie, keeping the frames cached when it was
+	 * last played. It must be released when the movie is destroyed.
+	 */
+	Clip *acquire(uint32 room, uint16 id, uint32 frameCount, uint16 width, uint16 height, const Graphics::PixelFormat &format);
+	void release(Clip *clip);
+
+	/** Get a cached frame, or 0 if it needs to be decoded */
+	const Graphics::Surface *getFrame(Clip *clip, int32 frame);
+
+	/** Keep a decoded frame, evicting the ones furthest from it if needed */
+	void addFrame(Clip *clip, int32 frame, const Graphics::Surface &surface);
+
+	uint32 getUsedSize() const { return _usedSize; }
+	uint32 getMaxSize() const { return _maxSize; }
+	const ClipList &getClips() const { return _clips; }
+
+private:
+	static const uint32 kDefaultMaxSize = 64 * 1024 * 1024;
+
+	/** Clips up to this size are kept entirely */
+	static const uint32 kCompleteClipMaxSize = 12 * 1024 * 1024;
+
+	/** Number of frames kept on each side of the current frame for longer clips */
+	static const int32 kWindowFrames = 30;
+
+	ClipList _clips;
+	uint32 _usedSize;
+	uint32 _maxSize;
+	uint32 _useCounter;
+
+	void freeFrame(Clip *clip, uint32 frame);
+	void freeClip(Clip *clip);
+	bool evictUnusedClip();
+	bool evictFurthestFrame(Clip *clip, int32 frame);
+};
+
+} // End of namespace Myst3
+
+#endif // MOVIECACHE_H_
@@ -47,6 +47,7 @@
 #include "engines/myst3/menu.h"
 #include "engines/myst3/sound.h"
 #include "engines/myst3/ambient.h"
+#include "engines/myst3/moviecache.h"
 #include "engines/myst3/transition.h"
 
 #include "image/jpeg.h"
@@ -73,7 +74,7 @@ Myst3Engine::Myst3Engine(OSystem *syst, const Myst3GameDescription *version) :
 		_db(0), _console(0), _scriptEngine(0),
 		_state(0), _node(0), _scene(0), _archiveNode(0),
 		_cursor(0), _inventory(0), _gfx(0), _menu(0),
-		_rnd(0), _sound(0), _ambient(0),
+		_rnd(0), _sound(0), _ambient(0), _movieCache(0),
 		_inputSpacePressed(false), _inputEnterPressed(false),
 		_inputEscapePressed(false), _inputTildePressed(false),
 		_menuAction(0), _projectorBackground(0),
@@ -132,6 +133,7 @@ Myst3Engine::~Myst3Engine() {
 	delete _rnd;
 	delete _sound;
 	delete _ambient;
+	delete _movieCache;
 	delete _gfx;
 }
 
@@ -157,6 +159,7 @@ Common::Error Myst3Engine::run() {
 	_gfx = createRenderer(_system);
 	_sound = new Sound(this);
 	_ambient = new Ambient(this);
+	_movieCache = new MovieCache();
 	_rnd = new Common::RandomSource("sprint");
 	_console = new Console(this);
 	_scriptEngine = new Script(this);
@@ -208,6 +211,8 @@ Common::Error Myst3Engine::run() {
 			_menuAction = 0;
 		}
 
+		_state->updateBackgroundSave(false);
+
 		drawFrame();
 	}
 
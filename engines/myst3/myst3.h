@@ -90,6 +90,7 @@ class Renderer;
 class Menu;
 class Sound;
 class Ambient;
+class MovieCache;
 class ShakeEffect;
 class RotationEffect;
 class Transition;
@@ -115,6 +116,7 @@ public:
 	Database *_db;
 	Sound *_sound;
 	Ambient *_ambient;
+	MovieCache *_movieCache;
 	
 	Common::RandomSource *_rnd;
 
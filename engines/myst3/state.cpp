@@ -24,10 +24,27 @@
 #include "engines/myst3/database.h"
 
 #include "common/debug-channels.h"
+#include "common/mutex.h"
 #include "common/savefile.h"
 
 namespace Myst3 {
 
+struct GameState::BackgroundSave {
+	StateData data;
+	Common::OutSaveFile *saveFile;
+	OSystem::WorkerJobRef job;
+	uint32 startTime;
+	uint32 snapshotTime;
+
+	// Set by the worker thread
+	Common::Mutex mutex;
+	bool done;
+	bool failed;
+};
+
+// The save whose job has not been waited for yet
+GameState::BackgroundSave *GameState::_pendingSave = nullptr;
+
 GameState::StateData::StateData() {
 	version = GameState::kSaveVersion;
 	gameRunning = true;
@@ -77,7 +94,7 @@ GameState::StateData::StateData() {
 }
 
 GameState::GameState(Myst3Engine *vm):
-		_vm(vm) {
+		_vm(vm), _backgroundSave(nullptr) {
 
 #define VAR(var, x, unk) _varDescriptions.setVal(#x, VarDescription(var, #x, unk));
 
@@ -386,6 +403,7 @@ GameState::GameState(Myst3Engine *vm):
 }
 
 GameState::~GameState() {
+	updateBackgroundSave(true);
 }
 
 void GameState::syncFloat(Common::Serializer &s, float &val,
@@ -501,6 +519,10 @@ void GameState::newGame() {
 }
 
 bool GameState::load(const Common::String &file) {
+	// The save may belong to the engine state rather than this one, the
+	// engine loop still reports it
+	waitBackgroundSave();
+
 	Common::InSaveFile *saveFile = _vm->getSaveFileManager()->openForLoading(file);
 	Common::Serializer s = Common::Serializer(saveFile, 0);
 	_data.syncWithSaveGame(s);
@@ -511,8 +533,16 @@ bool GameState::load(const Common::String &file) {
 	return true;
 }
 
-bool GameState::save(Common::OutSaveFile *saveFile) {
-	Common::Serializer s = Common::Serializer(0, saveFile);
+void GameState::saveInBackground(Common::OutSaveFile *saveFile) {
+	// Only one save is written at a time
+	updateBackgroundSave(true);
+
+	if (!saveFile) {
+		warning("Unable to create the savegame");
+		return;
+	}
+
+	uint32 startTime = g_system->getMillis();
 
 	// Update save creation info
 	TimeDate t;
@@ -523,11 +553,62 @@ bool GameState::save(Common::OutSaveFile *saveFile) {
 	_data.saveHour = t.tm_hour;
 	_data.saveMinute = t.tm_min;
 
-	_data.gameRunning = false;
-	_data.syncWithSaveGame(s);
-	_data.gameRunning = true;
+	// The thumbnail is shared with the copy, since it is replaced rather
+	// than modified. Serializing it and compressing the file are left to
+	// the worker thread.
+	_backgroundSave = new BackgroundSave();
+	_backgroundSave->data = _data;
+	_backgroundSave->data.gameRunning = false;
+	_backgroundSave->saveFile = saveFile;
+	_backgroundSave->startTime = startTime;
+	_backgroundSave->snapshotTime = g_system->getMillis() - startTime;
+	_backgroundSave->done = false;
+	_backgroundSave->failed = false;
+	_backgroundSave->job = g_system->startWorkerJob(backgroundSaveJob, _backgroundSave);
+	_pendingSave = _backgroundSave;
+}
 
-	return true;
+void GameState::backgroundSaveJob(void *param) {
+	BackgroundSave *save = (BackgroundSave *)param;
+
+	Common::Serializer s = Common::Serializer(0, save->saveFile);
+	save->data.syncWithSaveGame(s);
+	save->saveFile->finalize();
+
+	Common::StackLock lock(save->mutex);
+	save->failed = save->saveFile->err();
+	save->done = true;
+}
+
+void GameState::updateBackgroundSave(bool wait) {
+	if (!_backgroundSave)
+		return;
+
+	if (!wait) {
+		Common::StackLock lock(_backgroundSave->mutex);
+		if (!_backgroundSave->done)
+			return;
+	}
+
+	if (_pendingSave == _backgroundSave)
+		waitBackgroundSave();
+
+	if (_backgroundSave->failed)
+		warning("Unable to write the savegame");
+	debugC(kDebugSaveLoad, "Saved the game: the snapshot took %d ms, the whole save %d ms",
+	       _backgroundSave->snapshotTime, g_system->getMillis() - _backgroundSave->startTime);
+
+	delete _backgroundSave->saveFile;
+	delete _backgroundSave;
+	_backgroundSave = nullptr;
+}
+
+void GameState::waitBackgroundSave() {
+	if (!_pendingSave)
+		return;
+
+	g_system->waitWorkerJob(_pendingSave->job);
+	_pendingSave = nullptr;
 }
 
 Graphics::Surface *GameState::getSaveThumbnail() const {
@@ -50,7 +50,21 @@ public:
 
 	void newGame();
 	bool load(const Common::String &file);
-	bool save(Common::OutSaveFile *save);
+	/**
+	 * Save the state on a worker thread, which then deletes the file. Only
+	 * a copy of the state data is made on the calling thread.
+	 */
+	void saveInBackground(Common::OutSaveFile *saveFile);
+	/**
+	 * Report the save running on a worker thread once it is over. Saves
+	 * must be waited for before reading a savegame.
+	 */
+	void updateBackgroundSave(bool wait);
+	/**
+	 * Wait for the save being written on a worker thread, if any, without
+	 * reporting it. For the code reading savegames outside of the engine.
+	 */
+	static void waitBackgroundSave();
 
 	int32 getVar(uint16 var);
 	void setVar(uint16 var, int32 value);
@@ -388,12 +402,18 @@ public:
 	static const uint kThumbnailHeight = 135;
 
 private:
+	struct BackgroundSave;
+
 	Myst3Engine *_vm;
 
 	static const uint32 kSaveVersion = 149;
 
 	StateData _data;
 
+	BackgroundSave *_backgroundSave;
+	static BackgroundSave *_pendingSave;
+	static void backgroundSaveJob(void *param);
+
 	struct VarDescription {
 		VarDescription() : var(0), name(0), unknown(0) {}
 		VarDescription(uint16 v, const char *n, bool u) : var(v), name(n), unknown(u) {}
@@ -50,6 +50,7 @@ VisualSmacker::~VisualSmacker() {
 	delete _texture;
 	delete _smacker;
 	delete _surfaceRenderer;
+	_convertedSurface.free();
 }
 
 void VisualSmacker::load(Common::SeekableReadStream *stream) {
@@ -75,34 +76,36 @@ void VisualSmacker::update() {
 		_surface = _smacker->decodeNextFrame();
 		const byte *palette = _smacker->getPalette();
 
-		// Convert the surface to RGBA
-		Graphics::Surface *convertedSurface = new Graphics::Surface();
-		convertedSurface->create(_surface->w, _surface->h, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24));
+		if (_convertedSurface.w != _surface->w || _convertedSurface.h != _surface->h) {
+			_convertedSurface.free();
+			_convertedSurface.create(_surface->w, _surface->h, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24));
+		}
+
+		// Convert the palette once, then the surface to RGBA with lookups
+		uint32 colors[256];
+		for (int i = 0; i < 256; i++) {
+			byte r = palette[i * 3];
+			byte g = palette[i * 3 + 1];
+			byte b = palette[i * 3 + 2];
+
+			if (r != 0 || g != 255 || b != 255) {
+				colors[i] = _convertedSurface.format.RGBToColor(r, g, b);
+			} else {
+				// Cyan is the transparent color
+				colors[i] = 0;
+			}
+		}
 
 		for (int y = 0; y < _surface->h; y++) {
 			const byte *srcRow = (const byte *)_surface->getBasePtr(0, y);
-			uint32 *dstRow = (uint32 *)convertedSurface->getBasePtr(0, y);
+			uint32 *dstRow = (uint32 *)_convertedSurface.getBasePtr(0, y);
 
 			for (int x = 0; x < _surface->w; x++) {
-				byte index = *srcRow++;
-
-				byte r = palette[index * 3];
-				byte g = palette[index * 3 + 1];
-				byte b = palette[index * 3 + 2];
-
-				if (r != 0 || g != 255 || b != 255) {
-					*dstRow++ = convertedSurface->format.RGBToColor(r, g, b);
-				} else {
-					// Cyan is the transparent color
-					*dstRow++ = 0;
-				}
+				*dstRow++ = colors[*srcRow++];
 			}
 		}
 
-		_texture->update(convertedSurface);
-
-		convertedSurface->free();
-		delete convertedSurface;
+		_texture->update(&_convertedSurface);
 	}
 }
 
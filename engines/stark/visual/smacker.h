@@ -28,14 +28,12 @@
 #include "common/rect.h"
 #include "common/stream.h"
 
+#include "graphics/surface.h"
+
 namespace Video {
 class SmackerDecoder;
 }
 
-namespace Graphics {
-struct Surface;
-}
-
 namespace Stark {
 
 namespace Gfx {
@@ -80,6 +78,7 @@ public:
 private:
 	Video::SmackerDecoder *_smacker;
 	const Graphics::Surface *_surface;
+	Graphics::Surface _convertedSurface;
 
 	Common::Point _position;
 	Gfx::Driver *_gfx;
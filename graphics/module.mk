@@ -24,6 +24,7 @@ MODULE_OBJS := \
 	VectorRenderer.o \
 	VectorRendererSpec.o \
 	wincursor.o \
+	yuv_dsp.o \
 	yuv_to_rgb.o \
 	yuva_to_rgba.o \
 	pixelbuffer.o \
@@ -0,0 +1,648 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/simd.h"
+#include "common/util.h"
+
+#include "graphics/yuv_dsp.h"
+
+namespace Graphics {
+
+namespace YUVDSP {
+
+/**
+ * Fixed point factor for scaling ITU luminance values from [0, 219] to
+ * [0, 255]: c + ((c * kITUScale) >> 16) equals c * 255 / 219 in that range.
+ */
+static const int kITUScale = 10775;
+
+/**
+ * Fractional parts of the chroma factors, in 1/65536. For chroma offsets
+ * in [-128, 127] they give exactly the truncated values of the floating
+ * point factors the managers' tables are built from.
+ */
+enum {
+	kCrToR = 26285, ///< 0.419 / 0.299 = 1 + kCrToR / 65536
+	kCrToG = 46773, ///< 0.299 / 0.419 = kCrToG / 65536
+	kCbToG = 22567, ///< 0.114 / 0.331 = kCbToG / 65536
+	kCbToB = 50685  ///< 0.587 / 0.331 = 1 + kCbToB / 65536
+};
+
+/** Number of pixels interpolated at once by the YUV410 converter. */
+enum {
+	kChunkSize = 256
+};
+
+/** Where the color channels go in a destination pixel. */
+struct Packing {
+	int rLoss, rShift;
+	int gLoss, gShift;
+	int bLoss, bShift;
+	int aLoss, aShift;
+	uint32 alpha; ///< Alpha bits of opaque pixels, used when there is no alpha plane
+
+	/**
+	 * Whether the pixels have 4 bytes with one channel each, e.g. RGBA8888,
+	 * so that the vector code can store them by interleaving bytes. The
+	 * positions are byte offsets in memory; a format without alpha has its
+	 * unused byte at aPos.
+	 */
+	bool bytePositions;
+	int rPos, gPos, bPos, aPos;
+};
+
+static Packing makePacking(const PixelFormat &format) {
+	Packing p;
+	p.rLoss = format.rLoss;
+	p.rShift = format.rShift;
+	p.gLoss = format.gLoss;
+	p.gShift = format.gShift;
+	p.bLoss = format.bLoss;
+	p.bShift = format.bShift;
+	p.aLoss = format.aLoss;
+	p.aShift = format.aShift;
+	p.alpha = (0xFF >> format.aLoss) << format.aShift;
+
+	p.bytePositions = false;
+	p.rPos = p.gPos = p.bPos = p.aPos = 0;
+
+	if (format.bytesPerPixel == 4 && !format.rLoss && !format.gLoss && !format.bLoss && (!format.aLoss || format.aLoss == 8) &&
+	    !(format.rShift & 7) && !(format.gShift & 7) && !(format.bShift & 7) && !(format.aShift & 7)) {
+		p.rPos = format.rShift >> 3;
+		p.gPos = format.gShift >> 3;
+		p.bPos = format.bShift >> 3;
+		if (!format.aLoss) {
+			p.aPos = format.aShift >> 3;
+		} else {
+			// Use the byte no color channel is in
+			p.aPos = 0 + 1 + 2 + 3 - p.rPos - p.gPos - p.bPos;
+		}
+
+		const int used = (1 << p.rPos) | (1 << p.gPos) | (1 << p.bPos) | (1 << p.aPos);
+		p.bytePositions = (used == 0xF);
+
+#ifdef SCUMM_BIG_ENDIAN
+		p.rPos = 3 - p.rPos;
+		p.gPos = 3 - p.gPos;
+		p.bPos = 3 - p.bPos;
+		p.aPos = 3 - p.aPos;
+#endif
+	}
+
+	return p;
+}
+
+/** Multiply a chroma offset by a factor, truncating towards zero. */
+static inline int scaleChroma(int c, int whole, int frac) {
+	const int a = ABS(c);
+	const int t = a * whole + ((a * frac) >> 16);
+	return c < 0 ? -t : t;
+}
+
+template<bool kITU>
+static inline int clipChannel(int value) {
+	if (kITU) {
+		value = CLIP(value, 16, 235) - 16;
+		return value + ((value * kITUScale) >> 16);
+	}
+
+	return CLIP(value, 0, 255);
+}
+
+template<bool kITU, typename PixelInt>
+static inline void convertPixelC(byte *dst, const Packing &p, int y, const byte *a, int rTerm, int gTerm, int bTerm) {
+	uint32 color = ((clipChannel<kITU>(y + rTerm) >> p.rLoss) << p.rShift) |
+	               ((clipChannel<kITU>(y + gTerm) >> p.gLoss) << p.gShift) |
+	               ((clipChannel<kITU>(y + bTerm) >> p.bLoss) << p.bShift);
+
+	if (a)
+		color |= (*a >> p.aLoss) << p.aShift;
+	else
+		color |= p.alpha;
+
+	*(PixelInt *)dst = (PixelInt)color;
+}
+
+/**
+ * Convert one row of pixels starting at 'start', or two rows sharing one
+ * row of chroma samples for YUV420.
+ */
+template<bool kITU, typename PixelInt>
+static void convertRowsC(byte *dst, int dstPitch, const Packing &p, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, const byte *aSrc, int start, int width, bool is420) {
+	for (int x = start; x < width; x++) {
+		const int t = is420 ? (x >> 1) : x;
+		const int cb = uSrc[t] - 128;
+		const int cr = vSrc[t] - 128;
+
+		const int rTerm = scaleChroma(cr, 1, kCrToR);
+		const int gTerm = -scaleChroma(cr, 0, kCrToG) - scaleChroma(cb, 0, kCbToG);
+		const int bTerm = scaleChroma(cb, 1, kCbToB);
+
+		byte *out = dst + x * sizeof(PixelInt);
+		convertPixelC<kITU, PixelInt>(out, p, ySrc[x], aSrc ? aSrc + x : 0, rTerm, gTerm, bTerm);
+		if (is420)
+			convertPixelC<kITU, PixelInt>(out + dstPitch, p, ySrc[yPitch + x], aSrc ? aSrc + yPitch + x : 0, rTerm, gTerm, bTerm);
+	}
+}
+
+#if defined(SCUMMVM_SSE2)
+
+template<bool kITU>
+static inline __m128i clipSSE2(__m128i value) {
+	if (kITU) {
+		const __m128i c16 = _mm_set1_epi16(16);
+		value = _mm_sub_epi16(_mm_max_epi16(_mm_min_epi16(value, _mm_set1_epi16(235)), c16), c16);
+		return _mm_add_epi16(value, _mm_mulhi_epu16(value, _mm_set1_epi16(kITUScale)));
+	}
+
+	return _mm_max_epi16(_mm_min_epi16(value, _mm_set1_epi16(255)), _mm_setzero_si128());
+}
+
+static inline __m128i scaleChromaSSE2(__m128i absC, __m128i sign, int whole, int frac) {
+	__m128i t = _mm_mulhi_epu16(absC, _mm_set1_epi16((int16)frac));
+	if (whole)
+		t = _mm_add_epi16(t, absC);
+	return _mm_sub_epi16(_mm_xor_si128(t, sign), sign);
+}
+
+/** Compute the values added to the luminance for 8 chroma samples, widened to 16 bits. */
+static inline void chromaTermsSSE2(__m128i u, __m128i v, __m128i &r, __m128i &g, __m128i &b) {
+	const __m128i c128 = _mm_set1_epi16(128);
+	const __m128i cb = _mm_sub_epi16(u, c128);
+	const __m128i cr = _mm_sub_epi16(v, c128);
+	const __m128i cbSign = _mm_srai_epi16(cb, 15);
+	const __m128i crSign = _mm_srai_epi16(cr, 15);
+	const __m128i cbAbs = _mm_sub_epi16(_mm_xor_si128(cb, cbSign), cbSign);
+	const __m128i crAbs = _mm_sub_epi16(_mm_xor_si128(cr, crSign), crSign);
+
+	r = scaleChromaSSE2(crAbs, crSign, 1, kCrToR);
+	g = _mm_sub_epi16(_mm_setzero_si128(), _mm_add_epi16(scaleChromaSSE2(crAbs, crSign, 0, kCrToG), scaleChromaSSE2(cbAbs, cbSign, 0, kCbToG)));
+	b = scaleChromaSSE2(cbAbs, cbSign, 1, kCbToB);
+}
+
+/** The values added to the luminance of 16 pixels. */
+struct ChromaSSE2 {
+	__m128i rLo, rHi;
+	__m128i gLo, gHi;
+	__m128i bLo, bHi;
+};
+
+struct PackingSSE2 {
+	__m128i rLoss, rShift;
+	__m128i gLoss, gShift;
+	__m128i bLoss, bShift;
+	__m128i aLoss, aShift;
+	__m128i alpha8, alpha16, alpha32;
+	bool hasAlpha;
+	bool bytePositions;
+	int rPos, gPos, bPos, aPos;
+
+	explicit PackingSSE2(const Packing &p) {
+		rLoss = _mm_cvtsi32_si128(p.rLoss);
+		rShift = _mm_cvtsi32_si128(p.rShift);
+		gLoss = _mm_cvtsi32_si128(p.gLoss);
+		gShift = _mm_cvtsi32_si128(p.gShift);
+		bLoss = _mm_cvtsi32_si128(p.bLoss);
+		bShift = _mm_cvtsi32_si128(p.bShift);
+		aLoss = _mm_cvtsi32_si128(p.aLoss);
+		aShift = _mm_cvtsi32_si128(p.aShift);
+		alpha8 = _mm_set1_epi8((char)(0xFF >> p.aLoss));
+		alpha16 = _mm_set1_epi16((int16)p.alpha);
+		alpha32 = _mm_set1_epi32(p.alpha);
+		hasAlpha = (p.aLoss < 8);
+		bytePositions = p.bytePositions;
+		rPos = p.rPos;
+		gPos = p.gPos;
+		bPos = p.bPos;
+		aPos = p.aPos;
+	}
+};
+
+/** Store 8 pixels of 16 bits. The channels are clipped 16-bit values. */
+static inline void store16SSE2(byte *dst, const PackingSSE2 &p, __m128i r, __m128i g, __m128i b, __m128i alpha) {
+	r = _mm_sll_epi16(_mm_srl_epi16(r, p.rLoss), p.rShift);
+	g = _mm_sll_epi16(_mm_srl_epi16(g, p.gLoss), p.gShift);
+	b = _mm_sll_epi16(_mm_srl_epi16(b, p.bLoss), p.bShift);
+	_mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, alpha)));
+}
+
+/** Store 8 pixels of 32 bits. The channels are clipped 16-bit values, the alpha is already packed. */
+static inline void store32SSE2(byte *dst, const PackingSSE2 &p, __m128i r, __m128i g, __m128i b, __m128i alphaLo, __m128i alphaHi) {
+	const __m128i zero = _mm_setzero_si128();
+	r = _mm_srl_epi16(r, p.rLoss);
+	g = _mm_srl_epi16(g, p.gLoss);
+	b = _mm_srl_epi16(b, p.bLoss);
+
+	const __m128i lo = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), p.rShift),
+	                                             _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), p.gShift)),
+	                                _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(b, zero), p.bShift), alphaLo));
+	const __m128i hi = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), p.rShift),
+	                                             _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), p.gShift)),
+	                                _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(b, zero), p.bShift), alphaHi));
+
+	_mm_storeu_si128((__m128i *)dst, lo);
+	_mm_storeu_si128((__m128i *)(dst + 16), hi);
+}
+
+/** Convert 16 pixels of one row. */
+template<bool kITU, typename PixelInt>
+static FORCEINLINE void convertPixelsSSE2(byte *dst, const PackingSSE2 &p, const byte *ySrc, const byte *aSrc, const ChromaSSE2 &c) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i y = _mm_loadu_si128((const __m128i *)ySrc);
+	const __m128i yLo = _mm_unpacklo_epi8(y, zero);
+	const __m128i yHi = _mm_unpackhi_epi8(y, zero);
+
+	const __m128i rLo = clipSSE2<kITU>(_mm_add_epi16(yLo, c.rLo));
+	const __m128i rHi = clipSSE2<kITU>(_mm_add_epi16(yHi, c.rHi));
+	const __m128i gLo = clipSSE2<kITU>(_mm_add_epi16(yLo, c.gLo));
+	const __m128i gHi = clipSSE2<kITU>(_mm_add_epi16(yHi, c.gHi));
+	const __m128i bLo = clipSSE2<kITU>(_mm_add_epi16(yLo, c.bLo));
+	const __m128i bHi = clipSSE2<kITU>(_mm_add_epi16(yHi, c.bHi));
+
+	if (sizeof(PixelInt) == 2) {
+		__m128i aLo = p.alpha16, aHi = p.alpha16;
+		if (aSrc) {
+			const __m128i a = _mm_loadu_si128((const __m128i *)aSrc);
+			aLo = _mm_sll_epi16(_mm_srl_epi16(_mm_unpacklo_epi8(a, zero), p.aLoss), p.aShift);
+			aHi = _mm_sll_epi16(_mm_srl_epi16(_mm_unpackhi_epi8(a, zero), p.aLoss), p.aShift);
+		}
+
+		store16SSE2(dst, p, rLo, gLo, bLo, aLo);
+		store16SSE2(dst + 16, p, rHi, gHi, bHi, aHi);
+	} else if (p.bytePositions) {
+		// Interleave the channel bytes in memory order
+		__m128i channels[4];
+		channels[p.rPos] = _mm_packus_epi16(rLo, rHi);
+		channels[p.gPos] = _mm_packus_epi16(gLo, gHi);
+		channels[p.bPos] = _mm_packus_epi16(bLo, bHi);
+		channels[p.aPos] = (aSrc && p.hasAlpha) ? _mm_loadu_si128((const __m128i *)aSrc) : p.alpha8;
+
+		const __m128i lo01 = _mm_unpacklo_epi8(channels[0], channels[1]);
+		const __m128i hi01 = _mm_unpackhi_epi8(channels[0], channels[1]);
+		const __m128i lo23 = _mm_unpacklo_epi8(channels[2], channels[3]);
+		const __m128i hi23 = _mm_unpackhi_epi8(channels[2], channels[3]);
+
+		_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(lo01, lo23));
+		_mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(lo01, lo23));
+		_mm_storeu_si128((__m128i *)(dst + 32), _mm_unpacklo_epi16(hi01, hi23));
+		_mm_storeu_si128((__m128i *)(dst + 48), _mm_unpackhi_epi16(hi01, hi23));
+	} else {
+		__m128i a0 = p.alpha32, a1 = p.alpha32, a2 = p.alpha32, a3 = p.alpha32;
+		if (aSrc) {
+			const __m128i a = _mm_loadu_si128((const __m128i *)aSrc);
+			const __m128i aLo = _mm_srl_epi16(_mm_unpacklo_epi8(a, zero), p.aLoss);
+			const __m128i aHi = _mm_srl_epi16(_mm_unpackhi_epi8(a, zero), p.aLoss);
+			a0 = _mm_sll_epi32(_mm_unpacklo_epi16(aLo, zero), p.aShift);
+			a1 = _mm_sll_epi32(_mm_unpackhi_epi16(aLo, zero), p.aShift);
+			a2 = _mm_sll_epi32(_mm_unpacklo_epi16(aHi, zero), p.aShift);
+			a3 = _mm_sll_epi32(_mm_unpackhi_epi16(aHi, zero), p.aShift);
+		}
+
+		store32SSE2(dst, p, rLo, gLo, bLo, a0, a1);
+		store32SSE2(dst + 32, p, rHi, gHi, bHi, a2, a3);
+	}
+}
+
+/** Convert the rows in steps of 16 pixels, returning how many were done. */
+template<bool kITU, typename PixelInt>
+static int convertRowsSIMD(byte *dst, int dstPitch, const Packing &packing, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, const byte *aSrc, int width, bool is420) {
+	const PackingSSE2 p(packing);
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		ChromaSSE2 c;
+		if (is420) {
+			// Each chroma sample covers two pixels
+			const __m128i u = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(uSrc + (x >> 1))), zero);
+			const __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(vSrc + (x >> 1))), zero);
+			__m128i r, g, b;
+			chromaTermsSSE2(u, v, r, g, b);
+			c.rLo = _mm_unpacklo_epi16(r, r);
+			c.rHi = _mm_unpackhi_epi16(r, r);
+			c.gLo = _mm_unpacklo_epi16(g, g);
+			c.gHi = _mm_unpackhi_epi16(g, g);
+			c.bLo = _mm_unpacklo_epi16(b, b);
+			c.bHi = _mm_unpackhi_epi16(b, b);
+		} else {
+			const __m128i u = _mm_loadu_si128((const __m128i *)(uSrc + x));
+			const __m128i v = _mm_loadu_si128((const __m128i *)(vSrc + x));
+			chromaTermsSSE2(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(v, zero), c.rLo, c.gLo, c.bLo);
+			chromaTermsSSE2(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(v, zero), c.rHi, c.gHi, c.bHi);
+		}
+
+		byte *out = dst + x * sizeof(PixelInt);
+		convertPixelsSSE2<kITU, PixelInt>(out, p, ySrc + x, aSrc ? aSrc + x : 0, c);
+		if (is420)
+			convertPixelsSSE2<kITU, PixelInt>(out + dstPitch, p, ySrc + yPitch + x, aSrc ? aSrc + yPitch + x : 0, c);
+	}
+
+	return x;
+}
+
+#elif defined(SCUMMVM_NEON)
+
+template<bool kITU>
+static inline uint16x8_t clipNEON(int16x8_t value) {
+	if (kITU) {
+		const int16x8_t c16 = vdupq_n_s16(16);
+		const uint16x8_t c = vreinterpretq_u16_s16(vsubq_s16(vmaxq_s16(vminq_s16(value, vdupq_n_s16(235)), c16), c16));
+		const uint16x4_t lo = vshrn_n_u32(vmull_n_u16(vget_low_u16(c), kITUScale), 16);
+		const uint16x4_t hi = vshrn_n_u32(vmull_n_u16(vget_high_u16(c), kITUScale), 16);
+		return vaddq_u16(c, vcombine_u16(lo, hi));
+	}
+
+	return vreinterpretq_u16_s16(vmaxq_s16(vminq_s16(value, vdupq_n_s16(255)), vdupq_n_s16(0)));
+}
+
+static inline int16x8_t scaleChromaNEON(uint16x8_t absC, int16x8_t sign, int whole, int frac) {
+	const uint16x4_t lo = vshrn_n_u32(vmull_n_u16(vget_low_u16(absC), frac), 16);
+	const uint16x4_t hi = vshrn_n_u32(vmull_n_u16(vget_high_u16(absC), frac), 16);
+	int16x8_t t = vreinterpretq_s16_u16(vcombine_u16(lo, hi));
+	if (whole)
+		t = vaddq_s16(t, vreinterpretq_s16_u16(absC));
+	return vsubq_s16(veorq_s16(t, sign), sign);
+}
+
+/** Compute the values added to the luminance for 8 chroma samples. */
+static inline void chromaTermsNEON(uint8x8_t u, uint8x8_t v, int16x8_t &r, int16x8_t &g, int16x8_t &b) {
+	const int16x8_t cb = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+	const int16x8_t cr = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+	const int16x8_t cbSign = vshrq_n_s16(cb, 15);
+	const int16x8_t crSign = vshrq_n_s16(cr, 15);
+	const uint16x8_t cbAbs = vreinterpretq_u16_s16(vabsq_s16(cb));
+	const uint16x8_t crAbs = vreinterpretq_u16_s16(vabsq_s16(cr));
+
+	r = scaleChromaNEON(crAbs, crSign, 1, kCrToR);
+	g = vnegq_s16(vaddq_s16(scaleChromaNEON(crAbs, crSign, 0, kCrToG), scaleChromaNEON(cbAbs, cbSign, 0, kCbToG)));
+	b = scaleChromaNEON(cbAbs, cbSign, 1, kCbToB);
+}
+
+/** The values added to the luminance of 16 pixels. */
+struct ChromaNEON {
+	int16x8_t rLo, rHi;
+	int16x8_t gLo, gHi;
+	int16x8_t bLo, bHi;
+};
+
+struct PackingNEON {
+	// Negative counts shift to the right
+	int16x8_t rLoss, gLoss, bLoss, aLoss;
+	int16x8_t rShift16, gShift16, bShift16, aShift16;
+	int32x4_t rShift32, gShift32, bShift32, aShift32;
+	uint8x16_t alpha8;
+	uint16x8_t alpha16;
+	uint32x4_t alpha32;
+	bool hasAlpha;
+	bool bytePositions;
+	int rPos, gPos, bPos, aPos;
+
+	explicit PackingNEON(const Packing &p) {
+		rLoss = vdupq_n_s16(-p.rLoss);
+		gLoss = vdupq_n_s16(-p.gLoss);
+		bLoss = vdupq_n_s16(-p.bLoss);
+		aLoss = vdupq_n_s16(-p.aLoss);
+		rShift16 = vdupq_n_s16(p.rShift);
+		gShift16 = vdupq_n_s16(p.gShift);
+		bShift16 = vdupq_n_s16(p.bShift);
+		aShift16 = vdupq_n_s16(p.aShift);
+		rShift32 = vdupq_n_s32(p.rShift);
+		gShift32 = vdupq_n_s32(p.gShift);
+		bShift32 = vdupq_n_s32(p.bShift);
+		aShift32 = vdupq_n_s32(p.aShift);
+		alpha8 = vdupq_n_u8(0xFF >> p.aLoss);
+		alpha16 = vdupq_n_u16((uint16)p.alpha);
+		alpha32 = vdupq_n_u32(p.alpha);
+		hasAlpha = (p.aLoss < 8);
+		bytePositions = p.bytePositions;
+		rPos = p.rPos;
+		gPos = p.gPos;
+		bPos = p.bPos;
+		aPos = p.aPos;
+	}
+};
+
+static inline void store16NEON(byte *dst, const PackingNEON &p, uint16x8_t r, uint16x8_t g, uint16x8_t b, uint16x8_t alpha) {
+	r = vshlq_u16(vshlq_u16(r, p.rLoss), p.rShift16);
+	g = vshlq_u16(vshlq_u16(g, p.gLoss), p.gShift16);
+	b = vshlq_u16(vshlq_u16(b, p.bLoss), p.bShift16);
+	vst1q_u16((uint16 *)dst, vorrq_u16(vorrq_u16(r, g), vorrq_u16(b, alpha)));
+}
+
+static inline void store32NEON(byte *dst, const PackingNEON &p, uint16x8_t r, uint16x8_t g, uint16x8_t b, uint32x4_t alphaLo, uint32x4_t alphaHi) {
+	r = vshlq_u16(r, p.rLoss);
+	g = vshlq_u16(g, p.gLoss);
+	b = vshlq_u16(b, p.bLoss);
+
+	const uint32x4_t lo = vorrq_u32(vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(r)), p.rShift32),
+	                                          vshlq_u32(vmovl_u16(vget_low_u16(g)), p.gShift32)),
+	                                vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(b)), p.bShift32), alphaLo));
+	const uint32x4_t hi = vorrq_u32(vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(r)), p.rShift32),
+	                                          vshlq_u32(vmovl_u16(vget_high_u16(g)), p.gShift32)),
+	                                vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(b)), p.bShift32), alphaHi));
+
+	vst1q_u32((uint32 *)dst, lo);
+	vst1q_u32((uint32 *)(dst + 16), hi);
+}
+
+/** Convert 16 pixels of one row. */
+template<bool kITU, typename PixelInt>
+static FORCEINLINE void convertPixelsNEON(byte *dst, const PackingNEON &p, const byte *ySrc, const byte *aSrc, const ChromaNEON &c) {
+	const uint8x16_t y = vld1q_u8(ySrc);
+	const int16x8_t yLo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y)));
+	const int16x8_t yHi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y)));
+
+	const uint16x8_t rLo = clipNEON<kITU>(vaddq_s16(yLo, c.rLo));
+	const uint16x8_t rHi = clipNEON<kITU>(vaddq_s16(yHi, c.rHi));
+	const uint16x8_t gLo = clipNEON<kITU>(vaddq_s16(yLo, c.gLo));
+	const uint16x8_t gHi = clipNEON<kITU>(vaddq_s16(yHi, c.gHi));
+	const uint16x8_t bLo = clipNEON<kITU>(vaddq_s16(yLo, c.bLo));
+	const uint16x8_t bHi = clipNEON<kITU>(vaddq_s16(yHi, c.bHi));
+
+	if (sizeof(PixelInt) == 2) {
+		uint16x8_t aLo = p.alpha16, aHi = p.alpha16;
+		if (aSrc) {
+			const uint8x16_t a = vld1q_u8(aSrc);
+			aLo = vshlq_u16(vshlq_u16(vmovl_u8(vget_low_u8(a)), p.aLoss), p.aShift16);
+			aHi = vshlq_u16(vshlq_u16(vmovl_u8(vget_high_u8(a)), p.aLoss), p.aShift16);
+		}
+
+		store16NEON(dst, p, rLo, gLo, bLo, aLo);
+		store16NEON(dst + 16, p, rHi, gHi, bHi, aHi);
+	} else if (p.bytePositions) {
+		// Interleave the channel bytes in memory order
+		uint8x16x4_t channels;
+		channels.val[p.rPos] = vcombine_u8(vmovn_u16(rLo), vmovn_u16(rHi));
+		channels.val[p.gPos] = vcombine_u8(vmovn_u16(gLo), vmovn_u16(gHi));
+		channels.val[p.bPos] = vcombine_u8(vmovn_u16(bLo), vmovn_u16(bHi));
+		channels.val[p.aPos] = (aSrc && p.hasAlpha) ? vld1q_u8(aSrc) : p.alpha8;
+		vst4q_u8(dst, channels);
+	} else {
+		uint32x4_t a0 = p.alpha32, a1 = p.alpha32, a2 = p.alpha32, a3 = p.alpha32;
+		if (aSrc) {
+			const uint8x16_t a = vld1q_u8(aSrc);
+			const uint16x8_t aLo = vshlq_u16(vmovl_u8(vget_low_u8(a)), p.aLoss);
+			const uint16x8_t aHi = vshlq_u16(vmovl_u8(vget_high_u8(a)), p.aLoss);
+			a0 = vshlq_u32(vmovl_u16(vget_low_u16(aLo)), p.aShift32);
+			a1 = vshlq_u32(vmovl_u16(vget_high_u16(aLo)), p.aShift32);
+			a2 = vshlq_u32(vmovl_u16(vget_low_u16(aHi)), p.aShift32);
+			a3 = vshlq_u32(vmovl_u16(vget_high_u16(aHi)), p.aShift32);
+		}
+
+		store32NEON(dst, p, rLo, gLo, bLo, a0, a1);
+		store32NEON(dst + 32, p, rHi, gHi, bHi, a2, a3);
+	}
+}
+
+/** Convert the rows in steps of 16 pixels, returning how many were done. */
+template<bool kITU, typename PixelInt>
+static int convertRowsSIMD(byte *dst, int dstPitch, const Packing &packing, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, const byte *aSrc, int width, bool is420) {
+	const PackingNEON p(packing);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		ChromaNEON c;
+		if (is420) {
+			// Each chroma sample covers two pixels
+			int16x8_t r, g, b;
+			chromaTermsNEON(vld1_u8(uSrc + (x >> 1)), vld1_u8(vSrc + (x >> 1)), r, g, b);
+			const int16x8x2_t rr = vzipq_s16(r, r);
+			const int16x8x2_t gg = vzipq_s16(g, g);
+			const int16x8x2_t bb = vzipq_s16(b, b);
+			c.rLo = rr.val[0];
+			c.rHi = rr.val[1];
+			c.gLo = gg.val[0];
+			c.gHi = gg.val[1];
+			c.bLo = bb.val[0];
+			c.bHi = bb.val[1];
+		} else {
+			const uint8x16_t u = vld1q_u8(uSrc + x);
+			const uint8x16_t v = vld1q_u8(vSrc + x);
+			chromaTermsNEON(vget_low_u8(u), vget_low_u8(v), c.rLo, c.gLo, c.bLo);
+			chromaTermsNEON(vget_high_u8(u), vget_high_u8(v), c.rHi, c.gHi, c.bHi);
+		}
+
+		byte *out = dst + x * sizeof(PixelInt);
+		convertPixelsNEON<kITU, PixelInt>(out, p, ySrc + x, aSrc ? aSrc + x : 0, c);
+		if (is420)
+			convertPixelsNEON<kITU, PixelInt>(out + dstPitch, p, ySrc + yPitch + x, aSrc ? aSrc + yPitch + x : 0, c);
+	}
+
+	return x;
+}
+
+#endif
+
+/**
+ * Convert one row of pixels, or two rows sharing one row of chroma samples
+ * for YUV420.
+ */
+template<bool kITU, typename PixelInt>
+static void convertRows(byte *dst, int dstPitch, const Packing &p, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, const byte *aSrc, int width, bool is420) {
+	int start = 0;
+#ifdef SCUMMVM_SIMD
+	start = convertRowsSIMD<kITU, PixelInt>(dst, dstPitch, p, ySrc, yPitch, uSrc, vSrc, aSrc, width, is420);
+#endif
+	convertRowsC<kITU, PixelInt>(dst, dstPitch, p, ySrc, yPitch, uSrc, vSrc, aSrc, start, width, is420);
+}
+
+typedef void (*RowsProc)(byte *dst, int dstPitch, const Packing &p, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, const byte *aSrc, int width, bool is420);
+
+static RowsProc getRowsProc(const PixelFormat &format, bool itu) {
+	assert(format.bytesPerPixel == 2 || format.bytesPerPixel == 4);
+
+	if (format.bytesPerPixel == 2)
+		return itu ? convertRows<true, uint16> : convertRows<false, uint16>;
+	else
+		return itu ? convertRows<true, uint32> : convertRows<false, uint32>;
+}
+
+void convert444(byte *dst, int dstPitch, const PixelFormat &format, bool itu,
+                const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const RowsProc rowsProc = getRowsProc(format, itu);
+	const Packing p = makePacking(format);
+
+	for (int h = 0; h < yHeight; h++) {
+		rowsProc(dst, dstPitch, p, ySrc, yPitch, uSrc, vSrc, 0, yWidth, false);
+
+		dst += dstPitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+void convert420(byte *dst, int dstPitch, const PixelFormat &format, bool itu,
+                const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const RowsProc rowsProc = getRowsProc(format, itu);
+	const Packing p = makePacking(format);
+
+	for (int h = 0; h < yHeight; h += 2) {
+		rowsProc(dst, dstPitch, p, ySrc, yPitch, uSrc, vSrc, aSrc, yWidth, true);
+
+		dst += dstPitch * 2;
+		ySrc += yPitch * 2;
+		if (aSrc)
+			aSrc += yPitch * 2;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+void convert410(byte *dst, int dstPitch, const PixelFormat &format, bool itu,
+                const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const RowsProc rowsProc = getRowsProc(format, itu);
+	const Packing p = makePacking(format);
+	byte uRow[kChunkSize], vRow[kChunkSize];
+
+	for (int y = 0; y < yHeight; y++) {
+		const byte *uLine = uSrc + (y >> 2) * uvPitch;
+		const byte *vLine = vSrc + (y >> 2) * uvPitch;
+		const int yDiff = y & 3;
+
+		for (int x = 0; x < yWidth; x += kChunkSize) {
+			const int width = MIN<int>(kChunkSize, yWidth - x);
+
+			// Bilinear interpolation of the chroma, exactly as the lookup table converter does it
+			for (int i = 0; i < width; i++) {
+				const int index = (x + i) >> 2;
+				const int xDiff = (x + i) & 3;
+				const byte *u = uLine + index;
+				const byte *v = vLine + index;
+
+				uRow[i] = (u[0] * (4 - xDiff) * (4 - yDiff) + u[1] * xDiff * (4 - yDiff) +
+				           u[uvPitch] * yDiff * (4 - xDiff) + u[uvPitch + 1] * xDiff * yDiff) >> 4;
+				vRow[i] = (v[0] * (4 - xDiff) * (4 - yDiff) + v[1] * xDiff * (4 - yDiff) +
+				           v[uvPitch] * yDiff * (4 - xDiff) + v[uvPitch + 1] * xDiff * yDiff) >> 4;
+			}
+
+			rowsProc(dst + x * format.bytesPerPixel, dstPitch, p, ySrc + x, yPitch, uRow, vRow, 0, width, false);
+		}
+
+		dst += dstPitch;
+		ySrc += yPitch;
+	}
+}
+
+} // End of namespace YUVDSP
+
+} // End of namespace Graphics
@@ -0,0 +1,60 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_DSP_H
+#define GRAPHICS_YUV_DSP_H
+
+#include "common/scummsys.h"
+#include "graphics/pixelformat.h"
+
+namespace Graphics {
+
+/**
+ * Arithmetic YUV to RGB converters.
+ *
+ * These compute the same pixels as the lookup table converters of
+ * YUVToRGBManager and YUVAToRGBAManager, but with fixed point arithmetic
+ * on whole rows at once, using vector instructions. The managers only use
+ * them when Common::hasSIMD() is set; on builds without vector support
+ * they run plain C code.
+ *
+ * The destination must use 2 or 4 bytes per pixel.
+ */
+namespace YUVDSP {
+
+/** Convert a YUV444 image. */
+void convert444(byte *dst, int dstPitch, const PixelFormat &format, bool itu,
+                const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
+/** Convert a YUV420 image. The alpha plane, which shares the pitch of the y plane, is optional. */
+void convert420(byte *dst, int dstPitch, const PixelFormat &format, bool itu,
+                const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
+/** Convert a YUV410 image, with bilinear scaling of the chroma planes. */
+void convert410(byte *dst, int dstPitch, const PixelFormat &format, bool itu,
+                const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
+} // End of namespace YUVDSP
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_YUV_DSP_H
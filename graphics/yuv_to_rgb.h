@@ -69,6 +69,18 @@ public:
 	 */
 	void convert444(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUV444 image into a caller provided buffer, e.g. a locked
+	 * texture, instead of a surface
+	 *
+	 * @param dst       the destination pixels
+	 * @param dstPitch  the pitch of the destination, in bytes
+	 * @param dstFormat the pixel format of the destination (2 or 4 bytes per pixel)
+	 *
+	 * The other parameters are the same as for the surface variant.
+	 */
+	void convert444(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
 	/**
 	 * Convert a YUV420 image to an RGB surface
 	 *
@@ -84,6 +96,18 @@ public:
 	 */
 	void convert420(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUV420 image into a caller provided buffer, e.g. a locked
+	 * texture, instead of a surface
+	 *
+	 * @param dst       the destination pixels
+	 * @param dstPitch  the pitch of the destination, in bytes
+	 * @param dstFormat the pixel format of the destination (2 or 4 bytes per pixel)
+	 *
+	 * The other parameters are the same as for the surface variant.
+	 */
+	void convert420(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
 	/**
 	 * Convert a YUV410 image to an RGB surface
 	 *
@@ -105,6 +129,18 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUV410 image into a caller provided buffer, e.g. a locked
+	 * texture, instead of a surface
+	 *
+	 * @param dst       the destination pixels
+	 * @param dstPitch  the pitch of the destination, in bytes
+	 * @param dstFormat the pixel format of the destination (2 or 4 bytes per pixel)
+	 *
+	 * The other parameters are the same as for the surface variant.
+	 */
+	void convert410(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
@@ -83,7 +83,10 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/simd.h"
+
 #include "graphics/surface.h"
+#include "graphics/yuv_dsp.h"
 #include "graphics/yuva_to_rgba.h"
 
 namespace Common {
@@ -238,7 +241,7 @@ void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVAToRGBALookup *lo
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		aSrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
@@ -247,20 +250,32 @@ void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVAToRGBALookup *lo
 }
 
 void YUVAToRGBAManager::convert420(Graphics::Surface *dst, YUVAToRGBAManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
 	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
-	assert(ySrc && uSrc && vSrc);
+	convert420((byte *)dst->getPixels(), dst->pitch, dst->format, scale, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+void YUVAToRGBAManager::convert420(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, YUVAToRGBAManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst);
+	assert(dstFormat.bytesPerPixel == 2 || dstFormat.bytesPerPixel == 4);
+	assert(ySrc && uSrc && vSrc && aSrc);
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
-	const YUVAToRGBALookup *lookup = getLookup(dst->format, scale);
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		YUVDSP::convert420(dst, dstPitch, dstFormat, scale == kScaleITU, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+#endif
+
+	const YUVAToRGBALookup *lookup = getLookup(dstFormat, scale);
 
 	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUVA420ToRGBA<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
+	if (dstFormat.bytesPerPixel == 2)
+		convertYUVA420ToRGBA<uint16>(dst, dstPitch, lookup, _colorTab, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUVA420ToRGBA<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUVA420ToRGBA<uint32>(dst, dstPitch, lookup, _colorTab, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 } // End of namespace Graphics
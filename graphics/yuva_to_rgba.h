@@ -63,6 +63,18 @@ public:
 	 */
 	void convert420(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUVA420 image into a caller provided buffer, e.g. a locked
+	 * texture, instead of a surface
+	 *
+	 * @param dst       the destination pixels
+	 * @param dstPitch  the pitch of the destination, in bytes
+	 * @param dstFormat the pixel format of the destination (2 or 4 bytes per pixel)
+	 *
+	 * The other parameters are the same as for the surface variant.
+	 */
+	void convert420(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVAToRGBAManager();
@@ -36,6 +36,8 @@
 
 #include "engines/engine.h"
 
+#include "audio/mixer.h"
+
 #include "gui/debugger.h"
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 	#include "gui/console.h"
@@ -77,6 +79,8 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+
+	registerCmd("mixer",			WRAP_METHOD(Debugger, cmdMixer));
 }
 
 Debugger::~Debugger() {
@@ -734,4 +738,64 @@ bool Debugger::debuggerCompletionCallback(GUI::ConsoleDialog *console, const cha
 
 #endif
 
+bool Debugger::cmdMixer(int argc, const char **argv) {
+	Audio::Mixer *mixer = g_system->getMixer();
+
+	if (argc == 2 && !strcmp(argv[1], "on")) {
+		mixer->resetStatistics();
+		mixer->setStatisticsEnabled(true);
+		debugPrintf("Mixer statistics enabled\n");
+		return true;
+	} else if (argc == 2 && !strcmp(argv[1], "off")) {
+		mixer->setStatisticsEnabled(false);
+		debugPrintf("Mixer statistics disabled\n");
+		return true;
+	} else if (argc == 2 && !strcmp(argv[1], "reset")) {
+		mixer->resetStatistics();
+		debugPrintf("Mixer statistics reset\n");
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Usage: %s [on|off|reset]\n", argv[0]);
+		return true;
+	}
+
+	if (!mixer->isStatisticsEnabled()) {
+		debugPrintf("Mixer statistics are disabled, use '%s on' to collect them\n", argv[0]);
+		return true;
+	}
+
+	Audio::MixerStatistics stats;
+	mixer->getStatistics(stats);
+
+	const uint32 callbacks = MAX<uint32>(stats.callbacks, 1);
+	debugPrintf("%u callbacks at %u Hz, %u underruns\n", stats.callbacks, stats.outputRate, stats.underruns);
+	debugPrintf("Callback time: avg %u us, max %u us\n", (uint32)(stats.callbackMicros / callbacks), stats.maxCallbackMicros);
+	debugPrintf("Lock wait: avg %u us, max %u us\n", (uint32)(stats.lockWaitMicros / callbacks), stats.maxLockWaitMicros);
+
+	debugPrintf("Callback time histogram:\n");
+	uint32 limit = Audio::MixerStatistics::kHistogramFirstBucketMicros;
+	for (int i = 0; i < Audio::MixerStatistics::kHistogramBuckets; i++, limit *= 2) {
+		if (i < Audio::MixerStatistics::kHistogramBuckets - 1)
+			debugPrintf("  < %5u us: %u\n", limit, stats.callbackHistogram[i]);
+		else
+			debugPrintf(" >= %5u us: %u\n", limit / 2, stats.callbackHistogram[i]);
+	}
+
+	static const char *const typeNames[] = { "plain", "music", "sfx", "speech" };
+
+	debugPrintf("Channels:\n");
+	debugPrintf("  id type   conv    rate ch   frames  avg us  max us ns/frame\n");
+	for (uint i = 0; i < stats.numChannels; i++) {
+		const Audio::MixerStatistics::ChannelStatistics &chan = stats.channels[i];
+		const uint32 calls = MAX<uint32>(chan.mixCalls, 1);
+		const uint32 nsPerFrame = chan.frames ? (uint32)(chan.decodeMicros * 1000 / chan.frames) : 0;
+
+		debugPrintf("%4d %-6s %-6s %5u %2d %8u %7u %7u %8u%s\n", chan.id, typeNames[chan.type], chan.converter,
+		            chan.inputRate, chan.stereo ? 2 : 1, (uint32)chan.frames, (uint32)(chan.decodeMicros / calls),
+		            chan.maxDecodeMicros, nsPerFrame, chan.paused ? " (paused)" : "");
+	}
+
+	return true;
+}
+
 } // End of namespace GUI
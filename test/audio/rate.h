@@ -0,0 +1,101 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/simd.h"
+
+#include "helper.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	/**
+	 * Run a converter over a sine stream, once with the vector kernels and
+	 * once with the plain C code, and check that both mix exactly the same
+	 * samples into an already filled output buffer.
+	 */
+	void compareWithScalar(const int inRate, const int outRate, const bool isStereo, const bool reverseStereo,
+	                       const Audio::st_volume_t volL, const Audio::st_volume_t volR) {
+		// Odd sizes, so the scalar tail of the vector loops gets exercised
+		const int frames = 4099;
+		const int chunk = 1021;
+
+		int16 *out[2];
+		for (int pass = 0; pass < 2; ++pass) {
+			Common::setSIMDEnabled(pass == 0);
+
+			Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, 0, false, isStereo);
+			Audio::RateConverter *conv = Audio::makeRateConverter(inRate, outRate, isStereo, reverseStereo);
+
+			// Prefill the buffer with a loud pattern so clamping happens
+			out[pass] = new int16[frames * 2];
+			for (int i = 0; i < frames * 2; ++i)
+				out[pass][i] = (int16)((i % 7 - 3) * 9000);
+
+			int written = 0;
+			while (written < frames) {
+				const int len = MIN(chunk, frames - written);
+				const int got = conv->flow(*s, out[pass] + written * 2, len, volL, volR);
+				written += got;
+				if (got < len)
+					break;
+			}
+			TS_ASSERT_EQUALS(written, frames);
+
+			delete conv;
+			delete s;
+		}
+		Common::setSIMDEnabled(true);
+
+		TS_ASSERT_EQUALS(memcmp(out[0], out[1], frames * 2 * sizeof(int16)), 0);
+
+		delete[] out[0];
+		delete[] out[1];
+	}
+
+	void compareAllVolumes(const int inRate, const int outRate, const bool isStereo, const bool reverseStereo) {
+		compareWithScalar(inRate, outRate, isStereo, reverseStereo, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		compareWithScalar(inRate, outRate, isStereo, reverseStereo, 255, 37);
+		compareWithScalar(inRate, outRate, isStereo, reverseStereo, 0, 129);
+		compareWithScalar(inRate, outRate, isStereo, reverseStereo, 1000, 40000);
+	}
+
+public:
+	void test_copy_mono() {
+		compareAllVolumes(22050, 22050, false, false);
+	}
+
+	void test_copy_stereo() {
+		compareAllVolumes(22050, 22050, true, false);
+	}
+
+	void test_copy_stereo_reverse() {
+		compareAllVolumes(22050, 22050, true, true);
+	}
+
+	void test_simple_mono() {
+		compareAllVolumes(44100, 22050, false, false);
+	}
+
+	void test_simple_stereo() {
+		compareAllVolumes(44100, 22050, true, false);
+	}
+
+	void test_simple_stereo_reverse() {
+		compareAllVolumes(44100, 11025, true, true);
+	}
+
+	void test_linear_mono() {
+		compareAllVolumes(22050, 44100, false, false);
+	}
+
+	void test_linear_stereo() {
+		compareAllVolumes(11025, 48000, true, false);
+	}
+
+	void test_linear_stereo_reverse() {
+		compareAllVolumes(44100, 48000, true, true);
+	}
+};
@@ -0,0 +1,171 @@
+// The benchmark runner is a host tool which prints to stdout directly
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+// Only built with the Grim engine, see test/module.mk
+#ifdef ENABLE_GRIM
+
+#include "common/array.h"
+
+#include "math/quat.h"
+
+#include "engines/grim/keyframecursor.h"
+
+#include "test/benchmark/benchmark.h"
+
+#include <stdio.h>
+
+/**
+ * Keyframe animation sampling benchmarks.
+ *
+ * The fixtures are clips of rotation tracks, one per bone, sampled at 60
+ * frames per second by several actors playing the clip at different times,
+ * as AnimationStateEmi::animate does. The key is found by scanning from the
+ * first key as before, by a binary search as KeyframeAnim did, and with a
+ * KeyframeCursor per track. All of them have to pick the same keys.
+ */
+
+namespace {
+
+struct Track {
+	Common::Array<float> times;
+	Common::Array<Math::Quaternion> rotations;
+};
+
+class Clip {
+public:
+	Clip(int bones, int keys, float duration) : _duration(duration) {
+		uint32 seed = bones * 1000 + keys;
+		_tracks.resize(bones);
+		for (int b = 0; b < bones; b++) {
+			Track &track = _tracks[b];
+			for (int k = 0; k < keys; k++) {
+				seed = seed * 1103515245 + 12345;
+				// Keys are mostly evenly spaced, with some jitter
+				const float jitter = ((seed >> 8) % 100) / 400.f;
+				track.times.push_back((k + jitter) * duration / keys);
+				track.rotations.push_back(Math::Quaternion(0.f, 0.f, (seed >> 16) % 100 / 100.f, 1.f).normalize());
+			}
+		}
+	}
+
+	float getDuration() const { return _duration; }
+	int getBoneCount() const { return _tracks.size(); }
+	const Track &getTrack(int bone) const { return _tracks[bone]; }
+
+private:
+	float _duration;
+	Common::Array<Track> _tracks;
+};
+
+enum SearchMode {
+	kScan,
+	kBinary,
+	kCursor
+};
+
+class Sampler {
+public:
+	Sampler(const Clip &clip, int actors, int frames, SearchMode mode) :
+			_clip(clip), _actors(actors), _frames(frames), _mode(mode), _checksum(0) {
+		_cursors.resize(actors * clip.getBoneCount());
+	}
+
+	void operator()() {
+		_checksum = 0;
+		_result = Math::Quaternion();
+		for (int frame = 0; frame < _frames; frame++) {
+			for (int actor = 0; actor < _actors; actor++) {
+				// The actors play the looping clip from starts spread over it
+				float time = frame * 1000.f / 60.f + actor * _clip.getDuration() / _actors;
+				while (time >= _clip.getDuration())
+					time -= _clip.getDuration();
+
+				for (int bone = 0; bone < _clip.getBoneCount(); bone++)
+					sample(_clip.getTrack(bone), time, _cursors[actor * _clip.getBoneCount() + bone]);
+			}
+		}
+	}
+
+	uint32 getChecksum() const { return _checksum; }
+
+private:
+	int findKey(const Track &track, float time, Grim::KeyframeCursor &cursor) const {
+		const int count = track.times.size();
+		if (_mode == kCursor)
+			return cursor.countKeysBefore(track.times.begin(), count, time, false);
+
+		if (_mode == kScan) {
+			for (int i = 0; i < count; i++) {
+				if (track.times[i] >= time)
+					return i;
+			}
+			return count;
+		}
+
+		int low = 0, high = count;
+		while (low < high) {
+			const int mid = (low + high) / 2;
+			if (track.times[mid] < time)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		return low;
+	}
+
+	void sample(const Track &track, float time, Grim::KeyframeCursor &cursor) {
+		const int count = track.times.size();
+		const int key = findKey(track, time, cursor);
+		_checksum = _checksum * 31 + key;
+
+		Math::Quaternion quat;
+		if (key == 0) {
+			quat = track.rotations[0];
+		} else if (key < count) {
+			const float interp = (time - track.times[key - 1]) / (track.times[key] - track.times[key - 1]);
+			quat = track.rotations[key - 1].slerpQuat(track.rotations[key], interp);
+		} else {
+			quat = track.rotations[count - 1];
+		}
+		_result = _result * quat;
+	}
+
+	const Clip &_clip;
+	int _actors;
+	int _frames;
+	SearchMode _mode;
+	Common::Array<Grim::KeyframeCursor> _cursors;
+	uint32 _checksum;
+	Math::Quaternion _result;
+};
+
+void runClip(int bones, int keys, float duration, int actors) {
+	static const char *const modeNames[] = { "scan", "binary", "cursor" };
+	const int frames = 120;
+
+	Clip clip(bones, keys, duration);
+	uint32 expected = 0;
+	for (int mode = kScan; mode <= kCursor; mode++) {
+		Sampler sampler(clip, actors, frames, (SearchMode)mode);
+		uint runs;
+		const uint64 micros = Benchmark::measure(sampler, runs);
+		if (mode == kScan)
+			expected = sampler.getChecksum();
+
+		char name[64], extra[64];
+		snprintf(name, sizeof(name), "%d bones %d keys x%d %s", bones, keys, actors, modeNames[mode]);
+		snprintf(extra, sizeof(extra), "%.2f us per frame, %s", (double)micros / (runs * frames),
+		         sampler.getChecksum() == expected ? "ok" : "MISMATCH");
+		Benchmark::report("animation", name, micros, (double)runs * frames * actors * bones, "samples", extra);
+	}
+}
+
+} // End of anonymous namespace
+
+void benchmarkAnimation() {
+	runClip(40, 30, 1000.f, 4);
+	runClip(40, 300, 10000.f, 4);
+	runClip(60, 1200, 40000.f, 8);
+}
+
+#endif
@@ -0,0 +1,586 @@
+// Input files are read with stdio, there is no file system backend here
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+#include "audio/decoders/adpcm.h"
+#include "audio/decoders/aiff.h"
+#include "audio/decoders/asf.h"
+#include "audio/decoders/flac.h"
+#include "audio/decoders/mp3.h"
+#include "audio/decoders/quicktime.h"
+#include "audio/decoders/raw.h"
+#include "audio/decoders/vorbis.h"
+#include "audio/decoders/wave.h"
+#include "audio/decoders/xa.h"
+
+#include "common/endian.h"
+#include "common/memstream.h"
+#include "common/str.h"
+#include "common/util.h"
+
+#ifdef USE_BINK
+#include "video/bink_decoder.h"
+#endif
+
+#ifdef ENABLE_GRIM
+#include "engines/grim/movie/codecs/vima.h"
+#endif
+
+#include "test/benchmark/benchmark.h"
+#include "test/benchmark/null_system.h"
+
+#include <stdio.h>
+
+/**
+ * Decoder throughput benchmarks.
+ *
+ * Every fixture is decoded three ways:
+ *  - "read":  straight readBuffer() calls, measuring the decoder alone
+ *  - "mix":   played through a MixerImpl which is pulled as fast as possible,
+ *             like the audio callback of a backend would do
+ *  - "seek":  random seeks followed by short reads (rewinds for streams
+ *             which can not seek)
+ *
+ * Without arguments only synthetic fixtures are used. Files given on the
+ * command line are decoded based on their extension.
+ */
+
+namespace {
+
+enum {
+	kFixtureRate = 22050,
+	kFixtureSeconds = 10,
+	kMixerRate = 44100,
+	kReadChunk = 4096,
+	kSeekCount = 64,
+	kSeekReadSamples = 2048
+};
+
+/** Small deterministic random generator, so runs are comparable. */
+class FixtureRandom {
+public:
+	FixtureRandom(uint32 seed = 0x12345678) : _state(seed) {}
+
+	uint32 next() {
+		_state = _state * 1103515245 + 12345;
+		return _state >> 8;
+	}
+
+	byte nextByte() { return (byte)next(); }
+	uint32 nextRange(uint32 max) { return next() % max; }
+
+private:
+	uint32 _state;
+};
+
+/**
+ * A decodable input: owns the encoded data and creates a fresh stream
+ * over it for every run.
+ */
+class Fixture {
+public:
+	Fixture(const Common::String &name, byte *data, uint32 size) : _name(name), _data(data), _size(size) {}
+	virtual ~Fixture() { free(_data); }
+
+	const Common::String &getName() const { return _name; }
+
+	/** Create a new stream, or return 0 if the data can't be decoded. */
+	virtual Audio::RewindableAudioStream *createStream() = 0;
+
+	/** Create a new stream if the format can seek, or return 0. */
+	virtual Audio::SeekableAudioStream *createSeekableStream() { return 0; }
+
+protected:
+	Common::SeekableReadStream *createDataStream() const {
+		return new Common::MemoryReadStream(_data, _size, DisposeAfterUse::NO);
+	}
+
+	Common::String _name;
+	byte *_data;
+	uint32 _size;
+};
+
+class RawFixture : public Fixture {
+public:
+	RawFixture(byte *data, uint32 size, int rate, bool stereo) :
+		Fixture(stereo ? "pcm16 stereo" : "pcm16 mono", data, size), _rate(rate), _stereo(stereo) {}
+
+	Audio::RewindableAudioStream *createStream() {
+		return createSeekableStream();
+	}
+
+	Audio::SeekableAudioStream *createSeekableStream() {
+		return Audio::makeRawStream(createDataStream(), _rate,
+		                            Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (_stereo ? Audio::FLAG_STEREO : 0));
+	}
+
+private:
+	int _rate;
+	bool _stereo;
+};
+
+class ADPCMFixture : public Fixture {
+public:
+	ADPCMFixture(const char *name, byte *data, uint32 size, Audio::ADPCMType type, int channels, uint32 blockAlign) :
+		Fixture(name, data, size), _type(type), _channels(channels), _blockAlign(blockAlign) {}
+
+	Audio::RewindableAudioStream *createStream() {
+		return Audio::makeADPCMStream(createDataStream(), DisposeAfterUse::YES, _size, _type, kFixtureRate, _channels, _blockAlign);
+	}
+
+private:
+	Audio::ADPCMType _type;
+	int _channels;
+	uint32 _blockAlign;
+};
+
+class XAFixture : public Fixture {
+public:
+	XAFixture(byte *data, uint32 size) : Fixture("xa", data, size) {}
+
+	Audio::RewindableAudioStream *createStream() {
+		return Audio::makeXAStream(createDataStream(), kFixtureRate);
+	}
+};
+
+/** A file decoded with the decoder matching its extension. */
+class FileFixture : public Fixture {
+public:
+	FileFixture(const Common::String &name, byte *data, uint32 size) : Fixture(name, data, size) {}
+
+	Audio::RewindableAudioStream *createStream() {
+		Audio::SeekableAudioStream *seekable = createSeekableStream();
+		if (seekable)
+			return seekable;
+
+		const Common::String ext = getExtension();
+		if (ext.hasSuffix(".wav"))
+			return Audio::makeWAVStream(createDataStream(), DisposeAfterUse::YES);
+		if (ext.hasSuffix(".aif") || ext.hasSuffix(".aiff"))
+			return Audio::makeAIFFStream(createDataStream(), DisposeAfterUse::YES);
+		if (ext.hasSuffix(".xa"))
+			return Audio::makeXAStream(createDataStream(), kFixtureRate);
+
+		return 0;
+	}
+
+	Audio::SeekableAudioStream *createSeekableStream() {
+		const Common::String ext = getExtension();
+
+#ifdef USE_MAD
+		if (ext.hasSuffix(".mp3"))
+			return Audio::makeMP3Stream(createDataStream(), DisposeAfterUse::YES);
+#endif
+#ifdef USE_VORBIS
+		if (ext.hasSuffix(".ogg"))
+			return Audio::makeVorbisStream(createDataStream(), DisposeAfterUse::YES);
+#endif
+#ifdef USE_FLAC
+		if (ext.hasSuffix(".flac") || ext.hasSuffix(".fla"))
+			return Audio::makeFLACStream(createDataStream(), DisposeAfterUse::YES);
+#endif
+		if (ext.hasSuffix(".wma") || ext.hasSuffix(".asf"))
+			return Audio::makeASFStream(createDataStream(), DisposeAfterUse::YES);
+		if (ext.hasSuffix(".mov") || ext.hasSuffix(".qt") || ext.hasSuffix(".m4a"))
+			return Audio::makeQuickTimeStream(createDataStream(), DisposeAfterUse::YES);
+
+		return 0;
+	}
+
+private:
+	Common::String getExtension() const {
+		Common::String ext = _name;
+		ext.toLowercase();
+		return ext;
+	}
+};
+
+#ifdef ENABLE_GRIM
+/**
+ * Stream decoding VIMA blocks the way the SMUSH and iMUSE code does, a
+ * block at a time.
+ */
+class VimaStream : public Audio::RewindableAudioStream {
+public:
+	enum {
+		kBlockSamples = 2048
+	};
+
+	VimaStream(const byte *data, uint32 blockSize, uint32 blockCount, const uint16 *table) :
+		_data(data), _blockSize(blockSize), _blockCount(blockCount), _table(table) {
+		rewind();
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		int samples = 0;
+		while (samples < numSamples) {
+			if (_bufferPos == kBlockSamples) {
+				if (_block == _blockCount)
+					break;
+				Grim::decompressVima(_data + _block * _blockSize, _buffer, kBlockSamples * 2, const_cast<uint16 *>(_table));
+				for (int i = 0; i < kBlockSamples; i++)
+					_buffer[i] = (int16)READ_BE_UINT16(&_buffer[i]);
+				_block++;
+				_bufferPos = 0;
+			}
+			const int count = MIN<int>(numSamples - samples, kBlockSamples - _bufferPos);
+			memcpy(buffer + samples, _buffer + _bufferPos, count * 2);
+			_bufferPos += count;
+			samples += count;
+		}
+		return samples;
+	}
+
+	bool isStereo() const { return false; }
+	int getRate() const { return kFixtureRate; }
+	bool endOfData() const { return _block == _blockCount && _bufferPos == kBlockSamples; }
+
+	bool rewind() {
+		_block = 0;
+		_bufferPos = kBlockSamples;
+		return true;
+	}
+
+private:
+	const byte *_data;
+	uint32 _blockSize, _blockCount;
+	const uint16 *_table;
+
+	uint32 _block;
+	int _bufferPos;
+	int16 _buffer[kBlockSamples];
+};
+
+class VimaFixture : public Fixture {
+public:
+	VimaFixture(byte *data, uint32 blockSize, uint32 blockCount) :
+		Fixture("vima", data, blockSize * blockCount), _blockSize(blockSize), _blockCount(blockCount) {
+		Grim::vimaInit(_table);
+	}
+
+	Audio::RewindableAudioStream *createStream() {
+		return new VimaStream(_data, _blockSize, _blockCount, _table);
+	}
+
+private:
+	uint32 _blockSize, _blockCount;
+	uint16 _table[5786];
+};
+#endif
+
+#pragma mark -
+
+void fillRandom(byte *data, uint32 size, FixtureRandom &random) {
+	for (uint32 i = 0; i < size; i++)
+		data[i] = random.nextByte();
+}
+
+/** Create 'blocks' blocks of random ADPCM data with valid block headers. */
+byte *createADPCMBlocks(Audio::ADPCMType type, int channels, uint32 blockAlign, uint32 blocks, FixtureRandom &random) {
+	byte *data = (byte *)malloc(blockAlign * blocks);
+	fillRandom(data, blockAlign * blocks, random);
+
+	for (uint32 b = 0; b < blocks; b++) {
+		byte *block = data + b * blockAlign;
+		switch (type) {
+		case Audio::kADPCMMSIma:
+			// Per channel: initial sample, step index
+			for (int i = 0; i < channels; i++)
+				WRITE_LE_UINT16(block + i * 4 + 2, random.nextRange(89));
+			break;
+		case Audio::kADPCMMS:
+			// Coefficient indices, then delta and the two first samples
+			for (int i = 0; i < channels; i++)
+				block[i] = random.nextRange(7);
+			for (int i = 0; i < channels; i++)
+				WRITE_LE_UINT16(block + channels + i * 2, 16 + random.nextRange(512));
+			break;
+		case Audio::kADPCMDK3:
+			WRITE_LE_UINT16(block + 2, kFixtureRate);
+			block[14] = random.nextRange(89);
+			block[15] = random.nextRange(89);
+			break;
+		default:
+			// Headerless, or the decoder clips the header values itself
+			break;
+		}
+	}
+
+	return data;
+}
+
+/** Create XA sound groups with valid filters, terminated by an end flag. */
+byte *createXA(uint32 blocks, FixtureRandom &random) {
+	byte *data = (byte *)malloc(blocks * 16);
+	fillRandom(data, blocks * 16, random);
+
+	for (uint32 b = 0; b < blocks; b++) {
+		byte *block = data + b * 16;
+		block[0] = (random.nextRange(5) << 4) | random.nextRange(13);
+		block[1] = (b == blocks - 1) ? 7 : 0;
+	}
+
+	return data;
+}
+
+void createSyntheticFixtures(Common::Array<Fixture *> &fixtures) {
+	FixtureRandom random;
+	const uint32 samples = kFixtureRate * kFixtureSeconds;
+
+	for (int stereo = 0; stereo < 2; stereo++) {
+		const uint32 size = samples * 2 * (stereo + 1);
+		int16 *pcm = (int16 *)malloc(size);
+		for (uint32 i = 0; i < size / 2; i++)
+			WRITE_LE_UINT16(&pcm[i], (uint16)(sin(i * 0.01) * 20000));
+		fixtures.push_back(new RawFixture((byte *)pcm, size, kFixtureRate, stereo != 0));
+	}
+
+	// 4 bit formats: two samples per byte and channel
+	const uint32 blockAlign = 1024;
+	const uint32 blocks = samples / blockAlign / 2 * 2;
+
+	fixtures.push_back(new ADPCMFixture("adpcm oki", createADPCMBlocks(Audio::kADPCMOki, 1, blockAlign, blocks / 2, random),
+	                                    blockAlign * (blocks / 2), Audio::kADPCMOki, 1, 0));
+	fixtures.push_back(new ADPCMFixture("adpcm dvi", createADPCMBlocks(Audio::kADPCMDVI, 2, blockAlign, blocks, random),
+	                                    blockAlign * blocks, Audio::kADPCMDVI, 2, 0));
+	fixtures.push_back(new ADPCMFixture("adpcm ms-ima", createADPCMBlocks(Audio::kADPCMMSIma, 2, blockAlign, blocks, random),
+	                                    blockAlign * blocks, Audio::kADPCMMSIma, 2, blockAlign));
+	fixtures.push_back(new ADPCMFixture("adpcm ms", createADPCMBlocks(Audio::kADPCMMS, 2, blockAlign, blocks, random),
+	                                    blockAlign * blocks, Audio::kADPCMMS, 2, blockAlign));
+	fixtures.push_back(new ADPCMFixture("adpcm dk3", createADPCMBlocks(Audio::kADPCMDK3, 2, blockAlign, blocks, random),
+	                                    blockAlign * blocks, Audio::kADPCMDK3, 2, blockAlign));
+
+	// Apple IMA packets hold 64 samples of one channel
+	const uint32 applePackets = samples * 2 / 64;
+	fixtures.push_back(new ADPCMFixture("adpcm apple", createADPCMBlocks(Audio::kADPCMApple, 2, 34, applePackets, random),
+	                                    34 * applePackets, Audio::kADPCMApple, 2, 34));
+
+	// XA sound groups hold 28 samples
+	const uint32 xaBlocks = samples / 28;
+	fixtures.push_back(new XAFixture(createXA(xaBlocks, random), xaBlocks * 16));
+
+#ifdef ENABLE_GRIM
+	// Worst case a VIMA sample takes 7 bits plus a 16 bit escape
+	const uint32 vimaBlockSize = VimaStream::kBlockSamples * 3 + 16;
+	const uint32 vimaBlocks = samples / VimaStream::kBlockSamples;
+	byte *vima = (byte *)malloc(vimaBlockSize * vimaBlocks);
+	fillRandom(vima, vimaBlockSize * vimaBlocks, random);
+	for (uint32 b = 0; b < vimaBlocks; b++)
+		vima[b * vimaBlockSize] = random.nextRange(89);
+	fixtures.push_back(new VimaFixture(vima, vimaBlockSize, vimaBlocks));
+#endif
+}
+
+byte *readFile(const char *path, uint32 &size) {
+	FILE *f = fopen(path, "rb");
+	if (!f)
+		return 0;
+
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	byte *data = (byte *)malloc(size);
+	if (fread(data, 1, size, f) != size) {
+		free(data);
+		data = 0;
+	}
+
+	fclose(f);
+	return data;
+}
+
+#pragma mark -
+
+/** Format the columns shared by all decoder results. */
+Common::String formatDecoderResult(double mediaSeconds, uint64 micros, uint64 allocs, uint runs) {
+	Common::String result = Common::String::format("%8.1fx realtime", micros ? mediaSeconds * 1000000.0 / micros : 0.0);
+	if (Benchmark::isAllocationCountAvailable())
+		result += Common::String::format(" %10.1f allocs/run", (double)allocs / runs);
+	return result;
+}
+
+void runRead(Fixture &fixture) {
+	int16 *buffer = new int16[kReadChunk];
+	uint64 samples = 0, micros = 0, allocs = 0;
+	uint runs = 0;
+	double mediaSeconds = 0;
+
+	while (micros < 200000) {
+		// Count the allocations made while setting up the decoder too
+		const uint64 startAllocs = Benchmark::getAllocationCount();
+		Audio::RewindableAudioStream *stream = fixture.createStream();
+		if (!stream)
+			break;
+
+		const int channels = stream->isStereo() ? 2 : 1;
+		const int rate = stream->getRate();
+
+		const uint64 start = Benchmark::getMicros();
+		uint64 runSamples = 0;
+		int got;
+		while ((got = stream->readBuffer(buffer, kReadChunk)) > 0)
+			runSamples += got;
+		micros += Benchmark::getMicros() - start;
+		allocs += Benchmark::getAllocationCount() - startAllocs;
+
+		samples += runSamples;
+		mediaSeconds += (double)runSamples / channels / rate;
+		runs++;
+		delete stream;
+
+		if (!runSamples)
+			break;
+	}
+	delete[] buffer;
+
+	if (!runs) {
+		printf("%-12s %-40s could not be decoded\n", "decoders", fixture.getName().c_str());
+		return;
+	}
+
+	const Common::String name = fixture.getName() + " read";
+	Benchmark::report("decoders", name.c_str(), micros, (double)samples, "samples",
+	                  formatDecoderResult(mediaSeconds, micros, allocs, runs).c_str());
+}
+
+void runMix(Fixture &fixture, Benchmark::NullSystem &system) {
+	Audio::MixerImpl *mixer = system.getMixerImpl();
+	Audio::Mixer *player = mixer;
+	const uint frames = 1024;
+	byte *buffer = new byte[frames * 4];
+	uint64 mixed = 0, micros = 0, allocs = 0;
+	uint runs = 0;
+
+	while (micros < 200000) {
+		const uint64 startAllocs = Benchmark::getAllocationCount();
+		Audio::RewindableAudioStream *stream = fixture.createStream();
+		if (!stream)
+			return;
+
+		const uint64 start = Benchmark::getMicros();
+
+		Audio::SoundHandle handle;
+		player->playStream(Audio::Mixer::kPlainSoundType, &handle, stream);
+		while (player->isSoundHandleActive(handle))
+			mixed += mixer->mixCallback(buffer, frames * 4);
+
+		micros += Benchmark::getMicros() - start;
+		allocs += Benchmark::getAllocationCount() - startAllocs;
+		runs++;
+	}
+	delete[] buffer;
+
+	const Common::String name = fixture.getName() + " mix";
+	Benchmark::report("decoders", name.c_str(), micros, (double)mixed * 2, "samples",
+	                  formatDecoderResult((double)mixed / mixer->getOutputRate(), micros, allocs, runs).c_str());
+}
+
+void runSeek(Fixture &fixture) {
+	Audio::SeekableAudioStream *seekable = fixture.createSeekableStream();
+	Audio::RewindableAudioStream *stream = seekable ? seekable : fixture.createStream();
+	if (!stream)
+		return;
+
+	const uint32 lengthMs = seekable ? seekable->getLength().msecs() : 0;
+
+	int16 *buffer = new int16[kSeekReadSamples];
+	FixtureRandom random(0xBEEF);
+
+	const uint64 startAllocs = Benchmark::getAllocationCount();
+	const uint64 start = Benchmark::getMicros();
+	for (int i = 0; i < kSeekCount; i++) {
+		if (seekable && lengthMs)
+			seekable->seek(Audio::Timestamp(random.nextRange(lengthMs), seekable->getRate()));
+		else
+			stream->rewind();
+		stream->readBuffer(buffer, kSeekReadSamples);
+	}
+	const uint64 micros = Benchmark::getMicros() - start;
+	const uint64 allocs = Benchmark::getAllocationCount() - startAllocs;
+
+	delete[] buffer;
+	delete stream;
+
+	const Common::String name = fixture.getName() + (seekable ? " seek" : " rewind");
+	Common::String extra;
+	if (Benchmark::isAllocationCountAvailable())
+		extra = Common::String::format("%10.1f allocs/seek", (double)allocs / kSeekCount);
+	Benchmark::report("decoders", name.c_str(), micros, kSeekCount, "seeks", extra.c_str());
+}
+
+#ifdef USE_BINK
+/**
+ * Bink audio is only reachable through the Bink container, so movies are
+ * measured as a whole, with the audio played through the null mixer.
+ */
+void runBink(const Common::String &path, byte *data, uint32 size, Benchmark::NullSystem &system) {
+	Audio::MixerImpl *mixer = system.getMixerImpl();
+	Video::BinkDecoder bink;
+	if (!bink.loadStream(new Common::MemoryReadStream(data, size, DisposeAfterUse::NO))) {
+		printf("%-12s %-40s could not be decoded\n", "decoders", path.c_str());
+		return;
+	}
+
+	const uint frames = 1024;
+	byte *buffer = new byte[frames * 4];
+
+	const uint64 startAllocs = Benchmark::getAllocationCount();
+	const uint64 start = Benchmark::getMicros();
+	bink.start();
+	uint64 mixed = 0;
+	while (!bink.endOfVideo()) {
+		if (bink.needsUpdate())
+			bink.decodeNextFrame();
+		mixed += mixer->mixCallback(buffer, frames * 4);
+	}
+	const uint64 micros = Benchmark::getMicros() - start;
+	const uint64 allocs = Benchmark::getAllocationCount() - startAllocs;
+
+	delete[] buffer;
+
+	const double mediaSeconds = bink.getDuration().msecs() / 1000.0;
+	const Common::String name = path + " bink a+v";
+	Benchmark::report("decoders", name.c_str(), micros, (double)bink.getFrameCount(), "frames",
+	                  formatDecoderResult(mediaSeconds, micros, allocs, 1).c_str());
+}
+#endif
+
+} // End of anonymous namespace
+
+void benchmarkAudioDecoders() {
+	Benchmark::NullSystem system(kMixerRate);
+
+	Common::Array<Fixture *> fixtures;
+	createSyntheticFixtures(fixtures);
+
+	const Common::StringArray &args = Benchmark::getArguments();
+	for (uint i = 0; i < args.size(); i++) {
+		uint32 size;
+		byte *data = readFile(args[i].c_str(), size);
+		if (!data) {
+			printf("Could not read '%s'\n", args[i].c_str());
+			continue;
+		}
+
+#ifdef USE_BINK
+		Common::String lower = args[i];
+		lower.toLowercase();
+		if (lower.hasSuffix(".bik")) {
+			runBink(args[i], data, size, system);
+			free(data);
+			continue;
+		}
+#endif
+
+		fixtures.push_back(new FileFixture(args[i], data, size));
+	}
+
+	for (uint i = 0; i < fixtures.size(); i++) {
+		runRead(*fixtures[i]);
+		runMix(*fixtures[i], system);
+		runSeek(*fixtures[i]);
+		delete fixtures[i];
+	}
+}
@@ -0,0 +1,106 @@
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/simd.h"
+#include "common/str.h"
+
+#include "test/benchmark/benchmark.h"
+
+namespace {
+
+/**
+ * Endless stream replaying a short precomputed waveform, so the benchmark
+ * measures the converters and not the decoding.
+ */
+class PatternStream : public Audio::AudioStream {
+public:
+	PatternStream(int rate, bool stereo) : _rate(rate), _stereo(stereo), _pos(0) {
+		for (int i = 0; i < kPatternSize; ++i)
+			_pattern[i] = (int16)((i * 7919) % 65536 - 32768);
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; ++i) {
+			buffer[i] = _pattern[_pos];
+			_pos = (_pos + 1) % kPatternSize;
+		}
+		return numSamples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return false; }
+
+private:
+	enum { kPatternSize = 4096 };
+
+	int16 _pattern[kPatternSize];
+	int _rate;
+	bool _stereo;
+	int _pos;
+};
+
+/**
+ * Mix a number of channels into one output buffer, the way MixerImpl does
+ * on every audio callback.
+ */
+class MixRun {
+public:
+	enum {
+		kChannels = 32,
+		kFrames = 1024
+	};
+
+	MixRun(int inRate, int outRate, bool stereo) {
+		for (int i = 0; i < kChannels; ++i) {
+			_streams[i] = new PatternStream(inRate, stereo);
+			_converters[i] = Audio::makeRateConverter(inRate, outRate, stereo, (i & 1) != 0);
+		}
+	}
+
+	~MixRun() {
+		for (int i = 0; i < kChannels; ++i) {
+			delete _converters[i];
+			delete _streams[i];
+		}
+	}
+
+	void operator()() {
+		memset(_buffer, 0, sizeof(_buffer));
+		for (int i = 0; i < kChannels; ++i)
+			_converters[i]->flow(*_streams[i], _buffer, kFrames, 200, 180);
+	}
+
+private:
+	PatternStream *_streams[kChannels];
+	Audio::RateConverter *_converters[kChannels];
+	int16 _buffer[kFrames * 2];
+};
+
+void runRate(const char *name, int inRate, int outRate, bool stereo) {
+	for (int simd = 0; simd < 2; ++simd) {
+		Common::setSIMDEnabled(simd != 0);
+		if (simd && !Common::hasSIMD())
+			break;
+
+		MixRun run(inRate, outRate, stereo);
+		uint runs;
+		const uint64 micros = Benchmark::measure(run, runs);
+
+		const Common::String variant = Common::String::format("%s %s %s", name, stereo ? "stereo" : "mono", simd ? "simd" : "c");
+		Benchmark::report("rate", variant.c_str(), micros, (double)runs * MixRun::kChannels * MixRun::kFrames, "frames");
+	}
+	Common::setSIMDEnabled(true);
+}
+
+} // End of anonymous namespace
+
+void benchmarkRateConverters() {
+	runRate("copy 44100->44100", 44100, 44100, false);
+	runRate("copy 44100->44100", 44100, 44100, true);
+	runRate("simple 44100->22050", 44100, 22050, false);
+	runRate("simple 44100->22050", 44100, 22050, true);
+	runRate("linear 22050->48000", 22050, 48000, false);
+	runRate("linear 22050->48000", 22050, 48000, true);
+}
@@ -0,0 +1,70 @@
+#ifndef TEST_BENCHMARK_H
+#define TEST_BENCHMARK_H
+
+#include "common/scummsys.h"
+#include "common/str-array.h"
+
+/**
+ * Minimal helpers shared by the micro benchmarks in this directory.
+ *
+ * The benchmarks are built into test/benchmark/runner by "make benchmark".
+ * Each benchmark is a plain function registered in the table in main.cpp,
+ * it reports its results through Benchmark::report(). They are meant to be
+ * compared between builds on the same machine, so the absolute numbers
+ * depend on the configured optimization flags.
+ */
+namespace Benchmark {
+
+/**
+ * Return a monotonic timestamp in microseconds.
+ */
+uint64 getMicros();
+
+/**
+ * Return the command line arguments which did not select a benchmark,
+ * e.g. input files.
+ */
+const Common::StringArray &getArguments();
+
+/**
+ * Return the number of heap allocations made so far by the process.
+ *
+ * Allocations are only counted on platforms where malloc can be wrapped,
+ * check isAllocationCountAvailable() before reporting them.
+ */
+uint64 getAllocationCount();
+bool isAllocationCountAvailable();
+
+/**
+ * Print a result line.
+ *
+ * @param suite   the benchmark group, e.g. "rate"
+ * @param name    the variant which was measured
+ * @param micros  the time spent
+ * @param units   the amount of work done in that time
+ * @param unitName what a unit of work is, e.g. "samples"
+ * @param extra   additional text appended to the line, may be 0
+ */
+void report(const char *suite, const char *name, uint64 micros, double units, const char *unitName, const char *extra = 0);
+
+/**
+ * Measure a whole number of runs of 'func' taking at least 'minMicros'.
+ *
+ * @return the total time spent, the number of runs is stored in 'runs'
+ */
+template<class T>
+uint64 measure(T &func, uint &runs, uint64 minMicros = 200000) {
+	runs = 0;
+	const uint64 start = getMicros();
+	uint64 elapsed;
+	do {
+		func();
+		runs++;
+		elapsed = getMicros() - start;
+	} while (elapsed < minMicros);
+	return elapsed;
+}
+
+} // End of namespace Benchmark
+
+#endif
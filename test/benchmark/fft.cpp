@@ -0,0 +1,138 @@
+#include "common/dct.h"
+#include "common/fft.h"
+#include "common/mdct.h"
+#include "common/rdft.h"
+#include "common/simd.h"
+#include "common/str.h"
+
+#include "test/benchmark/benchmark.h"
+
+namespace {
+
+enum { kMaxBits = 13 };
+
+void fillSignal(float *data, int count) {
+	for (int i = 0; i < count; ++i)
+		data[i] = (float)(((i * 7919) % 2048) - 1024) / 1024.0f;
+}
+
+/** Forward complex FFT, permutation included. */
+class FFTRun {
+public:
+	FFTRun(int bits) : _fft(bits, 0), _size(1 << bits) {
+		fillSignal(_data, _size * 2);
+	}
+
+	void operator()() {
+		_fft.permute((Common::Complex *)_data);
+		_fft.calc((Common::Complex *)_data);
+	}
+
+private:
+	Common::FFT _fft;
+	int _size;
+	float _data[(1 << kMaxBits) * 2];
+};
+
+/** Inverse real DFT, as used by the Bink audio decoder. */
+class RDFTRun {
+public:
+	RDFTRun(int bits) : _rdft(bits, Common::RDFT::IDFT_C2R), _size(1 << bits) {
+		fillSignal(_data, _size);
+	}
+
+	void operator()() {
+		_rdft.calc(_data);
+	}
+
+private:
+	Common::RDFT _rdft;
+	int _size;
+	float _data[1 << kMaxBits];
+};
+
+/** DCT-III, as used by the Bink audio decoder. */
+class DCTRun {
+public:
+	DCTRun(int bits) : _dct(bits, Common::DCT::DCT_III), _size(1 << bits) {
+		fillSignal(_data, _size + 1);
+	}
+
+	void operator()() {
+		_dct.calc(_data);
+	}
+
+private:
+	Common::DCT _dct;
+	int _size;
+	float _data[(1 << kMaxBits) + 1];
+};
+
+/** Inverse MDCT, as used by the WMA decoder. */
+class IMDCTRun {
+public:
+	IMDCTRun(int bits) : _mdct(bits, true, 1.0), _size(1 << bits) {
+		fillSignal(_input, _size / 2);
+	}
+
+	void operator()() {
+		_mdct.calcIMDCT(_output, _input);
+	}
+
+private:
+	Common::MDCT _mdct;
+	int _size;
+	float _input[1 << (kMaxBits - 1)];
+	float _output[1 << kMaxBits];
+};
+
+/**
+ * Create and destroy a transform while another one of the same size is
+ * alive, the way decoders opening a new stream do.
+ */
+class SetupRun {
+public:
+	SetupRun(int bits) : _bits(bits), _keepAlive(bits, Common::RDFT::IDFT_C2R) {}
+
+	void operator()() {
+		Common::RDFT rdft(_bits, Common::RDFT::IDFT_C2R);
+	}
+
+private:
+	int _bits;
+	Common::RDFT _keepAlive;
+};
+
+template<class Run>
+void runTransform(const char *name, int bits, double points) {
+	for (int simd = 0; simd < 2; ++simd) {
+		Common::setSIMDEnabled(simd != 0);
+		if (simd && !Common::hasSIMD())
+			break;
+
+		Run *run = new Run(bits);
+		uint runs;
+		const uint64 micros = Benchmark::measure(*run, runs);
+		delete run;
+
+		const Common::String variant = Common::String::format("%s %d %s", name, 1 << bits, simd ? "simd" : "c");
+		Benchmark::report("fft", variant.c_str(), micros, (double)runs * points, "points");
+	}
+	Common::setSIMDEnabled(true);
+}
+
+} // End of anonymous namespace
+
+void benchmarkFFT() {
+	for (int bits = 6; bits <= kMaxBits; bits += 2)
+		runTransform<FFTRun>("fft", bits, 1 << bits);
+
+	runTransform<RDFTRun>("rdft", 11, 1 << 11);
+	runTransform<DCTRun>("dct-iii", 11, 1 << 11);
+	runTransform<IMDCTRun>("imdct", 11, 1 << 11);
+
+	SetupRun setup(12);
+	uint runs;
+	const uint64 micros = Benchmark::measure(setup, runs);
+	Benchmark::report("fft", "rdft 4096 setup", micros, runs, "transforms");
+}
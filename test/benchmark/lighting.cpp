@@ -0,0 +1,241 @@
+// The benchmark runner is a host tool which prints to stdout directly
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+// Only built with the Grim engine, see test/module.mk
+#ifdef ENABLE_GRIM
+
+#include "common/array.h"
+#include "common/simd.h"
+
+#include "engines/grim/emi/vertexlighting.h"
+
+#include "test/benchmark/benchmark.h"
+
+#include <math.h>
+#include <stdio.h>
+
+/**
+ * EMI software vertex lighting benchmarks.
+ *
+ * The fixtures are meshes the size of the EMI characters, in a set with an
+ * ambient light, a directional light, omni lights and spot lights. They are
+ * lit as EMIModel::updateLighting did before, one vertex at a time with all
+ * the lights, and with VertexLighting, with and without the vector code.
+ * All of them have to give the vertices the same light.
+ */
+
+namespace {
+
+typedef Grim::VertexLighting::LightSource LightSource;
+
+class Scene {
+public:
+	Scene(int vertexCount, int omniCount, int spotCount) {
+		uint32 seed = vertexCount + omniCount * 100 + spotCount;
+
+		_vertices.resize(vertexCount);
+		_normals.resize(vertexCount);
+		_indices.resize(vertexCount);
+		for (int i = 0; i < vertexCount; i++) {
+			_vertices[i].set(random(seed), random(seed), random(seed) + 1.f);
+			_normals[i] = Math::Vector3d(random(seed), random(seed), random(seed) + 0.1f).getNormalized();
+			_indices[i] = i;
+		}
+		_modelToWorld.setPosition(Math::Vector3d(0.5f, -0.2f, 0.f));
+
+		LightSource light = makeLight(LightSource::kAmbient, seed);
+		light._intensity = 0.2f;
+		_lights.push_back(light);
+		light = makeLight(LightSource::kDirect, seed);
+		_lights.push_back(light);
+		for (int i = 0; i < omniCount; i++)
+			_lights.push_back(makeLight(LightSource::kOmni, seed));
+		for (int i = 0; i < spotCount; i++) {
+			light = makeLight(LightSource::kSpot, seed);
+			// Every other spot light has a cone narrow enough to be seen
+			if (i % 2) {
+				light._umbraAngle = 0.3f;
+				light._penumbraAngle = 0.8f;
+			}
+			_lights.push_back(light);
+		}
+	}
+
+	int getVertexCount() const { return _vertices.size(); }
+	const Math::Matrix4 &getModelToWorld() const { return _modelToWorld; }
+	const Math::Vector3d *getVertices() const { return _vertices.begin(); }
+	const Math::Vector3d *getNormals() const { return _normals.begin(); }
+	const int *getIndices() const { return _indices.begin(); }
+	const Common::Array<LightSource> &getLights() const { return _lights; }
+
+private:
+	static uint32 next(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	}
+
+	// A random number between -1 and 1
+	static float random(uint32 &seed) {
+		return (next(seed) % 2001) / 1000.f - 1.f;
+	}
+
+	static LightSource makeLight(LightSource::Type type, uint32 &seed) {
+		LightSource light;
+		light._type = type;
+		light._pos.set(random(seed) * 3.f, random(seed) * 3.f, random(seed) * 3.f + 2.f);
+		light._dir = Math::Vector3d(random(seed), random(seed), random(seed) - 1.f).getNormalized();
+		light._color[0] = (next(seed) % 256) / 255.f;
+		light._color[1] = (next(seed) % 256) / 255.f;
+		light._color[2] = (next(seed) % 256) / 255.f;
+		light._intensity = 0.5f + (next(seed) % 100) / 200.f;
+		light._falloffNear = 0.5f + (next(seed) % 100) / 100.f;
+		light._falloffFar = light._falloffNear + 1.f + (next(seed) % 300) / 100.f;
+		// The angles of the game's spot lights are in degrees
+		light._umbraAngle = 20.f;
+		light._penumbraAngle = 40.f;
+		return light;
+	}
+
+	Common::Array<Math::Vector3d> _vertices;
+	Common::Array<Math::Vector3d> _normals;
+	Common::Array<int> _indices;
+	Common::Array<LightSource> _lights;
+	Math::Matrix4 _modelToWorld;
+};
+
+enum LightMode {
+	kPerVertex,
+	kScalar,
+	kSIMD
+};
+
+class Lighter {
+public:
+	Lighter(const Scene &scene, LightMode mode) : _scene(scene), _mode(mode) {
+		_results.resize(scene.getVertexCount());
+	}
+
+	void operator()() {
+		if (_mode == kPerVertex) {
+			lightPerVertex();
+			return;
+		}
+
+		_lighting.setVertices(_scene.getModelToWorld(), _scene.getVertices(), _scene.getNormals(),
+		                      _scene.getIndices(), _scene.getVertexCount());
+		const Common::Array<LightSource> &lights = _scene.getLights();
+		for (uint i = 0; i < lights.size(); i++)
+			_lighting.addLight(lights[i]);
+		_lighting.getResults(_results.begin());
+	}
+
+	const Common::Array<Math::Vector3d> &getResults() const { return _results; }
+
+private:
+	// What EMIModel::updateLighting did before
+	void lightPerVertex() {
+		const Common::Array<LightSource> &lights = _scene.getLights();
+		for (int i = 0; i < _scene.getVertexCount(); i++) {
+			Math::Vector3d &result = _results[i];
+			result.set(0.0f, 0.0f, 0.0f);
+
+			Math::Vector3d normal = _scene.getNormals()[i];
+			Math::Vector3d vertex = _scene.getVertices()[i];
+			_scene.getModelToWorld().transform(&vertex, true);
+			_scene.getModelToWorld().transform(&normal, false);
+
+			for (uint j = 0; j < lights.size(); ++j) {
+				const LightSource *l = &lights[j];
+				float shade = l->_intensity;
+
+				if (l->_type != LightSource::kAmbient) {
+					Math::Vector3d dir = l->_dir;
+
+					if (l->_type != LightSource::kDirect) {
+						dir = l->_pos - vertex;
+						float distSq = dir.getSquareMagnitude();
+						if (distSq > l->_falloffFar * l->_falloffFar)
+							continue;
+
+						dir.normalize();
+
+						if (distSq > l->_falloffNear * l->_falloffNear) {
+							float dist = sqrt(distSq);
+							float attn = 1.0f - (dist - l->_falloffNear) / (l->_falloffFar - l->_falloffNear);
+							shade *= attn;
+						}
+					}
+
+					if (l->_type == LightSource::kSpot) {
+						float cosAngle = l->_dir.dotProduct(dir);
+						if (cosAngle < 0.0f)
+							continue;
+
+						float angle = acos(cosAngle);
+						if (angle > l->_penumbraAngle)
+							continue;
+
+						if (angle > l->_umbraAngle)
+							shade *= 1.0f - (angle - l->_umbraAngle) / (l->_penumbraAngle - l->_umbraAngle);
+					}
+
+					float dot = MAX(0.0f, normal.dotProduct(dir));
+					shade *= dot;
+				}
+
+				result += Math::Vector3d(l->_color[0], l->_color[1], l->_color[2]) * shade;
+			}
+
+			float max = MAX(MAX(result.x(), result.y()), result.z());
+			if (max > 1.0f)
+				result /= max;
+		}
+	}
+
+	const Scene &_scene;
+	LightMode _mode;
+	Grim::VertexLighting _lighting;
+	Common::Array<Math::Vector3d> _results;
+};
+
+float getMaxError(const Lighter &lighter, const Lighter &reference) {
+	float error = 0.f;
+	for (uint i = 0; i < lighter.getResults().size(); i++)
+		error = MAX(error, (lighter.getResults()[i] - reference.getResults()[i]).getMagnitude());
+	return error;
+}
+
+void runScene(int vertexCount, int omniCount, int spotCount) {
+	static const char *const modeNames[] = { "per vertex", "scalar", "simd" };
+
+	Scene scene(vertexCount, omniCount, spotCount);
+	Lighter reference(scene, kPerVertex);
+	reference();
+
+	for (int mode = kPerVertex; mode <= kSIMD; mode++) {
+		Common::setSIMDEnabled(mode == kSIMD);
+		if (mode == kSIMD && !Common::hasSIMD())
+			break;
+
+		Lighter lighter(scene, (LightMode)mode);
+		uint runs;
+		const uint64 micros = Benchmark::measure(lighter, runs);
+
+		const float error = getMaxError(lighter, reference);
+		char name[64], extra[64];
+		snprintf(name, sizeof(name), "%d vertices %d lights %s", vertexCount, (int)scene.getLights().size(), modeNames[mode]);
+		snprintf(extra, sizeof(extra), "%.1f us per mesh, %s", (double)micros / runs, error < 1e-4f ? "ok" : "MISMATCH");
+		Benchmark::report("lighting", name, micros, (double)runs * vertexCount * scene.getLights().size(), "vertex lights", extra);
+	}
+	Common::setSIMDEnabled(true);
+}
+
+} // End of anonymous namespace
+
+void benchmarkLighting() {
+	runScene(500, 2, 0);
+	runScene(2000, 3, 2);
+	runScene(8000, 6, 4);
+}
+
+#endif
@@ -0,0 +1,185 @@
+// The benchmark runner is a host tool which prints to stdout directly
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+// Only built with the Grim engine, see test/module.mk
+#ifdef ENABLE_GRIM
+
+#include "engines/grim/lua/lua.h"
+#include "engines/grim/lua/lualib.h"
+
+#include "test/benchmark/benchmark.h"
+#include "test/benchmark/null_system.h"
+
+#include <stdio.h>
+
+/**
+ * Grim Lua interpreter benchmarks.
+ *
+ * Each snippet is a loop in the style of the game scripts, written in the
+ * Lua 3.1 of the engine: arithmetic on locals, global counters, fields and
+ * methods of actor-like tables, some of them inherited through an "index"
+ * tag method, table constructors, string concatenation and calls of
+ * functions with upvalues. Every snippet returns a checksum, which has to
+ * match the one computed here.
+ */
+
+namespace Grim {
+// Only used by the task code for the quirks of the game and the frame time,
+// which the snippets don't need
+class GrimEngine;
+GrimEngine *g_grim = nullptr;
+}
+
+namespace {
+
+const char *const script =
+	"function arithmetic(n)\n"
+	"  local i, s = 1, 0\n"
+	"  while i <= n do\n"
+	"    s = s + i * 3 - i\n"
+	"    i = i + 1\n"
+	"  end\n"
+	"  return s\n"
+	"end\n"
+	"\n"
+	"counter = 0\n"
+	"step = 2\n"
+	"function globals(n)\n"
+	"  counter = 0\n"
+	"  local i = 1\n"
+	"  while i <= n do\n"
+	"    counter = counter + step\n"
+	"    i = i + 1\n"
+	"  end\n"
+	"  return counter\n"
+	"end\n"
+	"\n"
+	"function fields(n)\n"
+	"  local pos = { x = 1, y = 2, z = 3, name = 'manny', visible = 1 }\n"
+	"  local i, s = 1, 0\n"
+	"  while i <= n do\n"
+	"    s = s + pos.x + pos.y * pos.z\n"
+	"    i = i + 1\n"
+	"  end\n"
+	"  return s\n"
+	"end\n"
+	"\n"
+	"Actor = { hname = 'actor' }\n"
+	"function Actor:walk(dx) self.x = self.x + dx return self.x end\n"
+	"function Actor:new(x) return { x = x, y = 0, walk = Actor.walk } end\n"
+	"function methods(n)\n"
+	"  local a = Actor:new(0)\n"
+	"  local i = 1\n"
+	"  while i <= n do\n"
+	"    a:walk(1)\n"
+	"    i = i + 1\n"
+	"  end\n"
+	"  return a.x\n"
+	"end\n"
+	"\n"
+	"Base = { speed = 3 }\n"
+	"function Base:move(t) return self.speed * t end\n"
+	"derivedtag = newtag()\n"
+	"settagmethod(derivedtag, 'index', function(t, i) return %Base[i] end)\n"
+	"function inherited(n)\n"
+	"  local d = { name = 'glottis' }\n"
+	"  settag(d, derivedtag)\n"
+	"  local i, s = 1, 0\n"
+	"  while i <= n do\n"
+	"    s = s + d:move(2)\n"
+	"    i = i + 1\n"
+	"  end\n"
+	"  return s\n"
+	"end\n"
+	"\n"
+	"function tables(n)\n"
+	"  local i, s = 1, 0\n"
+	"  while i <= n do\n"
+	"    local t = { i, 2; x = i, y = 1 }\n"
+	"    s = s + t.x + t[2]\n"
+	"    i = i + 1\n"
+	"  end\n"
+	"  return s\n"
+	"end\n"
+	"\n"
+	"function strings(n)\n"
+	"  local i, s = 1, 0\n"
+	"  while i <= n do\n"
+	"    local name = 'actor' .. i\n"
+	"    if name ~= 'actor' then s = s + 1 end\n"
+	"    i = i + 1\n"
+	"  end\n"
+	"  return s\n"
+	"end\n"
+	"\n"
+	"function calls(n)\n"
+	"  local k = 2\n"
+	"  local f = function(x) return x + %k end\n"
+	"  local i, s = 1, 0\n"
+	"  while i <= n do\n"
+	"    s = f(s)\n"
+	"    i = i + 1\n"
+	"  end\n"
+	"  return s\n"
+	"end\n";
+
+class Snippet {
+public:
+	Snippet(const char *function, int iterations) : _function(function), _iterations(iterations), _result(0.f) {}
+
+	void operator()() {
+		Grim::lua_beginblock();
+		Grim::lua_pushnumber((float)_iterations);
+		Grim::lua_callfunction(Grim::lua_getglobal(_function));
+		_result = Grim::lua_getnumber(Grim::lua_getresult(1));
+		Grim::lua_endblock();
+	}
+
+	float getResult() const { return _result; }
+
+private:
+	const char *_function;
+	int _iterations;
+	float _result;
+};
+
+void runSnippet(const char *function, int iterations, float expected) {
+	Snippet snippet(function, iterations);
+	uint runs;
+	const uint64 micros = Benchmark::measure(snippet, runs);
+
+	char extra[64];
+	snprintf(extra, sizeof(extra), "%.1f us per call, %s", (double)micros / runs,
+	         snippet.getResult() == expected ? "ok" : "MISMATCH");
+	Benchmark::report("lua", function, micros, (double)runs * iterations, "iterations", extra);
+}
+
+} // End of anonymous namespace
+
+void benchmarkLua() {
+	// The garbage collector reads the time
+	Benchmark::NullSystem system;
+
+	Grim::lua_open();
+	Grim::lua_mathlibopen();
+	if (Grim::lua_dostring(script)) {
+		printf("lua: the script doesn't compile\n");
+		Grim::lua_close();
+		return;
+	}
+
+	// The sums stay well inside the integers which floats represent exactly
+	const int n = 1000;
+	runSnippet("arithmetic", n, (float)n * (n + 1));
+	runSnippet("globals", n, 2.f * n);
+	runSnippet("fields", n, 7.f * n);
+	runSnippet("methods", n, (float)n);
+	runSnippet("inherited", n, 6.f * n);
+	runSnippet("tables", n, (float)n * (n + 1) / 2 + 2.f * n);
+	runSnippet("strings", n, (float)n);
+	runSnippet("calls", n, 2.f * n);
+
+	Grim::lua_close();
+}
+
+#endif
@@ -0,0 +1,158 @@
+// The benchmark runner is a host tool which prints to stdout directly
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/scummsys.h"
+#include "common/simd.h"
+
+#include "test/benchmark/benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef POSIX
+#include <sys/time.h>
+#endif
+
+void benchmarkRateConverters();
+void benchmarkAudioDecoders();
+void benchmarkFFT();
+void benchmarkYUV();
+void benchmarkSmacker();
+void benchmarkSeek();
+#ifdef ENABLE_GRIM
+void benchmarkPathfinding();
+void benchmarkTextParse();
+void benchmarkAnimation();
+void benchmarkSkinning();
+void benchmarkLighting();
+void benchmarkLua();
+#endif
+
+namespace {
+
+struct BenchmarkEntry {
+	const char *name;
+	void (*func)();
+};
+
+const BenchmarkEntry benchmarks[] = {
+	{ "rate", benchmarkRateConverters },
+	{ "decoders", benchmarkAudioDecoders },
+	{ "fft", benchmarkFFT },
+	{ "yuv", benchmarkYUV },
+	{ "smacker", benchmarkSmacker },
+	{ "seek", benchmarkSeek },
+#ifdef ENABLE_GRIM
+	{ "path", benchmarkPathfinding },
+	{ "textparse", benchmarkTextParse },
+	{ "animation", benchmarkAnimation },
+	{ "skinning", benchmarkSkinning },
+	{ "lighting", benchmarkLighting },
+	{ "lua", benchmarkLua },
+#endif
+	{ 0, 0 }
+};
+
+Common::StringArray arguments;
+
+uint64 allocationCount = 0;
+
+} // End of anonymous namespace
+
+#ifdef __GLIBC__
+// Count heap allocations by wrapping the C library allocator. operator new
+// ends up here as well.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t num, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) __THROW {
+	allocationCount++;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t num, size_t size) __THROW {
+	allocationCount++;
+	return __libc_calloc(num, size);
+}
+
+void *realloc(void *ptr, size_t size) __THROW {
+	allocationCount++;
+	return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+namespace Benchmark {
+
+const Common::StringArray &getArguments() {
+	return arguments;
+}
+
+uint64 getAllocationCount() {
+	return allocationCount;
+}
+
+bool isAllocationCountAvailable() {
+#ifdef __GLIBC__
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint64 getMicros() {
+#ifdef POSIX
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return (uint64)tv.tv_sec * 1000000 + tv.tv_usec;
+#else
+	return (uint64)clock() * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+void report(const char *suite, const char *name, uint64 micros, double units, const char *unitName, const char *extra) {
+	const double seconds = micros / 1000000.0;
+	printf("%-12s %-40s %10.3f ms %14.1f %s/s %10.3f ns/%s%s%s\n", suite, name, micros / 1000.0,
+	       seconds > 0 ? units / seconds : 0.0, unitName, units > 0 ? micros * 1000.0 / units : 0.0, unitName,
+	       extra ? " " : "", extra ? extra : "");
+}
+
+} // End of namespace Benchmark
+
+int main(int argc, char *argv[]) {
+	if (argc > 1 && (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help"))) {
+		printf("Usage: %s [benchmark...] [argument...]\n\n", argv[0]);
+		printf("Arguments which are not benchmark names are passed on to the\n"
+		       "benchmarks, e.g. the files to decode.\n\nAvailable benchmarks:\n");
+		for (const BenchmarkEntry *b = benchmarks; b->name; ++b)
+			printf("  %s\n", b->name);
+		return 0;
+	}
+
+	// Split the command line into benchmark names and arguments
+	bool selected[ARRAYSIZE(benchmarks)];
+	bool anySelected = false;
+	memset(selected, 0, sizeof(selected));
+	for (int i = 1; i < argc; ++i) {
+		bool isName = false;
+		for (uint j = 0; benchmarks[j].name; ++j) {
+			if (!strcmp(argv[i], benchmarks[j].name)) {
+				selected[j] = anySelected = isName = true;
+			}
+		}
+		if (!isName)
+			arguments.push_back(argv[i]);
+	}
+
+	printf("Vector kernels: %s\n", Common::hasSIMD() ? "available" : "not available");
+
+	for (uint j = 0; benchmarks[j].name; ++j) {
+		if (selected[j] || !anySelected)
+			benchmarks[j].func();
+	}
+
+	return 0;
+}
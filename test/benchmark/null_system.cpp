@@ -0,0 +1,78 @@
+// Log messages of the null system go straight to stderr
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/benchmark/null_system.h"
+#include "test/benchmark/benchmark.h"
+
+#include "audio/mixer_intern.h"
+#include "graphics/pixelbuffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace Benchmark {
+
+NullSystem::NullSystem(uint outputRate) : _mixer(0) {
+	_startMicros = getMicros();
+	g_system = this;
+
+	_mixer = new Audio::MixerImpl(this, outputRate);
+	_mixer->setReady(true);
+}
+
+NullSystem::~NullSystem() {
+	delete _mixer;
+	_mixer = 0;
+
+	if (g_system == this)
+		g_system = 0;
+}
+
+const OSystem::GraphicsMode *NullSystem::getSupportedGraphicsModes() const {
+	static const GraphicsMode modes[] = {
+		{ "null", "No output", 0 },
+		{ 0, 0, 0 }
+	};
+	return modes;
+}
+
+Graphics::PixelFormat NullSystem::getScreenFormat() const {
+	return Graphics::PixelFormat::createFormatCLUT8();
+}
+
+Common::List<Graphics::PixelFormat> NullSystem::getSupportedFormats() const {
+	Common::List<Graphics::PixelFormat> list;
+	list.push_back(Graphics::PixelFormat::createFormatCLUT8());
+	return list;
+}
+
+Graphics::PixelBuffer NullSystem::getScreenPixelBuffer() {
+	return Graphics::PixelBuffer();
+}
+
+Graphics::PixelFormat NullSystem::getOverlayFormat() const {
+	return Graphics::PixelFormat::createFormatCLUT8();
+}
+
+uint32 NullSystem::getMillis(bool skipRecord) {
+	return (uint32)((getMicros() - _startMicros) / 1000);
+}
+
+uint64 NullSystem::getMicros() {
+	return Benchmark::getMicros();
+}
+
+void NullSystem::getTimeAndDate(TimeDate &t) const {
+	memset(&t, 0, sizeof(t));
+}
+
+Audio::Mixer *NullSystem::getMixer() {
+	return _mixer;
+}
+
+void NullSystem::logMessage(LogMessageType::Type type, const char *message) {
+	fputs(message, stderr);
+	fflush(stderr);
+}
+
+} // End of namespace Benchmark
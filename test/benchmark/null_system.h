@@ -0,0 +1,89 @@
+#ifndef TEST_BENCHMARK_NULL_SYSTEM_H
+#define TEST_BENCHMARK_NULL_SYSTEM_H
+
+#include "common/system.h"
+
+namespace Audio {
+class MixerImpl;
+}
+
+namespace Benchmark {
+
+/**
+ * An OSystem without any devices, for driving code which needs g_system
+ * (mutexes, the clock, the mixer) from the benchmarks.
+ *
+ * Mutexes are no-ops, so everything must run on the calling thread. The
+ * mixer is never called back on its own; benchmarks pull samples from it
+ * with MixerImpl::mixCallback().
+ */
+class NullSystem : public OSystem {
+public:
+	NullSystem(uint outputRate = 44100);
+	~NullSystem();
+
+	Audio::MixerImpl *getMixerImpl() { return _mixer; }
+
+	// Graphics
+	const GraphicsMode *getSupportedGraphicsModes() const;
+	int getDefaultGraphicsMode() const { return 0; }
+	bool setGraphicsMode(int mode) { return true; }
+	int getGraphicsMode() const { return 0; }
+	Graphics::PixelFormat getScreenFormat() const;
+	Common::List<Graphics::PixelFormat> getSupportedFormats() const;
+	void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL) {}
+	void launcherInitSize(uint width, uint height) {}
+	void setupScreen(uint screenW, uint screenH, bool fullscreen, bool accel3d) {}
+	Graphics::PixelBuffer getScreenPixelBuffer();
+	int16 getHeight() { return 0; }
+	int16 getWidth() { return 0; }
+	PaletteManager *getPaletteManager() { return 0; }
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	Graphics::Surface *lockScreen() { return 0; }
+	void unlockScreen() {}
+	void fillScreen(uint32 col) {}
+	void updateScreen() {}
+	void setShakePos(int shakeOffset) {}
+	void showOverlay() {}
+	void hideOverlay() {}
+	Graphics::PixelFormat getOverlayFormat() const;
+	void clearOverlay() {}
+	void grabOverlay(void *buf, int pitch) {}
+	void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	int16 getOverlayHeight() { return 0; }
+	int16 getOverlayWidth() { return 0; }
+
+	// Mouse
+	bool showMouse(bool visible) { return false; }
+	bool lockMouse(bool lock) { return false; }
+	void warpMouse(int x, int y) {}
+	void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale = false, const Graphics::PixelFormat *format = NULL) {}
+
+	// Time
+	uint32 getMillis(bool skipRecord = false);
+	uint64 getMicros();
+	void delayMillis(uint msecs) {}
+	void getTimeAndDate(TimeDate &t) const;
+
+	// Mutexes
+	MutexRef createMutex() { return (MutexRef)this; }
+	void lockMutex(MutexRef mutex) {}
+	void unlockMutex(MutexRef mutex) {}
+	void deleteMutex(MutexRef mutex) {}
+
+	// Sound
+	Audio::Mixer *getMixer();
+
+	// Misc
+	void quit() {}
+	void displayMessageOnOSD(const char *msg) {}
+	void logMessage(LogMessageType::Type type, const char *message);
+
+private:
+	Audio::MixerImpl *_mixer;
+	uint64 _startMicros;
+};
+
+} // End of namespace Benchmark
+
+#endif
@@ -0,0 +1,389 @@
+// The benchmark runner is a host tool which prints to stdout directly
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+// Only built with the Grim engine, see test/module.mk
+#ifdef ENABLE_GRIM
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/str.h"
+
+#include "engines/grim/walkgraph.h"
+
+#include "test/benchmark/benchmark.h"
+
+/**
+ * Grim path finding benchmarks.
+ *
+ * The fixtures are grids of square walk boxes with some boxes missing, like
+ * a set with obstacles. Random walks between boxes are searched with the
+ * precomputed WalkGraph, and with a copy of the search Actor::walkTo did
+ * before, which scanned lists and looked for the bridges between every
+ * pair of boxes while searching. Both have to find paths of the same length.
+ */
+
+namespace {
+
+/** A fixed sequence of pseudo random numbers. */
+class Random {
+public:
+	Random(uint32 seed) : _seed(seed) {}
+
+	uint getNumber(uint max) {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 8) % (max + 1);
+	}
+
+private:
+	uint32 _seed;
+};
+
+struct Box {
+	Math::Vector3d vertices[5];
+	bool enabled;
+};
+
+class BoxMesh {
+public:
+	BoxMesh(int size, int holePercent) : _size(size) {
+		Random random(size * 100 + holePercent);
+
+		_boxes.resize(size * size);
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				Box &box = _boxes[y * size + x];
+				box.vertices[0] = Math::Vector3d(x, y, 0.f);
+				box.vertices[1] = Math::Vector3d(x + 1, y, 0.f);
+				box.vertices[2] = Math::Vector3d(x + 1, y + 1, 0.f);
+				box.vertices[3] = Math::Vector3d(x, y + 1, 0.f);
+				box.vertices[4] = box.vertices[0];
+				box.enabled = (int)random.getNumber(99) >= holePercent;
+			}
+		}
+	}
+
+	int getBoxCount() const { return _boxes.size(); }
+	const Box &getBox(int i) const { return _boxes[i]; }
+	Math::Vector3d getCenter(int i) const { return Math::Vector3d(i % _size + 0.5f, i / _size + 0.5f, 0.f); }
+
+	bool isPointInBox(int i, const Math::Vector3d &p) const {
+		const Math::Vector3d *v = _boxes[i].vertices;
+		return p.x() >= v[0].x() && p.x() <= v[2].x() && p.y() >= v[0].y() && p.y() <= v[2].y();
+	}
+
+	Math::Vector3d getClosestPoint(int i, const Math::Vector3d &p) const {
+		const Math::Vector3d *v = _boxes[i].vertices;
+		return Math::Vector3d(CLIP(p.x(), v[0].x(), v[2].x()), CLIP(p.y(), v[0].y(), v[2].y()), 0.f);
+	}
+
+	/** The edges of a box which are inside another one, as Sector::getBridgesTo() does it. */
+	Common::List<Math::Line3d> getBridges(int from, int to) const {
+		const Math::Vector3d *a = _boxes[from].vertices;
+		const Math::Vector3d *b = _boxes[to].vertices;
+		const Math::Vector3d normal(0.f, 0.f, 1.f);
+
+		Common::List<Math::Line3d> bridges;
+		for (int i = 0; i < 4; i++)
+			bridges.push_back(Math::Line3d(a[i], a[i + 1]));
+
+		for (int i = 0; i < 4; i++) {
+			Math::Line3d line(b[i], b[i + 1]);
+			Math::Vector3d edge = line.end() - line.begin();
+			Common::List<Math::Line3d>::iterator it = bridges.begin();
+			while (it != bridges.end()) {
+				Math::Line3d &bridge = *it;
+				Math::Vector3d pos;
+				bool b1Out = Math::Vector3d::crossProduct(edge, bridge.begin() - line.begin()).dotProduct(normal) < 0;
+				bool b2Out = Math::Vector3d::crossProduct(edge, bridge.end() - line.begin()).dotProduct(normal) < 0;
+
+				if (b1Out && b2Out) {
+					it = bridges.erase(it);
+					continue;
+				} else if (b1Out) {
+					if (bridge.intersectLine2d(line, &pos, false))
+						bridge = Math::Line3d(pos, bridge.end());
+				} else if (b2Out) {
+					if (bridge.intersectLine2d(line, &pos, false))
+						bridge = Math::Line3d(bridge.begin(), pos);
+				}
+				++it;
+			}
+		}
+
+		return bridges;
+	}
+
+private:
+	int _size;
+	Common::Array<Box> _boxes;
+};
+
+float getPathLength(const Math::Vector3d &start, const Common::List<Math::Vector3d> &path) {
+	// The path is stored from the end to the start
+	float length = 0.f;
+	Math::Vector3d next = start;
+	for (Common::List<Math::Vector3d>::const_iterator i = path.reverse_begin(); i != path.end(); --i) {
+		length += (*i - next).getMagnitude();
+		next = *i;
+	}
+	return length;
+}
+
+class MeshQuery : public Grim::WalkGraph::PathQuery {
+public:
+	MeshQuery(const BoxMesh &mesh, const Math::Vector3d &dest) : _mesh(mesh), _dest(dest) {}
+
+	bool isNodeEnabled(int node) override { return _mesh.getBox(node).enabled; }
+	bool isGoal(int node) override { return _mesh.isPointInBox(node, _dest); }
+	Math::Vector3d getTarget(int node) override { return _mesh.getClosestPoint(node, _dest); }
+	Math::Vector3d adjustStep(const Math::Vector3d &from, const Math::Vector3d &to) override { return to; }
+
+private:
+	const BoxMesh &_mesh;
+	Math::Vector3d _dest;
+};
+
+struct PathNode {
+	int box;
+	PathNode *parent;
+	Math::Vector3d pos;
+	float dist;
+	float cost;
+};
+
+/** The search Actor::walkTo used to do, with open and closed lists. */
+bool findPathWithLists(const BoxMesh &mesh, int startBox, const Math::Vector3d &startPos, const Math::Vector3d &dest, Common::List<Math::Vector3d> &path) {
+	Common::List<PathNode *> openList;
+	Common::List<PathNode *> closedList;
+	bool pathFound = false;
+
+	PathNode *start = new PathNode;
+	start->box = startBox;
+	start->parent = nullptr;
+	start->pos = startPos;
+	start->dist = 0.f;
+	start->cost = 0.f;
+	openList.push_back(start);
+
+	Common::List<int> boxes;
+	for (int i = 0; i < mesh.getBoxCount(); i++) {
+		if (mesh.getBox(i).enabled)
+			boxes.push_back(i);
+	}
+
+	do {
+		PathNode *node = nullptr;
+		float cost = -1.f;
+		for (Common::List<PathNode *>::iterator j = openList.begin(); j != openList.end(); ++j) {
+			float c = (*j)->dist + (*j)->cost;
+			if (cost < 0.f || c < cost) {
+				cost = c;
+				node = *j;
+			}
+		}
+		closedList.push_back(node);
+		openList.remove(node);
+
+		if (mesh.isPointInBox(node->box, dest)) {
+			for (PathNode *n = node; n->parent; n = n->parent)
+				path.push_back(n->pos);
+			pathFound = true;
+			break;
+		}
+
+		for (Common::List<int>::iterator i = boxes.begin(); i != boxes.end(); ++i) {
+			bool inClosed = false;
+			for (Common::List<PathNode *>::iterator j = closedList.begin(); j != closedList.end(); ++j) {
+				if ((*j)->box == *i) {
+					inClosed = true;
+					break;
+				}
+			}
+			if (inClosed)
+				continue;
+
+			Common::List<Math::Line3d> bridges = mesh.getBridges(node->box, *i);
+			if (bridges.empty())
+				continue;
+
+			Math::Vector3d closestPoint = mesh.getClosestPoint(*i, dest);
+			Math::Vector3d best;
+			float bestDist = 1e6f;
+			Math::Line3d l(node->pos, closestPoint);
+			while (!bridges.empty()) {
+				Math::Line3d bridge = bridges.back();
+				Math::Vector3d pos;
+				if (!bridge.intersectLine2d(l, &pos, false)) {
+					pos = bridge.middle();
+				} else {
+					best = pos;
+					break;
+				}
+				float dist = (pos - closestPoint).getMagnitude();
+				if (dist < bestDist) {
+					bestDist = dist;
+					best = pos;
+				}
+				bridges.pop_back();
+			}
+
+			PathNode *n = nullptr;
+			for (Common::List<PathNode *>::iterator j = openList.begin(); j != openList.end(); ++j) {
+				if ((*j)->box == *i) {
+					n = *j;
+					break;
+				}
+			}
+			if (n) {
+				float newCost = node->cost + (best - node->pos).getMagnitude();
+				if (newCost < n->cost) {
+					n->cost = newCost;
+					n->parent = node;
+					n->pos = best;
+					n->dist = (n->pos - dest).getMagnitude();
+				}
+			} else {
+				n = new PathNode;
+				n->box = *i;
+				n->parent = node;
+				n->pos = best;
+				n->dist = (n->pos - dest).getMagnitude();
+				n->cost = node->cost + (n->pos - node->pos).getMagnitude();
+				openList.push_back(n);
+			}
+		}
+	} while (!openList.empty());
+
+	for (Common::List<PathNode *>::iterator j = closedList.begin(); j != closedList.end(); ++j)
+		delete *j;
+	for (Common::List<PathNode *>::iterator j = openList.begin(); j != openList.end(); ++j)
+		delete *j;
+
+	return pathFound;
+}
+
+struct Walk {
+	int startBox;
+	Math::Vector3d start;
+	Math::Vector3d dest;
+};
+
+class PathRun {
+public:
+	PathRun(const BoxMesh &mesh, const Common::Array<Walk> &walks, Grim::WalkGraph *graph) :
+			_mesh(mesh), _walks(walks), _graph(graph) {
+		_lengths.resize(walks.size());
+	}
+
+	void operator()() {
+		for (uint i = 0; i < _walks.size(); i++) {
+			const Walk &walk = _walks[i];
+			Common::List<Math::Vector3d> path;
+			bool found;
+			if (_graph) {
+				MeshQuery query(_mesh, walk.dest);
+				found = _graph->findPath(walk.startBox, walk.start, walk.dest, query, path);
+			} else {
+				found = findPathWithLists(_mesh, walk.startBox, walk.start, walk.dest, path);
+			}
+
+			_lengths[i] = found ? getPathLength(walk.start, path) : -1.f;
+		}
+	}
+
+	/** The length of each path found by the last run, or -1 when there was none. */
+	const Common::Array<float> &getLengths() const { return _lengths; }
+
+private:
+	const BoxMesh &_mesh;
+	const Common::Array<Walk> &_walks;
+	Grim::WalkGraph *_graph;
+	Common::Array<float> _lengths;
+};
+
+/** Build the graph like Set does, skipping the boxes which are too far apart to touch. */
+void buildGraph(const BoxMesh &mesh, Grim::WalkGraph &graph) {
+	graph.reset(mesh.getBoxCount(), false);
+	for (int i = 0; i < mesh.getBoxCount(); i++) {
+		const Math::Vector3d *a = mesh.getBox(i).vertices;
+		for (int j = 0; j < mesh.getBoxCount(); j++) {
+			const Math::Vector3d *b = mesh.getBox(j).vertices;
+			if (i == j || a[0].x() > b[2].x() || b[0].x() > a[2].x() || a[0].y() > b[2].y() || b[0].y() > a[2].y())
+				continue;
+
+			Common::List<Math::Line3d> bridges = mesh.getBridges(i, j);
+			if (!bridges.empty())
+				graph.addEdge(i, j, bridges);
+		}
+	}
+}
+
+class BuildRun {
+public:
+	BuildRun(const BoxMesh &mesh) : _mesh(mesh) {}
+
+	void operator()() {
+		Grim::WalkGraph graph;
+		buildGraph(_mesh, graph);
+	}
+
+private:
+	const BoxMesh &_mesh;
+};
+
+void runMesh(int size, int holePercent, int walkCount) {
+	BoxMesh mesh(size, holePercent);
+
+	Random random(size);
+	Common::Array<int> enabled;
+	for (int i = 0; i < mesh.getBoxCount(); i++) {
+		if (mesh.getBox(i).enabled)
+			enabled.push_back(i);
+	}
+
+	Common::Array<Walk> walks;
+	for (int i = 0; i < walkCount; i++) {
+		Walk walk;
+		walk.startBox = enabled[random.getNumber(enabled.size() - 1)];
+		walk.start = mesh.getCenter(walk.startBox);
+		walk.dest = mesh.getCenter(enabled[random.getNumber(enabled.size() - 1)]);
+		walks.push_back(walk);
+	}
+
+	BuildRun build(mesh);
+	uint buildRuns;
+	const uint64 buildMicros = Benchmark::measure(build, buildRuns);
+
+	Grim::WalkGraph graph;
+	buildGraph(mesh, graph);
+
+	PathRun lists(mesh, walks, nullptr);
+	PathRun heap(mesh, walks, &graph);
+	uint listRuns, heapRuns;
+	const uint64 listMicros = Benchmark::measure(lists, listRuns);
+	const uint64 heapMicros = Benchmark::measure(heap, heapRuns);
+
+	bool ok = true;
+	for (uint i = 0; i < walks.size(); i++) {
+		if (fabs(lists.getLengths()[i] - heap.getLengths()[i]) > 0.001f)
+			ok = false;
+	}
+
+	const Common::String name = Common::String::format("%dx%d boxes, %d%% holes", size, size, holePercent);
+	Common::String listName = name + " lists";
+	Common::String heapName = name + " graph";
+	Common::String extra = Common::String::format("%8.1f us/build %d edges %s", (double)buildMicros / buildRuns, graph.getEdgeCount(), ok ? "ok" : "MISMATCH");
+
+	Benchmark::report("path", listName.c_str(), listMicros, (double)listRuns * walks.size(), "paths");
+	Benchmark::report("path", heapName.c_str(), heapMicros, (double)heapRuns * walks.size(), "paths", extra.c_str());
+}
+
+} // End of anonymous namespace
+
+void benchmarkPathfinding() {
+	runMesh(8, 20, 64);
+	runMesh(16, 25, 64);
+	runMesh(24, 30, 32);
+}
+
+#endif
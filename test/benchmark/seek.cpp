@@ -0,0 +1,234 @@
+// Input files are read with stdio, there is no file system backend here
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "graphics/surface.h"
+
+#ifdef USE_BINK
+#include "video/bink_decoder.h"
+#endif
+#include "video/smk_decoder.h"
+
+#include "test/benchmark/benchmark.h"
+#include "test/benchmark/null_system.h"
+#include "test/benchmark/smacker_encoder.h"
+
+#include <stdio.h>
+
+/**
+ * Video seeking latency benchmarks.
+ *
+ * Each run seeks to a fixed list of scattered frames and decodes the frame
+ * there, which is what a player does when jumping around in a movie. This
+ * is compared to rewinding and decoding up to the frame, which is all
+ * decoders without a keyframe index could do.
+ *
+ * The synthetic Smacker fixture has a keyframe every two seconds, or only
+ * the first one, and is checked against the source images. Files given on
+ * the command line ending in .smk or .bik are measured too, and checked
+ * against playing them.
+ */
+
+namespace {
+
+using Benchmark::SmackerEncoder;
+
+const int kSeekCount = 16;
+
+/** Scattered frames to seek to, in no particular order. */
+void getSeekTargets(int frameCount, Common::Array<int> &targets) {
+	uint32 seed = 12345;
+	targets.clear();
+	for (int i = 0; i < kSeekCount; i++) {
+		seed = seed * 1103515245 + 12345;
+		targets.push_back((seed >> 8) % frameCount);
+	}
+}
+
+/** A checksum of the visible pixels of a frame. */
+uint32 hashSurface(const Graphics::Surface *surface) {
+	if (!surface)
+		return 0;
+
+	uint32 hash = 2166136261u;
+	for (int y = 0; y < surface->h; y++) {
+		const byte *row = (const byte *)surface->getBasePtr(0, y);
+		for (int x = 0; x < surface->w * surface->format.bytesPerPixel; x++)
+			hash = (hash ^ row[x]) * 16777619u;
+	}
+
+	return hash;
+}
+
+/** Go to each target frame and decode it. */
+class SeekRun {
+public:
+	SeekRun(Video::VideoDecoder *decoder, const Common::Array<int> &targets, bool useSeek) :
+			_decoder(decoder), _targets(targets), _useSeek(useSeek) {
+		_hashes.resize(targets.size());
+	}
+
+	void operator()() {
+		for (uint i = 0; i < _targets.size(); i++) {
+			if (_useSeek) {
+				_decoder->seekToFrame(_targets[i]);
+			} else {
+				_decoder->rewind();
+				for (int frame = 0; frame < _targets[i]; frame++)
+					_decoder->decodeNextFrame();
+			}
+
+			_hashes[i] = hashSurface(_decoder->decodeNextFrame());
+		}
+	}
+
+	/** The checksums of the frames decoded by the last run. */
+	const Common::Array<uint32> &getHashes() const { return _hashes; }
+
+private:
+	Video::VideoDecoder *_decoder;
+	const Common::Array<int> &_targets;
+	bool _useSeek;
+	Common::Array<uint32> _hashes;
+};
+
+void runSeek(const char *name, Video::VideoDecoder *decoder, const Common::Array<int> &targets, const Common::Array<uint32> &expected, bool useSeek) {
+	SeekRun run(decoder, targets, useSeek);
+	uint runs;
+	const uint64 micros = Benchmark::measure(run, runs);
+
+	bool ok = true;
+	for (uint i = 0; i < targets.size(); i++)
+		if (run.getHashes()[i] != expected[i])
+			ok = false;
+
+	const double seeks = (double)runs * targets.size();
+	Common::String extra = Common::String::format("%8.2f ms/seek %s", micros / seeks / 1000.0, ok ? "ok" : "MISMATCH");
+	Common::String fullName = Common::String::format("%s %s", name, useSeek ? "seek" : "decode");
+
+	Benchmark::report("seek", fullName.c_str(), micros, seeks, "seeks", extra.c_str());
+}
+
+/** Measure both ways of getting to the targets, against the frames seen while playing. */
+void runDecoder(const char *name, Video::VideoDecoder *decoder, const Common::Array<uint32> &frameHashes) {
+	Common::Array<int> targets;
+	getSeekTargets(frameHashes.size(), targets);
+
+	Common::Array<uint32> expected;
+	for (uint i = 0; i < targets.size(); i++)
+		expected.push_back(frameHashes[targets[i]]);
+
+	runSeek(name, decoder, targets, expected, false);
+	runSeek(name, decoder, targets, expected, true);
+}
+
+/** Play a whole video, to know what each frame should look like. */
+void hashFrames(Video::VideoDecoder *decoder, Common::Array<uint32> &frameHashes) {
+	frameHashes.clear();
+	while (!decoder->endOfVideo())
+		frameHashes.push_back(hashSurface(decoder->decodeNextFrame()));
+
+	decoder->rewind();
+}
+
+void runSynthetic(int keyframeInterval) {
+	const int width = 320, height = 200, frameCount = 600;
+	SmackerEncoder encoder(width, height, frameCount, false, false, keyframeInterval);
+	const Common::Array<byte> file = encoder.encode();
+
+	// The frames as they were encoded
+	Graphics::Surface surface;
+	surface.create(width, height, Graphics::PixelFormat::createFormatCLUT8());
+
+	Common::Array<uint32> frameHashes;
+	for (int frame = 0; frame < frameCount; frame++) {
+		for (int y = 0; y < height; y++) {
+			byte *row = (byte *)surface.getBasePtr(0, y);
+			for (int x = 0; x < width; x++)
+				row[x] = encoder.getPixel(x, y, frame);
+		}
+
+		frameHashes.push_back(hashSurface(&surface));
+	}
+
+	surface.free();
+
+	Video::SmackerDecoder smk;
+	smk.loadStream(new Common::MemoryReadStream(file.begin(), file.size(), DisposeAfterUse::NO));
+
+	const Common::String name = keyframeInterval ?
+			Common::String::format("smk2 %dx%d keyframes/%d", width, height, keyframeInterval) :
+			Common::String::format("smk2 %dx%d keyframe 0", width, height);
+	runDecoder(name.c_str(), &smk, frameHashes);
+}
+
+byte *readFile(const char *path, uint32 &size) {
+	FILE *f = fopen(path, "rb");
+	if (!f)
+		return 0;
+
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	byte *data = (byte *)malloc(size);
+	if (fread(data, 1, size, f) != size) {
+		free(data);
+		data = 0;
+	}
+
+	fclose(f);
+	return data;
+}
+
+void runFile(const char *path) {
+	Common::String lower = path;
+	lower.toLowercase();
+
+	Video::VideoDecoder *decoder = 0;
+	if (lower.hasSuffix(".smk"))
+		decoder = new Video::SmackerDecoder();
+#ifdef USE_BINK
+	else if (lower.hasSuffix(".bik"))
+		decoder = new Video::BinkDecoder();
+#endif
+
+	if (!decoder)
+		return;
+
+	uint32 size;
+	byte *data = readFile(path, size);
+	if (!data) {
+		printf("Could not read '%s'\n", path);
+		delete decoder;
+		return;
+	}
+
+	if (decoder->loadStream(new Common::MemoryReadStream(data, size, DisposeAfterUse::NO))) {
+		Common::Array<uint32> frameHashes;
+		hashFrames(decoder, frameHashes);
+		if (!frameHashes.empty())
+			runDecoder(path, decoder, frameHashes);
+	} else {
+		printf("Could not load '%s'\n", path);
+	}
+
+	delete decoder;
+	free(data);
+}
+
+} // End of anonymous namespace
+
+void benchmarkSeek() {
+	Benchmark::NullSystem system;
+
+	runSynthetic(30);
+	runSynthetic(0);
+
+	const Common::StringArray &args = Benchmark::getArguments();
+	for (uint i = 0; i < args.size(); i++)
+		runFile(args[i].c_str());
+}
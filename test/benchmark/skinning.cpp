@@ -0,0 +1,233 @@
+// The benchmark runner is a host tool which prints to stdout directly
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+// Only built with the Grim engine, see test/module.mk
+#ifdef ENABLE_GRIM
+
+#include "common/array.h"
+#include "common/simd.h"
+
+#include "math/quat.h"
+
+#include "engines/grim/emi/skinning.h"
+
+#include "test/benchmark/benchmark.h"
+
+#include <math.h>
+#include <stdio.h>
+
+/**
+ * EMI mesh skinning benchmarks.
+ *
+ * The fixtures are meshes the size of the EMI characters, with one to three
+ * joints influencing every vertex. They are skinned as EMIModel did before,
+ * by moving each vertex back from the bind pose and then to the current pose
+ * once per influence, and with Skinning, with and without the vector code.
+ * The time includes computing the joint matrices. All of them have to move
+ * the vertices to the same places.
+ */
+
+namespace {
+
+struct Influence {
+	int vertex;
+	int joint;
+	float weight;
+};
+
+struct JointPoses {
+	Math::Matrix4 bindPose;
+	Math::Matrix4 invBindPose;
+	Math::Matrix4 finalPose;
+};
+
+class Mesh {
+public:
+	Mesh(int vertexCount, int jointCount) {
+		uint32 seed = vertexCount + jointCount;
+
+		// A tree of joints, each one a rotation and a translation away from a
+		// joint before it, in a bind pose and in an animated pose
+		_joints.resize(jointCount);
+		for (int j = 0; j < jointCount; j++) {
+			const int parent = j ? (int)(next(seed) % j) : -1;
+			Math::Matrix4 bindRel = makeTransform(seed);
+			Math::Matrix4 finalRel = makeTransform(seed);
+			_joints[j].bindPose = parent < 0 ? bindRel : _joints[parent].bindPose * bindRel;
+			_joints[j].finalPose = parent < 0 ? finalRel : _joints[parent].finalPose * finalRel;
+			_joints[j].invBindPose = Grim::Skinning::getInverseBindMatrix(_joints[j].bindPose);
+		}
+
+		_vertices.resize(vertexCount);
+		_normals.resize(vertexCount);
+		for (int v = 0; v < vertexCount; v++) {
+			_vertices[v].set(random(seed) * 2.f, random(seed) * 2.f, random(seed) * 2.f);
+			_normals[v] = Math::Vector3d(random(seed), random(seed), random(seed) + 0.1f).getNormalized();
+
+			const int count = 1 + next(seed) % 3;
+			float total = 0.f;
+			for (int i = 0; i < count; i++) {
+				Influence influence;
+				influence.vertex = v;
+				influence.joint = next(seed) % jointCount;
+				influence.weight = 0.2f + (next(seed) % 100) / 100.f;
+				total += influence.weight;
+				_influences.push_back(influence);
+			}
+			for (int i = _influences.size() - count; i < (int)_influences.size(); i++)
+				_influences[i].weight /= total;
+		}
+
+		_skinning.reset(vertexCount);
+		for (uint i = 0; i < _influences.size(); i++)
+			_skinning.addInfluence(_influences[i].vertex, _influences[i].joint, _influences[i].weight);
+	}
+
+	int getVertexCount() const { return _vertices.size(); }
+	int getInfluenceCount() const { return _influences.size(); }
+	const Common::Array<JointPoses> &getJoints() const { return _joints; }
+	const Common::Array<Influence> &getInfluences() const { return _influences; }
+	const Math::Vector3d *getVertices() const { return _vertices.begin(); }
+	const Math::Vector3d *getNormals() const { return _normals.begin(); }
+	const Grim::Skinning &getSkinning() const { return _skinning; }
+
+private:
+	static uint32 next(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 8;
+	}
+
+	// A random number between -1 and 1
+	static float random(uint32 &seed) {
+		return (next(seed) % 2001) / 1000.f - 1.f;
+	}
+
+	static Math::Matrix4 makeTransform(uint32 &seed) {
+		Math::Matrix4 m;
+		Math::Quaternion(random(seed), random(seed), random(seed), 1.f).normalize().toMatrix(m);
+		m.setPosition(Math::Vector3d(random(seed), random(seed), random(seed)));
+		return m;
+	}
+
+	Common::Array<JointPoses> _joints;
+	Common::Array<Math::Vector3d> _vertices;
+	Common::Array<Math::Vector3d> _normals;
+	Common::Array<Influence> _influences;
+	Grim::Skinning _skinning;
+};
+
+enum SkinMode {
+	kPerInfluence,
+	kScalar,
+	kSIMD
+};
+
+class Skinner {
+public:
+	Skinner(const Mesh &mesh, SkinMode mode) : _mesh(mesh), _mode(mode) {
+		_outVertices.resize(mesh.getVertexCount());
+		_outNormals.resize(mesh.getVertexCount());
+		_jointMatrices.resize(mesh.getJoints().size());
+	}
+
+	void operator()() {
+		if (_mode == kPerInfluence)
+			skinPerInfluence();
+		else
+			skinWithJointMatrices();
+	}
+
+	const Common::Array<Math::Vector3d> &getVertices() const { return _outVertices; }
+	const Common::Array<Math::Vector3d> &getNormals() const { return _outNormals; }
+
+private:
+	// What EMIModel::prepareForRender did before
+	void skinPerInfluence() {
+		const int vertexCount = _mesh.getVertexCount();
+		for (int i = 0; i < vertexCount; i++) {
+			_outVertices[i].set(0.f, 0.f, 0.f);
+			_outNormals[i].set(0.f, 0.f, 0.f);
+		}
+
+		const Common::Array<Influence> &influences = _mesh.getInfluences();
+		for (uint i = 0; i < influences.size(); i++) {
+			const Influence &influence = influences[i];
+			const JointPoses &joint = _mesh.getJoints()[influence.joint];
+
+			Math::Vector3d vert = _mesh.getVertices()[influence.vertex];
+			joint.bindPose.inverseTranslate(&vert);
+			joint.bindPose.inverseRotate(&vert);
+			joint.finalPose.transform(&vert, true);
+			_outVertices[influence.vertex] += vert * influence.weight;
+
+			Math::Vector3d normal = _mesh.getNormals()[influence.vertex];
+			joint.bindPose.inverseRotate(&normal);
+			joint.finalPose.transform(&normal, false);
+			_outNormals[influence.vertex] += normal * influence.weight;
+		}
+
+		for (int i = 0; i < vertexCount; i++)
+			_outNormals[i].normalize();
+	}
+
+	void skinWithJointMatrices() {
+		const Common::Array<JointPoses> &joints = _mesh.getJoints();
+		for (uint i = 0; i < joints.size(); i++)
+			_jointMatrices[i].set(joints[i].finalPose * joints[i].invBindPose);
+
+		_mesh.getSkinning().skin(_jointMatrices.begin(), _mesh.getVertices(), _mesh.getNormals(),
+		                         _outVertices.begin(), _outNormals.begin());
+	}
+
+	const Mesh &_mesh;
+	SkinMode _mode;
+	Common::Array<Grim::Skinning::JointMatrix> _jointMatrices;
+	Common::Array<Math::Vector3d> _outVertices;
+	Common::Array<Math::Vector3d> _outNormals;
+};
+
+float getMaxError(const Skinner &skinner, const Skinner &reference) {
+	float error = 0.f;
+	for (uint i = 0; i < skinner.getVertices().size(); i++) {
+		error = MAX(error, (skinner.getVertices()[i] - reference.getVertices()[i]).getMagnitude());
+		error = MAX(error, (skinner.getNormals()[i] - reference.getNormals()[i]).getMagnitude());
+	}
+	return error;
+}
+
+void runMesh(int vertexCount, int jointCount) {
+	static const char *const modeNames[] = { "per influence", "scalar", "simd" };
+
+	Mesh mesh(vertexCount, jointCount);
+	Skinner reference(mesh, kPerInfluence);
+	reference();
+
+	for (int mode = kPerInfluence; mode <= kSIMD; mode++) {
+		Common::setSIMDEnabled(mode == kSIMD);
+		if (mode == kSIMD && !Common::hasSIMD())
+			break;
+
+		Skinner skinner(mesh, (SkinMode)mode);
+		uint runs;
+		const uint64 micros = Benchmark::measure(skinner, runs);
+
+		// The vertices are a few units from the joints, the rounding errors
+		// of the two ways of computing them stay well below this
+		const float error = getMaxError(skinner, reference);
+		char name[64], extra[64];
+		snprintf(name, sizeof(name), "%d vertices %d joints %s", vertexCount, jointCount, modeNames[mode]);
+		snprintf(extra, sizeof(extra), "%.1f us per mesh, %s", (double)micros / runs, error < 1e-3f ? "ok" : "MISMATCH");
+		Benchmark::report("skinning", name, micros, (double)runs * vertexCount, "vertices", extra);
+	}
+	Common::setSIMDEnabled(true);
+}
+
+} // End of anonymous namespace
+
+void benchmarkSkinning() {
+	runMesh(500, 20);
+	runMesh(2000, 40);
+	runMesh(8000, 60);
+}
+
+#endif
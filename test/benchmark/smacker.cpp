@@ -0,0 +1,151 @@
+// Input files are read with stdio, there is no file system backend here
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/str.h"
+#include "common/util.h"
+
+#include "graphics/surface.h"
+
+#include "video/smk_decoder.h"
+
+#include "test/benchmark/benchmark.h"
+#include "test/benchmark/null_system.h"
+#include "test/benchmark/smacker_encoder.h"
+
+#include <stdio.h>
+
+/**
+ * Smacker video decoding benchmarks.
+ *
+ * The fixtures are synthesized by a small lossless Smacker encoder, so the
+ * decoded frames are checked against the source images before timing. Every
+ * block type shows up: flat background gets filled once and skipped after
+ * that, a two color band needs mono blocks and a textured sprite moving
+ * across the screen needs full blocks. The SMK4 fixture uses a doubled
+ * texture so the other two full block modes get used as well.
+ *
+ * Files given on the command line ending in .smk are decoded too.
+ */
+
+namespace {
+
+using Benchmark::SmackerEncoder;
+
+/** Decode a whole movie, as fast as possible. */
+class SmackerRun {
+public:
+	SmackerRun(const byte *data, uint32 size) : _data(data), _size(size) {}
+
+	void operator()() {
+		Video::SmackerDecoder smk;
+		if (!smk.loadStream(new Common::MemoryReadStream(_data, _size, DisposeAfterUse::NO)))
+			return;
+
+		while (!smk.endOfVideo())
+			smk.decodeNextFrame();
+	}
+
+private:
+	const byte *_data;
+	uint32 _size;
+};
+
+bool verify(const byte *data, uint32 size, const SmackerEncoder &encoder, int width, int height) {
+	Video::SmackerDecoder smk;
+	if (!smk.loadStream(new Common::MemoryReadStream(data, size, DisposeAfterUse::NO)))
+		return false;
+
+	for (int frame = 0; !smk.endOfVideo(); frame++) {
+		const Graphics::Surface *surface = smk.decodeNextFrame();
+		if (!surface)
+			return false;
+
+		for (int y = 0; y < height; y++) {
+			const byte *row = (const byte *)surface->getBasePtr(0, y);
+			for (int x = 0; x < width; x++) {
+				if (row[x] != encoder.getPixel(x, y, frame))
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void runSmacker(const char *name, const byte *data, uint32 size, double mediaSeconds, const char *status) {
+	SmackerRun run(data, size);
+	uint runs;
+	const uint64 startAllocs = Benchmark::getAllocationCount();
+	const uint64 micros = Benchmark::measure(run, runs);
+	const uint64 allocs = Benchmark::getAllocationCount() - startAllocs;
+
+	Video::SmackerDecoder smk;
+	smk.loadStream(new Common::MemoryReadStream(data, size, DisposeAfterUse::NO));
+	if (mediaSeconds <= 0)
+		mediaSeconds = smk.getDuration().msecs() / 1000.0;
+
+	Common::String extra = Common::String::format("%8.1fx realtime", micros ? mediaSeconds * runs * 1000000.0 / micros : 0.0);
+	if (Benchmark::isAllocationCountAvailable())
+		extra += Common::String::format(" %10.1f allocs/run", (double)allocs / runs);
+	if (status)
+		extra += Common::String::format(" %s", status);
+
+	Benchmark::report("smacker", name, micros, (double)smk.getFrameCount() * runs, "frames", extra.c_str());
+}
+
+void runSynthetic(int width, int height, bool smk4) {
+	SmackerEncoder encoder(width, height, 120, smk4, smk4);
+	const Common::Array<byte> file = encoder.encode();
+
+	const bool ok = verify(file.begin(), file.size(), encoder, width, height);
+	const Common::String name = Common::String::format("%s %dx%d synthetic", smk4 ? "smk4" : "smk2", width, height);
+	runSmacker(name.c_str(), file.begin(), file.size(), encoder.getDuration(), ok ? "ok" : "MISMATCH");
+}
+
+byte *readFile(const char *path, uint32 &size) {
+	FILE *f = fopen(path, "rb");
+	if (!f)
+		return 0;
+
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	byte *data = (byte *)malloc(size);
+	if (fread(data, 1, size, f) != size) {
+		free(data);
+		data = 0;
+	}
+
+	fclose(f);
+	return data;
+}
+
+} // End of anonymous namespace
+
+void benchmarkSmacker() {
+	Benchmark::NullSystem system;
+
+	runSynthetic(320, 200, false);
+	runSynthetic(640, 480, true);
+
+	const Common::StringArray &args = Benchmark::getArguments();
+	for (uint i = 0; i < args.size(); i++) {
+		Common::String lower = args[i];
+		lower.toLowercase();
+		if (!lower.hasSuffix(".smk"))
+			continue;
+
+		uint32 size;
+		byte *data = readFile(args[i].c_str(), size);
+		if (!data) {
+			printf("Could not read '%s'\n", args[i].c_str());
+			continue;
+		}
+
+		runSmacker(args[i].c_str(), data, size, 0, 0);
+		free(data);
+	}
+}
@@ -0,0 +1,526 @@
+#ifndef TEST_BENCHMARK_SMACKER_ENCODER_H
+#define TEST_BENCHMARK_SMACKER_ENCODER_H
+
+#include "common/array.h"
+#include "common/endian.h"
+#include "common/util.h"
+
+namespace Benchmark {
+
+enum {
+	kMMapTree = 0,
+	kMClrTree = 1,
+	kFullTree = 2,
+	kTypeTree = 3,
+	kTreeCount = 4,
+
+	// Keys of the Huffman leaves, 16-bit values and the three escapes
+	kMarkerKey = 0x10000,
+	kKeyCount = 0x10003
+};
+
+enum BlockType {
+	kBlockMono = 0,
+	kBlockFull = 1,
+	kBlockSkip = 2,
+	kBlockFill = 3
+};
+
+/** Writes bits LSB first, the order the Smacker decoder reads them in. */
+class BitWriter {
+public:
+	BitWriter() : _bitCount(0) {}
+
+	void putBit(uint bit) {
+		if ((_bitCount & 7) == 0)
+			_data.push_back(0);
+		if (bit)
+			_data.back() |= 1 << (_bitCount & 7);
+		_bitCount++;
+	}
+
+	void putBits(uint64 value, uint n) {
+		for (uint i = 0; i < n; i++)
+			putBit((value >> i) & 1);
+	}
+
+	const Common::Array<byte> &getData() const { return _data; }
+
+private:
+	Common::Array<byte> _data;
+	uint32 _bitCount;
+};
+
+/** A Huffman code over the leaf keys which have been counted. */
+class HuffmanCode {
+public:
+	HuffmanCode() : _root(-1) {
+		_counts.resize(kKeyCount);
+	}
+
+	void count(uint32 key) { _counts[key]++; }
+	uint32 getCount(uint32 key) const { return _counts[key]; }
+	bool empty() const { return _root < 0; }
+	uint getNodeCount() const { return _nodes.size(); }
+
+	void build() {
+		// Two queue construction: sorted leaves, and the internal nodes
+		// which are created in increasing weight order
+		Common::Array<int> leaves;
+		for (uint32 key = 0; key < kKeyCount; key++) {
+			if (_counts[key]) {
+				Node node = { _counts[key], { -1, -1 }, key };
+				leaves.push_back(_nodes.size());
+				_nodes.push_back(node);
+			}
+		}
+		if (leaves.empty())
+			return;
+
+		Common::sort(leaves.begin(), leaves.end(), LeafOrder(_nodes));
+
+		uint leaf = 0, internal = leaves.size();
+		while (_nodes.size() - internal + leaves.size() - leaf > 1) {
+			int child[2];
+			for (int i = 0; i < 2; i++) {
+				if (leaf < leaves.size() && (internal == _nodes.size() || _nodes[leaves[leaf]].weight <= _nodes[internal].weight))
+					child[i] = leaves[leaf++];
+				else
+					child[i] = internal++;
+			}
+
+			Node node = { _nodes[child[0]].weight + _nodes[child[1]].weight, { child[0], child[1] }, 0 };
+			_nodes.push_back(node);
+		}
+		_root = _nodes.size() - 1;
+
+		_codes.resize(kKeyCount);
+		_lengths.resize(kKeyCount);
+		assignCodes(_root, 0, 0);
+	}
+
+	void write(BitWriter &bw, uint32 key) const {
+		assert(_counts[key]);
+		bw.putBits(_codes[key], _lengths[key]);
+	}
+
+	/** Serialize a tree of 8-bit values. */
+	void writeSmallTree(BitWriter &bw) const {
+		bw.putBit(1);
+		writeNode(bw, _root, 0, 0, 0);
+		bw.putBit(0);
+	}
+
+	/** Serialize a tree of 16-bit values, using two small trees for the bytes. */
+	void writeBigTree(BitWriter &bw, const HuffmanCode &lo, const HuffmanCode &hi, const uint32 *markers) const {
+		if (empty()) {
+			bw.putBit(0);
+			return;
+		}
+
+		bw.putBit(1);
+		lo.writeSmallTree(bw);
+		hi.writeSmallTree(bw);
+		for (int i = 0; i < 3; i++)
+			bw.putBits(markers[i], 16);
+		writeNode(bw, _root, &lo, &hi, markers);
+		bw.putBit(0);
+	}
+
+private:
+	struct Node {
+		uint32 weight;
+		int child[2];
+		uint32 key;
+	};
+
+	struct LeafOrder {
+		LeafOrder(const Common::Array<Node> &nodes) : _nodes(nodes) {}
+		bool operator()(int a, int b) const { return _nodes[a].weight < _nodes[b].weight; }
+		const Common::Array<Node> &_nodes;
+	};
+
+	void assignCodes(int node, uint64 code, uint length) {
+		if (_nodes[node].child[0] < 0) {
+			assert(length <= 64);
+			_codes[_nodes[node].key] = code;
+			_lengths[_nodes[node].key] = length;
+			return;
+		}
+
+		assignCodes(_nodes[node].child[0], code, length + 1);
+		assignCodes(_nodes[node].child[1], code | ((uint64)1 << length), length + 1);
+	}
+
+	void writeNode(BitWriter &bw, int node, const HuffmanCode *lo, const HuffmanCode *hi, const uint32 *markers) const {
+		const Node &n = _nodes[node];
+		if (n.child[0] >= 0) {
+			bw.putBit(1);
+			writeNode(bw, n.child[0], lo, hi, markers);
+			writeNode(bw, n.child[1], lo, hi, markers);
+			return;
+		}
+
+		bw.putBit(0);
+		if (!lo) {
+			bw.putBits(n.key, 8);
+		} else {
+			const uint32 value = n.key >= kMarkerKey ? markers[n.key - kMarkerKey] : n.key;
+			lo->write(bw, value & 0xff);
+			hi->write(bw, value >> 8);
+		}
+	}
+
+	Common::Array<uint32> _counts;
+	Common::Array<Node> _nodes;
+	Common::Array<uint64> _codes;
+	Common::Array<byte> _lengths;
+	int _root;
+};
+
+/** A Huffman coded value, or raw bits when the tree is negative. */
+struct Symbol {
+	int tree;
+	uint32 key;
+	uint bits;
+};
+
+/**
+ * A small lossless Smacker encoder, for synthesizing benchmark fixtures.
+ *
+ * Frames are coded against the previous one, except for frame 0 and every
+ * keyframeInterval-th frame, which are marked as keyframes.
+ */
+class SmackerEncoder {
+public:
+	SmackerEncoder(int width, int height, int frameCount, bool smk4, bool doubled, int keyframeInterval = 0) :
+			_width(width), _height(height), _frameCount(frameCount), _smk4(smk4), _doubled(doubled),
+			_keyframeInterval(keyframeInterval) {
+	}
+
+	bool isKeyframe(int frame) const {
+		return frame == 0 || (_keyframeInterval > 0 && frame % _keyframeInterval == 0);
+	}
+
+	/** The pixel of a frame, the decoder has to reproduce these exactly. */
+	byte getPixel(int x, int y, int frame) const {
+		// A textured sprite, kept on even coordinates for the doubled texture
+		const int spriteX = ((frame * 6) % (_width - 96)) & ~1;
+		const int spriteY = (_height / 4 + (frame * 2) % (_height / 4)) & ~1;
+		if (x >= spriteX && x < spriteX + 96 && y >= spriteY && y < spriteY + 64) {
+			int u = x - spriteX, v = y - spriteY;
+			if (_doubled) {
+				u >>= 1;
+				v >>= 1;
+			}
+			return 64 + (u * 7 + v * 13 + ((u * v) >> 3)) % 48;
+		}
+
+		// A scrolling band of two colors
+		if (y >= _height * 3 / 4 && y < _height * 3 / 4 + 32) {
+			const uint32 hash = ((x + frame * 2) >> 1) * 0x9E37 ^ (y >> 1) * 0x85EB;
+			return ((hash >> 7) & 1) ? 200 : 210;
+		}
+
+		return 16 + ((x / 64 + y / 48) & 15);
+	}
+
+	Common::Array<byte> encode() {
+		// First pass: choose the symbols, second pass: write their codes
+		Common::Array<Common::Array<Symbol> > frames;
+		frames.resize(_frameCount);
+		for (int frame = 0; frame < _frameCount; frame++)
+			encodeFrame(frame, frames[frame]);
+
+		chooseMarkers();
+
+		HuffmanCode lo[kTreeCount], hi[kTreeCount];
+		for (int tree = 0; tree < kTreeCount; tree++) {
+			_trees[tree].build();
+			for (uint32 key = 0; key < kKeyCount; key++) {
+				const uint32 count = _trees[tree].getCount(key);
+				if (!count)
+					continue;
+
+				const uint32 value = key >= kMarkerKey ? _markers[tree][key - kMarkerKey] : key;
+				lo[tree].count(value & 0xff);
+				hi[tree].count(value >> 8);
+			}
+			lo[tree].build();
+			hi[tree].build();
+		}
+
+		BitWriter treeWriter;
+		for (int tree = 0; tree < kTreeCount; tree++)
+			_trees[tree].writeBigTree(treeWriter, lo[tree], hi[tree], _markers[tree]);
+
+		Common::Array<Common::Array<byte> > frameData;
+		frameData.resize(_frameCount);
+		for (int frame = 0; frame < _frameCount; frame++)
+			writeFrame(frame, frames[frame], frameData[frame]);
+
+		Common::Array<byte> out;
+		putUint32BE(out, _smk4 ? MKTAG('S', 'M', 'K', '4') : MKTAG('S', 'M', 'K', '2'));
+		putUint32LE(out, _width);
+		putUint32LE(out, _height);
+		putUint32LE(out, _frameCount);
+		putUint32LE(out, (uint32)-6667); // 15 fps
+		putUint32LE(out, 0);
+		for (int i = 0; i < 7; i++)
+			putUint32LE(out, 0);
+		putUint32LE(out, treeWriter.getData().size());
+		for (int tree = 0; tree < kTreeCount; tree++)
+			putUint32LE(out, (_trees[tree].getNodeCount() + 3) * 4);
+		for (int i = 0; i < 7; i++)
+			putUint32LE(out, 0);
+		putUint32LE(out, 0);
+		for (int frame = 0; frame < _frameCount; frame++)
+			putUint32LE(out, frameData[frame].size() | (isKeyframe(frame) ? 1 : 0));
+		for (int frame = 0; frame < _frameCount; frame++)
+			out.push_back(frame == 0 ? 1 : 0);
+		append(out, treeWriter.getData());
+		for (int frame = 0; frame < _frameCount; frame++)
+			append(out, frameData[frame]);
+
+		return out;
+	}
+
+	double getDuration() const {
+		return _frameCount / 15.0;
+	}
+
+private:
+	struct Block {
+		BlockType type;
+		byte pixels[16];
+		int mode;
+	};
+
+	void getBlock(int bx, int by, int frame, Block &block) const {
+		byte colors[2];
+		int colorCount = 0;
+		bool sameAsPrevious = !isKeyframe(frame);
+
+		for (int i = 0; i < 16; i++) {
+			const int x = bx * 4 + (i & 3), y = by * 4 + (i >> 2);
+			const byte p = getPixel(x, y, frame);
+			block.pixels[i] = p;
+
+			if (sameAsPrevious && getPixel(x, y, frame - 1) != p)
+				sameAsPrevious = false;
+
+			if (colorCount < 3 && (colorCount < 1 || colors[0] != p) && (colorCount < 2 || colors[1] != p)) {
+				if (colorCount < 2)
+					colors[colorCount] = p;
+				colorCount++;
+			}
+		}
+
+		block.mode = 0;
+		if (sameAsPrevious) {
+			block.type = kBlockSkip;
+		} else if (colorCount == 1) {
+			block.type = kBlockFill;
+		} else if (colorCount == 2) {
+			block.type = kBlockMono;
+		} else {
+			block.type = kBlockFull;
+			if (_smk4) {
+				const byte *p = block.pixels;
+				const bool rowPairs = !memcmp(p, p + 4, 4) && !memcmp(p + 8, p + 12, 4);
+				const bool columnPairs = p[0] == p[1] && p[2] == p[3] && p[8] == p[9] && p[10] == p[11];
+				if (rowPairs && columnPairs)
+					block.mode = 1;
+				else if (rowPairs)
+					block.mode = 2;
+			}
+		}
+	}
+
+	bool sameRun(const Block &a, const Block &b) const {
+		return a.type == b.type && a.mode == b.mode && (a.type != kBlockFill || a.pixels[0] == b.pixels[0]);
+	}
+
+	void putValue(Common::Array<Symbol> &symbols, int tree, uint32 value) {
+		// Repeated values use the escapes to the last three values
+		uint32 *last = _last[tree];
+		uint32 key = value;
+		for (int i = 0; i < 3; i++) {
+			if (last[i] == value) {
+				key = kMarkerKey + i;
+				break;
+			}
+		}
+
+		if (value != last[0]) {
+			last[2] = last[1];
+			last[1] = last[0];
+			last[0] = value;
+		}
+
+		Symbol symbol = { tree, key, 0 };
+		symbols.push_back(symbol);
+		_trees[tree].count(key);
+	}
+
+	void putBits(Common::Array<Symbol> &symbols, uint32 value, uint bits) {
+		Symbol symbol = { -1, value, bits };
+		symbols.push_back(symbol);
+	}
+
+	void encodeFrame(int frame, Common::Array<Symbol> &symbols) {
+		memset(_last, 0, sizeof(_last));
+
+		const int bw = _width / 4, bh = _height / 4;
+		Common::Array<Block> blocks;
+		blocks.resize(bw * bh);
+		for (int by = 0; by < bh; by++)
+			for (int bx = 0; bx < bw; bx++)
+				getBlock(bx, by, frame, blocks[by * bw + bx]);
+
+		uint block = 0;
+		while (block < blocks.size()) {
+			uint length = 1;
+			while (block + length < blocks.size() && sameRun(blocks[block], blocks[block + length]))
+				length++;
+
+			// Split the run into the available run lengths
+			while (length) {
+				int index = 58;
+				if (length >= 128) {
+					index = 59;
+					while (index < 63 && (128u << (index - 58)) <= length)
+						index++;
+				} else {
+					index = MIN<uint>(length, 59) - 1;
+				}
+				const uint run = index <= 58 ? index + 1 : 128 << (index - 59);
+
+				writeRun(symbols, blocks, block, run, index);
+				block += run;
+				length -= run;
+			}
+		}
+	}
+
+	void writeRun(Common::Array<Symbol> &symbols, const Common::Array<Block> &blocks, uint first, uint run, int index) {
+		const Block &head = blocks[first];
+		uint32 type = head.type | (index << 2);
+		if (head.type == kBlockFill)
+			type |= head.pixels[0] << 8;
+		putValue(symbols, kTypeTree, type);
+
+		if (head.type == kBlockFull && _smk4) {
+			if (head.mode == 1) {
+				putBits(symbols, 1, 1);
+			} else {
+				putBits(symbols, 0, 1);
+				putBits(symbols, head.mode == 2 ? 1 : 0, 1);
+			}
+		}
+
+		for (uint b = first; b < first + run; b++) {
+			const byte *p = blocks[b].pixels;
+			switch (head.type) {
+			case kBlockMono: {
+				const byte hiColor = p[0];
+				byte loColor = p[0];
+				uint32 map = 0;
+				for (int i = 0; i < 16; i++) {
+					if (p[i] == hiColor)
+						map |= 1 << i;
+					else
+						loColor = p[i];
+				}
+				putValue(symbols, kMClrTree, (hiColor << 8) | loColor);
+				putValue(symbols, kMMapTree, map);
+				break;
+			}
+			case kBlockFull:
+				if (head.mode == 0) {
+					for (int row = 0; row < 4; row++) {
+						putValue(symbols, kFullTree, p[row * 4 + 2] | (p[row * 4 + 3] << 8));
+						putValue(symbols, kFullTree, p[row * 4 + 0] | (p[row * 4 + 1] << 8));
+					}
+				} else if (head.mode == 1) {
+					putValue(symbols, kFullTree, p[0] | (p[2] << 8));
+					putValue(symbols, kFullTree, p[8] | (p[10] << 8));
+				} else {
+					for (int row = 0; row < 4; row += 2) {
+						putValue(symbols, kFullTree, p[row * 4 + 2] | (p[row * 4 + 3] << 8));
+						putValue(symbols, kFullTree, p[row * 4 + 0] | (p[row * 4 + 1] << 8));
+					}
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	/** The escape values have to differ from all the literal values. */
+	void chooseMarkers() {
+		for (int tree = 0; tree < kTreeCount; tree++) {
+			uint32 value = 0xffff;
+			for (int i = 0; i < 3; i++) {
+				while (_trees[tree].getCount(value))
+					value--;
+				_markers[tree][i] = value--;
+			}
+		}
+	}
+
+	void writeFrame(int frame, const Common::Array<Symbol> &symbols, Common::Array<byte> &out) {
+		if (frame == 0) {
+			// A palette chunk with 256 explicit 6-bit colors
+			const uint32 size = (1 + 256 * 3 + 3) & ~3;
+			out.push_back(size / 4);
+			for (int i = 0; i < 256; i++) {
+				out.push_back(i & 0x3f);
+				out.push_back((i * 3) & 0x3f);
+				out.push_back((i >> 2) & 0x3f);
+			}
+			while (out.size() < size)
+				out.push_back(0);
+		}
+
+		BitWriter bw;
+		for (uint i = 0; i < symbols.size(); i++) {
+			if (symbols[i].tree < 0)
+				bw.putBits(symbols[i].key, symbols[i].bits);
+			else
+				_trees[symbols[i].tree].write(bw, symbols[i].key);
+		}
+
+		append(out, bw.getData());
+		while (out.size() & 3)
+			out.push_back(0);
+	}
+
+	static void putUint32LE(Common::Array<byte> &out, uint32 value) {
+		for (int i = 0; i < 4; i++)
+			out.push_back((value >> (i * 8)) & 0xff);
+	}
+
+	static void putUint32BE(Common::Array<byte> &out, uint32 value) {
+		for (int i = 3; i >= 0; i--)
+			out.push_back((value >> (i * 8)) & 0xff);
+	}
+
+	static void append(Common::Array<byte> &out, const Common::Array<byte> &data) {
+		for (uint i = 0; i < data.size(); i++)
+			out.push_back(data[i]);
+	}
+
+	int _width, _height, _frameCount;
+	bool _smk4, _doubled;
+	int _keyframeInterval;
+
+	HuffmanCode _trees[kTreeCount];
+	uint32 _markers[kTreeCount][3];
+	uint32 _last[kTreeCount][3];
+};
+
+} // End of namespace Benchmark
+
+#endif
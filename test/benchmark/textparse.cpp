@@ -0,0 +1,175 @@
+// The benchmark runner is a host tool which prints to stdout directly
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+// Only built with the Grim engine, see test/module.mk
+#ifdef ENABLE_GRIM
+
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "engines/grim/parsecache.h"
+#include "engines/grim/textsplit.h"
+
+#include "test/benchmark/benchmark.h"
+#include "test/benchmark/null_system.h"
+
+#include <stdio.h>
+
+/**
+ * Grim text resource parsing benchmarks.
+ *
+ * The fixtures are the sector sections of set files, parsed with the same
+ * formats as Sector::load. They are parsed without the parse cache, with an
+ * empty one which records the parsed values (the first time a set is
+ * entered), and with one holding them (every time after that, including
+ * after the cache was saved and loaded again). All of them have to produce
+ * the same values.
+ */
+
+namespace {
+
+struct SectorValues {
+	char name[257];
+	int id;
+	char type[257];
+	char visibility[257];
+	float height;
+	int numVertices;
+	float vertices[3 * 16];
+};
+
+Common::String makeSetText(int sectorCount) {
+	static const char *const types[] = { "walk", "camera", "funnel", "chernobyl" };
+
+	Common::String text = "section: sectors\n";
+	uint32 seed = sectorCount;
+	for (int i = 0; i < sectorCount; i++) {
+		text += Common::String::format("\tsector\t\tbox%03d\n\tID\t\t%d\n\ttype\t\t%s\n\tdefault visibility\t\t%s\n\theight\t\t%f\n",
+		                               i, 1000 + i, types[i % 4], i % 5 ? "visible" : "invisible", i % 7 ? 0.f : 9999.f);
+		const int numVertices = 4 + i % 5;
+		text += Common::String::format("\tnumvertices\t%d\n\tvertices:", numVertices);
+		for (int v = 0; v < numVertices; v++) {
+			for (int c = 0; c < 3; c++) {
+				seed = seed * 1103515245 + 12345;
+				text += Common::String::format("\t%.6f", (int)((seed >> 8) % 20000) / 1000.f - 10.f);
+			}
+			text += " # vertex\n";
+		}
+		text += "\n";
+	}
+	return text;
+}
+
+class SetParser {
+public:
+	SetParser(const Common::String &text, const char *name) : _text(text), _name(name) {}
+
+	void operator()() {
+		Common::MemoryReadStream data((const byte *)_text.c_str(), _text.size());
+		Grim::TextSplitter ts(_name, &data);
+		ts.expectString("section: sectors");
+
+		_sectors.clear();
+		while (!ts.isEof()) {
+			_sectors.push_back(SectorValues());
+			SectorValues &s = _sectors.back();
+			ts.scanString(" sector %256s", 1, s.name);
+			ts.scanString(" id %d", 1, &s.id);
+			ts.scanString(" type %256s", 1, s.type);
+			ts.scanString(" default visibility %256s", 1, s.visibility);
+			ts.scanString(" height %f", 1, &s.height);
+			ts.scanString(" numvertices %d", 1, &s.numVertices);
+			ts.scanString(" vertices: %f %f %f", 3, &s.vertices[0], &s.vertices[1], &s.vertices[2]);
+			for (int i = 1; i < s.numVertices; i++)
+				ts.scanString(" %f %f %f", 3, &s.vertices[i * 3], &s.vertices[i * 3 + 1], &s.vertices[i * 3 + 2]);
+		}
+	}
+
+	uint32 getChecksum() const {
+		uint32 sum = 0;
+		for (uint i = 0; i < _sectors.size(); i++) {
+			const SectorValues &s = _sectors[i];
+			sum = sum * 31 + Common::String(s.name).hash() + Common::String(s.type).hash() + Common::String(s.visibility).hash();
+			sum = sum * 31 + s.id + s.numVertices + (int)(s.height * 100);
+			for (int v = 0; v < s.numVertices * 3; v++)
+				sum = sum * 31 + (int)(s.vertices[v] * 1000);
+		}
+		return sum;
+	}
+
+private:
+	Common::String _text;
+	const char *_name;
+	Common::Array<SectorValues> _sectors;
+};
+
+// Parse with a new cache every run, as when entering a set for the first time
+class ColdParser {
+public:
+	ColdParser(SetParser &parser) : _parser(parser) {}
+
+	void operator()() {
+		delete Grim::g_parseCache;
+		Grim::g_parseCache = new Grim::ParseCache();
+		_parser();
+	}
+
+private:
+	SetParser &_parser;
+};
+
+void benchmarkSet(int sectorCount) {
+	const Common::String text = makeSetText(sectorCount);
+	SetParser parser(text, "bench.set");
+	ColdParser coldParser(parser);
+	char name[32], extra[64];
+	uint runs;
+
+	Grim::g_parseCache = nullptr;
+	parser();
+	const uint32 expected = parser.getChecksum();
+
+	snprintf(name, sizeof(name), "%d sectors none", sectorCount);
+	uint64 micros = Benchmark::measure(parser, runs);
+	snprintf(extra, sizeof(extra), "%.1f us per set", (double)micros / runs);
+	Benchmark::report("textparse", name, micros, (double)text.size() * runs / (1024 * 1024), "MB", extra);
+
+	snprintf(name, sizeof(name), "%d sectors cold", sectorCount);
+	micros = Benchmark::measure(coldParser, runs);
+	snprintf(extra, sizeof(extra), "%.1f us per set, %s", (double)micros / runs,
+	         parser.getChecksum() == expected ? "ok" : "MISMATCH");
+	Benchmark::report("textparse", name, micros, (double)text.size() * runs / (1024 * 1024), "MB", extra);
+
+	// Save the recorded values and load them again, as after a restart
+	Common::MemoryWriteStreamDynamic saved(DisposeAfterUse::YES);
+	Grim::g_parseCache->save(&saved);
+	Common::MemoryReadStream savedData(saved.getData(), saved.size());
+	Grim::g_parseCache->load(&savedData);
+
+	Grim::ParseCache::Stats stats;
+	Grim::g_parseCache->getStats(stats);
+	const uint32 hitsBefore = stats.hits;
+
+	snprintf(name, sizeof(name), "%d sectors warm", sectorCount);
+	micros = Benchmark::measure(parser, runs);
+	Grim::g_parseCache->getStats(stats);
+	snprintf(extra, sizeof(extra), "%.1f us per set, %u KB cached, %s", (double)micros / runs, stats.size / 1024,
+	         parser.getChecksum() == expected && stats.hits - hitsBefore == runs ? "ok" : "MISMATCH");
+	Benchmark::report("textparse", name, micros, (double)text.size() * runs / (1024 * 1024), "MB", extra);
+
+	delete Grim::g_parseCache;
+	Grim::g_parseCache = nullptr;
+}
+
+} // End of anonymous namespace
+
+void benchmarkTextParse() {
+	// The parse cache needs a mutex
+	Benchmark::NullSystem system;
+
+	benchmarkSet(40);
+	benchmarkSet(400);
+}
+
+#endif
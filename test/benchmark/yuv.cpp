@@ -0,0 +1,95 @@
+#include "common/simd.h"
+#include "common/str.h"
+
+#include "graphics/pixelformat.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "test/benchmark/benchmark.h"
+
+namespace {
+
+/** Convert one frame of random YUV data into a plain buffer. */
+class YUVRun {
+public:
+	YUVRun(int width, int height, bool is420, const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale) :
+			_width(width), _height(height), _is420(is420), _format(format), _scale(scale) {
+		_uvWidth = is420 ? width / 2 : width;
+		_uvHeight = is420 ? height / 2 : height;
+
+		_y = new byte[width * height];
+		_u = new byte[_uvWidth * _uvHeight];
+		_v = new byte[_uvWidth * _uvHeight];
+		_dst = new byte[width * height * format.bytesPerPixel];
+
+		uint32 seed = 1;
+		for (int i = 0; i < width * height; i++) {
+			seed = seed * 1103515245 + 12345;
+			_y[i] = (byte)(seed >> 16);
+		}
+		for (int i = 0; i < _uvWidth * _uvHeight; i++) {
+			seed = seed * 1103515245 + 12345;
+			_u[i] = (byte)(seed >> 16);
+			_v[i] = (byte)(seed >> 24);
+		}
+	}
+
+	~YUVRun() {
+		delete[] _dst;
+		delete[] _v;
+		delete[] _u;
+		delete[] _y;
+	}
+
+	void operator()() {
+		const int dstPitch = _width * _format.bytesPerPixel;
+		if (_is420)
+			YUVToRGBMan.convert420(_dst, dstPitch, _format, _scale, _y, _u, _v, _width, _height, _width, _uvWidth);
+		else
+			YUVToRGBMan.convert444(_dst, dstPitch, _format, _scale, _y, _u, _v, _width, _height, _width, _uvWidth);
+	}
+
+private:
+	int _width, _height;
+	int _uvWidth, _uvHeight;
+	bool _is420;
+	Graphics::PixelFormat _format;
+	Graphics::YUVToRGBManager::LuminanceScale _scale;
+	byte *_y, *_u, *_v;
+	byte *_dst;
+};
+
+void runConversion(int width, int height, bool is420, const char *formatName, const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale) {
+	for (int simd = 0; simd < 2; ++simd) {
+		Common::setSIMDEnabled(simd != 0);
+		if (simd && !Common::hasSIMD())
+			break;
+
+		YUVRun run(width, height, is420, format, scale);
+		uint runs;
+		const uint64 micros = Benchmark::measure(run, runs);
+
+		const Common::String variant = Common::String::format("%s %dx%d %s %s %s", is420 ? "420" : "444", width, height, formatName,
+		                                                      scale == Graphics::YUVToRGBManager::kScaleITU ? "itu" : "full", simd ? "simd" : "c");
+		Benchmark::report("yuv", variant.c_str(), micros, (double)runs * width * height, "pixels");
+	}
+	Common::setSIMDEnabled(true);
+}
+
+} // End of anonymous namespace
+
+void benchmarkYUV() {
+	static const int sizes[][2] = { { 640, 480 }, { 1280, 720 } };
+
+	const Graphics::PixelFormat rgba8888(4, 8, 8, 8, 8, 24, 16, 8, 0);
+	const Graphics::PixelFormat rgb565(2, 5, 6, 5, 0, 11, 5, 0, 0);
+
+	for (int s = 0; s < ARRAYSIZE(sizes); s++) {
+		for (int is420 = 1; is420 >= 0; is420--) {
+			runConversion(sizes[s][0], sizes[s][1], is420, "rgba8888", rgba8888, Graphics::YUVToRGBManager::kScaleITU);
+			runConversion(sizes[s][0], sizes[s][1], is420, "rgb565", rgb565, Graphics::YUVToRGBManager::kScaleITU);
+		}
+	}
+
+	// The full range scale only differs in the clipping
+	runConversion(640, 480, true, "rgba8888", rgba8888, Graphics::YUVToRGBManager::kScaleFull);
+}
@@ -0,0 +1,209 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/dct.h"
+#include "common/fft.h"
+#include "common/mdct.h"
+#include "common/rdft.h"
+#include "common/simd.h"
+
+class FFTTestSuite : public CxxTest::TestSuite
+{
+private:
+	static float testSignal(int i) {
+		return (float)(sin(i * 0.37) + 0.5 * cos(i * 1.91) + ((i * 7919) % 13) / 13.0 - 0.5);
+	}
+
+	static void fillSignal(float *data, int count) {
+		for (int i = 0; i < count; i++)
+			data[i] = testSignal(i);
+	}
+
+	/** Largest absolute difference between two buffers, relative to the largest value. */
+	static double relativeError(const float *a, const float *b, int count) {
+		double maxDiff = 0.0, maxValue = 1.0;
+		for (int i = 0; i < count; i++) {
+			maxDiff = MAX<double>(maxDiff, fabs(a[i] - b[i]));
+			maxValue = MAX<double>(maxValue, fabs(b[i]));
+		}
+
+		return maxDiff / maxValue;
+	}
+
+	static void runFFT(int bits, int inverse, bool simd, Common::Complex *data) {
+		Common::setSIMDEnabled(simd);
+
+		Common::FFT fft(bits, inverse);
+		fft.permute(data);
+		fft.calc(data);
+
+		Common::setSIMDEnabled(true);
+	}
+
+	static void runRDFT(int bits, Common::RDFT::TransformType trans, bool simd, float *data) {
+		Common::setSIMDEnabled(simd);
+
+		Common::RDFT rdft(bits, trans);
+		rdft.calc(data);
+
+		Common::setSIMDEnabled(true);
+	}
+
+	static void runDCT(int bits, Common::DCT::TransformType trans, bool simd, float *data) {
+		Common::setSIMDEnabled(simd);
+
+		Common::DCT dct(bits, trans);
+		dct.calc(data);
+
+		Common::setSIMDEnabled(true);
+	}
+
+	static void runIMDCT(int bits, bool simd, float *output, const float *input) {
+		Common::setSIMDEnabled(simd);
+
+		Common::MDCT mdct(bits, true, 1.0 / 32768.0);
+		mdct.calcIMDCT(output, input);
+
+		Common::setSIMDEnabled(true);
+	}
+
+public:
+	void test_fft_naive() {
+		for (int bits = 2; bits <= 10; bits++) {
+			for (int inverse = 0; inverse < 2; inverse++) {
+				const int n = 1 << bits;
+
+				Common::Complex *input = new Common::Complex[n];
+				Common::Complex *output = new Common::Complex[n];
+				for (int i = 0; i < n; i++) {
+					input[i].re = output[i].re = testSignal(i);
+					input[i].im = output[i].im = testSignal(i + n);
+				}
+
+				runFFT(bits, inverse, true, output);
+
+				// O(n^2) reference, computed in double precision
+				float *expected = new float[n * 2];
+				const double sign = inverse ? 1.0 : -1.0;
+				for (int k = 0; k < n; k++) {
+					double re = 0.0, im = 0.0;
+					for (int i = 0; i < n; i++) {
+						const double angle = sign * 2 * M_PI * ((i * k) % n) / n;
+						re += input[i].re * cos(angle) - input[i].im * sin(angle);
+						im += input[i].re * sin(angle) + input[i].im * cos(angle);
+					}
+
+					expected[k * 2] = (float)re;
+					expected[k * 2 + 1] = (float)im;
+				}
+
+				TS_ASSERT_LESS_THAN(relativeError((float *)output, expected, n * 2), 1e-5);
+
+				delete[] expected;
+				delete[] output;
+				delete[] input;
+			}
+		}
+	}
+
+	void test_fft_simd() {
+		for (int bits = 4; bits <= 14; bits++) {
+			for (int inverse = 0; inverse < 2; inverse++) {
+				const int n = 1 << bits;
+
+				float *scalar = new float[n * 2];
+				float *vector = new float[n * 2];
+				fillSignal(scalar, n * 2);
+				fillSignal(vector, n * 2);
+
+				runFFT(bits, inverse, false, (Common::Complex *)scalar);
+				runFFT(bits, inverse, true, (Common::Complex *)vector);
+
+				TS_ASSERT_LESS_THAN(relativeError(vector, scalar, n * 2), 1e-6);
+
+				delete[] vector;
+				delete[] scalar;
+			}
+		}
+	}
+
+	void test_rdft_simd() {
+		static const Common::RDFT::TransformType types[] = {
+			Common::RDFT::DFT_R2C, Common::RDFT::IDFT_C2R, Common::RDFT::IDFT_R2C, Common::RDFT::DFT_C2R
+		};
+
+		for (int bits = 4; bits <= 12; bits++) {
+			for (int t = 0; t < ARRAYSIZE(types); t++) {
+				const int n = 1 << bits;
+
+				float *scalar = new float[n];
+				float *vector = new float[n];
+				fillSignal(scalar, n);
+				fillSignal(vector, n);
+
+				runRDFT(bits, types[t], false, scalar);
+				runRDFT(bits, types[t], true, vector);
+
+				TS_ASSERT_LESS_THAN(relativeError(vector, scalar, n), 1e-6);
+
+				delete[] vector;
+				delete[] scalar;
+			}
+		}
+	}
+
+	void test_dct_simd() {
+		static const Common::DCT::TransformType types[] = {
+			Common::DCT::DCT_II, Common::DCT::DCT_III, Common::DCT::DCT_I, Common::DCT::DST_I
+		};
+
+		for (int bits = 4; bits <= 12; bits++) {
+			for (int t = 0; t < ARRAYSIZE(types); t++) {
+				// DCT-I works on n + 1 values
+				const int n = (1 << bits) + 1;
+
+				float *scalar = new float[n];
+				float *vector = new float[n];
+				fillSignal(scalar, n);
+				fillSignal(vector, n);
+
+				runDCT(bits, types[t], false, scalar);
+				runDCT(bits, types[t], true, vector);
+
+				TS_ASSERT_LESS_THAN(relativeError(vector, scalar, n), 1e-6);
+
+				delete[] vector;
+				delete[] scalar;
+			}
+		}
+	}
+
+	void test_imdct_simd() {
+		for (int bits = 6; bits <= 13; bits++) {
+			const int n = 1 << bits;
+
+			float *input = new float[n / 2];
+			float *scalar = new float[n];
+			float *vector = new float[n];
+			for (int i = 0; i < n / 2; i++)
+				input[i] = testSignal(i) * 16384.0f;
+
+			runIMDCT(bits, false, scalar, input);
+			runIMDCT(bits, true, vector, input);
+
+			TS_ASSERT_LESS_THAN(relativeError(vector, scalar, n), 1e-6);
+
+			delete[] vector;
+			delete[] scalar;
+			delete[] input;
+		}
+	}
+
+	void test_shared_tables() {
+		Common::FFT a(10, 0);
+		Common::FFT b(10, 0);
+		Common::FFT c(10, 1);
+
+		TS_ASSERT_EQUALS(a.getRevTab(), b.getRevTab());
+		TS_ASSERT_DIFFERS(a.getRevTab(), c.getRevTab());
+	}
+};
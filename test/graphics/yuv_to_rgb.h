@@ -0,0 +1,158 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/simd.h"
+
+#include "graphics/pixelformat.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuva_to_rgba.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum Subsampling {
+		k444,
+		k420,
+		k410,
+		k420Alpha
+	};
+
+	/** A fixed pseudo random sequence, so that failures can be reproduced. */
+	struct Random {
+		uint32 seed;
+
+		Random() : seed(0x7654321) {}
+
+		byte getRandomByte() {
+			seed = seed * 1103515245 + 12345;
+			return (byte)(seed >> 16);
+		}
+	};
+
+	static Graphics::PixelFormat getFormat(int index) {
+		switch (index) {
+		case 0:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0); // RGBA8888
+		case 1:
+			return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);  // RGB565
+		case 2:
+			return Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15); // ARGB1555
+		case 3:
+			return Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0);  // XBGR8888
+		default:
+			// Not byte aligned, to check the generic 32-bit packing
+			return Graphics::PixelFormat(4, 5, 5, 5, 1, 10, 5, 0, 15);
+		}
+	}
+
+	/**
+	 * Convert a random image once with the vector converters and once with
+	 * the lookup tables, and check that both produce the same pixels.
+	 */
+	void compareWithScalar(Subsampling subsampling, const Graphics::PixelFormat &format, bool itu, int width, int height) {
+		// Odd pitches, so that no row is aligned
+		const int yPitch = width + 3;
+		const int uvPitch = width + 5;
+		const int dstPitch = width * format.bytesPerPixel + 7;
+
+		// 410 reads one extra chroma row and column
+		byte *y = new byte[yPitch * height];
+		byte *a = new byte[yPitch * height];
+		byte *u = new byte[uvPitch * (height + 1)];
+		byte *v = new byte[uvPitch * (height + 1)];
+
+		Random rnd;
+		for (int i = 0; i < yPitch * height; i++) {
+			y[i] = rnd.getRandomByte();
+			a[i] = rnd.getRandomByte();
+		}
+		for (int i = 0; i < uvPitch * (height + 1); i++) {
+			u[i] = rnd.getRandomByte();
+			v[i] = rnd.getRandomByte();
+		}
+
+		byte *out[2];
+		for (int pass = 0; pass < 2; pass++) {
+			Common::setSIMDEnabled(pass == 0);
+
+			out[pass] = new byte[dstPitch * height];
+			memset(out[pass], 0xCD, dstPitch * height);
+
+			const Graphics::YUVToRGBManager::LuminanceScale scale = itu ? Graphics::YUVToRGBManager::kScaleITU : Graphics::YUVToRGBManager::kScaleFull;
+			switch (subsampling) {
+			case k444:
+				YUVToRGBMan.convert444(out[pass], dstPitch, format, scale, y, u, v, width, height, yPitch, uvPitch);
+				break;
+			case k420:
+				YUVToRGBMan.convert420(out[pass], dstPitch, format, scale, y, u, v, width, height, yPitch, uvPitch);
+				break;
+			case k410:
+				YUVToRGBMan.convert410(out[pass], dstPitch, format, scale, y, u, v, width, height, yPitch, uvPitch);
+				break;
+			case k420Alpha:
+				YUVAToRGBAMan.convert420(out[pass], dstPitch, format, itu ? Graphics::YUVAToRGBAManager::kScaleITU : Graphics::YUVAToRGBAManager::kScaleFull,
+				                         y, u, v, a, width, height, yPitch, uvPitch);
+				break;
+			}
+		}
+		Common::setSIMDEnabled(true);
+
+		TS_ASSERT_EQUALS(memcmp(out[0], out[1], dstPitch * height), 0);
+
+		delete[] out[0];
+		delete[] out[1];
+		delete[] v;
+		delete[] u;
+		delete[] a;
+		delete[] y;
+	}
+
+	void compareAllFormats(Subsampling subsampling) {
+		for (int f = 0; f < 5; f++) {
+			for (int itu = 0; itu < 2; itu++) {
+				// Widths with a partial vector step, and wider than one row chunk
+				compareWithScalar(subsampling, getFormat(f), itu, 68, 8);
+				compareWithScalar(subsampling, getFormat(f), itu, 300, 4);
+			}
+		}
+	}
+
+public:
+	void test_convert444() {
+		compareAllFormats(k444);
+	}
+
+	void test_convert420() {
+		compareAllFormats(k420);
+	}
+
+	void test_convert410() {
+		compareAllFormats(k410);
+	}
+
+	void test_convert420_alpha() {
+		compareAllFormats(k420Alpha);
+	}
+
+	void test_surface() {
+		// The surface variant is a thin wrapper around the buffer one
+		const int width = 32, height = 4;
+		byte y[width * height], u[width * height], v[width * height];
+		Random rnd;
+		for (int i = 0; i < width * height; i++) {
+			y[i] = rnd.getRandomByte();
+			u[i] = rnd.getRandomByte();
+			v[i] = rnd.getRandomByte();
+		}
+
+		const Graphics::PixelFormat format = getFormat(0);
+		Graphics::Surface surface;
+		surface.create(width, height, format);
+		YUVToRGBMan.convert444(&surface, Graphics::YUVToRGBManager::kScaleFull, y, u, v, width, height, width, width);
+
+		uint32 buffer[width * height];
+		YUVToRGBMan.convert444((byte *)buffer, width * 4, format, Graphics::YUVToRGBManager::kScaleFull, y, u, v, width, height, width, width);
+
+		TS_ASSERT_EQUALS(memcmp(surface.getPixels(), buffer, sizeof(buffer)), 0);
+		surface.free();
+	}
+};
@@ -0,0 +1,21 @@
+#include "engines/grim/set.h"
+
+#include "test/benchmark/benchmark.h"
+
+namespace Grim {
+// The parts of the engine built into the test runner refer to these, on
+// code paths the tests don't take (shrinking sectors, EMI savegames)
+class GrimEngine;
+GrimEngine *g_grim = nullptr;
+
+Sector *Set::getSectorBase(int id) {
+	return nullptr;
+}
+}
+
+namespace Benchmark {
+// The tests borrow the null system of the benchmarks, they don't look at its clock
+uint64 getMicros() {
+	return 0;
+}
+}
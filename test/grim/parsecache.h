@@ -0,0 +1,174 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+
+#include "engines/grim/parsecache.h"
+
+#include "test/benchmark/null_system.h"
+
+class ParseCacheTestSuite : public CxxTest::TestSuite
+{
+private:
+	// The cache locks a mutex
+	Benchmark::NullSystem *_system;
+
+	void storeString(Grim::ParseCache &cache, const char *fname, uint32 hash, const char *blob) {
+		cache.store(fname, hash, 100, (const byte *)blob, strlen(blob));
+	}
+
+	/** Whether the cache has the given blob for a file, released right away. */
+	bool hasBlob(Grim::ParseCache &cache, const char *fname, uint32 hash, const char *blob) {
+		uint32 length;
+		const byte *data = cache.find(fname, hash, 100, length);
+		if (!data)
+			return false;
+
+		const bool same = length == strlen(blob) && memcmp(data, blob, length) == 0;
+		cache.release(data);
+		return same;
+	}
+
+	void save(Grim::ParseCache &cache, Common::MemoryWriteStreamDynamic &stream) {
+		cache.save(&stream);
+		TS_ASSERT(!cache.isDirty());
+	}
+
+public:
+	void setUp() {
+		_system = new Benchmark::NullSystem();
+	}
+
+	void tearDown() {
+		delete _system;
+	}
+
+	void test_round_trip() {
+		Grim::ParseCache cache;
+		storeString(cache, "a.set", 1, "first blob");
+		storeString(cache, "B.cos", 2, "second");
+		storeString(cache, "empty.txt", 3, "x");
+		TS_ASSERT(cache.isDirty());
+
+		Common::MemoryWriteStreamDynamic saved(DisposeAfterUse::YES);
+		save(cache, saved);
+
+		Grim::ParseCache loaded;
+		Common::MemoryReadStream data(saved.getData(), saved.size());
+		TS_ASSERT(loaded.load(&data));
+		TS_ASSERT(!loaded.isDirty());
+		TS_ASSERT(hasBlob(loaded, "a.set", 1, "first blob"));
+		TS_ASSERT(hasBlob(loaded, "b.cos", 2, "second"));
+		TS_ASSERT(hasBlob(loaded, "empty.txt", 3, "x"));
+
+		// Other content, or another file
+		TS_ASSERT(!hasBlob(loaded, "a.set", 4, "first blob"));
+		TS_ASSERT(!hasBlob(loaded, "c.set", 1, "first blob"));
+
+		// Saving again what was loaded gives the same file
+		Common::MemoryWriteStreamDynamic saved2(DisposeAfterUse::YES);
+		save(loaded, saved2);
+		TS_ASSERT_EQUALS(saved2.size(), saved.size());
+
+		Grim::ParseCache::Stats stats;
+		loaded.getStats(stats);
+		TS_ASSERT_EQUALS(stats.entries, 3u);
+		TS_ASSERT_EQUALS(stats.size, 17u);
+		TS_ASSERT_EQUALS(stats.hits, 3u);
+		TS_ASSERT_EQUALS(stats.misses, 2u);
+	}
+
+	void test_truncated() {
+		Grim::ParseCache cache;
+		storeString(cache, "a.set", 1, "first blob");
+		storeString(cache, "b.set", 2, "second blob");
+
+		Common::MemoryWriteStreamDynamic saved(DisposeAfterUse::YES);
+		save(cache, saved);
+
+		// Any shorter file is rejected, and leaves the cache empty
+		for (uint32 size = 0; size < saved.size(); ++size) {
+			Grim::ParseCache loaded;
+			storeString(loaded, "old.set", 5, "old");
+			Common::MemoryReadStream data(saved.getData(), size);
+			TS_ASSERT(!loaded.load(&data));
+			TS_ASSERT(!hasBlob(loaded, "a.set", 1, "first blob"));
+			TS_ASSERT(!hasBlob(loaded, "old.set", 5, "old"));
+		}
+
+		// So is trailing data
+		byte *longer = (byte *)malloc(saved.size() + 1);
+		memcpy(longer, saved.getData(), saved.size());
+		longer[saved.size()] = 0;
+		Grim::ParseCache loaded;
+		Common::MemoryReadStream data(longer, saved.size() + 1, DisposeAfterUse::YES);
+		TS_ASSERT(!loaded.load(&data));
+	}
+
+	void test_bad_header() {
+		Grim::ParseCache cache;
+		storeString(cache, "a.set", 1, "first blob");
+
+		Common::MemoryWriteStreamDynamic saved(DisposeAfterUse::YES);
+		save(cache, saved);
+
+		// The tag, then the version
+		for (int i = 0; i < 8; i += 4) {
+			byte *copy = (byte *)malloc(saved.size());
+			memcpy(copy, saved.getData(), saved.size());
+			copy[i]++;
+			Grim::ParseCache loaded;
+			Common::MemoryReadStream data(copy, saved.size(), DisposeAfterUse::YES);
+			TS_ASSERT(!loaded.load(&data));
+		}
+	}
+
+	void test_replace_while_replaying() {
+		Grim::ParseCache cache;
+		storeString(cache, "a.set", 1, "first blob");
+
+		// A splitter replaying an entry keeps it, even once it is replaced
+		uint32 length;
+		const byte *data = cache.find("a.set", 1, 100, length);
+		TS_ASSERT(data);
+		storeString(cache, "a.set", 2, "second blob");
+		TS_ASSERT_EQUALS(length, 10u);
+		TS_ASSERT_EQUALS(memcmp(data, "first blob", length), 0);
+		cache.release(data);
+
+		data = cache.find("a.set", 2, 100, length);
+		TS_ASSERT(data);
+		cache.remove("a.set");
+		TS_ASSERT_EQUALS(memcmp(data, "second blob", length), 0);
+		cache.release(data);
+		TS_ASSERT(!hasBlob(cache, "a.set", 2, "second blob"));
+
+		// Replacing entries over and over doesn't keep the old blobs
+		for (int i = 0; i < 100; ++i)
+			storeString(cache, "a.set", i, "blob");
+		TS_ASSERT(hasBlob(cache, "a.set", 99, "blob"));
+
+		Grim::ParseCache::Stats stats;
+		cache.getStats(stats);
+		TS_ASSERT_EQUALS(stats.entries, 1u);
+		TS_ASSERT_EQUALS(stats.size, 4u);
+	}
+
+	void test_replace_loaded() {
+		Grim::ParseCache cache;
+		storeString(cache, "a.set", 1, "first blob");
+		Common::MemoryWriteStreamDynamic saved(DisposeAfterUse::YES);
+		save(cache, saved);
+
+		Grim::ParseCache loaded;
+		Common::MemoryReadStream data(saved.getData(), saved.size());
+		TS_ASSERT(loaded.load(&data));
+
+		uint32 length;
+		const byte *blob = loaded.find("a.set", 1, 100, length);
+		storeString(loaded, "a.set", 2, "second blob");
+		TS_ASSERT(loaded.isDirty());
+		TS_ASSERT_EQUALS(memcmp(blob, "first blob", length), 0);
+		loaded.release(blob);
+		TS_ASSERT(hasBlob(loaded, "a.set", 2, "second blob"));
+	}
+};
@@ -0,0 +1,340 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/memstream.h"
+#include "common/savefile.h"
+#include "common/zlib.h"
+
+#include "engines/grim/savegame.h"
+
+#include "test/benchmark/null_system.h"
+
+/** Savefiles kept in memory, written when finalized or deleted. */
+class MemorySaveFileManager : public Common::SaveFileManager {
+public:
+	typedef Common::HashMap<Common::String, Common::Array<byte> > FileMap;
+
+	Common::OutSaveFile *openForSaving(const Common::String &name, bool compress) {
+		Common::WriteStream *stream = new File(_files, name);
+		return compress ? Common::wrapCompressedWriteStream(stream) : stream;
+	}
+
+	Common::InSaveFile *openForLoading(const Common::String &name) {
+		if (!_files.contains(name))
+			return nullptr;
+		const Common::Array<byte> &data = _files[name];
+		return Common::wrapCompressedReadStream(new Common::MemoryReadStream(data.begin(), data.size()));
+	}
+
+	bool removeSavefile(const Common::String &name) {
+		_files.erase(name);
+		return true;
+	}
+
+	Common::StringArray listSavefiles(const Common::String &pattern) {
+		return Common::StringArray();
+	}
+
+	Common::Array<byte> &getFile(const Common::String &name) { return _files[name]; }
+
+private:
+	class File : public Common::WriteStream {
+	public:
+		File(FileMap &files, const Common::String &name) : _files(files), _name(name) {}
+		~File() { finalize(); }
+
+		uint32 write(const void *dataPtr, uint32 dataSize) {
+			const byte *data = (const byte *)dataPtr;
+			for (uint32 i = 0; i < dataSize; ++i)
+				_data.push_back(data[i]);
+			return dataSize;
+		}
+
+		void finalize() { _files[_name] = _data; }
+
+	private:
+		FileMap &_files;
+		Common::String _name;
+		Common::Array<byte> _data;
+	};
+
+	FileMap _files;
+};
+
+class SaveSystem : public Benchmark::NullSystem {
+public:
+	SaveSystem() { _savefileManager = new MemorySaveFileManager(); }
+
+	void getTimeAndDate(TimeDate &t) const {
+		memset(&t, 0, sizeof(t));
+		t.tm_year = 114;
+		t.tm_mon = 4;
+		t.tm_mday = 17;
+		t.tm_hour = 21;
+		t.tm_min = 42;
+	}
+};
+
+class SaveGameTestSuite : public CxxTest::TestSuite
+{
+private:
+	SaveSystem *_system;
+	int _writtenCalls;
+
+	static void written(Grim::SaveGame *savedState, bool success, void *param) {
+		SaveGameTestSuite *suite = (SaveGameTestSuite *)param;
+		TS_ASSERT(success);
+		suite->_writtenCalls++;
+	}
+
+	void writeSections(Grim::SaveGame *savedState) {
+		savedState->beginSection('SIMG');
+		for (int i = 0; i < 256 * 128; ++i)
+			savedState->writeLEUint16(i * 7);
+		savedState->endSection();
+
+		savedState->beginSection('SUBS');
+		savedState->writeLESint32(10);
+		savedState->write("Elaine's!", 10);
+		savedState->endSection();
+
+		savedState->beginSection('BITM');
+		savedState->writeLEUint32(42);
+		savedState->writeString("hello");
+		savedState->writeFloat(1.5f);
+		savedState->endSection();
+
+		savedState->beginSection('EMPT');
+		savedState->endSection();
+
+		// Compresses well, unlike the next one
+		savedState->beginSection('LUAS');
+		for (int i = 0; i < 200000; ++i)
+			savedState->writeByte(i % 13);
+		savedState->endSection();
+
+		savedState->beginSection('RAND');
+		uint32 seed = 1;
+		for (int i = 0; i < 10000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			savedState->writeByte(seed >> 16);
+		}
+		savedState->endSection();
+	}
+
+	/** Read the sections back, in another order than they were written. */
+	void checkSections(Grim::SaveGame *savedState) {
+		TS_ASSERT(savedState->isCompatible());
+
+		TS_ASSERT_EQUALS(savedState->beginSection('LUAS'), 200000u);
+		bool same = true;
+		for (int i = 0; i < 200000; ++i)
+			same &= savedState->readByte() == i % 13;
+		TS_ASSERT(same);
+		savedState->endSection();
+
+		TS_ASSERT_EQUALS(savedState->beginSection('SIMG'), 256u * 128u * 2u);
+		same = true;
+		for (int i = 0; i < 256 * 128; ++i)
+			same &= savedState->readLEUint16() == (uint16)(i * 7);
+		TS_ASSERT(same);
+		savedState->endSection();
+
+		TS_ASSERT_EQUALS(savedState->beginSection('BITM'), 17u);
+		TS_ASSERT_EQUALS(savedState->readLEUint32(), 42u);
+		TS_ASSERT_EQUALS(savedState->readString(), "hello");
+		TS_ASSERT_EQUALS(savedState->readFloat(), 1.5f);
+		savedState->endSection();
+
+		TS_ASSERT_EQUALS(savedState->beginSection('EMPT'), 0u);
+		savedState->endSection();
+
+		TS_ASSERT_EQUALS(savedState->beginSection('RAND'), 10000u);
+		uint32 seed = 1;
+		same = true;
+		for (int i = 0; i < 10000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			same &= savedState->readByte() == (byte)(seed >> 16);
+		}
+		TS_ASSERT(same);
+		savedState->endSection();
+
+		TS_ASSERT_EQUALS(savedState->beginSection('SUBS'), 14u);
+		TS_ASSERT_EQUALS(savedState->readLESint32(), 10);
+		char description[10];
+		savedState->read(description, 10);
+		TS_ASSERT_EQUALS(Common::String(description), "Elaine's!");
+		savedState->endSection();
+	}
+
+public:
+	void setUp() {
+		_system = new SaveSystem();
+		_writtenCalls = 0;
+	}
+
+	void tearDown() {
+		delete _system;
+	}
+
+	void test_round_trip() {
+		Grim::SaveGame *savedState = Grim::SaveGame::openForSaving("grim01.gsv");
+		TS_ASSERT(savedState);
+		writeSections(savedState);
+		savedState->setDescription("Manny's office");
+		delete savedState;
+
+		savedState = Grim::SaveGame::openForLoading("grim01.gsv");
+		TS_ASSERT(savedState);
+		TS_ASSERT_EQUALS(savedState->saveMinorVersion(), Grim::SaveGame::SAVEGAME_MINOR_VERSION);
+		TS_ASSERT(savedState->hasMetadata());
+		checkSections(savedState);
+		delete savedState;
+	}
+
+	void test_metadata() {
+		Grim::SaveGame *savedState = Grim::SaveGame::openForSaving("grim02.gsv");
+		writeSections(savedState);
+		savedState->setDescription("Manny's office");
+		delete savedState;
+
+		// Only the header is needed for the metadata
+		savedState = Grim::SaveGame::openForLoading("grim02.gsv");
+		TS_ASSERT(savedState->hasMetadata());
+		TS_ASSERT_EQUALS(savedState->getDescription(), "Manny's office");
+		int year, month, day, hour, minute;
+		savedState->getSaveDate(year, month, day);
+		savedState->getSaveTime(hour, minute);
+		TS_ASSERT_EQUALS(year, 2014);
+		TS_ASSERT_EQUALS(month, 5);
+		TS_ASSERT_EQUALS(day, 17);
+		TS_ASSERT_EQUALS(hour, 21);
+		TS_ASSERT_EQUALS(minute, 42);
+
+		TS_ASSERT(savedState->hasSection('SUBS'));
+		TS_ASSERT(!savedState->hasSection('PS2S'));
+		delete savedState;
+
+		// The thumbnail is read straight from the header, too
+		savedState = Grim::SaveGame::openForLoading("grim02.gsv");
+		TS_ASSERT_EQUALS(savedState->beginSection('SIMG'), 256u * 128u * 2u);
+		TS_ASSERT_EQUALS(savedState->readLEUint16(), 0);
+		TS_ASSERT_EQUALS(savedState->readLEUint16(), 7);
+		savedState->endSection();
+		delete savedState;
+	}
+
+	void test_no_description() {
+		// The scripts may not submit one, listing the saves then reads SUBS
+		Grim::SaveGame *savedState = Grim::SaveGame::openForSaving("grim03.gsv");
+		writeSections(savedState);
+		delete savedState;
+
+		savedState = Grim::SaveGame::openForLoading("grim03.gsv");
+		TS_ASSERT(savedState->hasMetadata());
+		TS_ASSERT(savedState->getDescription().empty());
+		checkSections(savedState);
+		delete savedState;
+	}
+
+	void test_truncated() {
+		Grim::SaveGame *savedState = Grim::SaveGame::openForSaving("grim04.gsv");
+		writeSections(savedState);
+		savedState->setDescription("Manny's office");
+		delete savedState;
+
+		// Cut in the metadata
+		MemorySaveFileManager *saves = (MemorySaveFileManager *)_system->getSavefileManager();
+		saves->getFile("grim04.gsv").resize(20);
+		TS_ASSERT(!Grim::SaveGame::openForLoading("grim04.gsv"));
+	}
+
+	void test_broken_directory() {
+		Grim::SaveGame *savedState = Grim::SaveGame::openForSaving("grim07.gsv");
+		writeSections(savedState);
+		delete savedState;
+
+		// The directory follows the metadata, its first entry is the thumbnail
+		MemorySaveFileManager *saves = (MemorySaveFileManager *)_system->getSavefileManager();
+		Common::Array<byte> &file = saves->getFile("grim07.gsv");
+		const uint32 directory = 16 + READ_BE_UINT32(&file[12]);
+		const Common::Array<byte> good = file;
+
+		// Too many sections
+		WRITE_BE_UINT32(&file[directory], 0x10000000);
+		savedState = Grim::SaveGame::openForLoading("grim07.gsv");
+		TS_ASSERT(savedState);
+		TS_ASSERT(!savedState->hasSection('SUBS'));
+		TS_ASSERT(savedState->isBroken());
+		delete savedState;
+
+		// A section going past the end of the file
+		file = good;
+		WRITE_BE_UINT32(&file[directory + 4 + 4], file.size() - 10);
+		savedState = Grim::SaveGame::openForLoading("grim07.gsv");
+		TS_ASSERT(!savedState->hasSection('SUBS'));
+		TS_ASSERT(savedState->isBroken());
+		delete savedState;
+
+		// A missing section is no reason to give up on the savegame
+		file = good;
+		savedState = Grim::SaveGame::openForLoading("grim07.gsv");
+		TS_ASSERT(!savedState->hasSection('PS2S'));
+		TS_ASSERT(!savedState->isBroken());
+		delete savedState;
+	}
+
+	void test_older_version() {
+		// Sections one after the other, and the whole file compressed
+		Common::WriteStream *file = _system->getSavefileManager()->openForSaving("grim05.gsv");
+		file->writeUint32BE('RSAV');
+		file->writeUint32BE(Grim::SaveGame::SAVEGAME_MAJOR_VERSION);
+		file->writeUint32BE(Grim::SaveGame::SAVEGAME_INDEXED_VERSION - 1);
+		file->writeUint32BE('BITM');
+		file->writeUint32BE(4);
+		file->writeUint32LE(7);
+		file->writeUint32BE('LUAS');
+		file->writeUint32BE(3);
+		file->writeByte(1);
+		file->writeByte(2);
+		file->writeByte(3);
+		file->writeUint32BE('ESAV');
+		file->finalize();
+		delete file;
+
+		Grim::SaveGame *savedState = Grim::SaveGame::openForLoading("grim05.gsv");
+		TS_ASSERT(savedState->isCompatible());
+		TS_ASSERT(!savedState->hasMetadata());
+		TS_ASSERT_EQUALS(savedState->beginSection('LUAS'), 3u);
+		TS_ASSERT_EQUALS(savedState->readByte(), 1);
+		savedState->endSection();
+		delete savedState;
+
+		savedState = Grim::SaveGame::openForLoading("grim05.gsv");
+		TS_ASSERT_EQUALS(savedState->beginSection('BITM'), 4u);
+		TS_ASSERT_EQUALS(savedState->readLEUint32(), 7u);
+		savedState->endSection();
+		delete savedState;
+	}
+
+	void test_background_write() {
+		Grim::SaveGame *savedState = Grim::SaveGame::openForSaving("grim06.gsv");
+		writeSections(savedState);
+		savedState->setDescription("Manny's office");
+		savedState->writeInBackground(written, this);
+
+		// Opening waits for the file to be complete
+		Grim::SaveGame *loaded = Grim::SaveGame::openForLoading("grim06.gsv");
+		TS_ASSERT(loaded);
+		TS_ASSERT_EQUALS(loaded->getDescription(), "Manny's office");
+		checkSections(loaded);
+		delete loaded;
+
+		// The callback is left to the poll
+		TS_ASSERT_EQUALS(_writtenCalls, 0);
+		TS_ASSERT(savedState->pollWritten());
+		TS_ASSERT_EQUALS(_writtenCalls, 1);
+		delete savedState;
+	}
+};
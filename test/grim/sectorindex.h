@@ -0,0 +1,173 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "engines/grim/sector.h"
+#include "engines/grim/sectorindex.h"
+#include "engines/grim/textsplit.h"
+
+class SectorIndexTestSuite : public CxxTest::TestSuite
+{
+private:
+	Common::Array<Grim::Sector *> _sectors;
+
+	/** Load a sector with the given corners, the way sets describe them. */
+	void addSector(const char *type, bool visible, float height, int numVertices, const float *vertices) {
+		Common::String text = Common::String::format(" sector box%d\n id %d\n type %s\n default visibility %s\n height %f\n numvertices %d\n",
+		                                             _sectors.size(), _sectors.size(), type, visible ? "visible" : "invisible", height, numVertices);
+		for (int i = 0; i < numVertices; ++i)
+			text += Common::String::format("%s %f %f %f\n", i == 0 ? " vertices:" : "", vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+
+		Common::MemoryReadStream stream((const byte *)text.c_str(), text.size());
+		Grim::TextSplitter ts("", &stream);
+		Grim::Sector *sector = new Grim::Sector();
+		sector->load(ts);
+		_sectors.push_back(sector);
+	}
+
+	void addFlatBox(const char *type, bool visible, float x0, float y0, float x1, float y1, float z) {
+		const float vertices[] = { x0, y0, z, x1, y0, z, x1, y1, z, x0, y1, z };
+		addSector(type, visible, 0.5f, 4, vertices);
+	}
+
+	// The queries Set did before the index, testing every sector in order
+
+	Grim::Sector *findPointSectorLinear(const Math::Vector3d &p, int type) {
+		for (uint i = 0; i < _sectors.size(); ++i) {
+			Grim::Sector *sector = _sectors[i];
+			if ((sector->getType() & type) && sector->isVisible() && sector->isPointInSector(p))
+				return sector;
+		}
+		return nullptr;
+	}
+
+	void findClosestSectorLinear(const Math::Vector3d &p, Grim::Sector **sect, Math::Vector3d *closestPoint) {
+		Grim::Sector *resultSect = nullptr;
+		Math::Vector3d resultPt = p;
+		float minDist = 0.0;
+
+		for (uint i = 0; i < _sectors.size(); ++i) {
+			Grim::Sector *sector = _sectors[i];
+			if ((sector->getType() & Grim::Sector::WalkType) == 0 || !sector->isVisible())
+				continue;
+			Math::Vector3d closestPt = sector->getClosestPoint(p);
+			float thisDist = (closestPt - p).getMagnitude();
+			if (!resultSect || thisDist < minDist) {
+				resultSect = sector;
+				resultPt = closestPt;
+				minDist = thisDist;
+			}
+		}
+
+		*sect = resultSect;
+		*closestPoint = resultPt;
+	}
+
+	/** Query a lattice of points reaching well outside of the sectors. */
+	void compareWithLinear() {
+		Grim::SectorIndex index;
+		index.build(_sectors.begin(), _sectors.size(), false);
+
+		for (float x = -12.f; x <= 12.f; x += 0.37f) {
+			for (float y = -12.f; y <= 12.f; y += 0.37f) {
+				for (float z = -0.5f; z <= 1.5f; z += 1.f) {
+					const Math::Vector3d p(x, y, z);
+
+					TS_ASSERT_EQUALS(index.findPointSector(p, Grim::Sector::WalkType), findPointSectorLinear(p, Grim::Sector::WalkType));
+					TS_ASSERT_EQUALS(index.findPointSector(p, Grim::Sector::CameraType), findPointSectorLinear(p, Grim::Sector::CameraType));
+
+					Grim::Sector *sector, *linearSector;
+					Math::Vector3d point, linearPoint;
+					index.findClosestSector(p, &sector, &point);
+					findClosestSectorLinear(p, &linearSector, &linearPoint);
+					TS_ASSERT_EQUALS(sector, linearSector);
+					TS_ASSERT_EQUALS(point, linearPoint);
+				}
+			}
+		}
+	}
+
+public:
+	void tearDown() {
+		for (uint i = 0; i < _sectors.size(); ++i)
+			delete _sectors[i];
+		_sectors.clear();
+	}
+
+	void test_empty() {
+		Grim::SectorIndex index;
+		index.build(_sectors.begin(), 0, false);
+
+		Grim::Sector *sector = nullptr;
+		Math::Vector3d point;
+		TS_ASSERT(!index.findPointSector(Math::Vector3d(0.f, 0.f, 0.f), Grim::Sector::WalkType));
+		index.findClosestSector(Math::Vector3d(1.f, 2.f, 3.f), &sector, &point);
+		TS_ASSERT(!sector);
+		TS_ASSERT_EQUALS(point, Math::Vector3d(1.f, 2.f, 3.f));
+	}
+
+	void test_boxes() {
+		// Overlapping boxes of different types and sizes, with holes
+		for (int i = 0; i < 6; ++i) {
+			for (int j = 0; j < 6; ++j) {
+				if ((i * 7 + j * 3) % 5 == 0)
+					continue;
+				addFlatBox((i + j) % 4 == 0 ? "camera" : "walk", (i * j) % 7 != 3, i * 1.5f - 4.f, j * 1.5f - 4.f, i * 1.5f - 2.f, j * 1.5f - 2.4f, 0.f);
+			}
+		}
+		addFlatBox("walk", true, -9.f, -1.f, -6.f, 1.f, 1.f);
+		addFlatBox("walk", true, 5.f, 5.f, 9.f, 9.f, 0.f);
+		compareWithLinear();
+	}
+
+	void test_unbounded_sectors() {
+		addFlatBox("walk", true, -3.f, -3.f, 3.f, 3.f, 0.f);
+		addFlatBox("walk", true, 4.f, -1.f, 6.f, 1.f, 0.f);
+
+		// A ramp with no height limit covers points far away from it on the ground
+		const float ramp[] = { -2.f, 4.f, 0.f, 2.f, 4.f, 0.f, 2.f, 8.f, 2.f, -2.f, 8.f, 2.f };
+		addSector("walk", true, 9999.f, 4, ramp);
+
+		// A tilted sector with a height only reaches a bit further
+		const float slope[] = { -8.f, -8.f, 0.f, -5.f, -8.f, 1.f, -5.f, -5.f, 1.f, -8.f, -5.f, 0.f };
+		addSector("walk", true, 1.f, 4, slope);
+
+		addFlatBox("walk", true, -1.f, -7.f, 1.f, -5.f, 0.f);
+
+		Grim::SectorIndex index;
+		index.build(_sectors.begin(), _sectors.size(), false);
+		TS_ASSERT_EQUALS(index.getUnboundedCount(), 1);
+
+		compareWithLinear();
+	}
+
+	void test_hidden_sectors() {
+		// Visibility is checked while querying, no rebuild is needed
+		addFlatBox("walk", true, -2.f, -2.f, 2.f, 2.f, 0.f);
+		addFlatBox("walk", true, -1.f, -1.f, 1.f, 1.f, 0.f);
+
+		Grim::SectorIndex index;
+		index.build(_sectors.begin(), _sectors.size(), false);
+		const Math::Vector3d p(0.f, 0.f, 0.f);
+		TS_ASSERT_EQUALS(index.findPointSector(p, Grim::Sector::WalkType), _sectors[0]);
+
+		_sectors[0]->setVisible(false);
+		TS_ASSERT_EQUALS(index.findPointSector(p, Grim::Sector::WalkType), _sectors[1]);
+		compareWithLinear();
+	}
+
+	void test_stats() {
+		addFlatBox("walk", true, -2.f, -2.f, 2.f, 2.f, 0.f);
+
+		Grim::SectorIndex index;
+		index.build(_sectors.begin(), _sectors.size(), false);
+		index.findPointSector(Math::Vector3d(0.f, 0.f, 0.f), Grim::Sector::WalkType);
+
+		const Grim::SectorIndex::QueryStats &stats = index.getStats(Grim::SectorIndex::kPointQuery);
+		TS_ASSERT_EQUALS(stats.queries, 1u);
+		TS_ASSERT_EQUALS(stats.sectorsTested, 1u);
+		TS_ASSERT_EQUALS(stats.micros, 0u);
+	}
+};
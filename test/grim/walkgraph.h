@@ -0,0 +1,267 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/list.h"
+
+#include "engines/grim/walkgraph.h"
+
+/**
+ * A grid of unit boxes, some of them missing, like the walk boxes of a set
+ * with obstacles. Neighbouring boxes share a whole side.
+ */
+class WalkGrid : public Grim::WalkGraph::PathQuery {
+public:
+	WalkGrid(int size, const char *holes) : _size(size) {
+		_enabled.resize(size * size);
+		for (int i = 0; i < size * size; ++i)
+			_enabled[i] = holes[i] != '#';
+	}
+
+	int getBoxCount() const { return _size * _size; }
+	bool isEnabled(int box) const { return _enabled[box]; }
+	Math::Vector3d getCenter(int box) const { return Math::Vector3d(box % _size + 0.5f, box / _size + 0.5f, 0.f); }
+
+	bool contains(int box, const Math::Vector3d &p) const {
+		const float x = box % _size, y = box / _size;
+		return p.x() >= x && p.x() <= x + 1 && p.y() >= y && p.y() <= y + 1;
+	}
+
+	Math::Vector3d getClosestPoint(int box, const Math::Vector3d &p) const {
+		const float x = box % _size, y = box / _size;
+		return Math::Vector3d(CLIP(p.x(), x, x + 1), CLIP(p.y(), y, y + 1), 0.f);
+	}
+
+	/** The side two boxes share, or nothing when they don't touch. */
+	Common::List<Math::Line3d> getBridges(int from, int to) const {
+		Common::List<Math::Line3d> bridges;
+		const int fx = from % _size, fy = from / _size;
+		const int tx = to % _size, ty = to / _size;
+		if (fy == ty && (tx == fx + 1 || tx == fx - 1)) {
+			const float x = MAX(fx, tx);
+			bridges.push_back(Math::Line3d(Math::Vector3d(x, fy, 0.f), Math::Vector3d(x, fy + 1, 0.f)));
+		} else if (fx == tx && (ty == fy + 1 || ty == fy - 1)) {
+			const float y = MAX(fy, ty);
+			bridges.push_back(Math::Line3d(Math::Vector3d(fx, y, 0.f), Math::Vector3d(fx + 1, y, 0.f)));
+		}
+		return bridges;
+	}
+
+	void buildGraph(Grim::WalkGraph &graph) const {
+		graph.reset(getBoxCount(), false);
+		for (int i = 0; i < getBoxCount(); ++i) {
+			for (int j = 0; j < getBoxCount(); ++j) {
+				Common::List<Math::Line3d> bridges = getBridges(i, j);
+				if (!bridges.empty())
+					graph.addEdge(i, j, bridges);
+			}
+		}
+	}
+
+	void setDest(const Math::Vector3d &dest) { _dest = dest; }
+
+	bool isNodeEnabled(int node) override { return _enabled[node]; }
+	bool isGoal(int node) override { return contains(node, _dest); }
+	Math::Vector3d getTarget(int node) override { return getClosestPoint(node, _dest); }
+	Math::Vector3d adjustStep(const Math::Vector3d &from, const Math::Vector3d &to) override { return to; }
+
+private:
+	int _size;
+	Common::Array<bool> _enabled;
+	Math::Vector3d _dest;
+};
+
+class WalkGraphTestSuite : public CxxTest::TestSuite
+{
+private:
+	struct ListNode {
+		int box;
+		ListNode *parent;
+		Math::Vector3d pos;
+		float dist;
+		float cost;
+	};
+
+	/** The search Actor::walkTo did before the walk graph, with open and closed lists. */
+	bool findPathWithLists(const WalkGrid &grid, int startBox, const Math::Vector3d &startPos, const Math::Vector3d &dest, Common::List<Math::Vector3d> &path) {
+		Common::List<ListNode *> openList;
+		Common::List<ListNode *> closedList;
+		bool found = false;
+
+		ListNode *start = new ListNode;
+		start->box = startBox;
+		start->parent = nullptr;
+		start->pos = startPos;
+		start->dist = 0.f;
+		start->cost = 0.f;
+		openList.push_back(start);
+
+		do {
+			ListNode *node = nullptr;
+			float cost = -1.f;
+			for (Common::List<ListNode *>::iterator j = openList.begin(); j != openList.end(); ++j) {
+				const float c = (*j)->dist + (*j)->cost;
+				if (cost < 0.f || c < cost) {
+					cost = c;
+					node = *j;
+				}
+			}
+			closedList.push_back(node);
+			openList.remove(node);
+
+			if (grid.contains(node->box, dest)) {
+				for (ListNode *n = node; n->parent; n = n->parent)
+					path.push_back(n->pos);
+				found = true;
+				break;
+			}
+
+			for (int i = 0; i < grid.getBoxCount(); ++i) {
+				if (!grid.isEnabled(i))
+					continue;
+
+				bool inClosed = false;
+				for (Common::List<ListNode *>::iterator j = closedList.begin(); j != closedList.end(); ++j) {
+					if ((*j)->box == i)
+						inClosed = true;
+				}
+				Common::List<Math::Line3d> bridges = grid.getBridges(node->box, i);
+				if (inClosed || bridges.empty())
+					continue;
+
+				Math::Vector3d closestPoint = grid.getClosestPoint(i, dest);
+				Math::Vector3d best;
+				if (!bridges.front().intersectLine2d(Math::Line3d(node->pos, closestPoint), &best, false))
+					best = bridges.front().middle();
+
+				ListNode *n = nullptr;
+				for (Common::List<ListNode *>::iterator j = openList.begin(); j != openList.end(); ++j) {
+					if ((*j)->box == i)
+						n = *j;
+				}
+				const float newCost = node->cost + (best - node->pos).getMagnitude();
+				if (!n) {
+					n = new ListNode;
+					n->box = i;
+					openList.push_back(n);
+				} else if (newCost >= n->cost) {
+					continue;
+				}
+				n->parent = node;
+				n->pos = best;
+				n->dist = (best - dest).getMagnitude();
+				n->cost = newCost;
+			}
+		} while (!openList.empty());
+
+		for (Common::List<ListNode *>::iterator j = closedList.begin(); j != closedList.end(); ++j)
+			delete *j;
+		for (Common::List<ListNode *>::iterator j = openList.begin(); j != openList.end(); ++j)
+			delete *j;
+
+		return found;
+	}
+
+	float getPathLength(const Math::Vector3d &start, const Common::List<Math::Vector3d> &path) {
+		// The path is stored from the end to the start
+		float length = 0.f;
+		Math::Vector3d next = start;
+		for (Common::List<Math::Vector3d>::const_iterator i = path.reverse_begin(); i != path.end(); --i) {
+			length += (*i - next).getMagnitude();
+			next = *i;
+		}
+		return length;
+	}
+
+	/** Walk from every enabled box to every box, with both searches. */
+	void compareAllWalks(WalkGrid &grid) {
+		Grim::WalkGraph graph;
+		grid.buildGraph(graph);
+
+		for (int from = 0; from < grid.getBoxCount(); ++from) {
+			if (!grid.isEnabled(from))
+				continue;
+
+			for (int to = 0; to < grid.getBoxCount(); ++to) {
+				const Math::Vector3d start = grid.getCenter(from);
+				const Math::Vector3d dest = grid.getCenter(to);
+
+				Common::List<Math::Vector3d> listPath;
+				const bool listFound = findPathWithLists(grid, from, start, dest, listPath);
+
+				Common::List<Math::Vector3d> graphPath;
+				grid.setDest(dest);
+				const bool graphFound = graph.findPath(from, start, dest, grid, graphPath);
+
+				TS_ASSERT_EQUALS(graphFound, listFound);
+				TS_ASSERT_EQUALS(graphPath.size(), listPath.size());
+				TS_ASSERT_DELTA(getPathLength(start, graphPath), getPathLength(start, listPath), 0.001f);
+			}
+		}
+	}
+
+public:
+	void test_open_grid() {
+		WalkGrid grid(5,
+			"....."
+			"....."
+			"....."
+			"....."
+			".....");
+		compareAllWalks(grid);
+	}
+
+	void test_obstacles() {
+		WalkGrid grid(6,
+			"......"
+			".##.#."
+			"..#..."
+			"#.#.##"
+			"..#..."
+			"....#.");
+		compareAllWalks(grid);
+	}
+
+	void test_unreachable_goals() {
+		// The right column is cut off by a wall
+		WalkGrid grid(5,
+			"...#."
+			"...#."
+			"...#."
+			"...#."
+			"...#.");
+		compareAllWalks(grid);
+
+		Grim::WalkGraph graph;
+		grid.buildGraph(graph);
+		Common::List<Math::Vector3d> path;
+		grid.setDest(grid.getCenter(9));
+		TS_ASSERT(!graph.findPath(0, grid.getCenter(0), grid.getCenter(9), grid, path));
+		TS_ASSERT(path.empty());
+	}
+
+	void test_reused_graph() {
+		// Searches keep state in the graph, a failed one must not leak into the next
+		WalkGrid grid(4,
+			"...."
+			".##."
+			"...#"
+			"..#.");
+		Grim::WalkGraph graph;
+		grid.buildGraph(graph);
+
+		Common::List<Math::Vector3d> listPath;
+		TS_ASSERT(findPathWithLists(grid, 3, grid.getCenter(3), grid.getCenter(12), listPath));
+		const float length = getPathLength(grid.getCenter(3), listPath);
+
+		for (int i = 0; i < 3; ++i) {
+			Common::List<Math::Vector3d> path;
+			grid.setDest(grid.getCenter(15));
+			TS_ASSERT(!graph.findPath(0, grid.getCenter(0), grid.getCenter(15), grid, path));
+
+			path.clear();
+			grid.setDest(grid.getCenter(12));
+			TS_ASSERT(graph.findPath(3, grid.getCenter(3), grid.getCenter(12), grid, path));
+			TS_ASSERT_DELTA(getPathLength(grid.getCenter(3), path), length, 0.001f);
+		}
+	}
+};
@@ -5,8 +5,26 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h
-TEST_LIBS    := audio/libaudio.a math/libmath.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h $(srcdir)/test/video/*.h $(srcdir)/test/graphics/*.h
+TEST_LIBS    := video/libvideo.a graphics/libgraphics.a audio/libaudio.a math/libmath.a common/libcommon.a
+TEST_SOURCES :=
+
+ifdef ENABLE_GRIM
+# Like for the benchmarks, the standalone parts of the engine are built in,
+# test/grim/engine_stubs.cpp stands in for the rest.
+TESTS        += $(srcdir)/test/grim/*.h
+TEST_SOURCES += $(srcdir)/engines/grim/walkgraph.cpp
+TEST_SOURCES += $(srcdir)/engines/grim/sector.cpp
+TEST_SOURCES += $(srcdir)/engines/grim/sectorindex.cpp
+TEST_SOURCES += $(srcdir)/engines/grim/textsplit.cpp
+TEST_SOURCES += $(srcdir)/engines/grim/parsecache.cpp
+TEST_SOURCES += $(srcdir)/engines/grim/savegame.cpp
+TEST_SOURCES += $(srcdir)/engines/grim/color.cpp
+TEST_SOURCES += $(srcdir)/engines/grim/debug.cpp
+TEST_SOURCES += $(srcdir)/test/grim/engine_stubs.cpp
+TEST_SOURCES += $(srcdir)/test/benchmark/null_system.cpp
+TEST_SOURCES += $(srcdir)/backends/saves/savefile.cpp
+endif
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
@@ -28,15 +46,48 @@ endif
 
 test: test/runner
 	./test/runner
-test/runner: test/runner.cpp $(TEST_LIBS)
+test/runner: test/runner.cpp $(TEST_SOURCES) $(TEST_LIBS)
 	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
 test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
 
+######################################################################
+# Micro benchmarks.
+# Use the 'benchmark' target to run them, pass BENCHMARK_ARGS to only
+# run some of them. Edit BENCHMARKS to add more benchmarks, and add them
+# to the table in test/benchmark/main.cpp.
+#
+######################################################################
+
+BENCHMARKS      := $(srcdir)/test/benchmark/*.cpp
+BENCHMARK_LIBS  := video/libvideo.a image/libimage.a graphics/libgraphics.a $(TEST_LIBS)
+
+ifdef ENABLE_GRIM
+# The VIMA decoder, the walk graph, the text parser, the skinning, the vertex
+# lighting and the Lua interpreter are standalone, build them in rather than
+# the whole engine. The Lua save code and io library need the engine.
+BENCHMARKS      += $(srcdir)/engines/grim/movie/codecs/vima.cpp
+BENCHMARKS      += $(srcdir)/engines/grim/walkgraph.cpp
+BENCHMARKS      += $(srcdir)/engines/grim/textsplit.cpp
+BENCHMARKS      += $(srcdir)/engines/grim/parsecache.cpp
+BENCHMARKS      += $(srcdir)/engines/grim/emi/skinning.cpp
+BENCHMARKS      += $(srcdir)/engines/grim/emi/vertexlighting.cpp
+BENCHMARKS      += $(filter-out %/liolib.cpp %/lsave.cpp %/lrestore.cpp,$(wildcard $(srcdir)/engines/grim/lua/*.cpp))
+BENCHMARKS      += $(srcdir)/engines/grim/color.cpp
+BENCHMARKS      += $(srcdir)/engines/grim/debug.cpp
+endif
+
+benchmark: test/benchmark/runner
+	./test/benchmark/runner $(BENCHMARK_ARGS)
+test/benchmark/runner: $(BENCHMARKS) $(BENCHMARK_LIBS)
+	@mkdir -p test/benchmark
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/benchmark/runner
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test
@@ -0,0 +1,200 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/simd.h"
+
+#include "video/bink_dsp.h"
+
+class BinkDSPTestSuite : public CxxTest::TestSuite
+{
+private:
+	// Odd pitch, so that no row is aligned
+	static const uint32 kPitch = 37;
+	static const uint32 kPlaneSize = kPitch * 17;
+
+	enum BlockKind {
+		kBlockDC,     ///< Only the DC coefficient, the most common case.
+		kBlockSparse, ///< A few low frequency coefficients.
+		kBlockDense,  ///< Every coefficient set.
+		kBlockExtreme ///< Coefficients at the int16 limits, to check overflow behaviour.
+	};
+
+	/** A fixed pseudo random sequence, so that failures can be reproduced. */
+	struct Random {
+		uint32 seed;
+
+		Random() : seed(0x1234567) {}
+
+		uint getRandomNumber(uint max) {
+			seed = seed * 1103515245 + 12345;
+			return (seed >> 8) % (max + 1);
+		}
+
+		uint getRandomBit() {
+			return getRandomNumber(1);
+		}
+	};
+
+	static void fillBlock(Random &rnd, int16 *block, BlockKind kind) {
+		memset(block, 0, 64 * sizeof(int16));
+
+		switch (kind) {
+		case kBlockDC:
+			block[0] = (int16)(rnd.getRandomNumber(4095) - 2048);
+			break;
+		case kBlockSparse:
+			for (int i = 0; i < 6; i++)
+				block[rnd.getRandomNumber(15)] = (int16)(rnd.getRandomNumber(1023) - 512);
+			break;
+		case kBlockDense:
+			for (int i = 0; i < 64; i++)
+				block[i] = (int16)(rnd.getRandomNumber(8191) - 4096);
+			break;
+		case kBlockExtreme:
+			for (int i = 0; i < 64; i++)
+				block[i] = rnd.getRandomBit() ? 32767 : -32768;
+			break;
+		}
+	}
+
+	static void fillPixels(Random &rnd, byte *pixels) {
+		for (uint32 i = 0; i < kPlaneSize; i++)
+			pixels[i] = rnd.getRandomNumber(255);
+	}
+
+	/** Run one kernel on fixture blocks, with and without SIMD, and compare the pixels. */
+	template<typename Kernel>
+	void compareKernel(const Kernel &kernel) {
+		Random rnd;
+
+		for (int n = 0; n < 256; n++) {
+			int16 block[64];
+			fillBlock(rnd, block, (BlockKind)(n & 3));
+
+			byte pattern[8], colors[2];
+			for (int i = 0; i < 8; i++)
+				pattern[i] = rnd.getRandomNumber(255);
+			colors[0] = rnd.getRandomNumber(255);
+			colors[1] = rnd.getRandomNumber(255);
+
+			byte scalar[kPlaneSize], vector[kPlaneSize];
+			fillPixels(rnd, scalar);
+			memcpy(vector, scalar, kPlaneSize);
+
+			int16 scalarBlock[64], vectorBlock[64];
+			memcpy(scalarBlock, block, sizeof(block));
+			memcpy(vectorBlock, block, sizeof(block));
+
+			Common::setSIMDEnabled(false);
+			kernel(scalar + 1, scalarBlock, colors, pattern);
+			Common::setSIMDEnabled(true);
+			kernel(vector + 1, vectorBlock, colors, pattern);
+
+			TS_ASSERT_EQUALS(memcmp(scalar, vector, kPlaneSize), 0);
+			TS_ASSERT_EQUALS(memcmp(scalarBlock, vectorBlock, sizeof(block)), 0);
+		}
+	}
+
+	struct IDCT {
+		void operator()(byte *dest, int16 *block, const byte *colors, const byte *pattern) const {
+			Video::BinkDSP::idct(block);
+		}
+	};
+
+	struct IDCTPut {
+		void operator()(byte *dest, int16 *block, const byte *colors, const byte *pattern) const {
+			Video::BinkDSP::idctPut(dest, kPitch, block);
+		}
+	};
+
+	struct IDCTAdd {
+		void operator()(byte *dest, int16 *block, const byte *colors, const byte *pattern) const {
+			Video::BinkDSP::idctAdd(dest, kPitch, block);
+		}
+	};
+
+	struct IDCTPutScaled {
+		void operator()(byte *dest, int16 *block, const byte *colors, const byte *pattern) const {
+			Video::BinkDSP::idctPutScaled(dest, kPitch, block);
+		}
+	};
+
+	struct PutScaled {
+		void operator()(byte *dest, int16 *block, const byte *colors, const byte *pattern) const {
+			Video::BinkDSP::putScaled(dest, kPitch, (const byte *)block);
+		}
+	};
+
+	struct AddResidue {
+		void operator()(byte *dest, int16 *block, const byte *colors, const byte *pattern) const {
+			Video::BinkDSP::addResidue(dest, kPitch, block);
+		}
+	};
+
+	struct FillPattern {
+		void operator()(byte *dest, int16 *block, const byte *colors, const byte *pattern) const {
+			Video::BinkDSP::fillPattern(dest, kPitch, colors, pattern);
+		}
+	};
+
+	struct FillPatternScaled {
+		void operator()(byte *dest, int16 *block, const byte *colors, const byte *pattern) const {
+			Video::BinkDSP::fillPatternScaled(dest, kPitch, colors, pattern);
+		}
+	};
+
+	struct CopyBlock {
+		void operator()(byte *dest, int16 *block, const byte *colors, const byte *pattern) const {
+			// Copy from the rows below, like a motion vector pointing down
+			Video::BinkDSP::copyBlock(dest, dest + kPitch * 8 + 3, kPitch);
+		}
+	};
+
+public:
+	void test_idct() {
+		compareKernel(IDCT());
+	}
+
+	void test_idct_put() {
+		compareKernel(IDCTPut());
+	}
+
+	void test_idct_add() {
+		compareKernel(IDCTAdd());
+	}
+
+	void test_idct_put_scaled() {
+		compareKernel(IDCTPutScaled());
+	}
+
+	void test_put_scaled() {
+		compareKernel(PutScaled());
+	}
+
+	void test_add_residue() {
+		compareKernel(AddResidue());
+	}
+
+	void test_fill_pattern() {
+		compareKernel(FillPattern());
+	}
+
+	void test_fill_pattern_scaled() {
+		compareKernel(FillPatternScaled());
+	}
+
+	void test_copy_block() {
+		compareKernel(CopyBlock());
+	}
+
+	void test_idct_dc() {
+		// A DC-only block decodes to a flat block
+		int16 block[64];
+		memset(block, 0, sizeof(block));
+		block[0] = 8 * 256;
+
+		Video::BinkDSP::idct(block);
+
+		for (int i = 0; i < 64; i++)
+			TS_ASSERT_EQUALS(block[i], 8);
+	}
+};
@@ -31,6 +31,7 @@
 #include "common/textconsole.h"
 #include "common/math.h"
 #include "common/stream.h"
+#include "common/memstream.h"
 #include "common/substream.h"
 #include "common/file.h"
 #include "common/str.h"
@@ -45,6 +46,7 @@
 
 #include "video/binkdata.h"
 #include "video/bink_decoder.h"
+#include "video/bink_dsp.h"
 
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
 static const uint32 kBIKgID = MKTAG('B', 'I', 'K', 'g');
@@ -59,10 +61,66 @@ static const uint16 kAudioFlagStereo = 0x2000;
 // Number of bits used to store first DC value in bundle
 static const uint32 kDCStartBits = 11;
 
+// Number of frames which have to confirm the BIKi chroma offsets before they are trusted
+static const uint32 kChromaOffsetChecks = 2;
+
 namespace Video {
 
+namespace {
+
+/**
+ * The bit stream of the chroma planes decoded by a worker job. Reading past
+ * the end sets the failure flag of the frame and gives zeros, rather than
+ * stopping the program from the worker thread.
+ */
+class WorkerBitStream : public Common::BitStream32LELSB {
+public:
+	WorkerBitStream(Common::SeekableReadStream *stream, bool &failed) :
+		Common::BitStream32LELSB(stream, true), _failed(failed) {
+		_bitsLeft = size();
+	}
+
+	uint32 getBit() {
+		if (_bitsLeft == 0) {
+			_failed = true;
+			return 0;
+		}
+
+		_bitsLeft--;
+		return Common::BitStream32LELSB::getBit();
+	}
+
+	uint32 peekBit() {
+		uint32 bitsLeft = _bitsLeft;
+		uint32 v = Common::BitStream32LELSB::peekBit();
+		_bitsLeft = bitsLeft;
+		return v;
+	}
+
+	uint32 peekBits(uint8 n) {
+		uint32 bitsLeft = _bitsLeft;
+		uint32 v = Common::BitStream32LELSB::peekBits(n);
+		_bitsLeft = bitsLeft;
+		return v;
+	}
+
+	void rewind() {
+		Common::BitStream32LELSB::rewind();
+		_bitsLeft = size();
+	}
+
+private:
+	bool &_failed;
+	uint32 _bitsLeft;
+};
+
+} // End of anonymous namespace
+
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+	_videoPacket = 0;
+	_videoPacketSize = 0;
+	_parallelDecoding = true;
 }
 
 BinkDecoder::~BinkDecoder() {
@@ -102,8 +160,10 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 	uint32 videoFlags = _bink->readUint32LE();
 
 	// BIKh and BIKi swap the chroma planes
-	addTrack(new BinkVideoTrack(width, height, getDefaultHighColorFormat(), frameCount,
-			Common::Rational(frameRateNum, frameRateDen), (id == kBIKhID || id == kBIKiID), videoFlags & kVideoFlagAlpha, id));
+	BinkVideoTrack *videoTrack = new BinkVideoTrack(width, height, getDefaultHighColorFormat(), frameCount,
+			Common::Rational(frameRateNum, frameRateDen), (id == kBIKhID || id == kBIKiID), videoFlags & kVideoFlagAlpha, id);
+	videoTrack->setParallelDecoding(_parallelDecoding);
+	addTrack(videoTrack);
 
 	uint32 audioTrackCount = _bink->readUint32LE();
 
@@ -137,6 +197,8 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 			_frames[i - 1].size = _frames[i].offset - _frames[i - 1].offset;
 
 		_frames[i].bits = 0;
+
+		_keyframeIndex.addFrame(i, _frames[i].offset, _frames[i].keyFrame);
 	}
 
 	_frames[frameCount - 1].size = _bink->size() - _frames[frameCount - 1].offset;
@@ -150,6 +212,10 @@ void BinkDecoder::close() {
 	delete _bink;
 	_bink = 0;
 
+	delete[] _videoPacket;
+	_videoPacket = 0;
+	_videoPacketSize = 0;
+
 	_audioTracks.clear();
 	_frames.clear();
 }
@@ -160,6 +226,9 @@ void BinkDecoder::readNextPacket() {
 	if (videoTrack->endOfTrack())
 		return;
 
+	// We may already be running on a worker thread
+	videoTrack->setParallelDecoding(_parallelDecoding && !isDecodingAhead());
+
 	VideoFrame &frame = _frames[videoTrack->getCurFrame() + 1];
 
 	if (!_bink->seek(frame.offset))
@@ -200,16 +269,32 @@ void BinkDecoder::readNextPacket() {
 		}
 	}
 
-	uint32 videoPacketStart = _bink->pos();
-	uint32 videoPacketEnd   = _bink->pos() + frameSize;
+	// Read the whole video packet, so that several planes can be decoded at once
+	if (frameSize > _videoPacketSize) {
+		delete[] _videoPacket;
+		_videoPacket = new byte[frameSize];
+		_videoPacketSize = frameSize;
+	}
+
+	frame.data     = _videoPacket;
+	frame.dataSize = _bink->read(_videoPacket, frameSize);
 
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), true);
+	frame.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(frame.data, frame.dataSize), true);
 
 	videoTrack->decodePacket(frame);
 
 	delete frame.bits;
 	frame.bits = 0;
+	frame.data = 0;
+	frame.dataSize = 0;
+}
+
+void BinkDecoder::setParallelDecoding(bool enable) {
+	_parallelDecoding = enable;
+
+	BinkVideoTrack *videoTrack = (BinkVideoTrack *)getTrack(0);
+	if (videoTrack)
+		videoTrack->setParallelDecoding(enable);
 }
 
 VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
@@ -222,7 +307,7 @@ VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
 	return (AudioTrack *)track;
 }
 
-BinkDecoder::VideoFrame::VideoFrame() : bits(0) {
+BinkDecoder::VideoFrame::VideoFrame() : bits(0), data(0), dataSize(0), onWorker(false), failed(false) {
 }
 
 BinkDecoder::VideoFrame::~VideoFrame() {
@@ -246,26 +331,37 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id) {
 	_curFrame = -1;
 
+	_parallelDecoding    = true;
+	_skipOutput          = false;
+	_chromaOffsetMode    = kChromaOffsetUnknown;
+	_chromaOffsetMatches = 0;
+
 	for (int i = 0; i < 16; i++)
 		_huffman[i] = 0;
 
-	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].countLength = 0;
+	for (int s = 0; s < 2; s++) {
+		PlaneState &state = _planeStates[s];
 
-		_bundles[i].huffman.index = 0;
-		for (int j = 0; j < 16; j++)
-			_bundles[i].huffman.symbols[j] = j;
+		for (int i = 0; i < kSourceMAX; i++) {
+			state.bundles[i].countLength = 0;
 
-		_bundles[i].data     = 0;
-		_bundles[i].dataEnd  = 0;
-		_bundles[i].curDec   = 0;
-		_bundles[i].curPtr   = 0;
-	}
+			state.bundles[i].huffman.index = 0;
+			for (int j = 0; j < 16; j++)
+				state.bundles[i].huffman.symbols[j] = j;
 
-	for (int i = 0; i < 16; i++) {
-		_colHighHuffman[i].index = 0;
-		for (int j = 0; j < 16; j++)
-			_colHighHuffman[i].symbols[j] = j;
+			state.bundles[i].data     = 0;
+			state.bundles[i].dataEnd  = 0;
+			state.bundles[i].curDec   = 0;
+			state.bundles[i].curPtr   = 0;
+		}
+
+		for (int i = 0; i < 16; i++) {
+			state.colHighHuffman[i].index = 0;
+			for (int j = 0; j < 16; j++)
+				state.colHighHuffman[i].symbols[j] = j;
+		}
+
+		state.colLastVal = 0;
 	}
 
 	// Make the surface even-sized:
@@ -309,7 +405,8 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	memset(_oldPlanes[2],   0, (width >> 1) * (height >> 1));
 	memset(_oldPlanes[3], 255,  width       *  height      );
 
-	initBundles();
+	// The bundles for the chroma job are only allocated once they are needed
+	initBundles(_planeStates[0]);
 	initHuffman();
 }
 
@@ -319,7 +416,8 @@ BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
 	}
 
-	deinitBundles();
+	deinitBundles(_planeStates[0]);
+	deinitBundles(_planeStates[1]);
 
 	for (int i = 0; i < 16; i++) {
 		delete _huffman[i];
@@ -342,9 +440,10 @@ bool BinkDecoder::seekIntern(const Audio::Timestamp &time) {
 
 	uint32 frame = videoTrack->getFrameAtTime(time);
 
-	// Track down the keyframe
-	uint32 keyFrame = findKeyFrame(frame);
-	videoTrack->setCurFrame(keyFrame - 1);
+	// Decode from the keyframe on, without converting the frames in between
+	uint32 keyFrame = _keyframeIndex.findKeyframe(frame);
+	if (!seekToIndexedFrame(videoTrack, frame))
+		return false;
 
 	// Adjust the video track to use for seeking
 	findNextVideoTrack();
@@ -354,9 +453,6 @@ bool BinkDecoder::seekIntern(const Audio::Timestamp &time) {
 		return true;
 	}
 
-	while (getCurFrame() < (int32)frame - 1)
-		decodeNextFrame();
-
 	// Skip decoded audio between the keyframe and the target frame
 	for (uint32 i = 0; i < _audioTracks.size(); i++) {
 		BinkAudioTrack *audioTrack = (BinkAudioTrack *)getTrack(i + 1);
@@ -371,17 +467,11 @@ bool BinkDecoder::seekIntern(const Audio::Timestamp &time) {
 	return true;
 }
 
-// ResidualVM-specific function
-uint32 BinkDecoder::findKeyFrame(uint32 frame) const {
-	assert(frame < _frames.size());
-
-	for (int i = frame; i >= 0; i--) {
-		if (_frames[i].keyFrame)
-			return i;
-	}
-
-	// If none found, we'll assume the requested frame is a key frame
-	return frame;
+bool BinkDecoder::restartAtKeyframe(uint frame) {
+	// readNextPacket() looks up where the frame starts
+	BinkVideoTrack *videoTrack = (BinkVideoTrack *)getTrack(0);
+	videoTrack->setCurFrame(frame - 1);
+	return true;
 }
 
 // ResidualVM-specific function
@@ -411,19 +501,26 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 		if (_id == kBIKiID)
 			frame.bits->skip(32);
 
-		decodePlane(frame, 3, false);
+		decodePlane(frame, _planeStates[0], 3, false);
 	}
 
-	if (_id == kBIKiID)
-		frame.bits->skip(32);
+	if (_id == kBIKiID) {
+		// BIKi stores where the chroma planes start in front of the luma plane
+		uint32 chromaOffset = frame.bits->getBits(32);
+		uint32 fieldEnd = frame.bits->pos();
 
-	for (int i = 0; i < 3; i++) {
-		int planeIdx = ((i == 0) || !_swapPlanes) ? i : (i ^ 3);
+		if (!decodePlanesParallel(frame, chromaOffset)) {
+			decodePlane(frame, _planeStates[0], 0, false);
+			checkChromaOffset(chromaOffset, fieldEnd, frame.bits->pos());
 
-		decodePlane(frame, planeIdx, i != 0);
+			if (frame.bits->pos() < frame.bits->size())
+				decodeChromaPlanes(frame, _planeStates[0]);
+		}
+	} else {
+		decodePlane(frame, _planeStates[0], 0, false);
 
-		if (frame.bits->pos() >= frame.bits->size())
-			break;
+		if (frame.bits->pos() < frame.bits->size())
+			decodeChromaPlanes(frame, _planeStates[0]);
 	}
 
 	// Convert the YUV data we have to our format
@@ -431,8 +528,9 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	// to allow for odd-sized videos.
 	// ResidualVM: added support for Alpha version: YUVAToRGBAMan, _curPlanes[3]
 	assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2] && _curPlanes[3]);
-	YUVAToRGBAMan.convert420(&_surface, Graphics::YUVAToRGBAManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2], _curPlanes[3],
-			_surfaceWidth, _surfaceHeight, _surfaceWidth, _surfaceWidth >> 1);
+	if (!_skipOutput)
+		YUVAToRGBAMan.convert420(&_surface, Graphics::YUVAToRGBAManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2], _curPlanes[3],
+				_surfaceWidth, _surfaceHeight, _surfaceWidth, _surfaceWidth >> 1);
 
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
@@ -441,7 +539,120 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	_curFrame++;
 }
 
-void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
+void BinkDecoder::BinkVideoTrack::decodeChromaPlanes(VideoFrame &video, PlaneState &state) {
+	for (int i = 1; i < 3; i++) {
+		int planeIdx = _swapPlanes ? (i ^ 3) : i;
+
+		decodePlane(video, state, planeIdx, true);
+
+		if (video.failed || video.bits->pos() >= video.bits->size())
+			break;
+	}
+}
+
+uint32 BinkDecoder::BinkVideoTrack::getChromaPos(uint32 chromaOffset, uint32 fieldEnd, ChromaOffsetMode mode) const {
+	uint64 pos;
+
+	if (mode == kChromaOffsetFromPacket)
+		pos = (uint64)chromaOffset * 8;
+	else if (mode == kChromaOffsetFromField)
+		pos = (uint64)chromaOffset * 8 + fieldEnd;
+	else
+		return 0;
+
+	if (pos > 0xFFFFFFFF)
+		return 0;
+
+	return (uint32)pos;
+}
+
+void BinkDecoder::BinkVideoTrack::checkChromaOffset(uint32 chromaOffset, uint32 fieldEnd, uint32 lumaEnd) {
+	if (_chromaOffsetMode == kChromaOffsetUnusable)
+		return;
+
+	if (_chromaOffsetMode == kChromaOffsetUnknown) {
+		if (getChromaPos(chromaOffset, fieldEnd, kChromaOffsetFromPacket) == lumaEnd)
+			_chromaOffsetMode = kChromaOffsetFromPacket;
+		else if (getChromaPos(chromaOffset, fieldEnd, kChromaOffsetFromField) == lumaEnd)
+			_chromaOffsetMode = kChromaOffsetFromField;
+		else
+			_chromaOffsetMode = kChromaOffsetUnusable;
+
+		_chromaOffsetMatches = 0;
+	} else if (getChromaPos(chromaOffset, fieldEnd, _chromaOffsetMode) != lumaEnd) {
+		_chromaOffsetMode = kChromaOffsetUnusable;
+	}
+
+	if (_chromaOffsetMode != kChromaOffsetUnusable)
+		_chromaOffsetMatches++;
+}
+
+void BinkDecoder::BinkVideoTrack::decodeError(VideoFrame &video, const char *s, ...) {
+	if (!video.onWorker) {
+		va_list va;
+		va_start(va, s);
+		Common::String message = Common::String::vformat(s, va);
+		va_end(va);
+
+		error("%s", message.c_str());
+	}
+
+	// Checked once the job is over
+	video.failed = true;
+}
+
+void BinkDecoder::BinkVideoTrack::chromaJobProc(void *param) {
+	ChromaJob *job = (ChromaJob *)param;
+
+	job->track->decodeChromaPlanes(job->frame, job->track->_planeStates[1]);
+}
+
+bool BinkDecoder::BinkVideoTrack::decodePlanesParallel(VideoFrame &video, uint32 chromaOffset) {
+	if (!_parallelDecoding || !video.data || _chromaOffsetMatches < kChromaOffsetChecks)
+		return false;
+
+	if (g_system->getWorkerCount() == 0)
+		return false;
+
+	uint32 fieldEnd  = video.bits->pos();
+	uint32 chromaPos = getChromaPos(chromaOffset, fieldEnd, _chromaOffsetMode);
+
+	// Planes start at 32-bit boundaries. If there are no chroma planes, there is nothing to split.
+	if ((chromaPos <= fieldEnd) || (chromaPos & 0x1F) || (chromaPos >= video.bits->size()))
+		return false;
+
+	if (!_planeStates[1].bundles[0].data)
+		initBundles(_planeStates[1]);
+
+	ChromaJob job;
+	job.track          = this;
+	job.frame.data     = video.data + (chromaPos >> 3);
+	job.frame.dataSize = video.dataSize - (chromaPos >> 3);
+	job.frame.bits     = new WorkerBitStream(new Common::MemoryReadStream(job.frame.data, job.frame.dataSize), job.frame.failed);
+	job.frame.onWorker = true;
+
+	OSystem::WorkerJobRef chromaJob = g_system->startWorkerJob(chromaJobProc, &job);
+	decodePlane(video, _planeStates[0], 0, false);
+	g_system->waitWorkerJob(chromaJob);
+
+	bool decodeAgain = job.frame.failed;
+
+	if (video.bits->pos() != chromaPos) {
+		// The chroma planes did not start where we guessed. Stop guessing for this video.
+		warning("Bink: Chroma planes at bit %d instead of %d, disabling parallel decoding", video.bits->pos(), chromaPos);
+		_chromaOffsetMode = kChromaOffsetUnusable;
+		decodeAgain = true;
+	}
+
+	// Decode the chroma planes again from the end of the luma plane. If the
+	// data is broken, this reports it the way serial decoding does.
+	if (decodeAgain && video.bits->pos() < video.bits->size())
+		decodeChromaPlanes(video, _planeStates[0]);
+
+	return true;
+}
+
+void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, PlaneState &state, int planeIdx, bool isChroma) {
 	uint32 blockWidth  = isChroma ? ((_surface.w  + 15) >> 4) : ((_surface.w  + 7) >> 3);
 	uint32 blockHeight = isChroma ? ((_surface.h + 15) >> 4) : ((_surface.h + 7) >> 3);
 	uint32 width       = isChroma ?  (_surface.w        >> 1) :   _surface.w;
@@ -450,6 +661,7 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 	DecodeContext ctx;
 
 	ctx.video     = &video;
+	ctx.state     = &state;
 	ctx.planeIdx  = planeIdx;
 	ctx.destStart = _curPlanes[planeIdx];
 	ctx.destEnd   = _curPlanes[planeIdx] + width * height;
@@ -466,28 +678,33 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 		ctx.coordScaledMap4[i] = ((i & 7) * 2 + 1) + (((i >> 3) * 2 + 1) * ctx.pitch);
 	}
 
+	Bundle *bundles = state.bundles;
+
 	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].countLength = _bundles[i].countLengths[isChroma ? 1 : 0];
+		bundles[i].countLength = bundles[i].countLengths[isChroma ? 1 : 0];
 
-		readBundle(video, (Source) i);
+		readBundle(video, state, (Source) i);
 	}
 
 	for (ctx.blockY = 0; ctx.blockY < blockHeight; ctx.blockY++) {
-		readBlockTypes  (video, _bundles[kSourceBlockTypes]);
-		readBlockTypes  (video, _bundles[kSourceSubBlockTypes]);
-		readColors      (video, _bundles[kSourceColors]);
-		readPatterns    (video, _bundles[kSourcePattern]);
-		readMotionValues(video, _bundles[kSourceXOff]);
-		readMotionValues(video, _bundles[kSourceYOff]);
-		readDCS         (video, _bundles[kSourceIntraDC], kDCStartBits, false);
-		readDCS         (video, _bundles[kSourceInterDC], kDCStartBits, true);
-		readRuns        (video, _bundles[kSourceRun]);
+		readBlockTypes  (video, bundles[kSourceBlockTypes]);
+		readBlockTypes  (video, bundles[kSourceSubBlockTypes]);
+		readColors      (video, state);
+		readPatterns    (video, bundles[kSourcePattern]);
+		readMotionValues(video, bundles[kSourceXOff]);
+		readMotionValues(video, bundles[kSourceYOff]);
+		readDCS         (video, bundles[kSourceIntraDC], kDCStartBits, false);
+		readDCS         (video, bundles[kSourceInterDC], kDCStartBits, true);
+		readRuns        (video, bundles[kSourceRun]);
+
+		if (video.failed)
+			return;
 
 		ctx.dest = ctx.destStart + 8 * ctx.blockY * ctx.pitch;
 		ctx.prev = ctx.prevStart + 8 * ctx.blockY * ctx.pitch;
 
 		for (ctx.blockX = 0; ctx.blockX < blockWidth; ctx.blockX++, ctx.dest += 8, ctx.prev += 8) {
-			BlockType blockType = (BlockType) getBundleValue(kSourceBlockTypes);
+			BlockType blockType = (BlockType) getBundleValue(ctx, kSourceBlockTypes);
 
 			// 16x16 block type on odd line means part of the already decoded block, so skip it
 			if ((ctx.blockY & 1) && (blockType == kBlockScaled)) {
@@ -529,9 +746,11 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 				blockRaw(ctx);
 				break;
 			default:
-				error("Unknown block type: %d", blockType);
+				decodeError(video, "Unknown block type: %d", blockType);
 			}
 
+			if (video.failed)
+				return;
 		}
 
 	}
@@ -541,19 +760,21 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 
 }
 
-void BinkDecoder::BinkVideoTrack::readBundle(VideoFrame &video, Source source) {
+void BinkDecoder::BinkVideoTrack::readBundle(VideoFrame &video, PlaneState &state, Source source) {
 	if (source == kSourceColors) {
 		for (int i = 0; i < 16; i++)
-			readHuffman(video, _colHighHuffman[i]);
+			readHuffman(video, state.colHighHuffman[i]);
 
-		_colLastVal = 0;
+		state.colLastVal = 0;
 	}
 
+	Bundle &bundle = state.bundles[source];
+
 	if ((source != kSourceIntraDC) && (source != kSourceInterDC))
-		readHuffman(video, _bundles[source].huffman);
+		readHuffman(video, bundle.huffman);
 
-	_bundles[source].curDec = _bundles[source].data;
-	_bundles[source].curPtr = _bundles[source].data;
+	bundle.curDec = bundle.data;
+	bundle.curPtr = bundle.data;
 }
 
 void BinkDecoder::BinkVideoTrack::readHuffman(VideoFrame &video, Huffman &huffman) {
@@ -630,14 +851,16 @@ void BinkDecoder::BinkVideoTrack::mergeHuffmanSymbols(VideoFrame &video, byte *d
 		*dst++ = *src2++;
 }
 
-void BinkDecoder::BinkVideoTrack::initBundles() {
+void BinkDecoder::BinkVideoTrack::initBundles(PlaneState &state) {
 	uint32 bw     = (_surface.w  + 7) >> 3;
 	uint32 bh     = (_surface.h + 7) >> 3;
 	uint32 blocks = bw * bh;
 
+	Bundle *bundles = state.bundles;
+
 	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].data    = new byte[blocks * 64];
-		_bundles[i].dataEnd = _bundles[i].data + blocks * 64;
+		bundles[i].data    = new byte[blocks * 64];
+		bundles[i].dataEnd = bundles[i].data + blocks * 64;
 	}
 
 	uint32 cbw[2] = { (uint32)((_surface.w + 7) >> 3), (uint32)((_surface.w  + 15) >> 4) };
@@ -647,21 +870,23 @@ void BinkDecoder::BinkVideoTrack::initBundles() {
 	for (int i = 0; i < 2; i++) {
 		int width = MAX<uint32>(cw[i], 8);
 
-		_bundles[kSourceBlockTypes   ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceSubBlockTypes].countLengths[i] = Common::intLog2(((width + 7) >> 4) + 511) + 1;
-		_bundles[kSourceColors       ].countLengths[i] = Common::intLog2((cbw[i])     * 64  + 511) + 1;
-		_bundles[kSourceIntraDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceInterDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceXOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceYOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourcePattern      ].countLengths[i] = Common::intLog2((cbw[i]      << 3) + 511) + 1;
-		_bundles[kSourceRun          ].countLengths[i] = Common::intLog2((cbw[i])     * 48  + 511) + 1;
+		bundles[kSourceBlockTypes   ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourceSubBlockTypes].countLengths[i] = Common::intLog2(((width + 7) >> 4) + 511) + 1;
+		bundles[kSourceColors       ].countLengths[i] = Common::intLog2((cbw[i])     * 64  + 511) + 1;
+		bundles[kSourceIntraDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourceInterDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourceXOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourceYOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+		bundles[kSourcePattern      ].countLengths[i] = Common::intLog2((cbw[i]      << 3) + 511) + 1;
+		bundles[kSourceRun          ].countLengths[i] = Common::intLog2((cbw[i])     * 48  + 511) + 1;
 	}
 }
 
-void BinkDecoder::BinkVideoTrack::deinitBundles() {
-	for (int i = 0; i < kSourceMAX; i++)
-		delete[] _bundles[i].data;
+void BinkDecoder::BinkVideoTrack::deinitBundles(PlaneState &state) {
+	for (int i = 0; i < kSourceMAX; i++) {
+		delete[] state.bundles[i].data;
+		state.bundles[i].data = 0;
+	}
 }
 
 void BinkDecoder::BinkVideoTrack::initHuffman() {
@@ -673,16 +898,18 @@ byte BinkDecoder::BinkVideoTrack::getHuffmanSymbol(VideoFrame &video, Huffman &h
 	return huffman.symbols[_huffman[huffman.index]->getSymbol(*video.bits)];
 }
 
-int32 BinkDecoder::BinkVideoTrack::getBundleValue(Source source) {
+int32 BinkDecoder::BinkVideoTrack::getBundleValue(DecodeContext &ctx, Source source) {
+	Bundle &bundle = ctx.state->bundles[source];
+
 	if ((source < kSourceXOff) || (source == kSourceRun))
-		return *_bundles[source].curPtr++;
+		return *bundle.curPtr++;
 
 	if ((source == kSourceXOff) || (source == kSourceYOff))
-		return (int8) *_bundles[source].curPtr++;
+		return (int8) *bundle.curPtr++;
 
-	int16 ret = *((int16 *) _bundles[source].curPtr);
+	int16 ret = *((int16 *) bundle.curPtr);
 
-	_bundles[source].curPtr += 2;
+	bundle.curPtr += 2;
 
 	return ret;
 }
@@ -699,11 +926,7 @@ uint32 BinkDecoder::BinkVideoTrack::readBundleCount(VideoFrame &video, Bundle &b
 }
 
 void BinkDecoder::BinkVideoTrack::blockSkip(DecodeContext &ctx) {
-	byte *dest = ctx.dest;
-	byte *prev = ctx.prev;
-
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
+	BinkDSP::copyBlock(ctx.dest, ctx.prev, ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledSkip(DecodeContext &ctx) {
@@ -719,15 +942,17 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 
 	int i = 0;
 	do {
-		int run = getBundleValue(kSourceRun) + 1;
+		int run = getBundleValue(ctx, kSourceRun) + 1;
 
 		i += run;
-		if (i > 64)
-			error("Run went out of bounds");
+		if (i > 64) {
+			decodeError(*ctx.video, "Run went out of bounds");
+			return;
+		}
 
 		if (ctx.video->bits->getBit()) {
 
-			byte v = getBundleValue(kSourceColors);
+			byte v = getBundleValue(ctx, kSourceColors);
 			for (int j = 0; j < run; j++, scan++)
 				ctx.dest[ctx.coordScaledMap1[*scan]] =
 				ctx.dest[ctx.coordScaledMap2[*scan]] =
@@ -739,7 +964,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 				ctx.dest[ctx.coordScaledMap1[*scan]] =
 				ctx.dest[ctx.coordScaledMap2[*scan]] =
 				ctx.dest[ctx.coordScaledMap3[*scan]] =
-				ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
+				ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(ctx, kSourceColors);
 
 	} while (i < 63);
 
@@ -747,32 +972,22 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 		ctx.dest[ctx.coordScaledMap1[*scan]] =
 		ctx.dest[ctx.coordScaledMap2[*scan]] =
 		ctx.dest[ctx.coordScaledMap3[*scan]] =
-		ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
+		ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(ctx, kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 	int16 block[64];
 	memset(block, 0, 64 * sizeof(int16));
 
-	block[0] = getBundleValue(kSourceIntraDC);
+	block[0] = getBundleValue(ctx, kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCT(block);
-
-	int16 *src   = block;
-	byte  *dest1 = ctx.dest;
-	byte  *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16, src += 8) {
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
-
-	}
+	BinkDSP::idctPutScaled(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
+	byte v = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 16; i++, dest += ctx.pitch)
@@ -783,35 +998,21 @@ void BinkDecoder::BinkVideoTrack::blockScaledPattern(DecodeContext &ctx) {
 	byte col[2];
 
 	for (int i = 0; i < 2; i++)
-		col[i] = getBundleValue(kSourceColors);
+		col[i] = getBundleValue(ctx, kSourceColors);
 
-	byte *dest1 = ctx.dest;
-	byte *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		byte v = getBundleValue(kSourcePattern);
+	BinkDSP::fillPatternScaled(ctx.dest, ctx.pitch, col, ctx.state->bundles[kSourcePattern].curPtr);
 
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2, v >>= 1)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = col[v & 1];
-	}
+	ctx.state->bundles[kSourcePattern].curPtr += 8;
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledRaw(DecodeContext &ctx) {
-	byte row[8];
-
-	byte *dest1 = ctx.dest;
-	byte *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		memcpy(row, _bundles[kSourceColors].curPtr, 8);
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = row[i];
+	BinkDSP::putScaled(ctx.dest, ctx.pitch, ctx.state->bundles[kSourceColors].curPtr);
 
-		_bundles[kSourceColors].curPtr += 8;
-	}
+	ctx.state->bundles[kSourceColors].curPtr += 64;
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
-	BlockType blockType = (BlockType) getBundleValue(kSourceSubBlockTypes);
+	BlockType blockType = (BlockType) getBundleValue(ctx, kSourceSubBlockTypes);
 
 	switch (blockType) {
 	case kBlockRun:
@@ -830,7 +1031,8 @@ void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
 		blockScaledRaw(ctx);
 		break;
 	default:
-		error("Invalid 16x16 block type: %d", blockType);
+		decodeError(*ctx.video, "Invalid 16x16 block type: %d", blockType);
+		return;
 	}
 
 	ctx.blockX += 1;
@@ -839,16 +1041,17 @@ void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockMotion(DecodeContext &ctx) {
-	int8 xOff = getBundleValue(kSourceXOff);
-	int8 yOff = getBundleValue(kSourceYOff);
+	int8 xOff = getBundleValue(ctx, kSourceXOff);
+	int8 yOff = getBundleValue(ctx, kSourceYOff);
 
 	byte *dest = ctx.dest;
 	byte *prev = ctx.prev + yOff * ((int32) ctx.pitch) + xOff;
-	if ((prev < ctx.prevStart) || (prev > ctx.prevEnd))
-		error("Copy out of bounds (%d | %d)", ctx.blockX * 8 + xOff, ctx.blockY * 8 + yOff);
+	if ((prev < ctx.prevStart) || (prev > ctx.prevEnd)) {
+		decodeError(*ctx.video, "Copy out of bounds (%d | %d)", ctx.blockX * 8 + xOff, ctx.blockY * 8 + yOff);
+		return;
+	}
 
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
+	BinkDSP::copyBlock(dest, prev, ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
@@ -856,26 +1059,28 @@ void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
 
 	int i = 0;
 	do {
-		int run = getBundleValue(kSourceRun) + 1;
+		int run = getBundleValue(ctx, kSourceRun) + 1;
 
 		i += run;
-		if (i > 64)
-			error("Run went out of bounds");
+		if (i > 64) {
+			decodeError(*ctx.video, "Run went out of bounds");
+			return;
+		}
 
 		if (ctx.video->bits->getBit()) {
 
-			byte v = getBundleValue(kSourceColors);
+			byte v = getBundleValue(ctx, kSourceColors);
 			for (int j = 0; j < run; j++)
 				ctx.dest[ctx.coordMap[*scan++]] = v;
 
 		} else
 			for (int j = 0; j < run; j++)
-				ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+				ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(ctx, kSourceColors);
 
 	} while (i < 63);
 
 	if (i == 63)
-		ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+		ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(ctx, kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
@@ -888,26 +1093,22 @@ void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
 
 	readResidue(*ctx.video, block, v);
 
-	byte  *dst = ctx.dest;
-	int16 *src = block;
-	for (int i = 0; i < 8; i++, dst += ctx.pitch, src += 8)
-		for (int j = 0; j < 8; j++)
-			dst[j] += src[j];
+	BinkDSP::addResidue(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 	int16 block[64];
 	memset(block, 0, 64 * sizeof(int16));
 
-	block[0] = getBundleValue(kSourceIntraDC);
+	block[0] = getBundleValue(ctx, kSourceIntraDC);
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCTPut(ctx, block);
+	BinkDSP::idctPut(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
+	byte v = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch)
@@ -920,35 +1121,31 @@ void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
 	int16 block[64];
 	memset(block, 0, 64 * sizeof(int16));
 
-	block[0] = getBundleValue(kSourceInterDC);
+	block[0] = getBundleValue(ctx, kSourceInterDC);
 
 	readDCTCoeffs(*ctx.video, block, false);
 
-	IDCTAdd(ctx, block);
+	BinkDSP::idctAdd(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
 	byte col[2];
 
 	for (int i = 0; i < 2; i++)
-		col[i] = getBundleValue(kSourceColors);
+		col[i] = getBundleValue(ctx, kSourceColors);
 
-	byte *dest = ctx.dest;
-	for (int i = 0; i < 8; i++, dest += ctx.pitch - 8) {
-		byte v = getBundleValue(kSourcePattern);
+	BinkDSP::fillPattern(ctx.dest, ctx.pitch, col, ctx.state->bundles[kSourcePattern].curPtr);
 
-		for (int j = 0; j < 8; j++, v >>= 1)
-			*dest++ = col[v & 1];
-	}
+	ctx.state->bundles[kSourcePattern].curPtr += 8;
 }
 
 void BinkDecoder::BinkVideoTrack::blockRaw(DecodeContext &ctx) {
 	byte *dest = ctx.dest;
-	byte *data = _bundles[kSourceColors].curPtr;
+	byte *data = ctx.state->bundles[kSourceColors].curPtr;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch, data += 8)
 		memcpy(dest, data, 8);
 
-	_bundles[kSourceColors].curPtr += 64;
+	ctx.state->bundles[kSourceColors].curPtr += 64;
 }
 
 void BinkDecoder::BinkVideoTrack::readRuns(VideoFrame &video, Bundle &bundle) {
@@ -957,8 +1154,10 @@ void BinkDecoder::BinkVideoTrack::readRuns(VideoFrame &video, Bundle &bundle) {
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Run value went out of bounds");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(video, "Run value went out of bounds");
+		return;
+	}
 
 	if (video.bits->getBit()) {
 		byte v = video.bits->getBits(4);
@@ -977,8 +1176,10 @@ void BinkDecoder::BinkVideoTrack::readMotionValues(VideoFrame &video, Bundle &bu
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Too many motion values");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(video, "Too many motion values");
+		return;
+	}
 
 	if (video.bits->getBit()) {
 		byte v = video.bits->getBits(4);
@@ -1014,8 +1215,10 @@ void BinkDecoder::BinkVideoTrack::readBlockTypes(VideoFrame &video, Bundle &bund
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Too many block type values");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(video, "Too many block type values");
+		return;
+	}
 
 	if (video.bits->getBit()) {
 		byte v = video.bits->getBits(4);
@@ -1051,8 +1254,10 @@ void BinkDecoder::BinkVideoTrack::readPatterns(VideoFrame &video, Bundle &bundle
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Too many pattern values");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(video, "Too many pattern values");
+		return;
+	}
 
 	byte v;
 	while (bundle.curDec < decEnd) {
@@ -1063,21 +1268,25 @@ void BinkDecoder::BinkVideoTrack::readPatterns(VideoFrame &video, Bundle &bundle
 }
 
 
-void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle) {
+void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, PlaneState &state) {
+	Bundle &bundle = state.bundles[kSourceColors];
+
 	uint32 n = readBundleCount(video, bundle);
 	if (n == 0)
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Too many color values");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(video, "Too many color values");
+		return;
+	}
 
 	if (video.bits->getBit()) {
-		_colLastVal = getHuffmanSymbol(video, _colHighHuffman[_colLastVal]);
+		state.colLastVal = getHuffmanSymbol(video, state.colHighHuffman[state.colLastVal]);
 
 		byte v;
 		v = getHuffmanSymbol(video, bundle.huffman);
-		v = (_colLastVal << 4) | v;
+		v = (state.colLastVal << 4) | v;
 
 		if (_id != kBIKiID) {
 			int sign = ((int8) v) >> 7;
@@ -1092,11 +1301,11 @@ void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle)
 	}
 
 	while (bundle.curDec < decEnd) {
-		_colLastVal = getHuffmanSymbol(video, _colHighHuffman[_colLastVal]);
+		state.colLastVal = getHuffmanSymbol(video, state.colHighHuffman[state.colLastVal]);
 
 		byte v;
 		v = getHuffmanSymbol(video, bundle.huffman);
-		v = (_colLastVal << 4) | v;
+		v = (state.colLastVal << 4) | v;
 
 		if (_id != kBIKiID) {
 			int sign = ((int8) v) >> 7;
@@ -1140,8 +1349,10 @@ void BinkDecoder::BinkVideoTrack::readDCS(VideoFrame &video, Bundle &bundle, int
 				v += v2;
 				*dest++ = v;
 
-				if ((v < -32768) || (v > 32767))
-					error("DC value went out of bounds: %d", v);
+				if ((v < -32768) || (v > 32767)) {
+					decodeError(video, "DC value went out of bounds: %d", v);
+					return;
+				}
 			}
 
 		} else
@@ -1342,88 +1553,6 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 	}
 }
 
-#define A1  2896 /* (1/sqrt(2))<<12 */
-#define A2  2217
-#define A3  3784
-#define A4 -5352
-
-#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
-    const int a0 = (src)[s0] + (src)[s4]; \
-    const int a1 = (src)[s0] - (src)[s4]; \
-    const int a2 = (src)[s2] + (src)[s6]; \
-    const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
-    const int a4 = (src)[s5] + (src)[s3]; \
-    const int a5 = (src)[s5] - (src)[s3]; \
-    const int a6 = (src)[s1] + (src)[s7]; \
-    const int a7 = (src)[s1] - (src)[s7]; \
-    const int b0 = a4 + a6; \
-    const int b1 = (A3*(a5 + a7)) >> 11; \
-    const int b2 = ((A4*a5) >> 11) - b0 + b1; \
-    const int b3 = (A1*(a6 - a4) >> 11) - b2; \
-    const int b4 = ((A2*a7) >> 11) + b3 - b1; \
-    (dest)[d0] = munge(a0+a2   +b0); \
-    (dest)[d1] = munge(a1+a3-a2+b2); \
-    (dest)[d2] = munge(a1-a3+a2+b3); \
-    (dest)[d3] = munge(a0-a2   -b4); \
-    (dest)[d4] = munge(a0-a2   +b4); \
-    (dest)[d5] = munge(a1-a3+a2-b3); \
-    (dest)[d6] = munge(a1+a3-a2-b2); \
-    (dest)[d7] = munge(a0+a2   -b0); \
-}
-/* end IDCT_TRANSFORM macro */
-
-#define MUNGE_NONE(x) (x)
-#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
-
-#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
-#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
-
-static inline void IDCTCol(int16 *dest, const int16 *src) {
-	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
-		dest[ 0] =
-		dest[ 8] =
-		dest[16] =
-		dest[24] =
-		dest[32] =
-		dest[40] =
-		dest[48] =
-		dest[56] = src[0];
-	} else {
-		IDCT_COL(dest, src);
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCT(int16 *block) {
-	int i;
-	int16 temp[64];
-
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int16 *block) {
-	int i, j;
-
-	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
-		for (j = 0; j < 8; j++)
-			 dest[j] += block[j];
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int16 *block) {
-	int i;
-	int16 temp[64];
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
-	}
-}
-
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio) : _audioInfo(&audio) {
 	_audioStream = Audio::makeQueuingAudioStream(_audioInfo->outSampleRate, _audioInfo->outChannels == 2);
 }
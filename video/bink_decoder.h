@@ -75,6 +75,13 @@ public:
 
 	// ResidualVM-specific:
 	Common::Rational getFrameRate();
+
+	/**
+	 * Allow decoding the luma and the chroma planes of a frame on two
+	 * threads, if the backend offers worker threads. Enabled by default.
+	 * The decoded frames are the same either way.
+	 */
+	void setParallelDecoding(bool enable);
 protected:
 	void readNextPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
@@ -82,7 +89,7 @@ protected:
 
 	// ResidualVM-specific:
 	bool seekIntern(const Audio::Timestamp &time);
-	uint32 findKeyFrame(uint32 frame) const;
+	bool restartAtKeyframe(uint frame);
 
 private:
 	static const int kAudioChannelsMax  = 2;
@@ -142,6 +149,12 @@ private:
 
 		Common::BitStream *bits;
 
+		const byte *data; ///< The video packet, while it is being decoded.
+		uint32 dataSize;
+
+		bool onWorker; ///< Decoded by a worker job, errors set failed instead of stopping.
+		bool failed;   ///< The worker job found broken data.
+
 		VideoFrame();
 		~VideoFrame();
 	};
@@ -163,14 +176,20 @@ private:
 		void setCurFrame(uint32 frame) { _curFrame = frame; }
 		Common::Rational getFrameRate() const { return _frameRate; }
 // End of ResidualVM-specific
+		bool setSkipOutput(bool skip) { _skipOutput = skip; return true; }
 
 		/** Decode a video packet. */
 		void decodePacket(VideoFrame &frame);
 
+		void setParallelDecoding(bool enable) { _parallelDecoding = enable; }
+
 	private:
+		struct PlaneState;
+
 		/** A decoder state. */
 		struct DecodeContext {
 			VideoFrame *video;
+			PlaneState *state;
 
 			uint32 planeIdx;
 
@@ -241,6 +260,30 @@ private:
 			byte *curPtr; ///< Pointer to the data that wasn't yet read.
 		};
 
+		/** Everything changing while decoding a plane, so that two planes can be decoded at once. */
+		struct PlaneState {
+			Bundle bundles[kSourceMAX]; ///< Bundles for decoding all data types.
+
+			/** Huffman codebooks to use for decoding high nibbles in color data types. */
+			Huffman colHighHuffman[16];
+			/** Value of the last decoded high nibble in color data types. */
+			int colLastVal;
+		};
+
+		/** Where the chroma planes of a BIKi frame start, according to the 32-bit field before the luma plane. */
+		enum ChromaOffsetMode {
+			kChromaOffsetUnknown,    ///< Not checked yet.
+			kChromaOffsetFromPacket, ///< Byte offset from the start of the video packet.
+			kChromaOffsetFromField,  ///< Byte offset from the end of the field.
+			kChromaOffsetUnusable    ///< The field does not match, decode serially.
+		};
+
+		/** The chroma planes decoded by a worker job. */
+		struct ChromaJob {
+			BinkVideoTrack *track;
+			VideoFrame frame;
+		};
+
 		int _curFrame;
 		int _frameCount;
 
@@ -255,31 +298,45 @@ private:
 
 		Common::Rational _frameRate;
 
-		Bundle _bundles[kSourceMAX]; ///< Bundles for decoding all data types.
+		PlaneState _planeStates[2]; ///< Luma (and serial decoding), chroma (parallel decoding).
 
 		Common::Huffman *_huffman[16]; ///< The 16 Huffman codebooks used in Bink decoding.
 
-		/** Huffman codebooks to use for decoding high nibbles in color data types. */
-		Huffman _colHighHuffman[16];
-		/** Value of the last decoded high nibble in color data types. */
-		int _colLastVal;
+		bool _parallelDecoding;           ///< May the chroma planes be decoded on a worker thread?
+		bool _skipOutput;                 ///< Keep the frames in YUV, without converting them to the surface?
+		ChromaOffsetMode _chromaOffsetMode; ///< How to find the chroma planes in a BIKi frame.
+		uint32 _chromaOffsetMatches;      ///< Serially decoded frames confirming _chromaOffsetMode.
 
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
 		/** Initialize the bundles. */
-		void initBundles();
+		void initBundles(PlaneState &state);
 		/** Deinitialize the bundles. */
-		void deinitBundles();
+		void deinitBundles(PlaneState &state);
 
 		/** Initialize the Huffman decoders. */
 		void initHuffman();
 
 		/** Decode a plane. */
-		void decodePlane(VideoFrame &video, int planeIdx, bool isChroma);
+		void decodePlane(VideoFrame &video, PlaneState &state, int planeIdx, bool isChroma);
+		/** Decode the two chroma planes, unless the data ends after the first. */
+		void decodeChromaPlanes(VideoFrame &video, PlaneState &state);
+
+		/** Decode the luma plane and the chroma planes in parallel, if possible. */
+		bool decodePlanesParallel(VideoFrame &video, uint32 chromaOffset);
+		/** Check whether the chroma offset found before the luma plane matches where the luma plane ended. */
+		void checkChromaOffset(uint32 chromaOffset, uint32 fieldEnd, uint32 lumaEnd);
+		/** Return the bit position of the chroma planes, or 0 if unknown. */
+		uint32 getChromaPos(uint32 chromaOffset, uint32 fieldEnd, ChromaOffsetMode mode) const;
+
+		static void chromaJobProc(void *param);
+
+		/** Stop on broken data, or only flag the frame when decoding on a worker thread. */
+		void decodeError(VideoFrame &video, const char *s, ...) GCC_PRINTF(3, 4);
 
 		/** Read/Initialize a bundle for decoding a plane. */
-		void readBundle(VideoFrame &video, Source source);
+		void readBundle(VideoFrame &video, PlaneState &state, Source source);
 
 		/** Read the symbols for a Huffman code. */
 		void readHuffman(VideoFrame &video, Huffman &huffman);
@@ -290,7 +347,7 @@ private:
 		byte getHuffmanSymbol(VideoFrame &video, Huffman &huffman);
 
 		/** Get a direct value out of a bundle. */
-		int32 getBundleValue(Source source);
+		int32 getBundleValue(DecodeContext &ctx, Source source);
 		/** Read a count value out of a bundle. */
 		uint32 readBundleCount(VideoFrame &video, Bundle &bundle);
 
@@ -317,15 +374,10 @@ private:
 		void readMotionValues(VideoFrame &video, Bundle &bundle);
 		void readBlockTypes  (VideoFrame &video, Bundle &bundle);
 		void readPatterns    (VideoFrame &video, Bundle &bundle);
-		void readColors      (VideoFrame &video, Bundle &bundle);
+		void readColors      (VideoFrame &video, PlaneState &state);
 		void readDCS         (VideoFrame &video, Bundle &bundle, int startBits, bool hasSign);
 		void readDCTCoeffs   (VideoFrame &video, int16 *block, bool isIntra);
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
-
-		// Bink video IDCT
-		void IDCT(int16 *block);
-		void IDCTPut(DecodeContext &ctx, int16 *block);
-		void IDCTAdd(DecodeContext &ctx, int16 *block);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
@@ -363,6 +415,10 @@ private:
 
 	Common::SeekableReadStream *_bink;
 
+	byte *_videoPacket;       ///< Buffer holding the video packet being decoded.
+	uint32 _videoPacketSize;  ///< Size of the video packet buffer.
+	bool _parallelDecoding;
+
 	Common::Array<AudioInfo> _audioTracks; ///< All audio tracks.
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
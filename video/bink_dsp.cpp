@@ -0,0 +1,682 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// The plain C IDCT is based on the one in FFmpeg's Bink decoder.
+
+#include "common/simd.h"
+
+#include "video/bink_dsp.h"
+
+namespace Video {
+
+namespace BinkDSP {
+
+#define A1  2896 /* (1/sqrt(2))<<12 */
+#define A2  2217
+#define A3  3784
+#define A4 -5352
+
+#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
+    const int a0 = (src)[s0] + (src)[s4]; \
+    const int a1 = (src)[s0] - (src)[s4]; \
+    const int a2 = (src)[s2] + (src)[s6]; \
+    const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
+    const int a4 = (src)[s5] + (src)[s3]; \
+    const int a5 = (src)[s5] - (src)[s3]; \
+    const int a6 = (src)[s1] + (src)[s7]; \
+    const int a7 = (src)[s1] - (src)[s7]; \
+    const int b0 = a4 + a6; \
+    const int b1 = (A3*(a5 + a7)) >> 11; \
+    const int b2 = ((A4*a5) >> 11) - b0 + b1; \
+    const int b3 = (A1*(a6 - a4) >> 11) - b2; \
+    const int b4 = ((A2*a7) >> 11) + b3 - b1; \
+    (dest)[d0] = munge(a0+a2   +b0); \
+    (dest)[d1] = munge(a1+a3-a2+b2); \
+    (dest)[d2] = munge(a1-a3+a2+b3); \
+    (dest)[d3] = munge(a0-a2   -b4); \
+    (dest)[d4] = munge(a0-a2   +b4); \
+    (dest)[d5] = munge(a1-a3+a2-b3); \
+    (dest)[d6] = munge(a1+a3-a2-b2); \
+    (dest)[d7] = munge(a0+a2   -b0); \
+}
+/* end IDCT_TRANSFORM macro */
+
+#define MUNGE_NONE(x) (x)
+#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
+
+#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
+#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
+
+static inline void IDCTCol(int16 *dest, const int16 *src) {
+	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
+		dest[ 0] =
+		dest[ 8] =
+		dest[16] =
+		dest[24] =
+		dest[32] =
+		dest[40] =
+		dest[48] =
+		dest[56] = src[0];
+	} else {
+		IDCT_COL(dest, src);
+	}
+}
+
+static void idctC(int16 *block) {
+	int i;
+	int16 temp[64];
+
+	for (i = 0; i < 8; i++)
+		IDCTCol(&temp[i], &block[i]);
+	for (i = 0; i < 8; i++) {
+		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
+	}
+}
+
+static void idctPutC(byte *dest, uint32 pitch, const int16 *block) {
+	int i;
+	int16 temp[64];
+	for (i = 0; i < 8; i++)
+		IDCTCol(&temp[i], &block[i]);
+	for (i = 0; i < 8; i++) {
+		IDCT_ROW( (&dest[i*pitch]), (&temp[8*i]) );
+	}
+}
+
+static void idctAddC(byte *dest, uint32 pitch, const int16 *block) {
+	int16 temp[64];
+	memcpy(temp, block, 64 * sizeof(int16));
+
+	idctC(temp);
+
+	const int16 *src = temp;
+	for (int i = 0; i < 8; i++, dest += pitch, src += 8)
+		for (int j = 0; j < 8; j++)
+			dest[j] += src[j];
+}
+
+static void idctPutScaledC(byte *dest, uint32 pitch, const int16 *block) {
+	int16 temp[64];
+	memcpy(temp, block, 64 * sizeof(int16));
+
+	idctC(temp);
+
+	const int16 *src = temp;
+	byte *dest1 = dest;
+	byte *dest2 = dest + pitch;
+	for (int j = 0; j < 8; j++, dest1 += (pitch << 1) - 16, dest2 += (pitch << 1) - 16, src += 8) {
+
+		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
+			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
+
+	}
+}
+
+static void putScaledC(byte *dest, uint32 pitch, const byte *src) {
+	byte *dest1 = dest;
+	byte *dest2 = dest + pitch;
+	for (int j = 0; j < 8; j++, dest1 += (pitch << 1) - 16, dest2 += (pitch << 1) - 16, src += 8) {
+
+		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
+			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
+
+	}
+}
+
+static void addResidueC(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dest += pitch, block += 8)
+		for (int j = 0; j < 8; j++)
+			dest[j] += block[j];
+}
+
+static void fillPatternC(byte *dest, uint32 pitch, const byte *colors, const byte *pattern) {
+	for (int i = 0; i < 8; i++, dest += pitch - 8) {
+		byte v = pattern[i];
+
+		for (int j = 0; j < 8; j++, v >>= 1)
+			*dest++ = colors[v & 1];
+	}
+}
+
+static void fillPatternScaledC(byte *dest, uint32 pitch, const byte *colors, const byte *pattern) {
+	byte *dest1 = dest;
+	byte *dest2 = dest + pitch;
+	for (int j = 0; j < 8; j++, dest1 += (pitch << 1) - 16, dest2 += (pitch << 1) - 16) {
+		byte v = pattern[j];
+
+		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2, v >>= 1)
+			dest1[0] = dest1[1] = dest2[0] = dest2[1] = colors[v & 1];
+	}
+}
+
+static void copyBlockC(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 8; j++, dest += pitch, src += pitch)
+		memcpy(dest, src, 8);
+}
+
+#if defined(SCUMMVM_SSE2)
+
+/**
+ * Multiply 32-bit lanes by a positive 16-bit constant. SSE2 has no 32-bit
+ * multiplication, so it is put together from 16-bit ones. The result wraps
+ * around exactly like the int multiplication in the C code.
+ */
+static inline __m128i mulConstSSE2(__m128i x, int16 c) {
+	const __m128i k  = _mm_set1_epi16(c);
+	const __m128i lo = _mm_mullo_epi16(x, k);
+	const __m128i hi = _mm_mulhi_epu16(x, k);
+
+	return _mm_add_epi32(lo, _mm_slli_epi32(hi, 16));
+}
+
+/** IDCT_TRANSFORM on four columns at once, in 32-bit lanes. */
+static inline void idctTransformSSE2(const __m128i *s, __m128i *d, bool isRow) {
+	const __m128i a0 = _mm_add_epi32(s[0], s[4]);
+	const __m128i a1 = _mm_sub_epi32(s[0], s[4]);
+	const __m128i a2 = _mm_add_epi32(s[2], s[6]);
+	const __m128i a3 = _mm_srai_epi32(mulConstSSE2(_mm_sub_epi32(s[2], s[6]), A1), 11);
+	const __m128i a4 = _mm_add_epi32(s[5], s[3]);
+	const __m128i a5 = _mm_sub_epi32(s[5], s[3]);
+	const __m128i a6 = _mm_add_epi32(s[1], s[7]);
+	const __m128i a7 = _mm_sub_epi32(s[1], s[7]);
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = _mm_srai_epi32(mulConstSSE2(_mm_add_epi32(a5, a7), A3), 11);
+	const __m128i c5 = _mm_sub_epi32(_mm_setzero_si128(), mulConstSSE2(a5, -A4));
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(_mm_srai_epi32(c5, 11), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(_mm_srai_epi32(mulConstSSE2(_mm_sub_epi32(a6, a4), A1), 11), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(_mm_srai_epi32(mulConstSSE2(a7, A2), 11), b3), b1);
+
+	const __m128i a0p2 = _mm_add_epi32(a0, a2);
+	const __m128i a0m2 = _mm_sub_epi32(a0, a2);
+	const __m128i a1p3m2 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2);
+	const __m128i a1m3p2 = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+
+	d[0] = _mm_add_epi32(a0p2, b0);
+	d[1] = _mm_add_epi32(a1p3m2, b2);
+	d[2] = _mm_add_epi32(a1m3p2, b3);
+	d[3] = _mm_sub_epi32(a0m2, b4);
+	d[4] = _mm_add_epi32(a0m2, b4);
+	d[5] = _mm_sub_epi32(a1m3p2, b3);
+	d[6] = _mm_sub_epi32(a1p3m2, b2);
+	d[7] = _mm_sub_epi32(a0p2, b0);
+
+	if (isRow) {
+		const __m128i round = _mm_set1_epi32(0x7F);
+		for (int i = 0; i < 8; i++)
+			d[i] = _mm_srai_epi32(_mm_add_epi32(d[i], round), 8);
+	}
+}
+
+/** Truncate two vectors of 32-bit values to 16 bits, like storing them into an int16. */
+static inline __m128i packTruncateSSE2(__m128i lo, __m128i hi) {
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+
+	return _mm_packs_epi32(lo, hi);
+}
+
+/** Truncate two vectors of 16-bit values to 8 bits, like storing them into a byte. */
+static inline __m128i packBytesSSE2(__m128i lo, __m128i hi) {
+	const __m128i mask = _mm_set1_epi16(0xFF);
+
+	return _mm_packus_epi16(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+}
+
+static inline void transposeSSE2(__m128i *r) {
+	const __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+	const __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+	const __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+	const __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+	const __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+	const __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+	const __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+	const __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+	const __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	const __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	const __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	const __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	const __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	const __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	const __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	const __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+	r[0] = _mm_unpacklo_epi64(b0, b4);
+	r[1] = _mm_unpackhi_epi64(b0, b4);
+	r[2] = _mm_unpacklo_epi64(b1, b5);
+	r[3] = _mm_unpackhi_epi64(b1, b5);
+	r[4] = _mm_unpacklo_epi64(b2, b6);
+	r[5] = _mm_unpackhi_epi64(b2, b6);
+	r[6] = _mm_unpacklo_epi64(b3, b7);
+	r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+/** One pass of the IDCT over all 8 columns of the rows. */
+static inline void idctPassSSE2(__m128i *rows, bool isRow) {
+	__m128i sLo[8], sHi[8], dLo[8], dHi[8];
+
+	for (int i = 0; i < 8; i++) {
+		sLo[i] = _mm_srai_epi32(_mm_unpacklo_epi16(rows[i], rows[i]), 16);
+		sHi[i] = _mm_srai_epi32(_mm_unpackhi_epi16(rows[i], rows[i]), 16);
+	}
+
+	idctTransformSSE2(sLo, dLo, isRow);
+	idctTransformSSE2(sHi, dHi, isRow);
+
+	for (int i = 0; i < 8; i++)
+		rows[i] = packTruncateSSE2(dLo[i], dHi[i]);
+}
+
+/** Inverse transform a block into 8 rows of 16-bit values. */
+static void idctRowsSIMD(const int16 *block, __m128i *rows) {
+	for (int i = 0; i < 8; i++)
+		rows[i] = _mm_loadu_si128((const __m128i *)(block + i * 8));
+
+	// The column pass works on rows as they are, the row pass on the transposed block
+	idctPassSSE2(rows, false);
+	transposeSSE2(rows);
+	idctPassSSE2(rows, true);
+	transposeSSE2(rows);
+}
+
+static void idctSIMD(int16 *block) {
+	__m128i rows[8];
+	idctRowsSIMD(block, rows);
+
+	for (int i = 0; i < 8; i++)
+		_mm_storeu_si128((__m128i *)(block + i * 8), rows[i]);
+}
+
+static void idctPutSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	__m128i rows[8];
+	idctRowsSIMD(block, rows);
+
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2) {
+		const __m128i pixels = packBytesSSE2(rows[i], rows[i + 1]);
+
+		_mm_storel_epi64((__m128i *)dest, pixels);
+		_mm_storel_epi64((__m128i *)(dest + pitch), _mm_srli_si128(pixels, 8));
+	}
+}
+
+/** Add two rows of 16-bit values to two rows of pixels, wrapping around. */
+static inline void addRowsSSE2(byte *dest, uint32 pitch, __m128i row1, __m128i row2) {
+	const __m128i values = packBytesSSE2(row1, row2);
+	const __m128i pixels = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)dest),
+	                                          _mm_loadl_epi64((const __m128i *)(dest + pitch)));
+	const __m128i sum = _mm_add_epi8(pixels, values);
+
+	_mm_storel_epi64((__m128i *)dest, sum);
+	_mm_storel_epi64((__m128i *)(dest + pitch), _mm_srli_si128(sum, 8));
+}
+
+static void idctAddSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	__m128i rows[8];
+	idctRowsSIMD(block, rows);
+
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2)
+		addRowsSSE2(dest, pitch, rows[i], rows[i + 1]);
+}
+
+static void addResidueSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2, block += 16)
+		addRowsSSE2(dest, pitch, _mm_loadu_si128((const __m128i *)block), _mm_loadu_si128((const __m128i *)(block + 8)));
+}
+
+/** Store 8 pixels doubled horizontally into two rows. */
+static inline void storeScaledSSE2(byte *dest, uint32 pitch, __m128i pixels) {
+	const __m128i doubled = _mm_unpacklo_epi8(pixels, pixels);
+
+	_mm_storeu_si128((__m128i *)dest, doubled);
+	_mm_storeu_si128((__m128i *)(dest + pitch), doubled);
+}
+
+static void idctPutScaledSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	__m128i rows[8];
+	idctRowsSIMD(block, rows);
+
+	for (int i = 0; i < 8; i += 2, dest += pitch * 4) {
+		const __m128i pixels = packBytesSSE2(rows[i], rows[i + 1]);
+
+		storeScaledSSE2(dest, pitch, pixels);
+		storeScaledSSE2(dest + pitch * 2, pitch, _mm_srli_si128(pixels, 8));
+	}
+}
+
+static void putScaledSIMD(byte *dest, uint32 pitch, const byte *src) {
+	for (int i = 0; i < 8; i++, dest += pitch * 2, src += 8)
+		storeScaledSSE2(dest, pitch, _mm_loadl_epi64((const __m128i *)src));
+}
+
+static void fillPatternSIMD(byte *dest, uint32 pitch, const byte *colors, const byte *pattern) {
+	const __m128i bits = _mm_set_epi8(0, 0, 0, 0, 0, 0, 0, 0, -128, 64, 32, 16, 8, 4, 2, 1);
+	const __m128i col0 = _mm_set1_epi8((char)colors[0]);
+	const __m128i col1 = _mm_set1_epi8((char)colors[1]);
+
+	for (int i = 0; i < 8; i++, dest += pitch) {
+		const __m128i v    = _mm_and_si128(_mm_set1_epi8((char)pattern[i]), bits);
+		const __m128i mask = _mm_cmpeq_epi8(v, bits);
+
+		_mm_storel_epi64((__m128i *)dest, _mm_or_si128(_mm_and_si128(mask, col1), _mm_andnot_si128(mask, col0)));
+	}
+}
+
+static void fillPatternScaledSIMD(byte *dest, uint32 pitch, const byte *colors, const byte *pattern) {
+	const __m128i bits = _mm_set_epi8(-128, -128, 64, 64, 32, 32, 16, 16, 8, 8, 4, 4, 2, 2, 1, 1);
+	const __m128i col0 = _mm_set1_epi8((char)colors[0]);
+	const __m128i col1 = _mm_set1_epi8((char)colors[1]);
+
+	for (int i = 0; i < 8; i++, dest += pitch * 2) {
+		const __m128i v      = _mm_and_si128(_mm_set1_epi8((char)pattern[i]), bits);
+		const __m128i mask   = _mm_cmpeq_epi8(v, bits);
+		const __m128i pixels = _mm_or_si128(_mm_and_si128(mask, col1), _mm_andnot_si128(mask, col0));
+
+		_mm_storeu_si128((__m128i *)dest, pixels);
+		_mm_storeu_si128((__m128i *)(dest + pitch), pixels);
+	}
+}
+
+static void copyBlockSIMD(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 8; j++, dest += pitch, src += pitch)
+		_mm_storel_epi64((__m128i *)dest, _mm_loadl_epi64((const __m128i *)src));
+}
+
+#elif defined(SCUMMVM_NEON)
+
+/** IDCT_TRANSFORM on four columns at once, in 32-bit lanes. */
+static inline void idctTransformNEON(const int32x4_t *s, int32x4_t *d, bool isRow) {
+	const int32x4_t a0 = vaddq_s32(s[0], s[4]);
+	const int32x4_t a1 = vsubq_s32(s[0], s[4]);
+	const int32x4_t a2 = vaddq_s32(s[2], s[6]);
+	const int32x4_t a3 = vshrq_n_s32(vmulq_n_s32(vsubq_s32(s[2], s[6]), A1), 11);
+	const int32x4_t a4 = vaddq_s32(s[5], s[3]);
+	const int32x4_t a5 = vsubq_s32(s[5], s[3]);
+	const int32x4_t a6 = vaddq_s32(s[1], s[7]);
+	const int32x4_t a7 = vsubq_s32(s[1], s[7]);
+	const int32x4_t b0 = vaddq_s32(a4, a6);
+	const int32x4_t b1 = vshrq_n_s32(vmulq_n_s32(vaddq_s32(a5, a7), A3), 11);
+	const int32x4_t b2 = vaddq_s32(vsubq_s32(vshrq_n_s32(vmulq_n_s32(a5, A4), 11), b0), b1);
+	const int32x4_t b3 = vsubq_s32(vshrq_n_s32(vmulq_n_s32(vsubq_s32(a6, a4), A1), 11), b2);
+	const int32x4_t b4 = vsubq_s32(vaddq_s32(vshrq_n_s32(vmulq_n_s32(a7, A2), 11), b3), b1);
+
+	const int32x4_t a0p2 = vaddq_s32(a0, a2);
+	const int32x4_t a0m2 = vsubq_s32(a0, a2);
+	const int32x4_t a1p3m2 = vsubq_s32(vaddq_s32(a1, a3), a2);
+	const int32x4_t a1m3p2 = vaddq_s32(vsubq_s32(a1, a3), a2);
+
+	d[0] = vaddq_s32(a0p2, b0);
+	d[1] = vaddq_s32(a1p3m2, b2);
+	d[2] = vaddq_s32(a1m3p2, b3);
+	d[3] = vsubq_s32(a0m2, b4);
+	d[4] = vaddq_s32(a0m2, b4);
+	d[5] = vsubq_s32(a1m3p2, b3);
+	d[6] = vsubq_s32(a1p3m2, b2);
+	d[7] = vsubq_s32(a0p2, b0);
+
+	if (isRow) {
+		const int32x4_t round = vdupq_n_s32(0x7F);
+		for (int i = 0; i < 8; i++)
+			d[i] = vshrq_n_s32(vaddq_s32(d[i], round), 8);
+	}
+}
+
+static inline void transposeNEON(int16x8_t *r) {
+	const int16x8x2_t t0 = vtrnq_s16(r[0], r[1]);
+	const int16x8x2_t t1 = vtrnq_s16(r[2], r[3]);
+	const int16x8x2_t t2 = vtrnq_s16(r[4], r[5]);
+	const int16x8x2_t t3 = vtrnq_s16(r[6], r[7]);
+
+	const int32x4x2_t u0 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[0]), vreinterpretq_s32_s16(t1.val[0]));
+	const int32x4x2_t u1 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[1]), vreinterpretq_s32_s16(t1.val[1]));
+	const int32x4x2_t u2 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[0]), vreinterpretq_s32_s16(t3.val[0]));
+	const int32x4x2_t u3 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[1]), vreinterpretq_s32_s16(t3.val[1]));
+
+	r[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32 (u0.val[0]), vget_low_s32 (u2.val[0])));
+	r[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32 (u1.val[0]), vget_low_s32 (u3.val[0])));
+	r[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32 (u0.val[1]), vget_low_s32 (u2.val[1])));
+	r[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32 (u1.val[1]), vget_low_s32 (u3.val[1])));
+	r[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[0]), vget_high_s32(u2.val[0])));
+	r[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[0]), vget_high_s32(u3.val[0])));
+	r[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[1]), vget_high_s32(u2.val[1])));
+	r[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[1]), vget_high_s32(u3.val[1])));
+}
+
+/** One pass of the IDCT over all 8 columns of the rows. */
+static inline void idctPassNEON(int16x8_t *rows, bool isRow) {
+	int32x4_t sLo[8], sHi[8], dLo[8], dHi[8];
+
+	for (int i = 0; i < 8; i++) {
+		sLo[i] = vmovl_s16(vget_low_s16(rows[i]));
+		sHi[i] = vmovl_s16(vget_high_s16(rows[i]));
+	}
+
+	idctTransformNEON(sLo, dLo, isRow);
+	idctTransformNEON(sHi, dHi, isRow);
+
+	// vmovn truncates, like storing into an int16
+	for (int i = 0; i < 8; i++)
+		rows[i] = vcombine_s16(vmovn_s32(dLo[i]), vmovn_s32(dHi[i]));
+}
+
+/** Inverse transform a block into 8 rows of 16-bit values. */
+static void idctRowsSIMD(const int16 *block, int16x8_t *rows) {
+	for (int i = 0; i < 8; i++)
+		rows[i] = vld1q_s16(block + i * 8);
+
+	// The column pass works on rows as they are, the row pass on the transposed block
+	idctPassNEON(rows, false);
+	transposeNEON(rows);
+	idctPassNEON(rows, true);
+	transposeNEON(rows);
+}
+
+/** Truncate 16-bit values to 8 bits, like storing them into a byte. */
+static inline uint8x8_t narrowBytesNEON(int16x8_t row) {
+	return vmovn_u16(vreinterpretq_u16_s16(row));
+}
+
+static void idctSIMD(int16 *block) {
+	int16x8_t rows[8];
+	idctRowsSIMD(block, rows);
+
+	for (int i = 0; i < 8; i++)
+		vst1q_s16(block + i * 8, rows[i]);
+}
+
+static void idctPutSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	int16x8_t rows[8];
+	idctRowsSIMD(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, narrowBytesNEON(rows[i]));
+}
+
+static void idctAddSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	int16x8_t rows[8];
+	idctRowsSIMD(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, vadd_u8(vld1_u8(dest), narrowBytesNEON(rows[i])));
+}
+
+static void addResidueSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dest += pitch, block += 8)
+		vst1_u8(dest, vadd_u8(vld1_u8(dest), narrowBytesNEON(vld1q_s16(block))));
+}
+
+/** Store 8 pixels doubled horizontally into two rows. */
+static inline void storeScaledNEON(byte *dest, uint32 pitch, uint8x8_t pixels) {
+	const uint8x8x2_t zipped = vzip_u8(pixels, pixels);
+	const uint8x16_t doubled = vcombine_u8(zipped.val[0], zipped.val[1]);
+
+	vst1q_u8(dest, doubled);
+	vst1q_u8(dest + pitch, doubled);
+}
+
+static void idctPutScaledSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	int16x8_t rows[8];
+	idctRowsSIMD(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch * 2)
+		storeScaledNEON(dest, pitch, narrowBytesNEON(rows[i]));
+}
+
+static void putScaledSIMD(byte *dest, uint32 pitch, const byte *src) {
+	for (int i = 0; i < 8; i++, dest += pitch * 2, src += 8)
+		storeScaledNEON(dest, pitch, vld1_u8(src));
+}
+
+static void fillPatternSIMD(byte *dest, uint32 pitch, const byte *colors, const byte *pattern) {
+	static const uint8 kBits[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+
+	const uint8x8_t bits = vld1_u8(kBits);
+	const uint8x8_t col0 = vdup_n_u8(colors[0]);
+	const uint8x8_t col1 = vdup_n_u8(colors[1]);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, vbsl_u8(vtst_u8(vdup_n_u8(pattern[i]), bits), col1, col0));
+}
+
+static void fillPatternScaledSIMD(byte *dest, uint32 pitch, const byte *colors, const byte *pattern) {
+	static const uint8 kBits[16] = { 1, 1, 2, 2, 4, 4, 8, 8, 16, 16, 32, 32, 64, 64, 128, 128 };
+
+	const uint8x16_t bits = vld1q_u8(kBits);
+	const uint8x16_t col0 = vdupq_n_u8(colors[0]);
+	const uint8x16_t col1 = vdupq_n_u8(colors[1]);
+
+	for (int i = 0; i < 8; i++, dest += pitch * 2) {
+		const uint8x16_t pixels = vbslq_u8(vtstq_u8(vdupq_n_u8(pattern[i]), bits), col1, col0);
+
+		vst1q_u8(dest, pixels);
+		vst1q_u8(dest + pitch, pixels);
+	}
+}
+
+static void copyBlockSIMD(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 8; j++, dest += pitch, src += pitch)
+		vst1_u8(dest, vld1_u8(src));
+}
+
+#endif
+
+void idct(int16 *block) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		idctSIMD(block);
+		return;
+	}
+#endif
+
+	idctC(block);
+}
+
+void idctPut(byte *dest, uint32 pitch, const int16 *block) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		idctPutSIMD(dest, pitch, block);
+		return;
+	}
+#endif
+
+	idctPutC(dest, pitch, block);
+}
+
+void idctAdd(byte *dest, uint32 pitch, const int16 *block) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		idctAddSIMD(dest, pitch, block);
+		return;
+	}
+#endif
+
+	idctAddC(dest, pitch, block);
+}
+
+void idctPutScaled(byte *dest, uint32 pitch, const int16 *block) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		idctPutScaledSIMD(dest, pitch, block);
+		return;
+	}
+#endif
+
+	idctPutScaledC(dest, pitch, block);
+}
+
+void putScaled(byte *dest, uint32 pitch, const byte *src) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		putScaledSIMD(dest, pitch, src);
+		return;
+	}
+#endif
+
+	putScaledC(dest, pitch, src);
+}
+
+void addResidue(byte *dest, uint32 pitch, const int16 *block) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		addResidueSIMD(dest, pitch, block);
+		return;
+	}
+#endif
+
+	addResidueC(dest, pitch, block);
+}
+
+void fillPattern(byte *dest, uint32 pitch, const byte *colors, const byte *pattern) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		fillPatternSIMD(dest, pitch, colors, pattern);
+		return;
+	}
+#endif
+
+	fillPatternC(dest, pitch, colors, pattern);
+}
+
+void fillPatternScaled(byte *dest, uint32 pitch, const byte *colors, const byte *pattern) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		fillPatternScaledSIMD(dest, pitch, colors, pattern);
+		return;
+	}
+#endif
+
+	fillPatternScaledC(dest, pitch, colors, pattern);
+}
+
+void copyBlock(byte *dest, const byte *src, uint32 pitch) {
+#ifdef SCUMMVM_SIMD
+	if (Common::hasSIMD()) {
+		copyBlockSIMD(dest, src, pitch);
+		return;
+	}
+#endif
+
+	copyBlockC(dest, src, pitch);
+}
+
+} // End of namespace BinkDSP
+
+} // End of namespace Video
@@ -0,0 +1,71 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef VIDEO_BINK_DSP_H
+#define VIDEO_BINK_DSP_H
+
+#include "common/scummsys.h"
+
+namespace Video {
+
+/**
+ * Block kernels of the Bink video decoder.
+ *
+ * All blocks are 8x8. Pixel values are not clamped, they wrap around like
+ * in the original decoder. Each kernel has a plain C implementation and,
+ * where available, a vector one, selected at runtime with Common::hasSIMD().
+ * Both always produce the same output.
+ */
+namespace BinkDSP {
+
+/** Inverse transform a block of DCT coefficients in place. */
+void idct(int16 *block);
+
+/** Inverse transform a block of DCT coefficients into pixels. */
+void idctPut(byte *dest, uint32 pitch, const int16 *block);
+
+/** Inverse transform a block of DCT coefficients and add it to the pixels. */
+void idctAdd(byte *dest, uint32 pitch, const int16 *block);
+
+/** Inverse transform a block of DCT coefficients into pixels, scaled up to 16x16. */
+void idctPutScaled(byte *dest, uint32 pitch, const int16 *block);
+
+/** Copy a block of pixels, scaled up to 16x16. */
+void putScaled(byte *dest, uint32 pitch, const byte *src);
+
+/** Add a block of residue values to the pixels. */
+void addResidue(byte *dest, uint32 pitch, const int16 *block);
+
+/** Fill a block with two colors, using one pattern byte per row (LSB first). */
+void fillPattern(byte *dest, uint32 pitch, const byte *colors, const byte *pattern);
+
+/** Fill a block with two colors, using one pattern byte per row, scaled up to 16x16. */
+void fillPatternScaled(byte *dest, uint32 pitch, const byte *colors, const byte *pattern);
+
+/** Copy a block of pixels, e.g. from the previous frame. */
+void copyBlock(byte *dest, const byte *src, uint32 pitch);
+
+} // End of namespace BinkDSP
+
+} // End of namespace Video
+
+#endif // VIDEO_BINK_DSP_H
@@ -47,6 +47,47 @@ enum SmkBlockTypes {
 	SMK_BLOCK_FILL = 3
 };
 
+/*
+ * class SmackerBitStream
+ * Reads the bits of a frame LSB first, straight from memory.
+ */
+
+class SmackerBitStream {
+public:
+	/** The data needs kPadding readable bytes after its end. */
+	SmackerBitStream(const byte *data, uint32 size) : _data(data), _size(size), _pos(0) {}
+
+	enum {
+		kPadding = 4
+	};
+
+	/** Peek at up to 24 bits, reading zeros past the end of the data. */
+	uint32 peekBits(uint n) const {
+		uint32 offset = _pos >> 3;
+		uint32 value = offset < _size ? READ_LE_UINT32(_data + offset) : 0;
+		return (value >> (_pos & 7)) & ((1 << n) - 1);
+	}
+
+	uint32 getBits(uint n) {
+		uint32 value = peekBits(n);
+		_pos += n;
+		return value;
+	}
+
+	uint32 getBit() {
+		return getBits(1);
+	}
+
+	void skip(uint n) {
+		_pos += n;
+	}
+
+private:
+	const byte *_data;
+	uint32 _size;
+	uint32 _pos;
+};
+
 /*
  * class SmallHuffmanTree
  * A Huffman-tree to hold 8-bit values.
@@ -143,20 +184,29 @@ public:
 	~BigHuffmanTree();
 
 	void reset();
-	uint32 getCode(Common::BitStream &bs);
+	uint32 getCode(SmackerBitStream &bs);
 private:
 	enum {
 		SMK_NODE = 0x80000000
 	};
 
+	/**
+	 * Codes up to this length are decoded with a single table lookup,
+	 * only longer ones walk the rest of the tree.
+	 */
+	enum {
+		kLookupBits = 12,
+		kLookupSize = 1 << kLookupBits
+	};
+
 	uint32 decodeTree(uint32 prefix, int length);
 
 	uint32  _treeSize;
 	uint32 *_tree;
 	uint32  _last[3];
 
-	uint32 _prefixtree[256];
-	byte _prefixlength[256];
+	uint32 _prefixtree[kLookupSize];
+	byte _prefixlength[kLookupSize];
 
 	/* Used during construction */
 	Common::BitStream &_bs;
@@ -167,6 +217,9 @@ private:
 
 BigHuffmanTree::BigHuffmanTree(Common::BitStream &bs, int allocSize)
 	: _bs(bs) {
+	for (uint32 i = 0; i < kLookupSize; ++i)
+		_prefixtree[i] = _prefixlength[i] = 0;
+
 	uint32 bit = _bs.getBit();
 	if (!bit) {
 		_tree = new uint32[1];
@@ -175,9 +228,6 @@ BigHuffmanTree::BigHuffmanTree(Common::BitStream &bs, int allocSize)
 		return;
 	}
 
-	for (uint32 i = 0; i < 256; ++i)
-		_prefixtree[i] = _prefixlength[i] = 0;
-
 	_loBytes = new SmallHuffmanTree(_bs);
 	_hiBytes = new SmallHuffmanTree(_bs);
 
@@ -223,8 +273,10 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 		_tree[_treeSize] = v;
 
-		if (length <= 8) {
-			for (int i = 0; i < 256; i += (1 << length)) {
+		// The table holds tree indices rather than values, so that the
+		// "last value" escapes below keep working.
+		if (length <= kLookupBits) {
+			for (int i = 0; i < kLookupSize; i += (1 << length)) {
 				_prefixtree[prefix | i] = _treeSize;
 				_prefixlength[prefix | i] = length;
 			}
@@ -243,9 +295,9 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 	uint32 t = _treeSize++;
 
-	if (length == 8) {
+	if (length == kLookupBits) {
 		_prefixtree[prefix] = t;
-		_prefixlength[prefix] = 8;
+		_prefixlength[prefix] = kLookupBits;
 	}
 
 	uint32 r1 = decodeTree(prefix, length + 1);
@@ -256,8 +308,8 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 	return r1+r2+1;
 }
 
-uint32 BigHuffmanTree::getCode(Common::BitStream &bs) {
-	byte peek = bs.peekBits(MIN<uint32>(bs.size() - bs.pos(), 8));
+uint32 BigHuffmanTree::getCode(SmackerBitStream &bs) {
+	uint32 peek = bs.peekBits(kLookupBits);
 	uint32 *p = &_tree[_prefixtree[peek]];
 	bs.skip(_prefixlength[peek]);
 
@@ -391,6 +443,13 @@ bool SmackerDecoder::loadStream(Common::SeekableReadStream *stream) {
 
 	_firstFrameStart = _fileStream->pos();
 
+	// Bit 0 of the frame sizes marks the keyframes
+	uint32 framePos = _firstFrameStart;
+	for (i = 0; i < frameCount; ++i) {
+		_keyframeIndex.addFrame(i, framePos, i == 0 || (_frameSizes[i] & 1));
+		framePos += _frameSizes[i] & ~3;
+	}
+
 	return true;
 }
 
@@ -417,6 +476,35 @@ bool SmackerDecoder::rewind() {
 	return true;
 }
 
+bool SmackerDecoder::seekIntern(const Audio::Timestamp &time) {
+	SmackerVideoTrack *videoTrack = (SmackerVideoTrack *)getTrack(0);
+	return seekToIndexedFrame(videoTrack, videoTrack->getFrameAtTime(time));
+}
+
+bool SmackerDecoder::restartAtKeyframe(uint frame) {
+	SmackerVideoTrack *videoTrack = (SmackerVideoTrack *)getTrack(0);
+
+	// Drop the audio queued for the previous position
+	for (TrackListIterator it = getTrackListBegin(); it != getTrackListEnd(); it++)
+		if ((*it)->getTrackType() == Track::kTrackTypeAudio)
+			(*it)->rewind();
+
+	// Palette records only hold the changes to the previous palette,
+	// so all of them up to the keyframe are needed
+	videoTrack->clearPalette();
+
+	for (uint i = 0; i < frame; i++) {
+		if (_frameTypes[i] & 1) {
+			_fileStream->seek(_keyframeIndex.getPosition(i));
+			videoTrack->unpackPalette(_fileStream);
+		}
+	}
+
+	videoTrack->setCurFrame(frame - 1);
+	_fileStream->seek(_keyframeIndex.getPosition(frame));
+	return true;
+}
+
 void SmackerDecoder::readNextPacket() {
 	SmackerVideoTrack *videoTrack = (SmackerVideoTrack *)getTrack(0);
 
@@ -452,6 +540,12 @@ void SmackerDecoder::readNextPacket() {
 			chunkSize -= 4;    // subtract the next 4 bytes (unpacked data size)
 		}
 
+		// Only the audio from the frame seeked to on is played
+		if (isSkippingFrames()) {
+			_fileStream->skip(chunkSize);
+			continue;
+		}
+
 		handleAudioTrack(i, chunkSize, dataSizeUnpacked);
 	}
 
@@ -463,14 +557,14 @@ void SmackerDecoder::readNextPacket() {
 
 	uint32 frameDataSize = frameSize - (_fileStream->pos() - startPos);
 
-	byte *frameData = (byte *)malloc(frameDataSize + 1);
+	byte *frameData = (byte *)malloc(frameDataSize + SmackerBitStream::kPadding);
 	// Padding to keep the BigHuffmanTrees from reading past the data end
-	frameData[frameDataSize] = 0x00;
+	memset(frameData + frameDataSize, 0, SmackerBitStream::kPadding);
 
 	_fileStream->read(frameData, frameDataSize);
 
-	Common::BitStream8LSB bs(new Common::MemoryReadStream(frameData, frameDataSize + 1, DisposeAfterUse::YES), true);
-	videoTrack->decodeFrame(bs);
+	videoTrack->decodeFrame(frameData, frameDataSize);
+	free(frameData);
 
 	_fileStream->seek(startPos + frameSize);
 }
@@ -560,7 +654,17 @@ void SmackerDecoder::SmackerVideoTrack::readTrees(Common::BitStream &bs, uint32
 	_TypeTree = new BigHuffmanTree(bs, typeSize);
 }
 
-void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStream &bs) {
+void SmackerDecoder::SmackerVideoTrack::decodeFrame(const byte *data, uint32 size) {
+	// For each 4-bit row of a mono block map, which pixels use the high color
+	static const uint32 monoMasks[16] = {
+		0x00000000, 0x000000FF, 0x0000FF00, 0x0000FFFF,
+		0x00FF0000, 0x00FF00FF, 0x00FFFF00, 0x00FFFFFF,
+		0xFF000000, 0xFF0000FF, 0xFF00FF00, 0xFF00FFFF,
+		0xFFFF0000, 0xFFFF00FF, 0xFFFFFF00, 0xFFFFFFFF
+	};
+
+	SmackerBitStream bs(data, size);
+
 	_MMapTree->reset();
 	_MClrTree->reset();
 	_FullTree->reset();
@@ -577,9 +681,10 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStream &bs) {
 	byte *out;
 	uint type, run, j, mode;
 	uint32 p1, p2, clr, map;
-	byte hi, lo;
+	uint32 hi, lo, row;
 	uint i;
 
+	// Rows of 4 pixels are written as one little endian word below
 	while (block < blocks) {
 		type = _TypeTree->getCode(bs);
 		run = getBlockRun((type >> 2) & 0x3f);
@@ -590,14 +695,13 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStream &bs) {
 				clr = _MClrTree->getCode(bs);
 				map = _MMapTree->getCode(bs);
 				out = (byte *)_surface->getPixels() + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
-				hi = clr >> 8;
-				lo = clr & 0xff;
+				hi = (clr >> 8) * 0x01010101;
+				lo = (clr & 0xff) * 0x01010101;
 				for (i = 0; i < 4; i++) {
+					const uint32 mask = monoMasks[map & 15];
+					row = (hi & mask) | (lo & ~mask);
 					for (j = 0; j < doubleY; j++) {
-						out[0] = (map & 1) ? hi : lo;
-						out[1] = (map & 2) ? hi : lo;
-						out[2] = (map & 4) ? hi : lo;
-						out[3] = (map & 8) ? hi : lo;
+						WRITE_LE_UINT32(out, row);
 						out += stride;
 					}
 					map >>= 4;
@@ -628,29 +732,25 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStream &bs) {
 						for (i = 0; i < 4; ++i) {
 							p1 = _FullTree->getCode(bs);
 							p2 = _FullTree->getCode(bs);
+							row = (p1 << 16) | (p2 & 0xffff);
 							for (j = 0; j < doubleY; ++j) {
-								out[2] = p1 & 0xff;
-								out[3] = p1 >> 8;
-								out[0] = p2 & 0xff;
-								out[1] = p2 >> 8;
+								WRITE_LE_UINT32(out, row);
 								out += stride;
 							}
 						}
 						break;
 					case 1:
 						p1 = _FullTree->getCode(bs);
-						out[0] = out[1] = p1 & 0xFF;
-						out[2] = out[3] = p1 >> 8;
+						row = (p1 & 0xff) * 0x0101 | (p1 >> 8) * 0x01010000;
+						WRITE_LE_UINT32(out, row);
 						out += stride;
-						out[0] = out[1] = p1 & 0xFF;
-						out[2] = out[3] = p1 >> 8;
+						WRITE_LE_UINT32(out, row);
 						out += stride;
 						p2 = _FullTree->getCode(bs);
-						out[0] = out[1] = p2 & 0xFF;
-						out[2] = out[3] = p2 >> 8;
+						row = (p2 & 0xff) * 0x0101 | (p2 >> 8) * 0x01010000;
+						WRITE_LE_UINT32(out, row);
 						out += stride;
-						out[0] = out[1] = p2 & 0xFF;
-						out[2] = out[3] = p2 >> 8;
+						WRITE_LE_UINT32(out, row);
 						out += stride;
 						break;
 					case 2:
@@ -660,18 +760,9 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStream &bs) {
 							// http://article.gmane.org/gmane.comp.video.ffmpeg.devel/78768
 							p2 = _FullTree->getCode(bs);
 							p1 = _FullTree->getCode(bs);
-							for (j = 0; j < doubleY; ++j) {
-								out[0] = p1 & 0xff;
-								out[1] = p1 >> 8;
-								out[2] = p2 & 0xff;
-								out[3] = p2 >> 8;
-								out += stride;
-							}
-							for (j = 0; j < doubleY; ++j) {
-								out[0] = p1 & 0xff;
-								out[1] = p1 >> 8;
-								out[2] = p2 & 0xff;
-								out[3] = p2 >> 8;
+							row = (p2 << 16) | (p1 & 0xffff);
+							for (j = 0; j < doubleY * 2; ++j) {
+								WRITE_LE_UINT32(out, row);
 								out += stride;
 							}
 						}
@@ -685,22 +776,28 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStream &bs) {
 				block++;
 			break;
 		case SMK_BLOCK_FILL:
-			uint32 col;
+			// Fill the blocks of the run on each row of blocks at once
 			mode = type >> 8;
-			while (run-- && block < blocks) {
+			while (run && block < blocks) {
+				uint count = MIN<uint>(MIN<uint>(run, blocks - block), bw - block % bw);
 				out = (byte *)_surface->getPixels() + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
-				col = mode * 0x01010101;
 				for (i = 0; i < 4 * doubleY; ++i) {
-					out[0] = out[1] = out[2] = out[3] = col;
+					memset(out, mode, count * 4);
 					out += stride;
 				}
-				++block;
+				block += count;
+				run -= count;
 			}
 			break;
 		}
 	}
 }
 
+void SmackerDecoder::SmackerVideoTrack::clearPalette() {
+	memset(_palette, 0, 3 * 256);
+	_dirtyPalette = true;
+}
+
 void SmackerDecoder::SmackerVideoTrack::unpackPalette(Common::SeekableReadStream *stream) {
 	uint startPos = stream->pos();
 	uint32 len = 4 * stream->readByte();
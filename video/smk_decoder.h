@@ -66,12 +66,15 @@ public:
 	void close();
 
 	bool rewind();
+	bool isSeekable() const { return isVideoLoaded(); }
 
 	// ResidualVM-specific function
 	Common::Rational getFrameRate() const;
 
 protected:
 	void readNextPacket();
+	bool seekIntern(const Audio::Timestamp &time);
+	bool restartAtKeyframe(uint frame);
 	bool supportsAudioTrackSwitching() const { return true; }
 	AudioTrack *getAudioTrack(int index);
 
@@ -96,8 +99,10 @@ protected:
 
 		void readTrees(Common::BitStream &bs, uint32 mMapSize, uint32 mClrSize, uint32 fullSize, uint32 typeSize);
 		void increaseCurFrame() { _curFrame++; }
-		void decodeFrame(Common::BitStream &bs);
+		void setCurFrame(int frame) { _curFrame = frame; }
+		void decodeFrame(const byte *data, uint32 size);
 		void unpackPalette(Common::SeekableReadStream *stream);
+		void clearPalette();
 
 		// ResidualVM-specific code
 		Common::Rational getFrameRate() const { return _frameRate; }
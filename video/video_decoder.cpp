@@ -30,9 +30,27 @@
 #include "common/system.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+/**
+ * A frame decoded ahead of time, along with the state of the video track
+ * right after decoding it.
+ */
+struct VideoDecoder::AheadFrame {
+	AheadFrame() : hasSurface(false), curFrame(-1), nextFrameStartTime(0), endOfTrack(false), dirtyPalette(false) {}
+	~AheadFrame() { surface.free(); }
+
+	Graphics::Surface surface;
+	bool hasSurface;
+	int curFrame;
+	uint32 nextFrameStartTime;
+	bool endOfTrack;
+	bool dirtyPalette;
+	byte palette[256 * 3];
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -48,6 +66,17 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodeAhead = 0;
+	_aheadActive = false;
+	_aheadStop = false;
+	_aheadWanted = false;
+	_aheadTrack = 0;
+	_aheadShown = 0;
+	_aheadJob = 0;
+	_aheadJobRunning = false;
+	_aheadJobIdle = false;
+	_lateFrames = 0;
+	_skippingFrames = false;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -56,7 +85,17 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	// Subclasses close() themselves first, so the worker is normally idle here
+	waitDecodeAheadJob(true);
+	freeDecodeAhead();
+}
+
 void VideoDecoder::close() {
+	flushDecodeAhead();
+	freeDecodeAhead();
+	_lateFrames = 0;
+
 	if (isPlaying())
 		stop();
 
@@ -79,6 +118,7 @@ void VideoDecoder::close() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_keyframeIndex.clear();
 }
 
 bool VideoDecoder::loadFile(const Common::String &filename) {
@@ -175,6 +215,58 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	if (_aheadActive || activateDecodeAhead()) {
+		AheadFrame *frame = 0;
+
+		{
+			Common::StackLock lock(_aheadMutex);
+			if (!_aheadQueue.empty()) {
+				frame = _aheadQueue.front();
+				_aheadQueue.remove_at(0);
+			}
+		}
+
+		if (!frame) {
+			// Nothing is ready: have the worker hand over the frame it is
+			// working on, or decode one if it is idle.
+			if (!_aheadJobRunning)
+				startDecodeAheadJob();
+			waitDecodeAheadJob(false);
+
+			Common::StackLock lock(_aheadMutex);
+			if (!_aheadQueue.empty()) {
+				frame = _aheadQueue.front();
+				_aheadQueue.remove_at(0);
+
+				if (_aheadShown)
+					_lateFrames++;
+			}
+		}
+
+		// The video track has ended
+		if (!frame)
+			return 0;
+
+		if (_aheadShown) {
+			Common::StackLock lock(_aheadMutex);
+			_aheadPool.push_back(_aheadShown);
+		}
+
+		_aheadShown = frame;
+
+		if (frame->dirtyPalette) {
+			memcpy(_aheadPalette, frame->palette, sizeof(_aheadPalette));
+			_palette = _aheadPalette;
+			_dirtyPalette = true;
+		}
+
+		// Keep the worker busy while the caller displays this frame
+		if (!_aheadJobRunning && !frame->endOfTrack)
+			startDecodeAheadJob();
+
+		return frame->hasSurface ? &frame->surface : 0;
+	}
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -200,6 +292,14 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// Frames decoded ahead of time were decoded in the old direction
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
+			stopDecodeAhead();
+			break;
+		}
+	}
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -222,9 +322,14 @@ const byte *VideoDecoder::getPalette() {
 int VideoDecoder::getCurFrame() const {
 	int32 frame = -1;
 
-	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo)
-			frame += ((VideoTrack *)*it)->getCurFrame() + 1;
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			if (_aheadShown && *it == _aheadTrack)
+				frame += _aheadShown->curFrame + 1;
+			else
+				frame += ((VideoTrack *)*it)->getCurFrame() + 1;
+		}
+	}
 
 	return frame;
 }
@@ -261,13 +366,20 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	const VideoTrack *nextVideoTrack = _nextVideoTrack;
+
+	// While decoding ahead, _nextVideoTrack is left alone and the state of
+	// the shown frame is used instead.
+	if (_aheadShown && _aheadShown->endOfTrack)
+		nextVideoTrack = 0;
+
+	if (endOfVideo() || _needsUpdate || !nextVideoTrack)
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = getNextFrameStartTime(nextVideoTrack);
 
-	if (_nextVideoTrack->isReversed()) {
+	if (nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
 		if (nextFrameStartTime >= currentTime)
 			return 0;
@@ -284,7 +396,7 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 
 bool VideoDecoder::endOfVideo() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if (!(*it)->endOfTrack() && (!isPlaying() || (*it)->getTrackType() != Track::kTrackTypeVideo || !_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
+		if (!trackEnded(*it) && (!isPlaying() || (*it)->getTrackType() != Track::kTrackTypeVideo || !_endTimeSet || getNextFrameStartTime((const VideoTrack *)*it) < (uint)_endTime.msecs()))
 			return false;
 
 	return true;
@@ -305,6 +417,8 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	flushDecodeAhead();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -339,6 +453,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	flushDecodeAhead();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -491,6 +607,75 @@ bool VideoDecoder::seekIntern(const Audio::Timestamp &time) {
 	return true;
 }
 
+bool VideoDecoder::seekToIndexedFrame(VideoTrack *track, uint frame) {
+	if (track->getFrameCount() > 0 && frame > (uint)track->getFrameCount())
+		frame = track->getFrameCount();
+
+	if (!restartAtKeyframe(_keyframeIndex.findKeyframe(frame)))
+		return false;
+
+	skipFrames(track, frame);
+	return true;
+}
+
+void VideoDecoder::skipFrames(VideoTrack *track, uint frame) {
+	bool skipOutput = track->setSkipOutput(true);
+	_skippingFrames = true;
+
+	while (!track->endOfTrack() && track->getCurFrame() < (int)frame - 1) {
+		int curFrame = track->getCurFrame();
+
+		readNextPacket();
+		track->decodeNextFrame();
+
+		// Don't spin if the decoder refuses to go on, e.g. while paused
+		if (track->getCurFrame() == curFrame)
+			break;
+	}
+
+	// Only the palette of the last frame matters
+	if (track->hasDirtyPalette()) {
+		_palette = track->getPalette();
+		_dirtyPalette = true;
+	}
+
+	_skippingFrames = false;
+
+	if (skipOutput)
+		track->setSkipOutput(false);
+}
+
+void VideoDecoder::KeyframeIndex::clear() {
+	_positions.clear();
+	_keyframes.clear();
+}
+
+void VideoDecoder::KeyframeIndex::addFrame(uint frame, uint32 position, bool keyframe) {
+	if (frame != _positions.size())
+		return;
+
+	_positions.push_back(position);
+
+	if (keyframe)
+		_keyframes.push_back(frame);
+}
+
+uint VideoDecoder::KeyframeIndex::findKeyframe(uint frame) const {
+	// Find the first keyframe after the frame
+	uint low = 0, high = _keyframes.size();
+
+	while (low < high) {
+		uint mid = (low + high) / 2;
+
+		if (_keyframes[mid] <= frame)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return (low == 0) ? 0 : _keyframes[low - 1];
+}
+
 bool VideoDecoder::setDitheringPalette(const byte *palette) {
 	// If a frame was already decoded, we can't set it now.
 	if (!_canSetDither)
@@ -841,7 +1026,7 @@ const VideoDecoder::Track *VideoDecoder::getTrack(uint track) const {
 
 bool VideoDecoder::endOfVideoTracks() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack())
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !trackEnded(*it))
 			return false;
 
 	return true;
@@ -896,7 +1081,7 @@ bool VideoDecoder::hasFramesLeft() const {
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack() && (!isPlaying() || !_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !trackEnded(*it) && (!isPlaying() || !_endTimeSet || getNextFrameStartTime((const VideoTrack *)*it) < (uint)_endTime.msecs()))
 			return true;
 
 	return false;
@@ -910,4 +1095,219 @@ bool VideoDecoder::hasAudio() const {
 	return false;
 }
 
+void VideoDecoder::setDecodeAhead(uint frames) {
+	if (frames == 0) {
+		stopDecodeAhead();
+	} else {
+		// The worker reads the queue depth, so let it finish first
+		waitDecodeAheadJob(true);
+	}
+
+	_decodeAhead = frames;
+}
+
+uint VideoDecoder::getQueuedFrameCount() const {
+	Common::StackLock lock(_aheadMutex);
+	return _aheadQueue.size();
+}
+
+bool VideoDecoder::isNextFrameReady() const {
+	if (!_aheadActive || !_aheadJobRunning)
+		return true;
+
+	Common::StackLock lock(_aheadMutex);
+	return !_aheadQueue.empty() || _aheadJobIdle;
+}
+
+bool VideoDecoder::activateDecodeAhead() {
+	if (_decodeAhead == 0 || !_nextVideoTrack || g_system->getWorkerCount() == 0)
+		return false;
+
+	// The queued frames only follow a single video track
+	VideoTrack *track = 0;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			if (track)
+				return false;
+
+			track = (VideoTrack *)*it;
+		}
+	}
+
+	_aheadTrack = track;
+	_aheadActive = true;
+	return true;
+}
+
+void VideoDecoder::startDecodeAheadJob() {
+	_aheadStop = false;
+	_aheadWanted = false;
+	_aheadJobIdle = false;
+	_aheadJobRunning = true;
+	_aheadJob = g_system->startWorkerJob(&decodeAheadJob, this);
+}
+
+void VideoDecoder::waitDecodeAheadJob(bool stop) {
+	if (!_aheadJobRunning)
+		return;
+
+	{
+		Common::StackLock lock(_aheadMutex);
+
+		if (stop)
+			_aheadStop = true;
+		else
+			_aheadWanted = true;
+	}
+
+	g_system->waitWorkerJob(_aheadJob);
+	_aheadJob = 0;
+	_aheadJobRunning = false;
+}
+
+void VideoDecoder::decodeAheadJob(void *param) {
+	VideoDecoder *decoder = (VideoDecoder *)param;
+
+	for (;;) {
+		{
+			Common::StackLock lock(decoder->_aheadMutex);
+
+			if (decoder->_aheadStop || decoder->_aheadQueue.size() >= decoder->_decodeAhead)
+				break;
+
+			// Someone is waiting for the next frame
+			if (decoder->_aheadWanted && !decoder->_aheadQueue.empty())
+				break;
+		}
+
+		if (!decoder->decodeAheadFrame())
+			break;
+	}
+
+	// Nothing more will be queued until the job is restarted
+	Common::StackLock lock(decoder->_aheadMutex);
+	decoder->_aheadJobIdle = true;
+}
+
+bool VideoDecoder::decodeAheadFrame() {
+	VideoTrack *track = _aheadTrack;
+
+	if (track->endOfTrack())
+		return false;
+
+	readNextPacket();
+	const Graphics::Surface *surface = track->decodeNextFrame();
+
+	AheadFrame *frame = 0;
+
+	{
+		Common::StackLock lock(_aheadMutex);
+
+		if (!_aheadPool.empty()) {
+			frame = _aheadPool.back();
+			_aheadPool.pop_back();
+		}
+	}
+
+	// There are never more than the queued frames, the shown one and
+	// this one, so the pool stays small.
+	if (!frame)
+		frame = new AheadFrame();
+
+	frame->hasSurface = surface != 0;
+
+	if (surface) {
+		Graphics::Surface &dst = frame->surface;
+
+		if (dst.w != surface->w || dst.h != surface->h || dst.format != surface->format) {
+			dst.free();
+			dst.create(surface->w, surface->h, surface->format);
+		}
+
+		const uint rowSize = surface->w * surface->format.bytesPerPixel;
+		for (int y = 0; y < surface->h; y++)
+			memcpy(dst.getBasePtr(0, y), surface->getBasePtr(0, y), rowSize);
+	}
+
+	frame->curFrame = track->getCurFrame();
+	frame->endOfTrack = track->endOfTrack();
+	frame->nextFrameStartTime = track->getNextFrameStartTime();
+	frame->dirtyPalette = track->hasDirtyPalette();
+
+	if (frame->dirtyPalette)
+		memcpy(frame->palette, track->getPalette(), sizeof(frame->palette));
+
+	Common::StackLock lock(_aheadMutex);
+	_aheadQueue.push_back(frame);
+	return true;
+}
+
+void VideoDecoder::flushDecodeAhead() {
+	if (!_aheadActive)
+		return;
+
+	waitDecodeAheadJob(true);
+
+	{
+		Common::StackLock lock(_aheadMutex);
+
+		for (AheadFrameList::iterator it = _aheadQueue.begin(); it != _aheadQueue.end(); it++)
+			_aheadPool.push_back(*it);
+
+		_aheadQueue.clear();
+
+		if (_aheadShown)
+			_aheadPool.push_back(_aheadShown);
+	}
+
+	_aheadShown = 0;
+	_aheadTrack = 0;
+	_aheadActive = false;
+
+	// The worker does not keep _nextVideoTrack up to date
+	findNextVideoTrack();
+}
+
+void VideoDecoder::stopDecodeAhead() {
+	if (!_aheadActive)
+		return;
+
+	VideoTrack *track = _aheadTrack;
+	int shownFrame = _aheadShown ? _aheadShown->curFrame : track->getCurFrame();
+
+	flushDecodeAhead();
+
+	if (track->getCurFrame() == shownFrame)
+		return;
+
+	Audio::Timestamp time = track->getFrameTime(shownFrame + 1);
+
+	if (time < 0 || !seekIntern(time))
+		warning("VideoDecoder: Could not go back to frame %d after decoding ahead", shownFrame);
+
+	findNextVideoTrack();
+}
+
+void VideoDecoder::freeDecodeAhead() {
+	for (AheadFrameList::iterator it = _aheadPool.begin(); it != _aheadPool.end(); it++)
+		delete *it;
+
+	_aheadPool.clear();
+}
+
+bool VideoDecoder::trackEnded(const Track *track) const {
+	if (_aheadShown && track == _aheadTrack)
+		return _aheadShown->endOfTrack;
+
+	return track->endOfTrack();
+}
+
+uint32 VideoDecoder::getNextFrameStartTime(const VideoTrack *track) const {
+	if (_aheadShown && track == _aheadTrack)
+		return _aheadShown->nextFrameStartTime;
+
+	return track->getNextFrameStartTime();
+}
+
 } // End of namespace Video
@@ -26,8 +26,10 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/mutex.h"
 #include "common/rational.h"
 #include "common/str.h"
+#include "common/system.h"
 #include "graphics/pixelformat.h"
 
 namespace Audio {
@@ -52,7 +54,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -396,6 +398,49 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/**
+	 * Decode frames ahead of time on a worker thread.
+	 *
+	 * When enabled, decodeNextFrame() returns frames that were decoded
+	 * in the background into a pool of surfaces owned by the VideoDecoder,
+	 * and restarts the background decoding for the following ones.
+	 * Seeking, rewinding and reversing the video drop the queued frames.
+	 *
+	 * This has no effect on backends without worker threads, or for videos
+	 * with more than one video track. It is off by default.
+	 *
+	 * @note Audio tracks keep being fed from the worker thread while the main
+	 *       thread queries them, which is fine for the usual queuing streams.
+	 * @param frames The maximum number of frames to decode ahead, or 0 to disable
+	 */
+	void setDecodeAhead(uint frames);
+
+	/**
+	 * Get the maximum number of frames decoded ahead of time.
+	 * @see setDecodeAhead()
+	 */
+	uint getDecodeAhead() const { return _decodeAhead; }
+
+	/**
+	 * Get the number of frames that are ready to be returned by decodeNextFrame().
+	 */
+	uint getQueuedFrameCount() const;
+
+	/**
+	 * Check whether decodeNextFrame() can return without waiting for the
+	 * worker thread. This is always true when not decoding ahead.
+	 *
+	 * Callers which must not block, e.g. timer callbacks, can use this to
+	 * pick up a late frame on their next call instead.
+	 */
+	bool isNextFrameReady() const;
+
+	/**
+	 * Get the number of times decodeNextFrame() had to wait for the worker
+	 * thread because no frame was ready. This is reset by close().
+	 */
+	uint32 getLateFrameCount() const { return _lateFrames; }
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -624,6 +669,18 @@ protected:
 		 */
 		virtual bool isReversed() const { return false; }
 
+		/**
+		 * Skip converting the decoded frames and writing them to the
+		 * surface, while frames are only decoded to reach a later one.
+		 * decodeNextFrame() may return stale data in the meantime.
+		 *
+		 * By default, a VideoTrack always outputs its frames.
+		 *
+		 * @param skip true to skip the output, false to restore it
+		 * @return true for success, false if the track can't skip its output
+		 */
+		virtual bool setSkipOutput(bool skip) { return !skip; }
+
 		/**
 		 * Can the video track dither?
 		 */
@@ -869,6 +926,104 @@ protected:
 	 */
 	VideoTrack *findNextVideoTrack();
 
+	/**
+	 * Whether frames are currently being decoded on a worker thread.
+	 *
+	 * readNextPacket() and the video track's decodeNextFrame() are then
+	 * called from the worker, so they must not start worker jobs on their own.
+	 */
+	bool isDecodingAhead() const { return _aheadActive; }
+
+	/**
+	 * Stop decoding ahead and drop all queued frames.
+	 *
+	 * The video track is moved back to the frame last returned by
+	 * decodeNextFrame(). Subclasses must call this before touching the
+	 * tracks outside of readNextPacket().
+	 */
+	void stopDecodeAhead();
+
+	/**
+	 * The positions of the frames of a video track, and which of them are
+	 * keyframes, that is frames decoding can start from.
+	 *
+	 * Decoders fill it from the container when it has a frame table, or
+	 * while playing. The meaning of a position is up to the decoder,
+	 * usually it is the offset of the frame in the stream.
+	 */
+	class KeyframeIndex {
+	public:
+		/**
+		 * Remove all frames.
+		 */
+		void clear();
+
+		/**
+		 * Add the next frame to the index. Frames have to be added in order,
+		 * starting at 0. Frames which are already indexed, or which would
+		 * leave a gap, are ignored.
+		 */
+		void addFrame(uint frame, uint32 position, bool keyframe);
+
+		/**
+		 * Get the number of frames from the start of the track which are indexed.
+		 */
+		uint getFrameCount() const { return _positions.size(); }
+
+		/**
+		 * Get the position of an indexed frame.
+		 */
+		uint32 getPosition(uint frame) const { return _positions[frame]; }
+
+		/**
+		 * Get the last indexed keyframe at or before the given frame, or 0
+		 * if there is none.
+		 */
+		uint findKeyframe(uint frame) const;
+
+	private:
+		Common::Array<uint32> _positions;
+		Common::Array<uint> _keyframes;
+	};
+
+	/**
+	 * The keyframe index of the video track, for the decoders using
+	 * seekToIndexedFrame(). It is cleared by close().
+	 */
+	KeyframeIndex _keyframeIndex;
+
+	/**
+	 * Seek a video track to the given frame using _keyframeIndex.
+	 *
+	 * The decoder restarts at the last indexed keyframe before the frame
+	 * with restartAtKeyframe(), and the frames in between are then decoded
+	 * with skipFrames().
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool seekToIndexedFrame(VideoTrack *track, uint frame);
+
+	/**
+	 * Prepare for decoding the given keyframe next. This is called by
+	 * seekToIndexedFrame() and must reset the track and the stream.
+	 *
+	 * @return true on success, false otherwise
+	 */
+	virtual bool restartAtKeyframe(uint frame) { return false; }
+
+	/**
+	 * Decode the frames of a video track up to, but not including, the
+	 * given frame, with its output skipped if the track supports it.
+	 */
+	void skipFrames(VideoTrack *track, uint frame);
+
+	/**
+	 * Whether frames are being decoded by skipFrames(). readNextPacket()
+	 * can leave out work only needed for displaying the frame, e.g.
+	 * queueing its audio.
+	 */
+	bool isSkippingFrames() const { return _skippingFrames; }
+
 	/**
 	 * Typedef helpers for accessing tracks
 	 */
@@ -943,6 +1098,38 @@ private:
 	bool hasFramesLeft() const;
 	bool hasAudio() const;
 
+	// Seeking
+	bool _skippingFrames;
+
+	// Decoding ahead on a worker thread
+	struct AheadFrame;
+	typedef Common::Array<AheadFrame *> AheadFrameList;
+
+	uint _decodeAhead;
+	bool _aheadActive;
+	bool _aheadStop;
+	bool _aheadWanted;
+	VideoTrack *_aheadTrack;
+	AheadFrameList _aheadQueue;
+	AheadFrameList _aheadPool;
+	AheadFrame *_aheadShown;
+	OSystem::WorkerJobRef _aheadJob;
+	bool _aheadJobRunning;
+	bool _aheadJobIdle;
+	mutable Common::Mutex _aheadMutex;
+	byte _aheadPalette[256 * 3];
+	uint32 _lateFrames;
+
+	static void decodeAheadJob(void *param);
+	bool decodeAheadFrame();
+	bool activateDecodeAhead();
+	void startDecodeAheadJob();
+	void waitDecodeAheadJob(bool stop);
+	void flushDecodeAhead();
+	void freeDecodeAhead();
+	bool trackEnded(const Track *track) const;
+	uint32 getNextFrameStartTime(const VideoTrack *track) const;
+
 	int32 _startTime;
 	uint32 _pauseLevel;
 	uint32 _pauseStartTime;